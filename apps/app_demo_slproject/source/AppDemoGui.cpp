@@ -13,6 +13,7 @@
 #include <CVCapture.h>
 #include <cv/CVImage.h>
 #include <cv/CVTrackedFeatures.h>
+#include <cv/CVTrackingWorker.h>
 #include <SLAssetManager.h>
 #include <SLAnimPlayback.h>
 #include <SLGLDepthBuffer.h>
@@ -50,10 +51,12 @@
 #endif
 
 //-----------------------------------------------------------------------------
-extern CVTracked*   tracker;      // Global pointer declared in AppDemoTracking
-extern SLNode*      trackedNode;  // Global pointer declared in AppDemoTracking
-extern SLGLTexture* gTexMRI3D;    // Global pointer declared in AppDemoLoad
-extern SLNode*      gDragonModel; // Global pointer declared in AppDemoLoad
+extern CVTracked*       tracker;         // Global pointer declared in AppDemoTracking
+extern SLNode*          trackedNode;     // Global pointer declared in AppDemoTracking
+extern CVTrackingWorker trackingWorker;  // Global tracking worker declared in AppDemoVideo
+extern bool             doAsyncTracking; // Global flag declared in AppDemoVideo
+extern SLGLTexture*     gTexMRI3D;       // Global pointer declared in AppDemoLoad
+extern SLNode*          gDragonModel;    // Global pointer declared in AppDemoLoad
 
 // #define IM_ARRAYSIZE(_ARR) ((int)(sizeof(_ARR) / sizeof(*_ARR)))
 
@@ -417,8 +420,18 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                     sprintf(m + strlen(m), "Window size: %d x %d\n", sv->viewportW(), sv->viewportH());
                     sprintf(m + strlen(m), "Drawcalls  : %d\n", SLGLVertexArray::totalDrawCalls);
                     sprintf(m + strlen(m), " Shadow    : %d\n", SLShadowMap::drawCalls);
+                    sprintf(m + strlen(m), " SM faces  : %d (%d cached)\n", SLShadowMap::facesRendered, SLShadowMap::facesCached);
                     sprintf(m + strlen(m), " Render    : %d\n", SLGLVertexArray::totalDrawCalls - SLShadowMap::drawCalls);
                     sprintf(m + strlen(m), "Primitives : %d\n", SLGLVertexArray::totalPrimitivesRendered);
+                    if (sv->doStateSorting())
+                    {
+                        const SLGLDrawListStats& dls = sv->drawList3D().stats();
+                        sprintf(m + strlen(m), "Draw list  : %d cmds\n", dls.numCommands);
+                        sprintf(m + strlen(m), " Programs  : %d (%d saved)\n", dls.numProgramChanges, dls.numProgramChangesSaved);
+                        sprintf(m + strlen(m), " Materials : %d (%d saved)\n", dls.numMaterialChanges, dls.numMaterialChangesSaved);
+                        sprintf(m + strlen(m), " VAO binds : %d (%d saved)\n", dls.numVAOBinds, dls.numVAOBindsSaved);
+                        sprintf(m + strlen(m), " Uniforms  : %d saved\n", dls.numUniformsSaved);
+                    }
                     sprintf(m + strlen(m), "FPS        : %5.1f\n", s->fps());
                     sprintf(m + strlen(m), "Frame time : %5.1f ms (100%%)\n", ft);
                     sprintf(m + strlen(m), " Capture   : %5.1f ms (%3d%%)\n", captureTime, (SLint)captureTimePC);
@@ -440,6 +453,11 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                         sprintf(m + strlen(m), "   Match   : %5.1f ms (%3d%%)\n", matchTime, (SLint)matchTimePC);
                         sprintf(m + strlen(m), "   OptFlow : %5.1f ms (%3d%%)\n", optFlowTime, (SLint)optFlowTimePC);
                         sprintf(m + strlen(m), "   Pose    : %5.1f ms (%3d%%)\n", poseTime, (SLint)poseTimePC);
+                        if (trackingWorker.isRunning())
+                        {
+                            sprintf(m + strlen(m), "   Latency : %5.1f ms (async)\n", trackingWorker.latencyMS());
+                            sprintf(m + strlen(m), "   Dropped : %d of %d frames\n", trackingWorker.numFramesDropped(), trackingWorker.numFramesDropped() + trackingWorker.numFramesTracked());
+                        }
                     }
 
                     // Wrong value of displayed, need to use a profiler to measure (can't just measure time before and after the draw call and take the difference, not with the GPU)
@@ -589,6 +607,7 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                 sprintf(m + strlen(m), "- WM Updates  :%5d\n", SLNode::numWMUpdates);
                 sprintf(m + strlen(m), "No. of Meshes :%5u\n", stats3D.numMeshes);
                 sprintf(m + strlen(m), "No. of Tri.   :%5u\n", stats3D.numTriangles);
+                sprintf(m + strlen(m), "Vertex ACMR   :%5.2f\n", stats3D.numTriangles ? (SLfloat)stats3D.numCacheMisses / (SLfloat)stats3D.numTriangles : 0.0f);
                 sprintf(m + strlen(m), "CPU MB Total  :%6.2f (100%%)\n", cpuMBTotal);
                 sprintf(m + strlen(m), "-   MB Tex.   :%6.2f (%3d%%)\n", cpuMBTexture, cpuMBTexturePC);
                 sprintf(m + strlen(m), "-   MB Meshes :%6.2f (%3d%%)\n", cpuMBMeshes, cpuMBMeshesPC);
@@ -2193,6 +2212,9 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
             if (ImGui::MenuItem("Do Alpha Sorting", "J", sv->doAlphaSorting()))
                 sv->doAlphaSorting(!sv->doAlphaSorting());
 
+            if (ImGui::MenuItem("Do State Sorting", nullptr, sv->doStateSorting()))
+                sv->doStateSorting(!sv->doStateSorting());
+
             if (ImGui::MenuItem("Do Depth Test", "T", sv->doDepthTest()))
                 sv->doDepthTest(!sv->doDepthTest());
 
@@ -2405,6 +2427,9 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
                     if (ImGui::MenuItem("Draw Detection", nullptr, tracker->drawDetection()))
                         tracker->drawDetection(!tracker->drawDetection());
 
+                if (ImGui::MenuItem("Asynchronous Tracking", nullptr, doAsyncTracking))
+                    doAsyncTracking = !doAsyncTracking;
+
                 if (ImGui::BeginMenu("Feature Tracking", featureTracker != nullptr))
                 {
                     if (ImGui::MenuItem("Force Relocation", nullptr, featureTracker->forceRelocation()))
@@ -3493,6 +3518,20 @@ void AppDemoGui::buildProperties(SLScene* s, SLSceneView* sv)
                                             shadowMap->cascadesFactor(factor);
                                     }
 
+                                    if (!shadowMap->useCascaded())
+                                    {
+                                        SLbool useCaching = shadowMap->useCaching();
+                                        if (ImGui::Checkbox("Cache static casters", &useCaching))
+                                            shadowMap->useCaching(useCaching);
+
+                                        if (useCaching && shadowMap->useCubemap())
+                                        {
+                                            SLint numFaces = shadowMap->numFacesPerFrame();
+                                            if (ImGui::SliderInt("Faces per frame (0=all)", &numFaces, 0, 6))
+                                                shadowMap->numFacesPerFrame(numFaces);
+                                        }
+                                    }
+
                                     SLVec2i texSize = shadowMap->textureSize();
                                     if (ImGui::SliderInt2("Texture resolution", (int*)&texSize, 32, 4096))
                                         shadowMap->textureSize(
@@ -3787,6 +3826,25 @@ void AppDemoGui::buildProperties(SLScene* s, SLSceneView* sv)
                         ImGui::Text("# vertices   : %u", v);
                         ImGui::Text("# triangles  : %u", t);
                         ImGui::Text("# hard edges : %u", e);
+
+                        SLbool compact = singleFullMesh->compactVertices();
+                        if (ImGui::Checkbox("Compact vertices", &compact))
+                            singleFullMesh->compactVertices(compact);
+
+                        if (singleFullMesh->clusters().empty())
+                        {
+                            if (ImGui::Button("Build clusters"))
+                                singleFullMesh->buildClusters();
+                        }
+                        else
+                        {
+                            SLbool doCC = singleFullMesh->doClusterCulling();
+                            if (ImGui::Checkbox("Cluster culling", &doCC))
+                                singleFullMesh->doClusterCulling(doCC);
+                            ImGui::Text("# clusters   : %u / %u",
+                                        singleFullMesh->numClustersDrawn(),
+                                        (SLuint)singleFullMesh->clusters().size());
+                        }
                     }
                     ImGui::Text("Material Name: %s", m->name().c_str());
 
@@ -3900,6 +3958,24 @@ void AppDemoGui::buildProperties(SLScene* s, SLSceneView* sv)
                                 ps->isGenerated(false);
                             }
 
+                            // Update on the CPU instead of with transform feedback
+                            bool doCPUSimulation = ps->doCPUSimulation();
+                            if (ImGui::Checkbox("CPU simulation", &doCPUSimulation))
+                                ps->doCPUSimulation(doCPUSimulation);
+                            if (doCPUSimulation)
+                            {
+                                ImGui::SameLine();
+                                ImGui::Text("(%s)", SLParticleSimulatorCPU::simdName());
+                            }
+
+                            // A fixed seed makes the generation and the CPU simulation reproducible
+                            int randomSeed = (int)ps->randomSeed();
+                            if (ImGui::InputInt("Random seed (0 = clock)", &randomSeed))
+                            {
+                                ps->randomSeed((SLuint)std::max(randomSeed, 0));
+                                ps->isGenerated(false);
+                            }
+
                             // TTL (Time to live)
                             if (ImGui::CollapsingHeader("Time to live"))
                             {
@@ -14,6 +14,7 @@
 #include <cv/CVTrackedChessboard.h>
 #include <cv/CVTrackedFaces.h>
 #include <cv/CVTrackedFeatures.h>
+#include <cv/CVTrackingWorker.h>
 #include <cv/CVCalibrationEstimator.h>
 
 #include <SLAlgo.h>
@@ -32,6 +33,7 @@
 #include <SLLightDirect.h>
 #include <SLLightRect.h>
 #include <SLLightSpot.h>
+#include <SLMeshBatch.h>
 #include <SLFaceAnim.h>
 #include <SLParticleSystem.h>
 #include <SLPoints.h>
@@ -57,9 +59,10 @@
 
 //-----------------------------------------------------------------------------
 // Global pointers declared in AppDemoVideo
-extern SLGLTexture* videoTexture;
-extern CVTracked*   tracker;
-extern SLNode*      trackedNode;
+extern SLGLTexture*     videoTexture;
+extern CVTracked*       tracker;
+extern SLNode*          trackedNode;
+extern CVTrackingWorker trackingWorker;
 //-----------------------------------------------------------------------------
 //! Global pointer to 3D MRI texture for volume rendering for threaded loading
 SLGLTexture* gTexMRI3D = nullptr;
@@ -741,11 +744,8 @@ void appDemoLoadScene(SLAssetManager* am,
 
     SLfloat startLoadMS = GlobalTimer::timeMS();
 
-    // Reset non CVTracked and CVCapture infos
-    CVTracked::resetTimes();                   // delete all tracker times
-    CVCapture::instance()->videoType(VT_NONE); // turn off any video
-
     // Reset asset pointer from previous scenes
+    trackingWorker.stop(); // The worker thread must not use the deleted tracker
     delete tracker;
     tracker      = nullptr;
     videoTexture = nullptr; // The video texture will be deleted by scene uninit
@@ -753,6 +753,10 @@ void appDemoLoadScene(SLAssetManager* am,
     if (sceneID != SID_VolumeRayCastLighted)
         gTexMRI3D = nullptr; // The 3D MRI texture will be deleted by scene uninit
 
+    // Reset non CVTracked and CVCapture infos after the tracking worker stopped
+    CVTracked::resetTimes();                   // delete all tracker times
+    CVCapture::instance()->videoType(VT_NONE); // turn off any video
+
     AppDemo::sceneID   = sceneID;
     SLGLState* stateGL = SLGLState::instance();
 
@@ -2389,6 +2393,7 @@ void appDemoLoadScene(SLAssetManager* am,
         light->createsShadows(true);
         light->createShadowMap();
         light->shadowMap()->rayCount(SLVec2i(16, 16));
+        light->shadowMap()->useCaching(true); // see SLShadowMap::useCaching
         light->castsShadows(false);
         scene->addChild(light);
 
@@ -2988,9 +2993,10 @@ resolution shadows near the camera and lower resolution shadows further away.");
             light1->shadowMaxBias(0.003f);
             scene->addChild(light1);
 
-            // Import main model
+            // Import main model. The many small meshes of Sponza get reordered for the vertex cache.
             SLAssimpImporter importer;
-            SLNode*          pbrGroup = importer.load(s->animManager(),
+            importer.optimizeMeshes(sceneID == SID_glTF_Sponza);
+            SLNode* pbrGroup = importer.load(s->animManager(),
                                              am,
                                              modelFile,
                                              Utils::getPath(modelFile),
@@ -3001,6 +3007,10 @@ resolution shadows near the camera and lower resolution shadows further away.");
                                              0.4f);   // 40% ambient reflection
             scene->addChild(pbrGroup);
 
+            // Sponza has a few hundred static nodes that share a few materials
+            if (sceneID == SID_glTF_Sponza)
+                SLMeshBatch::batchStaticNodes(am, pbrGroup, &s->animManager());
+
             s->skybox(skybox);
             sv->camera(cam1);
             sv->doWaitOnIdle(true); // Saves energy
@@ -6357,6 +6367,10 @@ resolution shadows near the camera and lower resolution shadows further away.");
                                          nullptr,
                                          SLProcess_Triangulate | SLProcess_JoinIdenticalVertices);
 
+            // Split the large mesh into clusters for the cluster culling
+            for (auto* mesh : importer.meshes())
+                mesh->buildClusters();
+
             SLNode* scene = new SLNode("Scene");
             s->root3D(scene);
             scene->addChild(light1);
@@ -6859,6 +6873,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
             ps->doColor(true);
             ps->color(SLCol4f(0.875f, 0.156f, 0.875f, 1.0f));
             ps->speed(0.0f);
+            ps->randomSeed(1); // same particles in every benchmark run
             SLMesh* pSMesh = ps;
             SLNode* pSNode = new SLNode(pSMesh, "Particle system node");
             root->addChild(pSNode);
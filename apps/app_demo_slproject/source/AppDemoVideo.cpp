@@ -12,6 +12,7 @@
 #include <SLSceneView.h>
 #include <CVCapture.h>
 #include <cv/CVTrackedAruco.h>
+#include <cv/CVTrackingWorker.h>
 #include <SLGLTexture.h>
 #include <cv/CVCalibrationEstimator.h>
 #include <AppDemoSceneView.h>
@@ -33,6 +34,13 @@ CVTracked* tracker = nullptr;
  it gets updated in the following onUpdateTracking routine */
 SLNode* trackedNode = nullptr;
 
+/*! Global tracking worker that runs the tracker in its own thread if
+ doAsyncTracking is true. It gets started in the following onUpdateVideo routine */
+CVTrackingWorker trackingWorker;
+
+/*! Global flag for the asynchronous tracking with the trackingWorker */
+bool doAsyncTracking = false;
+
 //-----------------------------------------------------------------------------
 // always update scene camera fovV from calibration because the calibration may have
 // been adapted in adjustForSL after a change of aspect ratio!
@@ -245,14 +253,38 @@ bool onUpdateVideo()
 
             if (tracker && trackedNode)
             {
-                bool foundPose = tracker->track(CVCapture::instance()->lastFrameGray,
-                                                CVCapture::instance()->lastFrame,
-                                                &ac->calibration);
+                bool      foundPose;
+                CVMatx44f cvOVM;
+
+                if (doAsyncTracking)
+                {
+                    // The frame is tracked in the worker thread and the pose
+                    // of an older frame gets extrapolated to the frame time
+                    if (trackingWorker.tracker() != tracker)
+                        trackingWorker.start(tracker);
+
+                    SLfloat frameTimeS = GlobalTimer::timeS();
+                    trackingWorker.pushFrame(CVCapture::instance()->lastFrameGray,
+                                             CVCapture::instance()->lastFrame,
+                                             ac->calibration,
+                                             frameTimeS);
+                    foundPose = trackingWorker.poseAtTime(frameTimeS, cvOVM);
+                }
+                else
+                {
+                    if (trackingWorker.isRunning())
+                        trackingWorker.stop();
+
+                    foundPose = tracker->track(CVCapture::instance()->lastFrameGray,
+                                               CVCapture::instance()->lastFrame,
+                                               &ac->calibration);
+                    cvOVM     = tracker->objectViewMat();
+                }
+
                 if (foundPose)
                 {
                     // clang-format off
                     // convert matrix type CVMatx44f to SLMat4f
-                    CVMatx44f cvOVM = tracker->objectViewMat();
                     SLMat4f glOVM(cvOVM.val[0], cvOVM.val[1], cvOVM.val[2], cvOVM.val[3],
                                   cvOVM.val[4], cvOVM.val[5], cvOVM.val[6], cvOVM.val[7],
                                   cvOVM.val[8], cvOVM.val[9], cvOVM.val[10],cvOVM.val[11],
@@ -320,7 +352,8 @@ bool onUpdateVideo()
                                              CVCapture::instance()->format,
                                              CVCapture::instance()->lastFrame.data,
                                              CVCapture::instance()->lastFrame.isContinuous(),
-                                             true);
+                                             true,
+                                             (SLuint)CVCapture::instance()->lastFrame.step);
             }
         }
         else
@@ -200,13 +200,16 @@ bool CVCapture::grabAndAdjustForSL(float viewportWdivH)
     {
         if (_captureDevice.isOpened())
         {
-            if (!_captureDevice.read(lastFrame))
+            // Read into a pooled buffer that keeps its memory between frames
+            CVMat& frame = _framePool.nextFree();
+
+            if (!_captureDevice.read(frame))
             {
                 // Try to loop the video
                 if (!videoFilename.empty() && videoLoops)
                 {
                     _captureDevice.set(cv::CAP_PROP_POS_FRAMES, 0);
-                    if (!_captureDevice.read(lastFrame))
+                    if (!_captureDevice.read(frame))
                         return false;
                 }
                 else
@@ -214,8 +217,9 @@ bool CVCapture::grabAndAdjustForSL(float viewportWdivH)
             }
 #if defined(ANDROID)
             // Convert BGR to RGB on mobile phones
-            cvtColor(CVCapture::lastFrame, CVCapture::lastFrame, cv::COLOR_BGR2RGB, 3);
+            cvtColor(frame, frame, cv::COLOR_BGR2RGB, 3);
 #endif
+            lastFrame = frame;
             adjustForSL(viewportWdivH);
         }
         else
@@ -257,13 +261,17 @@ void CVCapture::loadIntoLastFrame(const float       viewportWdivH,
         CVMat yuv(height + height / 2, width, CV_8UC1, (void*)data);
 
         // Android image copy loop #1
-        cvtColor(yuv, CVCapture::lastFrame, cv::COLOR_YUV2RGB_NV21, 3);
+        CVMat& frame = _framePool.nextFree();
+        cvtColor(yuv, frame, cv::COLOR_YUV2RGB_NV21, 3);
+        CVCapture::lastFrame = frame;
     }
     // convert 4 channel images to 3 channel
     else if (newFormat == PF_bgra || format == PF_rgba)
     {
-        CVMat rgba(height, width, CV_8UC4, (void*)data);
-        cvtColor(rgba, CVCapture::lastFrame, cv::COLOR_RGBA2RGB, 3);
+        CVMat  rgba(height, width, CV_8UC4, (void*)data);
+        CVMat& frame = _framePool.nextFree();
+        cvtColor(rgba, frame, cv::COLOR_RGBA2RGB, 3);
+        CVCapture::lastFrame = frame;
     }
     else
     {
@@ -376,8 +384,9 @@ void CVCapture::adjustForSL(float viewportWdivH)
     // 2) Crop Video image to the aspect ratio of OpenGL background //
     //////////////////////////////////////////////////////////////////
 
-    // Cropping is done almost always.
-    // So this is Android image copy loop #2
+    // Cropping is done almost always. The cropped image is only a region of
+    // interest (ROI) on the captured frame, so no pixels are copied. The ROI
+    // is not continuous anymore: Pass lastFrame.step to the texture upload.
 
     float inWdivH = (float)lastFrame.cols / (float)lastFrame.rows;
     // viewportWdivH is negative the viewport aspect will be the same
@@ -425,7 +434,7 @@ void CVCapture::adjustForSL(float viewportWdivH)
             if (hModulo4 == 3) height++;
         }
 
-        lastFrame(CVRect(cropW, cropH, width, height)).copyTo(lastFrame);
+        lastFrame = lastFrame(CVRect(cropW, cropH, width, height));
         // imwrite("AfterCropping.bmp", lastFrame);
     }
 
@@ -434,24 +443,18 @@ void CVCapture::adjustForSL(float viewportWdivH)
     //////////////////
 
     // Mirroring is done for most selfie cameras.
-    // So this is Android image copy loop #3
+    // The flip writes into a buffer of its own pool, so that the captured
+    // and the mirrored buffers keep their sizes. So this is Android image
+    // copy loop #2
 
-    if (activeCamera->calibration.isMirroredH())
-    {
-        CVMat mirrored;
-        if (activeCamera->calibration.isMirroredV())
-            cv::flip(lastFrame, mirrored, -1);
-        else
-            cv::flip(lastFrame, mirrored, 1);
-        lastFrame = mirrored;
-    }
-    else if (activeCamera->calibration.isMirroredV())
+    bool mirrorH = activeCamera->calibration.isMirroredH();
+    bool mirrorV = activeCamera->calibration.isMirroredV();
+
+    if (mirrorH || mirrorV)
     {
-        CVMat mirrored;
-        if (activeCamera->calibration.isMirroredH())
-            cv::flip(lastFrame, mirrored, -1);
-        else
-            cv::flip(lastFrame, mirrored, 0);
+        int    flipCode = mirrorH && mirrorV ? -1 : mirrorH ? 1 : 0;
+        CVMat& mirrored = _mirrorPool.nextFree();
+        cv::flip(lastFrame, mirrored, flipCode);
         lastFrame = mirrored;
     }
 
@@ -460,10 +463,12 @@ void CVCapture::adjustForSL(float viewportWdivH)
     /////////////////////////
 
     // Creating a grayscale version from an YUV input source is stupid.
-    // We just could take the Y channel.
-    // Android image copy loop #4
+    // We just could take the Y channel (see copyYUVPlanes).
+    // Android image copy loop #3
 
-    cv::cvtColor(lastFrame, lastFrameGray, cv::COLOR_BGR2GRAY);
+    CVMat& gray = _grayPool.nextFree();
+    cv::cvtColor(lastFrame, gray, cv::COLOR_BGR2GRAY);
+    lastFrameGray = gray;
 
     // Reset calibrated image size
     if (lastFrame.size() != activeCamera->calibration.imageSize())
@@ -691,9 +696,12 @@ void CVCapture::copyYUVPlanes(float  scrWdivH,
     bool mirrorH = CVCapture::activeCamera->mirrorH();
     bool mirrorV = CVCapture::activeCamera->mirrorV();
 
-    // Create output color (BGR) and grayscale images
-    lastFrame     = CVMat(dstH, dstW, CV_8UC(3));
-    lastFrameGray = CVMat(dstH, dstW, CV_8UC(1));
+    // Get output color (BGR) and grayscale images from the frame pools.
+    // The Y channel is copied into the grayscale image in the same loop as
+    // the color conversion. A view on the y-plane is not possible because
+    // the plane belongs to the camera and can be cropped and mirrored.
+    lastFrame     = _framePool.nextFree(dstH, dstW, CV_8UC(3));
+    lastFrameGray = _grayPool.nextFree(dstH, dstW, CV_8UC(1));
     format        = CVImage::cvType2glPixelFormat(lastFrame.type());
 
     // Bugfix on some devices with wrong pixel offsets
@@ -22,6 +22,7 @@ for a good top down information.
 
 #include <cv/CVTypedefs.h>
 #include <cv/CVImage.h>
+#include <cv/CVFramePool.h>
 #include <Averaged.h>
 #include <opencv2/opencv.hpp>
 #include <cv/CVCamera.h>
@@ -48,7 +49,10 @@ The live video image grabbing is not mandatory and can be replaced by the the
 top level application with its own video grabbing functionality. This is e.g.
 used in the iOS or Android examples.
 The CVCapture::lastFrame and CVCapture::lastFrameGray are on the other
-hand used in all applications as the buffer for the last captured image.\n
+hand used in all applications as the buffer for the last captured image.
+Both are views on buffers of a CVFramePool that are reused from frame to
+frame. CVCapture::lastFrame is cropped as a region of interest and is
+therefore in general not continuous.\n
 Alternatively CVCapture can open a video file by a given videoFilename.
 This feature can be used across all platforms.
 For more information on video and capture see:\n
@@ -142,6 +146,9 @@ private:
     CVVideoCapture _captureDevice;  //!< OpenCV capture device
     AvgFloat       _captureTimesMS; //!< Averaged time for video capturing in ms
     HighResTimer   _timer;          //!< High resolution timer
+    CVFramePool    _framePool;      //!< Reused buffers for the captured color frames
+    CVFramePool    _mirrorPool;     //!< Reused buffers for the mirrored color frames
+    CVFramePool    _grayPool;       //!< Reused buffers for the grayscale frames
 };
 //-----------------------------------------------------------------------------
 #endif // CVCapture_H
@@ -1,6 +1,121 @@
 #include <WAIMapStorage.h>
 #include <Profiler.h>
 
+#if defined(_WIN32)
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+/*! Read-only view on the content of a whole file. The file is memory mapped,
+ so that only the pages that are accessed get read. If the mapping fails the
+ file is read into a buffer.
+*/
+class WAIMappedFile
+{
+public:
+    ~WAIMappedFile() { close(); }
+
+    bool open(const std::string& path)
+    {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            {
+                HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping)
+                {
+                    _data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                    if (_data)
+                    {
+                        _size   = (size_t)fileSize.QuadPart;
+                        _mapped = true;
+                    }
+                }
+            }
+            CloseHandle(file);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED)
+                {
+                    _data   = (uint8_t*)addr;
+                    _size   = (size_t)st.st_size;
+                    _mapped = true;
+                }
+            }
+            ::close(fd);
+        }
+#endif
+        if (_mapped)
+            return true;
+
+        // fallback: read the whole file into a buffer
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f)
+            return false;
+
+        fseek(f, 0, SEEK_END);
+        long contentSize = ftell(f);
+        rewind(f);
+
+        if (contentSize > 0)
+        {
+            _buffer.resize((size_t)contentSize);
+            if (fread(_buffer.data(), 1, _buffer.size(), f) == _buffer.size())
+            {
+                _data = _buffer.data();
+                _size = _buffer.size();
+            }
+        }
+        fclose(f);
+
+        return _data != nullptr;
+    }
+
+    void close()
+    {
+        if (_mapped)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(_data);
+#else
+            munmap(_data, _size);
+#endif
+        }
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+        _data   = nullptr;
+        _size   = 0;
+        _mapped = false;
+    }
+
+    uint8_t* data() const { return _data; }
+    size_t   size() const { return _size; }
+
+private:
+    uint8_t*             _data   = nullptr; //!< Start of the file content
+    size_t               _size   = 0;       //!< Size of the file content in bytes
+    bool                 _mapped = false;   //!< True if _data is a memory mapping
+    std::vector<uint8_t> _buffer;           //!< File content if the mapping failed
+};
+//-----------------------------------------------------------------------------
+
 cv::Mat WAIMapStorage::convertToCVMat(const SLMat4f slMat)
 {
     cv::Mat cvMat = cv::Mat(4, 4, CV_32F);
@@ -155,6 +270,41 @@ void saveKeyFrames(std::vector<WAIKeyFrame*>&                        kfs,
 
             fs << "BowVectorWordsId" << wordsId;
             fs << "TfIdf" << tfIdf;
+
+            // the feature vector is stored as node ids, NO. of features per node and feature indices
+            // (the feature indices are remapped like the keypoints and descriptors)
+            WAIFeatVector&                  featVec  = kf->mFeatVec;
+            const std::map<size_t, size_t>* matching = KFmatching.size() > 0 ? &KFmatching[kf] : nullptr;
+            std::vector<int>                nodeIds;
+            std::vector<int>                nodeSizes;
+            std::vector<int>                featIndices;
+            for (auto it = featVec.getFeatMapping().begin(); it != featVec.getFeatMapping().end(); it++)
+            {
+                int nodeSize = 0;
+                for (unsigned int featIdx : it->second)
+                {
+                    if (matching)
+                    {
+                        auto mit = matching->find(featIdx);
+                        if (mit == matching->end())
+                            continue;
+                        featIndices.push_back((int)mit->second);
+                    }
+                    else
+                        featIndices.push_back((int)featIdx);
+                    nodeSize++;
+                }
+
+                if (nodeSize > 0)
+                {
+                    nodeIds.push_back((int)it->first);
+                    nodeSizes.push_back(nodeSize);
+                }
+            }
+
+            fs << "FeatVecNodeIds" << nodeIds;
+            fs << "FeatVecNodeSizes" << nodeSizes;
+            fs << "FeatVecIndices" << featIndices;
         }
 
         // scale factor
@@ -389,6 +539,20 @@ void WAIMapStorage::writeCVMatToBinaryFile(FILE* f, const cv::Mat& mat)
     writeVectorToBinaryFile(f, data);
 }
 
+/*! Writes the map in the binary format of version binaryMapVersion:
+ - MapInfo, followed by the 4x4 float matrix of the map node if nodeOmSaved
+ - DescriptorBlockInfo and the descriptors of all keyframes as one contiguous
+   block of 32 byte rows in the order of the keyframes in the file
+ - per keyframe: KeyFrameInfo, K, pose, loop edge ids, keypoints, bow vector
+   (word ids and tf-idf values), FeatVecInfo, feature vector (node ids, NO. of
+   indices per node and all feature indices) and the complete covisibility
+   weights (keyframe ids and weights)
+ - per map point: MapPointInfo, world position, observing keyframe ids,
+   corresponding keypoint indices, normal and descriptor
+ The parent ids of the keyframes form the spanning tree. Together with the
+ stored covisibility graph, bow and feature vectors nothing has to be
+ recomputed during loadMapBinary.
+*/
 bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
                                   SLNode*     mapNode,
                                   std::string filename,
@@ -411,8 +575,14 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
     }
 
     WAIMapStorage::MapInfo mapInfo = {};
-    mapInfo.version                = 1;
-
+    mapInfo.version                = binaryMapVersion;
+
+    // collect the saved keyframes with their (remapped) descriptors and keypoints
+    std::vector<WAIKeyFrame*> savedKfs;
+    std::vector<cv::Mat>      kfDescriptors;
+    std::vector<CVVKeyPoint>  kfKeyPoints;
+    std::set<WAIKeyFrame*>    savedKfSet;
+    int32_t                   descriptorRows = 0;
     for (int i = 0; i < kfs.size(); ++i)
     {
         WAIKeyFrame* kf = kfs[i];
@@ -421,9 +591,38 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
         if (kf->mBowVec.data.empty())
             continue;
 
-        mapInfo.kfCount++;
+        cv::Mat     descriptors;
+        CVVKeyPoint keyPoints;
+        if (KFmatching.size() > 0)
+        {
+            const std::map<size_t, size_t>& matching = KFmatching[kf];
+            descriptors.create((int)matching.size(), 32, CV_8U);
+            keyPoints.resize(matching.size());
+            for (int j = 0; j < kf->mvKeysUn.size(); j++)
+            {
+                auto it = matching.find(j);
+                if (it != matching.end())
+                {
+                    kf->mDescriptors.row(j).copyTo(descriptors.row(it->second));
+                    keyPoints[it->second] = kf->mvKeysUn[j];
+                }
+            }
+        }
+        else
+        {
+            descriptors = kf->mDescriptors;
+            keyPoints   = kf->mvKeysUn;
+        }
+
+        savedKfs.push_back(kf);
+        savedKfSet.insert(kf);
+        kfDescriptors.push_back(descriptors);
+        kfKeyPoints.push_back(keyPoints);
+        descriptorRows += descriptors.rows;
     }
 
+    mapInfo.kfCount = (int32_t)savedKfs.size();
+
     for (int i = 0; i < mpts.size(); ++i)
     {
         WAIMapPoint* mpt = mpts[i];
@@ -450,14 +649,18 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
         writeCVMatToBinaryFile(f, cvOm);
     }
 
+    // contiguous descriptor block of all keyframes
+    DescriptorBlockInfo descriptorBlockInfo = {};
+    descriptorBlockInfo.rows                = descriptorRows;
+    fwrite(&descriptorBlockInfo, sizeof(DescriptorBlockInfo), 1, f);
+    for (const cv::Mat& descriptors : kfDescriptors)
+        writeCVMatToBinaryFile(f, descriptors);
+
     // start keyframes sequence
-    for (int i = 0; i < kfs.size(); ++i)
+    for (int i = 0; i < savedKfs.size(); ++i)
     {
-        WAIKeyFrame* kf = kfs[i];
-        if (kf->isBad())
-            continue;
-        if (kf->mBowVec.data.empty())
-            continue;
+        WAIKeyFrame*       kf        = savedKfs[i];
+        const CVVKeyPoint& keyPoints = kfKeyPoints[i];
 
         WAIMapStorage::KeyFrameInfo kfInfo = {};
 
@@ -473,29 +676,6 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
         kfInfo.maxX = kf->mnMaxX;
         kfInfo.maxY = kf->mnMaxY;
 
-        cv::Mat     descriptors;
-        CVVKeyPoint keyPoints;
-        if (KFmatching.size() > 0)
-        {
-            const std::map<size_t, size_t>& matching = KFmatching[kf];
-            descriptors.create((int)matching.size(), 32, CV_8U);
-            keyPoints.resize(matching.size());
-            for (int j = 0; j < kf->mvKeysUn.size(); j++)
-            {
-                auto it = matching.find(j);
-                if (it != matching.end())
-                {
-                    kf->mDescriptors.row(j).copyTo(descriptors.row(it->second));
-                    keyPoints[it->second] = kf->mvKeysUn[j];
-                }
-            }
-        }
-        else
-        {
-            descriptors = kf->mDescriptors;
-            keyPoints   = kf->mvKeysUn;
-        }
-
         kfInfo.kpCount = keyPoints.size();
 
         if (kf->mnId != 0) // kf with id 0 has no parent
@@ -517,6 +697,10 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
 
         std::vector<int32_t> wordsId;
         std::vector<float>   tfIdf;
+        FeatVecInfo          featVecInfo = {};
+        std::vector<int32_t> featNodeIds;
+        std::vector<int32_t> featNodeSizes;
+        std::vector<int32_t> featIndices;
         if (saveBOW)
         {
             WAIBowVector& bowVec = kf->mBowVec;
@@ -529,30 +713,61 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
             }
 
             kfInfo.bowVecSize = wordsId.size();
+
+            // the feature indices are remapped like the keypoints and descriptors
+            WAIFeatVector&                  featVec  = kf->mFeatVec;
+            const std::map<size_t, size_t>* matching = KFmatching.size() > 0 ? &KFmatching[kf] : nullptr;
+            for (auto it = featVec.getFeatMapping().begin();
+                 it != featVec.getFeatMapping().end();
+                 it++)
+            {
+                int32_t nodeSize = 0;
+                for (unsigned int featIdx : it->second)
+                {
+                    if (matching)
+                    {
+                        auto mit = matching->find(featIdx);
+                        if (mit == matching->end())
+                            continue;
+                        featIndices.push_back((int32_t)mit->second);
+                    }
+                    else
+                        featIndices.push_back((int32_t)featIdx);
+                    nodeSize++;
+                }
+
+                if (nodeSize)
+                {
+                    featNodeIds.push_back(it->first);
+                    featNodeSizes.push_back(nodeSize);
+                }
+            }
+
+            featVecInfo.nodeCount  = featNodeIds.size();
+            featVecInfo.indexCount = featIndices.size();
         }
 
-        std::vector<int32_t>      bestCovisibleKeyFrameIds;
-        std::vector<int32_t>      bestCovisibleWeights;
-        std::vector<WAIKeyFrame*> bestCovisibles = kf->GetBestCovisibilityKeyFrames(20);
-        for (WAIKeyFrame* covisible : bestCovisibles)
+        // store all covisibility weights of the saved keyframes
+        std::vector<int32_t>        covisibleKeyFrameIds;
+        std::vector<int32_t>        covisibleWeights;
+        std::map<WAIKeyFrame*, int> covisibles = kf->GetConnectedKfWeights();
+        for (auto& covisible : covisibles)
         {
-            if (covisible->isBad())
+            if (covisible.first->isBad() || covisible.second == 0)
                 continue;
-            int weight = kf->GetWeight(covisible);
-            if (weight)
-            {
-                bestCovisibleKeyFrameIds.push_back(covisible->mnId);
-                bestCovisibleWeights.push_back(weight);
-            }
+            if (savedKfSet.find(covisible.first) == savedKfSet.end())
+                continue;
+
+            covisibleKeyFrameIds.push_back(covisible.first->mnId);
+            covisibleWeights.push_back(covisible.second);
         }
 
-        kfInfo.covisiblesCount = bestCovisibleKeyFrameIds.size();
+        kfInfo.covisiblesCount = covisibleKeyFrameIds.size();
 
         fwrite(&kfInfo, sizeof(KeyFrameInfo), 1, f);
         writeCVMatToBinaryFile(f, kf->mK);
         writeCVMatToBinaryFile(f, kf->GetPose());
         writeVectorToBinaryFile(f, loopEdgeIds);
-        writeCVMatToBinaryFile(f, descriptors);
         writeVectorToBinaryFile(f, keyPoints);
 
         if (saveBOW)
@@ -561,8 +776,13 @@ bool WAIMapStorage::saveMapBinary(WAIMap*     waiMap,
             writeVectorToBinaryFile(f, tfIdf);
         }
 
-        writeVectorToBinaryFile(f, bestCovisibleKeyFrameIds);
-        writeVectorToBinaryFile(f, bestCovisibleWeights);
+        fwrite(&featVecInfo, sizeof(FeatVecInfo), 1, f);
+        writeVectorToBinaryFile(f, featNodeIds);
+        writeVectorToBinaryFile(f, featNodeSizes);
+        writeVectorToBinaryFile(f, featIndices);
+
+        writeVectorToBinaryFile(f, covisibleKeyFrameIds);
+        writeVectorToBinaryFile(f, covisibleWeights);
 
         // save the original frame image for this keyframe
         if (imgDir != "")
@@ -673,12 +893,102 @@ cv::Mat WAIMapStorage::loadCVMatFromBinaryStream(uint8_t** data,
     return result;
 }
 
-bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
-                                  cv::Mat&          mapNodeOm,
-                                  WAIOrbVocabulary* voc,
-                                  std::string       path,
-                                  bool              loadImgs,
-                                  bool              fixKfsAndMPts)
+/*! Returns the size in bytes of the keyframe record that starts at record or 0
+ if the record is not valid: if it does not end before end, has negative counts
+ or a feature vector that refers to other indices than the keypoints.
+*/
+size_t WAIMapStorage::keyFrameRecordSize(const uint8_t* record,
+                                         const uint8_t* end,
+                                         int32_t        version)
+{
+    const uint64_t available = (uint64_t)(end - record);
+    if (available < sizeof(KeyFrameInfo))
+        return 0;
+
+    const KeyFrameInfo* kfInfo = (const KeyFrameInfo*)record;
+    if (kfInfo->loopEdgesCount < 0 || kfInfo->kpCount < 0 ||
+        kfInfo->bowVecSize < 0 || kfInfo->covisiblesCount < 0 ||
+        kfInfo->scaleLevels < 1)
+        return 0;
+
+    uint64_t size = sizeof(KeyFrameInfo);
+    size += (9 + 16) * sizeof(float); // K and Tcw
+    size += (uint64_t)kfInfo->loopEdgesCount * sizeof(int32_t);
+    if (version < 2)
+        size += (uint64_t)kfInfo->kpCount * 32; // descriptors
+    size += (uint64_t)kfInfo->kpCount * sizeof(cv::KeyPoint);
+    size += (uint64_t)kfInfo->bowVecSize * (sizeof(int32_t) + sizeof(float));
+    if (version >= 2)
+    {
+        if (available < size + sizeof(FeatVecInfo))
+            return 0;
+
+        const FeatVecInfo* featVecInfo = (const FeatVecInfo*)(record + size);
+        if (featVecInfo->nodeCount < 0 || featVecInfo->indexCount < 0)
+            return 0;
+
+        size += sizeof(FeatVecInfo);
+        const uint64_t nodeIdsOffset = size;
+        size += (uint64_t)featVecInfo->nodeCount * 2 * sizeof(int32_t);
+        size += (uint64_t)featVecInfo->indexCount * sizeof(int32_t);
+        if (available < size)
+            return 0;
+
+        const int32_t* nodeSizes = (const int32_t*)(record + nodeIdsOffset) + featVecInfo->nodeCount;
+        const int32_t* indices   = nodeSizes + featVecInfo->nodeCount;
+
+        // the nodes must partition the indices of the keypoints
+        int64_t indexCount = 0;
+        for (int32_t i = 0; i < featVecInfo->nodeCount; i++)
+        {
+            if (nodeSizes[i] < 0)
+                return 0;
+            indexCount += nodeSizes[i];
+        }
+        if (indexCount != featVecInfo->indexCount)
+            return 0;
+        for (int32_t i = 0; i < featVecInfo->indexCount; i++)
+            if (indices[i] < 0 || indices[i] >= kfInfo->kpCount)
+                return 0;
+    }
+    size += (uint64_t)kfInfo->covisiblesCount * 2 * sizeof(int32_t);
+
+    return available < size ? 0 : (size_t)size;
+}
+
+//! Returns the size in bytes of the map point record that starts at record or 0 if it is not valid
+size_t WAIMapStorage::mapPointRecordSize(const uint8_t* record,
+                                         const uint8_t* end)
+{
+    const uint64_t available = (uint64_t)(end - record);
+    if (available < sizeof(MapPointInfo))
+        return 0;
+
+    const MapPointInfo* mpInfo = (const MapPointInfo*)record;
+    if (mpInfo->nObervations < 0)
+        return 0;
+
+    uint64_t size = sizeof(MapPointInfo);
+    size += 3 * sizeof(float);                                    // world position
+    size += (uint64_t)mpInfo->nObervations * 2 * sizeof(int32_t); // observing keyframes and keypoints
+    size += 3 * sizeof(float);                                    // normal
+    size += 32;                                                   // descriptor
+
+    return available < size ? 0 : (size_t)size;
+}
+
+/*! Loads a map of the binary format written by saveMapBinary. If a region is
+ passed only the keyframes in the map tiles of the region are loaded (see
+ WAIMapTiles) together with the map points they observe. The tiles are defined
+ by the tiling of the keyframe database of waiMap.
+*/
+bool WAIMapStorage::loadMapBinary(WAIMap*                    waiMap,
+                                  cv::Mat&                   mapNodeOm,
+                                  WAIOrbVocabulary*          voc,
+                                  std::string                path,
+                                  bool                       loadImgs,
+                                  bool                       fixKfsAndMPts,
+                                  const WAIMapTiles::Region* region)
 {
     PROFILE_FUNCTION();
 
@@ -696,34 +1006,124 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         imgDir          = dir + Utils::getFileNameWOExt(path) + "/";
     }
 
-    FILE* f = fopen(path.c_str(), "rb");
-    if (!f)
+    WAIMappedFile file;
+    if (!file.open(path) || file.size() < sizeof(MapInfo))
+    {
+        Utils::log("WAIMapStorage", "Could not load map file %s", path.c_str());
         return false;
+    }
 
-    fseek(f, 0, SEEK_END);
-    uint32_t contentSize = ftell(f);
-    rewind(f);
+    uint8_t*       fContent = file.data();
+    const uint8_t* fEnd     = file.data() + file.size();
 
-    uint8_t* fContent      = (uint8_t*)malloc(sizeof(uint8_t*) * contentSize);
-    uint8_t* fContentStart = fContent;
-    if (!fContent)
-        return false;
-
-    size_t readResult = fread(fContent, 1, contentSize, f);
-    if (readResult != contentSize)
+    // nothing is created before the whole file is checked
+    auto isCorrupt = [&](const char* what)
+    {
+        Utils::log("WAIMapStorage", "Map file %s is corrupt: %s", path.c_str(), what);
         return false;
-
-    fclose(f);
+    };
+    auto fits = [&](uint64_t bytes)
+    { return bytes <= (uint64_t)(fEnd - fContent); };
 
     MapInfo* mapInfo = (MapInfo*)fContent;
     fContent += sizeof(MapInfo);
 
+    if (mapInfo->version > binaryMapVersion)
+    {
+        Utils::log("WAIMapStorage", "Map version %i of %s is not supported!", mapInfo->version, path.c_str());
+        return false;
+    }
+
+    if (mapInfo->kfCount < 0 || !fits((uint64_t)mapInfo->kfCount * sizeof(KeyFrameInfo)) ||
+        mapInfo->mpCount < 0 || !fits((uint64_t)mapInfo->mpCount * sizeof(MapPointInfo)))
+        return isCorrupt("keyframe or map point count");
+
     if (mapInfo->nodeOmSaved)
     {
+        if (!fits(16 * sizeof(float)))
+            return isCorrupt("map node matrix");
+
         cv::Mat cvMat = loadCVMatFromBinaryStream(&fContent, 4, 4, CV_32F);
         mapNodeOm     = cvMat.clone();
     }
 
+    // since version 2 the descriptors of all keyframes are stored in one block
+    cv::Mat fileDescriptors;
+    if (mapInfo->version >= 2)
+    {
+        if (!fits(sizeof(DescriptorBlockInfo)))
+            return isCorrupt("descriptor block");
+
+        DescriptorBlockInfo* descriptorBlockInfo = (DescriptorBlockInfo*)fContent;
+        fContent += sizeof(DescriptorBlockInfo);
+
+        if (descriptorBlockInfo->rows < 0 || !fits((uint64_t)descriptorBlockInfo->rows * 32))
+            return isCorrupt("descriptor block");
+
+        fileDescriptors = loadCVMatFromBinaryStream(&fContent, descriptorBlockInfo->rows, 32, CV_8U);
+    }
+
+    // check the keyframe records and collect the camera centers for a region
+    std::vector<cv::Point3f> kfPositions;
+    std::vector<int>         kfKpCounts(mapInfo->kfCount);
+    int64_t                  kpCountSum = 0;
+    uint8_t*                 record     = fContent;
+    if (region)
+        kfPositions.resize(mapInfo->kfCount);
+    for (int i = 0; i < mapInfo->kfCount; i++)
+    {
+        size_t recordSize = keyFrameRecordSize(record, fEnd, mapInfo->version);
+        if (recordSize == 0)
+            return isCorrupt("keyframe record");
+
+        if (region)
+        {
+            cv::Mat Tcw    = cv::Mat(4, 4, CV_32F, record + sizeof(KeyFrameInfo) + 9 * sizeof(float));
+            kfPositions[i] = WAIMapTiles::cameraCenter(Tcw);
+        }
+        kfKpCounts[i] = ((KeyFrameInfo*)record)->kpCount;
+        kpCountSum += kfKpCounts[i];
+        record += recordSize;
+    }
+
+    if (mapInfo->version >= 2 && kpCountSum != fileDescriptors.rows)
+        return isCorrupt("descriptor block");
+
+    for (int i = 0; i < mapInfo->mpCount; i++)
+    {
+        size_t recordSize = mapPointRecordSize(record, fEnd);
+        if (recordSize == 0)
+            return isCorrupt("map point record");
+        record += recordSize;
+    }
+
+    // select the keyframes in the tiles of the region by their camera centers
+    std::vector<bool> loadKf(mapInfo->kfCount, true);
+    int               loadedDescriptorRows = fileDescriptors.rows;
+    if (region)
+    {
+        int numSelected = waiMap->GetKeyFrameDB()->tiles().select(kfPositions, *region, loadKf);
+        Utils::log("WAIMapStorage", "Loading %i of %i keyframes in the region", numSelected, mapInfo->kfCount);
+
+        loadedDescriptorRows = 0;
+        for (int i = 0; i < mapInfo->kfCount; i++)
+            if (loadKf[i])
+                loadedDescriptorRows += kfKpCounts[i];
+    }
+
+    // the descriptors of the loaded keyframes are copied into one block that
+    // is shared by the keyframes
+    cv::Mat descriptorBlock;
+    int     descriptorRow     = 0;
+    int     fileDescriptorRow = 0;
+    if (mapInfo->version >= 2)
+    {
+        if (region)
+            descriptorBlock.create(loadedDescriptorRows, 32, CV_8U);
+        else
+            descriptorBlock = fileDescriptors.clone();
+    }
+
     std::map<int, std::vector<int>> bestCovisibleKeyFrameIdsMap;
     std::map<int, std::vector<int>> bestCovisibleWeightsMap;
 
@@ -732,6 +1132,14 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         PROFILE_SCOPE("WAI::WAIMapStorage::loadMapBinary::keyFrames");
 
         KeyFrameInfo* kfInfo = (KeyFrameInfo*)fContent;
+
+        if (!loadKf[i])
+        {
+            fContent += keyFrameRecordSize(fContent, fEnd, mapInfo->version);
+            fileDescriptorRow += kfInfo->kpCount;
+            continue;
+        }
+
         fContent += sizeof(KeyFrameInfo);
 
         int id       = kfInfo->id;
@@ -753,8 +1161,41 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
             loopEdgesMap[id] = loopEdges;
         }
 
-        cv::Mat                   featureDescriptors = loadCVMatFromBinaryStream(&fContent, kfInfo->kpCount, 32, CV_8U);
-        std::vector<cv::KeyPoint> keyPtsUndist       = loadVectorFromBinaryStream<cv::KeyPoint>(&fContent, kfInfo->kpCount);
+        cv::Mat featureDescriptors;
+        if (mapInfo->version >= 2)
+        {
+            featureDescriptors = descriptorBlock.rowRange(descriptorRow, descriptorRow + kfInfo->kpCount);
+            if (region)
+                fileDescriptors.rowRange(fileDescriptorRow, fileDescriptorRow + kfInfo->kpCount).copyTo(featureDescriptors);
+            descriptorRow += kfInfo->kpCount;
+            fileDescriptorRow += kfInfo->kpCount;
+        }
+        else
+            featureDescriptors = loadCVMatFromBinaryStream(&fContent, kfInfo->kpCount, 32, CV_8U);
+
+        std::vector<cv::KeyPoint> keyPtsUndist = loadVectorFromBinaryStream<cv::KeyPoint>(&fContent, kfInfo->kpCount);
+
+        WAIBowVector bow;
+        if (kfInfo->bowVecSize > 0)
+        {
+            std::vector<int32_t> wordsId = loadVectorFromBinaryStream<int32_t>(&fContent, kfInfo->bowVecSize);
+            std::vector<float>   tfIdf   = loadVectorFromBinaryStream<float>(&fContent, kfInfo->bowVecSize);
+
+            bow = WAIBowVector(wordsId, tfIdf);
+        }
+
+        WAIFeatVector featVec;
+        if (mapInfo->version >= 2)
+        {
+            FeatVecInfo* featVecInfo = (FeatVecInfo*)fContent;
+            fContent += sizeof(FeatVecInfo);
+
+            std::vector<int32_t> nodeIds   = loadVectorFromBinaryStream<int32_t>(&fContent, featVecInfo->nodeCount);
+            std::vector<int32_t> nodeSizes = loadVectorFromBinaryStream<int32_t>(&fContent, featVecInfo->nodeCount);
+            std::vector<int32_t> indices   = loadVectorFromBinaryStream<int32_t>(&fContent, featVecInfo->indexCount);
+
+            featVec = WAIFeatVector(nodeIds, nodeSizes, indices);
+        }
 
         float scaleFactor  = kfInfo->scaleFactor;
         int   nScaleLevels = kfInfo->scaleLevels;
@@ -807,7 +1248,7 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                                              keyPtsUndist.size(),
                                              keyPtsUndist,
                                              featureDescriptors,
-                                             voc,
+                                             nullptr,
                                              nScaleLevels,
                                              scaleFactor,
                                              vScaleFactor,
@@ -817,16 +1258,10 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                                              (int)nMinY,
                                              (int)nMaxX,
                                              (int)nMaxY,
-                                             K);
-
-        if (kfInfo->bowVecSize > 0)
-        {
-            std::vector<int32_t> wordsId = loadVectorFromBinaryStream<int32_t>(&fContent, kfInfo->bowVecSize);
-            std::vector<float>   tfIdf   = loadVectorFromBinaryStream<float>(&fContent, kfInfo->bowVecSize);
-
-            WAIBowVector bow(wordsId, tfIdf);
-            newKf->SetBowVector(bow);
-        }
+                                             K,
+                                             &bow,
+                                             &featVec,
+                                             mapInfo->version >= 2);
 
         if (imgDir != "")
         {
@@ -851,10 +1286,21 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         bestCovisibleWeightsMap[newKf->mnId]     = bestCovisibleWeights;
     }
 
+    if (keyFrames.empty())
+    {
+        Utils::log("WAIMapStorage", "No keyframes loaded from %s", path.c_str());
+        return false;
+    }
+
+    // the root of the spanning tree is the keyframe with id 0 or with a region
+    // the loaded keyframe with the smallest id
+    WAIKeyFrame* firstKF = kfsMap.begin()->second;
+    wai_assert((region || firstKF->mnId == 0) && "Could not find keyframe with id 0\n");
+
     // set parent keyframe pointers into keyframes
     for (WAIKeyFrame* kf : keyFrames)
     {
-        if (kf->mnId != 0)
+        if (kf != firstKF)
         {
             auto itParentId = parentIdMap.find(kf->mnId);
             if (itParentId != parentIdMap.end())
@@ -863,7 +1309,7 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                 auto itParentKf = kfsMap.find(parentId);
                 if (itParentKf != kfsMap.end())
                     kf->ChangeParent(itParentKf->second);
-                else
+                else if (!region) // the parent can be outside of the region
                     cerr << "[WAIMapIO] loadKeyFrames: Parent does not exist of keyframe " << kf->mnId << "! FAIL" << endl;
             }
             else
@@ -887,7 +1333,7 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                     kf->AddLoopEdge(loopKfIt->second);
                     numberOfLoopClosings++;
                 }
-                else
+                else if (!region)
                     cerr << "[WAIMapIO] loadKeyFrames: Loop keyframe id does not exist! FAIL" << endl;
             }
         }
@@ -927,14 +1373,16 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         }
         else
         {
-            cout << "no reference keyframe found!" << endl;
-            if (observingKfIds.size())
+            if (!region)
+                cout << "no reference keyframe found!" << endl;
+
+            // we use the first of the loaded observing keyframes
+            for (int j = 0; j < observingKfIds.size() && !refKFFound; j++)
             {
-                // we use the first of the observing keyframes
-                int kfId = observingKfIds[0];
-                if (kfsMap.find(kfId) != kfsMap.end())
+                auto itKf = kfsMap.find(observingKfIds[j]);
+                if (itKf != kfsMap.end())
                 {
-                    newPt->refKf(kfsMap[kfId]);
+                    newPt->refKf(itKf->second);
                     refKFFound = true;
                 }
             }
@@ -949,6 +1397,8 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                 if (kfsMap.find(kfId) != kfsMap.end())
                 {
                     WAIKeyFrame* kf = kfsMap[kfId];
+                    if (corrKpIndices[j] < 0 || corrKpIndices[j] >= kf->N)
+                        continue;
                     kf->AddMapPoint(newPt, corrKpIndices[j]);
                     newPt->AddObservation(kf, corrKpIndices[j]);
                 }
@@ -962,40 +1412,33 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
     }
 
     // update the covisibility graph, when all keyframes and mappoints are loaded
-    WAIKeyFrame* firstKF           = nullptr;
-    bool         buildSpanningTree = false;
+    bool buildSpanningTree = false;
     for (WAIKeyFrame* kf : keyFrames)
     {
         PROFILE_SCOPE("WAI::WAIMapStorage::loadMapBinary::updateConnections");
 
         std::map<WAIKeyFrame*, int> keyFrameWeightMap;
 
-        std::vector<int> bestCovisibleKeyFrameIds = bestCovisibleKeyFrameIdsMap[kf->mnId];
-        std::vector<int> bestCovisibleWeights     = bestCovisibleWeightsMap[kf->mnId];
+        // version 1 stores the 20 best covisibles, version 2 all covisibility weights
+        const std::vector<int>& bestCovisibleKeyFrameIds = bestCovisibleKeyFrameIdsMap[kf->mnId];
+        const std::vector<int>& bestCovisibleWeights     = bestCovisibleWeightsMap[kf->mnId];
 
         for (int i = 0; i < bestCovisibleKeyFrameIds.size(); i++)
         {
-            int          keyFrameId        = bestCovisibleKeyFrameIds[i];
-            int          weight            = bestCovisibleWeights[i];
-            WAIKeyFrame* covisibleKF       = kfsMap[keyFrameId];
-            keyFrameWeightMap[covisibleKF] = weight;
+            auto itCovisibleKF = kfsMap.find(bestCovisibleKeyFrameIds[i]);
+            if (itCovisibleKF != kfsMap.end())
+                keyFrameWeightMap[itCovisibleKF->second] = bestCovisibleWeights[i];
         }
 
         kf->UpdateConnections(keyFrameWeightMap, false);
 
-        if (kf->mnId == 0)
-        {
-            firstKF = kf;
-        }
-        else if (kf->GetParent() == NULL)
+        if (kf != firstKF && kf->GetParent() == NULL)
         {
             buildSpanningTree = true;
         }
     }
 
-    wai_assert(firstKF && "Could not find keyframe with id 0\n");
-
-    // Build spanning tree if keyframes have no parents (legacy support)
+    // Build spanning tree if keyframes have no parents (legacy support or parents outside of the region)
     if (buildSpanningTree)
     {
         PROFILE_SCOPE("WAI::WAIMapStorage::loadMapBinary::buildSpanningTree");
@@ -1054,6 +1497,9 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         }
     }
 
+    // compute the bow vectors that were not stored in the map file on all cores
+    WAIKeyFrame::ComputeBoW(keyFrames, voc);
+
     for (WAIKeyFrame* kf : keyFrames)
     {
         PROFILE_SCOPE("WAI::WAIMapStorage::loadMapBinary::addKeyFrame");
@@ -1067,7 +1513,7 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         waiMap->GetKeyFrameDB()->add(kf);
 
         // Add keyframe with id 0 to this vector. Otherwise RunGlobalBundleAdjustment in LoopClosing after loop was detected crashes.
-        if (kf->mnId == 0)
+        if (kf == firstKF)
         {
             waiMap->mvpKeyFrameOrigins.push_back(kf);
         }
@@ -1082,8 +1528,6 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
 
     waiMap->setNumLoopClosings(numLoopClosings);
 
-    free(fContentStart);
-
     return true;
 }
 
@@ -1161,6 +1605,29 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
         if (!(*it)["TfIdf"].empty())
             (*it)["TfIdf"] >> tfIdf;
 
+        std::vector<int> nodeIds;
+        std::vector<int> nodeSizes;
+        std::vector<int> featIndices;
+        if (!(*it)["FeatVecNodeIds"].empty())
+            (*it)["FeatVecNodeIds"] >> nodeIds;
+        if (!(*it)["FeatVecNodeSizes"].empty())
+            (*it)["FeatVecNodeSizes"] >> nodeSizes;
+        if (!(*it)["FeatVecIndices"].empty())
+            (*it)["FeatVecIndices"] >> featIndices;
+
+        // maps saved without the feature vector get their bow vectors computed after loading
+        WAIBowVector  bow;
+        WAIFeatVector featVec;
+        int nFeatIndices = 0;
+        for (int nodeSize : nodeSizes)
+            nFeatIndices += nodeSize;
+        if (!wordsId.empty() && wordsId.size() == tfIdf.size() && !nodeIds.empty() &&
+            nodeIds.size() == nodeSizes.size() && nFeatIndices == (int)featIndices.size())
+        {
+            bow     = WAIBowVector(wordsId, tfIdf);
+            featVec = WAIFeatVector(nodeIds, nodeSizes, featIndices);
+        }
+
         float scaleFactor;
         (*it)["scaleFactor"] >> scaleFactor;
         int nScaleLevels = -1;
@@ -1216,7 +1683,7 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
                                              keyPtsUndist.size(),
                                              keyPtsUndist,
                                              featureDescriptors,
-                                             voc,
+                                             nullptr,
                                              nScaleLevels,
                                              scaleFactor,
                                              vScaleFactor,
@@ -1226,13 +1693,9 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
                                              (int)nMinY,
                                              (int)nMaxX,
                                              (int)nMaxY,
-                                             K);
-
-        if (!wordsId.empty() && !tfIdf.empty())
-        {
-            WAIBowVector bow(wordsId, tfIdf);
-            newKf->SetBowVector(bow);
-        }
+                                             K,
+                                             &bow,
+                                             &featVec);
 
         if (imgDir != "")
         {
@@ -1503,6 +1966,9 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
         }
     }
 
+    // compute the bow vectors that were not stored in the map file on all cores
+    WAIKeyFrame::ComputeBoW(keyFrames, voc);
+
     for (WAIKeyFrame* kf : keyFrames)
     {
         if (kf->mBowVec.data.empty())
@@ -44,6 +44,19 @@ class WAI_API WAIMapStorage
         float minDistance, maxDistance;
     };
 
+    //! Header of the contiguous descriptor block of all keyframes (version 2)
+    struct DescriptorBlockInfo
+    {
+        int32_t rows;
+    };
+
+    //! Sizes of the stored feature vector of a keyframe (version 2)
+    struct FeatVecInfo
+    {
+        int32_t nodeCount;
+        int32_t indexCount;
+    };
+
     struct KeyPointData
     {
         float   x, y;
@@ -79,12 +92,16 @@ public:
                         bool              loadImgs,
                         bool              fixKfsAndMPts);
 
-    static bool loadMapBinary(WAIMap*           waiMap,
-                              cv::Mat&          mapNodeOm,
-                              WAIOrbVocabulary* voc,
-                              std::string       path,
-                              bool              loadImgs,
-                              bool              fixKfsAndMPts);
+    static bool loadMapBinary(WAIMap*                    waiMap,
+                              cv::Mat&                   mapNodeOm,
+                              WAIOrbVocabulary*          voc,
+                              std::string                path,
+                              bool                       loadImgs,
+                              bool                       fixKfsAndMPts,
+                              const WAIMapTiles::Region* region = nullptr);
+
+    //! Version of the binary map format written by saveMapBinary
+    static const int32_t binaryMapVersion = 2;
 
     static cv::Mat              convertToCVMat(const SLMat4f slMat);
     static SLMat4f              convertToSLMat(const cv::Mat& cvMat);
@@ -98,6 +115,10 @@ public:
     static std::vector<T> loadVectorFromBinaryStream(uint8_t** data, int count);
     static void           writeCVMatToBinaryFile(FILE* f, const cv::Mat& mat);
     static cv::Mat        loadCVMatFromBinaryStream(uint8_t** data, int rows, int cols, int type);
+
+private:
+    static size_t keyFrameRecordSize(const uint8_t* record, const uint8_t* end, int32_t version);
+    static size_t mapPointRecordSize(const uint8_t* record, const uint8_t* end);
 };
 
 #endif
@@ -0,0 +1,168 @@
+//#############################################################################
+//  File:      main.cpp
+//  Purpose:   Benchmark of ORB_SLAM2::ORBextractor on recorded SENS sequences
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+/*
+ Measures the ORB feature extraction time per frame on the video of one or more
+ sequences recorded with SENSRecorder (<dir>/video.avi). Every sequence is
+ extracted with 1 thread and with the max. NO. of threads. The checksum over
+ all keypoints and descriptors must be the same for every NO. of threads.
+
+ Usage: app-Benchmark-OrbExtractor [-n features] [-t threads] [-f frames] dir...
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <HighResTimer.h>
+#include <orb_slam/ORBextractor.h>
+
+//-----------------------------------------------------------------------------
+//! Extraction statistics of one sequence with one NO. of threads
+struct BenchmarkResult
+{
+    float    meanMS     = 0.0f; //!< Mean extraction time per frame in ms
+    float    medianMS   = 0.0f; //!< Median extraction time per frame in ms
+    float    maxMS      = 0.0f; //!< Max. extraction time per frame in ms
+    float    meanKeyPts = 0.0f; //!< Mean NO. of keypoints per frame
+    uint64_t checksum   = 0;    //!< Checksum over all keypoints and descriptors
+};
+//-----------------------------------------------------------------------------
+//! Loads up to maxFrames grayscale frames of the recorded video
+static bool loadFrames(const std::string& dir, int maxFrames, std::vector<cv::Mat>& frames)
+{
+    std::string videoFile = dir + "/video.avi";
+
+    cv::VideoCapture cap(videoFile);
+    if (!cap.isOpened())
+    {
+        printf("Could not open %s\n", videoFile.c_str());
+        return false;
+    }
+
+    cv::Mat frame;
+    while ((int)frames.size() < maxFrames && cap.read(frame))
+    {
+        cv::Mat gray;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        frames.push_back(gray);
+    }
+
+    return !frames.empty();
+}
+//-----------------------------------------------------------------------------
+//! Extracts all frames with the passed NO. of threads
+static BenchmarkResult runBenchmark(const std::vector<cv::Mat>& frames,
+                                    int                         nFeatures,
+                                    int                         numThreads)
+{
+    // Default ORB-SLAM2 settings as used by WAISlam
+    ORB_SLAM2::ORBextractor extractor(nFeatures, 1.2f, 8, 20, 7);
+    extractor.numThreads(numThreads);
+
+    std::vector<float>        timesMS;
+    std::vector<cv::KeyPoint> keyPts;
+    cv::Mat                   descriptors;
+    BenchmarkResult           result;
+    HighResTimer              timer;
+
+    // The first frame allocates the pyramid buffers and is not measured
+    extractor(frames[0], keyPts, descriptors);
+
+    for (const cv::Mat& frame : frames)
+    {
+        timer.start();
+        extractor(frame, keyPts, descriptors);
+        timesMS.push_back(timer.elapsedTimeInMilliSec());
+
+        result.meanKeyPts += (float)keyPts.size();
+        for (const cv::KeyPoint& kp : keyPts)
+            result.checksum = result.checksum * 31 + (uint64_t)(kp.pt.x * 16.0f) + (uint64_t)(kp.pt.y * 16.0f) * 7919;
+        for (int r = 0; r < descriptors.rows; ++r)
+            for (int c = 0; c < descriptors.cols; ++c)
+                result.checksum = result.checksum * 31 + descriptors.at<uchar>(r, c);
+    }
+
+    float sumMS = 0.0f;
+    for (float ms : timesMS)
+        sumMS += ms;
+
+    result.meanMS     = sumMS / (float)timesMS.size();
+    result.meanKeyPts = result.meanKeyPts / (float)frames.size();
+    result.maxMS      = *std::max_element(timesMS.begin(), timesMS.end());
+    std::sort(timesMS.begin(), timesMS.end());
+    result.medianMS = timesMS[timesMS.size() / 2];
+
+    return result;
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int                      nFeatures  = 1000;
+    int                      maxThreads = (int)std::max(std::thread::hardware_concurrency(), 1U);
+    int                      maxFrames  = 300;
+    std::vector<std::string> dirs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc)
+            nFeatures = atoi(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc)
+            maxThreads = atoi(argv[++i]);
+        else if (arg == "-f" && i + 1 < argc)
+            maxFrames = atoi(argv[++i]);
+        else
+            dirs.push_back(arg);
+    }
+
+    if (dirs.empty())
+    {
+        printf("Usage: app-Benchmark-OrbExtractor [-n features] [-t threads] [-f frames] dir...\n");
+        printf("dir is a sequence directory of SENSRecorder that contains video.avi\n");
+        return 1;
+    }
+
+    std::vector<int> threadCounts = {1};
+    if (maxThreads > 1)
+        threadCounts.push_back(maxThreads);
+
+    printf("%-40s %7s %7s %9s %9s %9s %9s %18s\n",
+           "sequence", "frames", "threads", "mean ms", "median ms", "max ms", "keypts", "checksum");
+
+    for (const std::string& dir : dirs)
+    {
+        std::vector<cv::Mat> frames;
+        if (!loadFrames(dir, maxFrames, frames))
+            continue;
+
+        for (int numThreads : threadCounts)
+        {
+            BenchmarkResult r = runBenchmark(frames, nFeatures, numThreads);
+            printf("%-40s %7d %7d %9.2f %9.2f %9.2f %9.1f %18llx\n",
+                   dir.c_str(),
+                   (int)frames.size(),
+                   numThreads,
+                   r.meanMS,
+                   r.medianMS,
+                   r.maxMS,
+                   r.meanKeyPts,
+                   (unsigned long long)r.checksum);
+        }
+    }
+
+    return 0;
+}
+//-----------------------------------------------------------------------------
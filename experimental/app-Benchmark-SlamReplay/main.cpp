@@ -0,0 +1,661 @@
+//#############################################################################
+//  File:      main.cpp
+//  Purpose:   Offline replay benchmark of WAISlam on recorded SENS sequences
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+/*
+ Replays a sequence recorded with SENSRecorder (the directory format that is
+ read by SENSSimulator: video.avi, camera.txt and cameraConfig.json) through
+ WAISlam without a window. Other than SENSSimulator the frames are not bound
+ to the recorded time: They are fed as fast as possible or with a fixed rate.
+
+ WAISlam runs in serial mode, so the local mapping and the loop closing run
+ on the benchmark thread after every frame. This makes the runs repeatable
+ and allows to measure them with the AverageTiming blocks:
+
+ - extraction:             Frame creation with ORB extraction (WAIFrame)
+ - matching:               TrackWithMotionModel, TrackReferenceKeyFrame and
+                           trackLocalMap (incl. their pose optimization)
+ - pose optimization:      PoseOpt.All
+ - relocalization:         relocalization
+ - local mapping:          LocalMapping with LocalBA
+ - loop closing:           LoopClosing
+
+ The camera centers of all tracked frames can be written with -w in the
+ format "frameIndex timestampUs x y z". A trajectory written by a trusted
+ run (or a ground truth converted to this format) is passed with -r as
+ reference. The trajectory error is the RMSE after aligning the estimated
+ trajectory with a similarity transform (monocular SLAM has no scale).
+
+ With -m the map is saved in the binary map format of WAIMapStorage after
+ the replay, loaded again and compared with the tracked map. The save and
+ load times are part of the result and a difference fails the run. If the
+ relocalization is restricted to the map tiles around the tracked pose (-rr
+ radius, -rk keyframe budget) the map is also loaded only within this region.
+
+ The result is written as JSON to stdout or to the file passed with -o.
+
+ Usage: app-Benchmark-SlamReplay -v vocabulary [-n features] [-f frames]
+        [-fps rate] [-fx focalLengthPix] [-r reference] [-w trajectory]
+        [-m map.bin] [-rr residentRadius] [-rk maxResidentKeyFrames]
+        [-o result.json] dir
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <json.hpp>
+#include <AverageTiming.h>
+#include <HighResTimer.h>
+#include <Utils.h>
+#include <WAISlam.h>
+#include <WAIMapStorage.h>
+#include <WAIOrbVocabulary.h>
+#include <orb_slam/ORBextractor.h>
+
+using json = nlohmann::json;
+
+//-----------------------------------------------------------------------------
+//! Camera center of a tracked frame
+struct TrajectoryPoint
+{
+    int         frameIndex  = 0;
+    long long   timestampUs = 0;
+    cv::Point3d center;
+};
+//-----------------------------------------------------------------------------
+//! Recorded sequence in the directory format of SENSRecorder
+struct Sequence
+{
+    std::string            videoFileName;      //!< Recorded video
+    std::vector<long long> timestampsUs;       //!< Recording time per frame index
+    int                    widthPix       = 0; //!< Width of the recorded stream
+    float                  focalLengthPix = 0; //!< Focal length of the recorded stream
+};
+//-----------------------------------------------------------------------------
+//! Loads the frame times and the camera config like SENSSimulator::loadCameraData
+static bool loadSequence(std::string dir, Sequence& seq)
+{
+    dir                        = Utils::unifySlashes(dir);
+    seq.videoFileName          = dir + "video.avi";
+    std::string textFileName   = dir + "camera.txt";
+    std::string configFileName = dir + "cameraConfig.json";
+
+    if (!Utils::fileExists(seq.videoFileName))
+    {
+        printf("Could not find %s\n", seq.videoFileName.c_str());
+        return false;
+    }
+
+    if (Utils::fileExists(configFileName))
+    {
+        cv::FileStorage fs(configFileName, cv::FileStorage::READ);
+        if (fs.isOpened())
+        {
+            fs["widthPix"] >> seq.widthPix;
+            fs["focalLengthPix"] >> seq.focalLengthPix;
+        }
+    }
+
+    std::ifstream file(textFileName);
+    std::string   line;
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> values;
+        Utils::splitString(line, ' ', values);
+        if (values.size() == 2)
+        {
+            long long timestampUs = std::stoll(values[0]);
+            int       frameIndex  = std::stoi(values[1]);
+            if (frameIndex >= (int)seq.timestampsUs.size())
+                seq.timestampsUs.resize((size_t)frameIndex + 1, 0);
+            seq.timestampsUs[(size_t)frameIndex] = timestampUs;
+        }
+    }
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+//! Reads a trajectory in the format "frameIndex timestampUs x y z"
+static bool loadTrajectory(const std::string& fileName, std::map<int, cv::Point3d>& trajectory)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        printf("Could not open %s\n", fileName.c_str());
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> values;
+        Utils::splitString(line, ' ', values);
+        if (values.size() == 5)
+            trajectory[std::stoi(values[0])] = cv::Point3d(std::stod(values[2]),
+                                                           std::stod(values[3]),
+                                                           std::stod(values[4]));
+    }
+    return !trajectory.empty();
+}
+//-----------------------------------------------------------------------------
+static void saveTrajectory(const std::string& fileName, const std::vector<TrajectoryPoint>& trajectory)
+{
+    std::ofstream file(fileName);
+    file.precision(9);
+    for (const TrajectoryPoint& p : trajectory)
+        file << p.frameIndex << " " << p.timestampUs << " "
+             << p.center.x << " " << p.center.y << " " << p.center.z << "\n";
+}
+//-----------------------------------------------------------------------------
+//! Trajectory error after the alignment with a similarity transform
+/*! The estimated camera centers are aligned to the reference with the closed
+ form solution of Umeyama (1991): s * R * est + t = ref. The error of every
+ frame with a reference position is the distance after the alignment.
+ */
+static json trajectoryError(const std::vector<TrajectoryPoint>& estimated,
+                            const std::map<int, cv::Point3d>&   reference)
+{
+    std::vector<cv::Point3d> src, dst;
+    for (const TrajectoryPoint& p : estimated)
+    {
+        auto it = reference.find(p.frameIndex);
+        if (it != reference.end())
+        {
+            src.push_back(p.center);
+            dst.push_back(it->second);
+        }
+    }
+
+    json result;
+    result["matchedFrames"] = src.size();
+    if (src.size() < 3)
+        return result;
+
+    double      n = (double)src.size();
+    cv::Point3d srcMean, dstMean;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        srcMean += src[i];
+        dstMean += dst[i];
+    }
+    srcMean /= n;
+    dstMean /= n;
+
+    cv::Mat sigma  = cv::Mat::zeros(3, 3, CV_64F);
+    double  srcVar = 0.0;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        cv::Mat s = (cv::Mat_<double>(3, 1) << src[i].x - srcMean.x, src[i].y - srcMean.y, src[i].z - srcMean.z);
+        cv::Mat d = (cv::Mat_<double>(3, 1) << dst[i].x - dstMean.x, dst[i].y - dstMean.y, dst[i].z - dstMean.z);
+        sigma += d * s.t();
+        srcVar += s.dot(s);
+    }
+    sigma /= n;
+    srcVar /= n;
+
+    if (srcVar <= 0.0)
+        return result;
+
+    cv::Mat w, u, vt;
+    cv::SVD::compute(sigma, w, u, vt);
+
+    cv::Mat S = cv::Mat::eye(3, 3, CV_64F);
+    if (cv::determinant(u) * cv::determinant(vt) < 0.0)
+        S.at<double>(2, 2) = -1.0;
+
+    cv::Mat R     = u * S * vt;
+    double  scale = cv::trace(cv::Mat::diag(w) * S)[0] / srcVar;
+    cv::Mat t     = cv::Mat(dstMean) - scale * R * cv::Mat(srcMean);
+
+    std::vector<double> errors;
+    double              sumSq = 0.0;
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        cv::Mat aligned = scale * R * cv::Mat(src[i]) + t;
+        double  err     = cv::norm(aligned - cv::Mat(dst[i]));
+        errors.push_back(err);
+        sumSq += err * err;
+    }
+
+    std::sort(errors.begin(), errors.end());
+    double sum = 0.0;
+    for (double err : errors)
+        sum += err;
+
+    result["scale"]  = scale;
+    result["rmse"]   = std::sqrt(sumSq / n);
+    result["mean"]   = sum / n;
+    result["median"] = errors[errors.size() / 2];
+    result["max"]    = errors.back();
+    return result;
+}
+//-----------------------------------------------------------------------------
+//! Saves the map with WAIMapStorage, loads it again and compares both maps
+/*! saveMapBinary stores only the keypoints of a keyframe that have a map
+ point, in the order of the keyframe. These are compared together with the
+ poses of the keyframes and the positions of the map points.
+ */
+static json mapRoundTrip(WAIMap* map, WAIOrbVocabulary* voc, const std::string& fileName)
+{
+    json result;
+    result["file"] = fileName;
+
+    HighResTimer timer;
+    timer.start();
+    bool saved       = WAIMapStorage::saveMapBinary(map, nullptr, fileName);
+    result["saveMS"] = timer.elapsedTimeInMilliSec();
+    result["saved"]  = saved;
+    if (!saved)
+        return result;
+
+    WAIMap  loadedMap(new WAIKeyFrameDB(voc));
+    cv::Mat mapNodeOm;
+    timer.start();
+    bool loaded      = WAIMapStorage::loadMapBinary(&loadedMap, mapNodeOm, voc, fileName, false, false);
+    result["loadMS"] = timer.elapsedTimeInMilliSec();
+    result["loaded"] = loaded;
+    if (!loaded)
+        return result;
+
+    std::map<long unsigned int, WAIKeyFrame*> keyFrames;
+    for (WAIKeyFrame* kf : map->GetAllKeyFrames())
+        if (!kf->isBad())
+            keyFrames[kf->mnId] = kf;
+
+    std::map<long unsigned int, WAIMapPoint*> mapPoints;
+    for (WAIMapPoint* mp : map->GetAllMapPoints())
+        if (!mp->isBad())
+            mapPoints[mp->mnId] = mp;
+
+    int                       mismatches = 0;
+    std::vector<WAIKeyFrame*> loadedKfs  = loadedMap.GetAllKeyFrames();
+    for (WAIKeyFrame* loadedKf : loadedKfs)
+    {
+        auto it = keyFrames.find(loadedKf->mnId);
+        if (it == keyFrames.end())
+        {
+            mismatches++;
+            continue;
+        }
+
+        WAIKeyFrame* kf    = it->second;
+        bool         equal = cv::countNonZero(kf->GetPose() != loadedKf->GetPose()) == 0;
+        int          row   = 0;
+
+        std::vector<WAIMapPoint*> matches = kf->GetMapPointMatches();
+        for (size_t j = 0; j < matches.size() && equal; j++)
+        {
+            if (!matches[j])
+                continue;
+
+            equal = row < loadedKf->N &&
+                    kf->mvKeysUn[j].pt == loadedKf->mvKeysUn[row].pt &&
+                    cv::norm(kf->mDescriptors.row((int)j), loadedKf->mDescriptors.row(row), cv::NORM_HAMMING) == 0;
+            row++;
+        }
+
+        if (!equal || row != loadedKf->N)
+            mismatches++;
+    }
+
+    std::vector<WAIMapPoint*> loadedMps = loadedMap.GetAllMapPoints();
+    for (WAIMapPoint* loadedMp : loadedMps)
+    {
+        auto it = mapPoints.find(loadedMp->mnId);
+        if (it == mapPoints.end() ||
+            cv::countNonZero(it->second->GetWorldPos() != loadedMp->GetWorldPos()) > 0)
+            mismatches++;
+    }
+
+    result["keyFrames"]       = loadedKfs.size();
+    result["mapPoints"]       = loadedMps.size();
+    result["mismatches"]      = mismatches;
+    result["missedKeyFrames"] = (int)keyFrames.size() - (int)loadedKfs.size();
+    result["passed"]          = mismatches == 0 && loadedKfs.size() == keyFrames.size();
+
+    // load only the resident tiles around the last tracked pose (see WAIMapTiles)
+    WAIKeyFrameDB* kfDB = map->GetKeyFrameDB();
+    if (kfDB->hasResidentRegion())
+    {
+        WAIMapTiles::Region region = kfDB->residentRegion();
+        WAIMap              regionMap(new WAIKeyFrameDB(voc));
+        regionMap.GetKeyFrameDB()->tileSize(kfDB->tileSize());
+
+        timer.start();
+        bool regionLoaded = WAIMapStorage::loadMapBinary(&regionMap, mapNodeOm, voc, fileName, false, false, &region);
+
+        json& regionResult     = result["region"];
+        regionResult["loadMS"] = timer.elapsedTimeInMilliSec();
+        regionResult["loaded"] = regionLoaded;
+
+        // the loaded keyframes must be the ones in the selected tiles
+        std::vector<cv::Point3f>       positions;
+        std::vector<long unsigned int> ids;
+        for (auto& kf : keyFrames)
+        {
+            positions.push_back(WAIMapTiles::cameraCenter(kf.second->GetPose()));
+            ids.push_back(kf.first);
+        }
+        std::vector<bool> selected;
+        int               numSelected = kfDB->tiles().select(positions, region, selected);
+
+        std::set<long unsigned int> loadedIds;
+        for (WAIKeyFrame* kf : regionMap.GetAllKeyFrames())
+            loadedIds.insert(kf->mnId);
+
+        int regionMismatches = 0;
+        for (size_t i = 0; i < ids.size(); i++)
+            if (selected[i] != (loadedIds.count(ids[i]) > 0))
+                regionMismatches++;
+
+        regionResult["keyFrames"]         = loadedIds.size();
+        regionResult["selectedKeyFrames"] = numSelected;
+        regionResult["mapPoints"]         = regionMap.MapPointsInMap();
+        regionResult["mismatches"]        = regionMismatches;
+        result["passed"]                  = result["passed"].get<bool>() && regionLoaded && regionMismatches == 0;
+    }
+
+    return result;
+}
+//-----------------------------------------------------------------------------
+//! Returns the value at the passed percentile of the sorted values
+static float percentile(const std::vector<float>& sortedValues, float perc)
+{
+    if (sortedValues.empty())
+        return 0.0f;
+    size_t index = (size_t)(perc * (float)(sortedValues.size() - 1) + 0.5f);
+    return sortedValues[index];
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    std::string vocFile, dir, referenceFile, trajectoryFile, mapFile, outputFile;
+    int         nFeatures            = 1000;
+    int         maxFrames            = INT_MAX;
+    float       fps                  = 0.0f;
+    float       focalLengthPix       = 0.0f;
+    float       residentRadius       = 0.0f;
+    int         maxResidentKeyFrames = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-v" && i + 1 < argc)
+            vocFile = argv[++i];
+        else if (arg == "-n" && i + 1 < argc)
+            nFeatures = atoi(argv[++i]);
+        else if (arg == "-f" && i + 1 < argc)
+            maxFrames = atoi(argv[++i]);
+        else if (arg == "-fps" && i + 1 < argc)
+            fps = (float)atof(argv[++i]);
+        else if (arg == "-fx" && i + 1 < argc)
+            focalLengthPix = (float)atof(argv[++i]);
+        else if (arg == "-r" && i + 1 < argc)
+            referenceFile = argv[++i];
+        else if (arg == "-w" && i + 1 < argc)
+            trajectoryFile = argv[++i];
+        else if (arg == "-m" && i + 1 < argc)
+            mapFile = argv[++i];
+        else if (arg == "-rr" && i + 1 < argc)
+            residentRadius = (float)atof(argv[++i]);
+        else if (arg == "-rk" && i + 1 < argc)
+            maxResidentKeyFrames = atoi(argv[++i]);
+        else if (arg == "-o" && i + 1 < argc)
+            outputFile = argv[++i];
+        else
+            dir = arg;
+    }
+
+    if (vocFile.empty() || dir.empty())
+    {
+        printf("Usage: app-Benchmark-SlamReplay -v vocabulary [-n features] [-f frames]\n");
+        printf("       [-fps rate] [-fx focalLengthPix] [-r reference] [-w trajectory]\n");
+        printf("       [-m map.bin] [-rr residentRadius] [-rk maxResidentKeyFrames]\n");
+        printf("       [-o result.json] dir\n");
+        printf("dir is a sequence directory of SENSRecorder that contains video.avi\n");
+        printf("-fps 0 (default) feeds the frames as fast as possible\n");
+        return 1;
+    }
+
+    Sequence seq;
+    if (!loadSequence(dir, seq))
+        return 1;
+
+    std::map<int, cv::Point3d> reference;
+    if (!referenceFile.empty() && !loadTrajectory(referenceFile, reference))
+        return 1;
+
+    cv::VideoCapture cap(seq.videoFileName);
+    if (!cap.isOpened())
+    {
+        printf("Could not open %s\n", seq.videoFileName.c_str());
+        return 1;
+    }
+
+    int width  = (int)cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    int height = (int)cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+
+    // The focal length of the recorded stream is scaled to the video size
+    if (focalLengthPix <= 0.0f && seq.focalLengthPix > 0.0f)
+    {
+        focalLengthPix = seq.focalLengthPix;
+        if (seq.widthPix > 0)
+            focalLengthPix *= (float)width / (float)seq.widthPix;
+    }
+
+    if (focalLengthPix <= 0.0f)
+    {
+        printf("No focal length in cameraConfig.json: Pass it with -fx\n");
+        return 1;
+    }
+
+    cv::Mat intrinsic = (cv::Mat_<float>(3, 3) << focalLengthPix, 0, width * 0.5f,
+                         0, focalLengthPix, height * 0.5f,
+                         0, 0, 1);
+    cv::Mat distortion = cv::Mat::zeros(4, 1, CV_32F);
+
+    WAIOrbVocabulary voc;
+    try
+    {
+        voc.loadFromFile(vocFile);
+    }
+    catch (std::exception& e)
+    {
+        printf("%s\n", e.what());
+        return 1;
+    }
+
+    // Default ORB-SLAM2 settings as used by CVTrackedWAI
+    ORB_SLAM2::ORBextractor trackingExtractor(nFeatures, 1.2f, 8, 20, 7);
+    ORB_SLAM2::ORBextractor iniExtractor(2 * nFeatures, 1.2f, 8, 20, 7);
+
+    WAISlam::Params params;
+    params.cullRedundantPerc    = 0.95f;
+    params.serial               = true;
+    params.residentRadius       = residentRadius;
+    params.maxResidentKeyFrames = maxResidentKeyFrames;
+
+    WAISlam slam(intrinsic,
+                 distortion,
+                 &voc,
+                 &iniExtractor,
+                 &trackingExtractor,
+                 &trackingExtractor,
+                 nullptr,
+                 params);
+
+    // Measurements of previous runs in this process must not be counted
+    std::map<std::string, std::pair<int, float>> timingBefore;
+    for (auto& block : Utils::AverageTiming::instance())
+        timingBefore[block.first] = std::make_pair(block.second->nCalls, block.second->totalMS);
+
+    std::vector<float>           frameTimesMS, extractionTimesMS;
+    std::vector<TrajectoryPoint> trajectory;
+    std::map<std::string, int>   stateFrames;
+    int                          initializedAtFrame = -1;
+    int                          trackingLosses     = 0;
+    int                          relocalizations    = 0;
+    int                          lateFrames         = 0;
+    WAITrackingState             prevState          = slam.getTrackingState();
+
+    HighResTimer timer;
+    auto         frameInterval = std::chrono::duration<double>(fps > 0.0f ? 1.0 / fps : 0.0);
+    auto         startTime     = std::chrono::steady_clock::now();
+
+    cv::Mat image, gray;
+    int     frameIndex = 0;
+    for (; frameIndex < maxFrames && cap.read(image); ++frameIndex)
+    {
+        auto deadline = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameInterval * frameIndex);
+        if (fps > 0.0f)
+            std::this_thread::sleep_until(deadline);
+
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+
+        timer.start();
+        WAIFrame frame;
+        slam.createFrame(frame, gray);
+        extractionTimesMS.push_back(timer.elapsedTimeInMilliSec());
+        if (params.ensureKFIntegration)
+            slam.updatePoseKFIntegration(frame);
+        else
+            slam.updatePose(frame);
+        frameTimesMS.push_back(timer.elapsedTimeInMilliSec());
+
+        if (fps > 0.0f && std::chrono::steady_clock::now() > deadline + frameInterval)
+            lateFrames++;
+
+        WAITrackingState state = slam.getTrackingState();
+        if (state == WAITrackingState::TrackingLost && prevState != WAITrackingState::TrackingLost)
+            trackingLosses++;
+        if (prevState == WAITrackingState::TrackingLost && state != WAITrackingState::TrackingLost)
+            relocalizations++;
+        if (initializedAtFrame < 0 && slam.isInitialized())
+            initializedAtFrame = frameIndex;
+        prevState = state;
+
+        std::string stateName = slam.getPrintableState();
+        stateName.erase(std::remove(stateName.begin(), stateName.end(), '\n'), stateName.end());
+        stateFrames[stateName]++;
+
+        WAIFrame* lastFrame = slam.getLastFramePtr();
+        if ((state == WAITrackingState::TrackingOK || state == WAITrackingState::TrackingStart) &&
+            !lastFrame->mTcw.empty())
+        {
+            cv::Mat         Ow = lastFrame->GetCameraCenter();
+            TrajectoryPoint p;
+            p.frameIndex  = frameIndex;
+            p.timestampUs = frameIndex < (int)seq.timestampsUs.size() ? seq.timestampsUs[(size_t)frameIndex] : 0;
+            p.center      = cv::Point3d(Ow.at<float>(0), Ow.at<float>(1), Ow.at<float>(2));
+            trajectory.push_back(p);
+        }
+    }
+
+    float totalS = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (frameTimesMS.empty())
+    {
+        printf("No frames in %s\n", seq.videoFileName.c_str());
+        return 1;
+    }
+
+    if (!trajectoryFile.empty())
+        saveTrajectory(trajectoryFile, trajectory);
+
+    // Result
+    json result;
+    result["sequence"]   = dir;
+    result["vocabulary"] = vocFile;
+    result["features"]   = nFeatures;
+    result["fps"]        = fps;
+    result["frames"]     = frameIndex;
+    result["width"]      = width;
+    result["height"]     = height;
+
+    float sumMS = 0.0f, sumExtractionMS = 0.0f;
+    for (size_t i = 0; i < frameTimesMS.size(); ++i)
+    {
+        sumMS += frameTimesMS[i];
+        sumExtractionMS += extractionTimesMS[i];
+    }
+    std::sort(frameTimesMS.begin(), frameTimesMS.end());
+
+    json& timing           = result["frameTiming"];
+    timing["totalS"]       = totalS;
+    timing["framesPerS"]   = (float)frameIndex / totalS;
+    timing["meanMS"]       = sumMS / (float)frameTimesMS.size();
+    timing["medianMS"]     = percentile(frameTimesMS, 0.5f);
+    timing["p95MS"]        = percentile(frameTimesMS, 0.95f);
+    timing["maxMS"]        = frameTimesMS.back();
+    timing["extractionMS"] = sumExtractionMS / (float)frameTimesMS.size();
+    timing["lateFrames"]   = lateFrames;
+
+    json& stages = result["stages"];
+    for (auto& block : Utils::AverageTiming::instance())
+    {
+        auto  before  = timingBefore[block.first];
+        int   calls   = block.second->nCalls - before.first;
+        float totalMS = block.second->totalMS - before.second;
+        if (calls <= 0)
+            continue;
+
+        json& stage      = stages[block.first];
+        stage["calls"]   = calls;
+        stage["totalMS"] = totalMS;
+        stage["meanMS"]  = totalMS / (float)calls;
+    }
+
+    json& tracking                 = result["tracking"];
+    tracking["initializedAtFrame"] = initializedAtFrame;
+    tracking["trackedFrames"]      = trajectory.size();
+    tracking["trackedRatio"]       = (float)trajectory.size() / (float)frameIndex;
+    tracking["trackingLosses"]     = trackingLosses;
+    tracking["relocalizations"]    = relocalizations;
+    tracking["framesPerState"]     = stateFrames;
+
+    json& mapInfo           = result["map"];
+    mapInfo["keyFrames"]    = slam.getMap()->KeyFramesInMap();
+    mapInfo["mapPoints"]    = slam.getMap()->MapPointsInMap();
+    mapInfo["loopClosings"] = slam.getMap()->getNumLoopClosings();
+
+    if (!reference.empty())
+    {
+        result["trajectoryError"]              = trajectoryError(trajectory, reference);
+        result["trajectoryError"]["reference"] = referenceFile;
+    }
+
+    bool mapRoundTripPassed = true;
+    if (!mapFile.empty())
+    {
+        result["mapRoundTrip"] = mapRoundTrip(slam.getMap(), &voc, mapFile);
+        mapRoundTripPassed     = result["mapRoundTrip"].value("passed", false);
+    }
+
+    if (outputFile.empty())
+        printf("%s\n", result.dump(4).c_str());
+    else
+    {
+        std::ofstream file(outputFile);
+        file << result.dump(4) << "\n";
+    }
+
+    return mapRoundTripPassed ? 0 : 1;
+}
+//-----------------------------------------------------------------------------
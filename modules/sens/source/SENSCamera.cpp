@@ -220,14 +220,11 @@ void SENSBaseCamera::updateFrame(cv::Mat bgrImg,
     // estimate time before running into lock
     SENSTimePt timePt = SENSClock::now();
 
-    // inform listeners
+    // inform listeners (they all share the same frame buffer)
     {
         std::lock_guard<std::mutex> lock(_listenerMutex);
-        if (_listeners.size())
-        {
-            for (SENSCameraListener* l : _listeners)
-                l->onFrame(timePt, bgrImg.clone());
-        }
+        for (SENSCameraListener* l : _listeners)
+            l->onFrame(timePt, bgrImg);
     }
 
     {
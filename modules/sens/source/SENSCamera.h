@@ -12,6 +12,7 @@
 
 #include <opencv2/core.hpp>
 #include "SENSFrame.h"
+#include "SENSFramePool.h"
 #include "SENSException.h"
 #include "SENSCalibration.h"
 #include <atomic>
@@ -150,8 +151,9 @@ class SENSCameraListener
 {
 public:
     virtual ~SENSCameraListener() {}
-    virtual void onFrame(const SENSTimePt& timePt, cv::Mat frame)      = 0;
-    virtual void onCameraConfigChanged(const SENSCameraConfig& config) = 0;
+    //! frame is shared by all listeners and must not be modified (clone it if needed)
+    virtual void onFrame(const SENSTimePt& timePt, const cv::Mat& frame) = 0;
+    virtual void onCameraConfigChanged(const SENSCameraConfig& config)   = 0;
 };
 //-----------------------------------------------------------------------------
 //! Pure abstract camera class
@@ -204,6 +206,9 @@ public:
     void                    setPermissionGranted() override { _permissionGranted = true; }
 
 protected:
+    /*! Informs the listeners and sets the latest frame. bgrImg is passed without
+    a copy, so the caller must not write into it anymore. Use a new buffer from
+    _framePool for every frame. */
     void updateFrame(cv::Mat bgrImg,
                      cv::Mat intrinsics,
                      int     width,
@@ -220,6 +225,7 @@ protected:
     std::mutex                       _listenerMutex;
     SENSFrameBasePtr                 _frame; //!< current frame
     std::mutex                       _frameMutex;
+    SENSFramePool                    _framePool; //!< reusable frame buffers for the camera implementations
 };
 //-----------------------------------------------------------------------------
 #endif // SENS_CAMERA_H
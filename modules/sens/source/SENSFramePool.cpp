@@ -0,0 +1,44 @@
+#include "SENSFramePool.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+SENSFramePool::SENSFramePool(int numFrames)
+  : _frames((size_t)std::max(numFrames, 1))
+{
+}
+//-----------------------------------------------------------------------------
+cv::Mat& SENSFramePool::nextFree()
+{
+    int numFrames = (int)_frames.size();
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        int      index = (_next + i) % numFrames;
+        cv::Mat& frame = _frames[(size_t)index];
+
+        // the reference counter is changed atomically by the listener threads
+        bool isReferenced = frame.u && CV_XADD(&frame.u->refcount, 0) > 1;
+        if (!isReferenced)
+        {
+            // frames that wrap foreign memory must not be written into
+            if (!frame.empty() && !frame.u)
+                frame.release();
+
+            _next = (index + 1) % numFrames;
+            return frame;
+        }
+    }
+
+    // all buffers are still in use by listeners: grow the ring
+    _frames.emplace_back();
+    _next = 0;
+    return _frames.back();
+}
+//-----------------------------------------------------------------------------
+cv::Mat& SENSFramePool::nextFree(int rows, int cols, int type)
+{
+    cv::Mat& frame = nextFree();
+    frame.create(rows, cols, type);
+    return frame;
+}
+//-----------------------------------------------------------------------------
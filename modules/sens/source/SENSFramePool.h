@@ -0,0 +1,47 @@
+//#############################################################################
+//  File:      SENSFramePool.h
+//  Purpose:   Reusable frame buffers of the SENS cameras
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SENS_FRAMEPOOL_H
+#define SENS_FRAMEPOOL_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+/*! SENSFramePool
+ Ring buffer of camera frame buffers that keep their memory from frame to
+ frame. A camera implementation writes every new image into the buffer
+ returned by nextFree (e.g. with cv::VideoCapture::read or cv::cvtColor) and
+ passes it to SENSBaseCamera::updateFrame. Listeners and SENSFrameBase only
+ hold reference counted cv::Mat headers on the buffer. A buffer is only handed
+ out again when no header outside of the pool references it anymore. If all
+ buffers are still in use the ring grows by one buffer.
+ The pool itself is not thread safe and must only be used by the thread that
+ produces the frames. It works like CVFramePool of the SL module but is kept
+ here because the SENS module only depends on OpenCV and Utils.
+ */
+class SENSFramePool
+{
+public:
+    explicit SENSFramePool(int numFrames = 3);
+
+    //! returns the next buffer that is not referenced outside of the pool (never assign another cv::Mat to it)
+    cv::Mat& nextFree();
+    //! returns the next free buffer with the passed size and type (allocates only if they changed)
+    cv::Mat& nextFree(int rows, int cols, int type);
+
+    int numFrames() const { return (int)_frames.size(); }
+
+private:
+    std::vector<cv::Mat> _frames;
+    int                  _next = 0;
+};
+//-----------------------------------------------------------------------------
+
+#endif //SENS_FRAMEPOOL_H
@@ -133,6 +133,8 @@ void SENSGLTextureReader::initGl()
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &lastFBO);
     GLint lastTex = -1;
     glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTex);
+    GLint lastVAO = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &lastVAO);
 
     //-----------------------------------------------------------------------------
     //setup shader program
@@ -217,7 +219,7 @@ void SENSGLTextureReader::initGl()
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glBindVertexArray((GLuint)lastVAO);
 
     glGenFramebuffers(1, &_fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
@@ -265,6 +267,9 @@ cv::Mat SENSGLTextureReader::readImageFromGpu()
     //viewport
     GLint lastViewport[4];
     glGetIntegerv(GL_VIEWPORT, lastViewport);
+    //vertex array (the app may cache its binding)
+    GLint lastVAO = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &lastVAO);
 
     //-----------------------------------------------------------------------------
     glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
@@ -290,6 +295,7 @@ cv::Mat SENSGLTextureReader::readImageFromGpu()
     //-------------------------------------------------------------------
     //restore old gl state
     glUseProgram(0);
+    glBindVertexArray((GLuint)lastVAO);
     glBindFramebuffer(GL_FRAMEBUFFER, lastFBO);
     glBindTexture(GL_TEXTURE_2D, lastTex);
     glViewport(lastViewport[0], lastViewport[1], lastViewport[2], lastViewport[3]);
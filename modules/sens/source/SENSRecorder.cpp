@@ -196,7 +196,7 @@ void SENSRecorder::onOrientation(const SENSTimePt& timePt, const SENSOrientation
         _orientationDataHandler->add(std::move(newData));
 }
 
-void SENSRecorder::onFrame(const SENSTimePt& timePt, cv::Mat frame)
+void SENSRecorder::onFrame(const SENSTimePt& timePt, const cv::Mat& frame)
 {
     auto newData = std::make_pair(frame, timePt);
     if (_cameraDataHandler)
@@ -49,7 +49,7 @@ private:
     //!orientation listener callback
     void onOrientation(const SENSTimePt& timePt, const SENSOrientation::Quat& ori) override;
     //!camera listener callback
-    void onFrame(const SENSTimePt& timePt, cv::Mat frame) override;
+    void onFrame(const SENSTimePt& timePt, const cv::Mat& frame) override;
     void onCameraConfigChanged(const SENSCameraConfig& config) override;
 
     std::string _outputDir;
@@ -334,7 +334,7 @@ void SENSSimulatedCamera::prepareSensorData(const int counter)
         _cap.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
     }
 
-    cv::Mat frame;
+    cv::Mat& frame = _framePool.nextFree();
 
     _cap.read(frame);
 
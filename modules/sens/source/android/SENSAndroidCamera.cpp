@@ -514,7 +514,7 @@ void SENSAndroidCamera::imageCallback(AImageReader* reader)
 
         AImage_delete(image);
 
-        cv::Mat      bgr;
+        cv::Mat&     bgr = _framePool.nextFree();
         HighResTimer t;
         cv::cvtColor(yuv, bgr, cv::COLOR_YUV2BGR_NV21, 3);
         SENS_DEBUG("SENSAndroidCamera: time for yuv conversion: %f ms", t.elapsedTimeInMilliSec());
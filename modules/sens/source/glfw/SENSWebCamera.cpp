@@ -78,7 +78,7 @@ void SENSWebCamera::grab()
 {
     while (!_stop)
     {
-        cv::Mat bgrImg;
+        cv::Mat& bgrImg = _framePool.nextFree();
         if (_videoCapture.read(bgrImg))
         {
             if (bgrImg.cols == _config.streamConfig.widthPix &&
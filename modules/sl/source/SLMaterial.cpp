@@ -375,8 +375,10 @@ SLMaterial::~SLMaterial()
 /*!
  If this material has not yet a shader program assigned (SLMaterial::_program)
  a suitable program will be generated with an instance of SLGLProgramGenerated.
+ The transform feedback update program is not needed if the particle system
+ is simulated on the CPU and can be omitted with generateProgramTF = false.
  */
-void SLMaterial::generateProgramPS()
+void SLMaterial::generateProgramPS(SLbool generateProgramTF)
 {
     // If no shader program is attached add a generated shader program
     // A 3D object can be stored without material or shader program information.
@@ -402,7 +404,7 @@ void SLMaterial::generateProgramPS()
         }
     }
 
-    if (!_programTF)
+    if (!_programTF && generateProgramTF)
     {
         /////////////////////////////
         // Generate update program
@@ -108,7 +108,7 @@ public:
                SLGLProgram*    program);
 
     ~SLMaterial() override;
-    void  generateProgramPS();
+    void  generateProgramPS(SLbool generateProgramTF = true);
     void  activate(SLCamera* cam,
                    SLVLight* lights,
                    SLSkybox* skybox = nullptr);
@@ -11,6 +11,7 @@
 #include <SLCamera.h>
 #include <SLLight.h>
 #include <SLLightRect.h>
+#include <SLMeshBatch.h>
 #include <SLSceneView.h>
 #include <SLSkybox.h>
 #include <GlobalTimer.h>
@@ -95,6 +96,7 @@ void SLSceneView::init(SLstring       name,
     _doMultiSampling  = true;
     _doFrustumCulling = true;
     _doAlphaSorting   = true;
+    _doStateSorting   = true;
     _doWaitOnIdle     = true;
     _drawBits.allOff();
 
@@ -129,6 +131,7 @@ void SLSceneView::unInit()
     _doMultiSampling  = true;
     _doFrustumCulling = true;
     _doAlphaSorting   = true;
+    _doStateSorting   = true;
     _doWaitOnIdle     = true;
     _drawBits.allOff();
 
@@ -520,6 +523,8 @@ SLbool SLSceneView::onPaint()
     SLGLVertexArray::totalDrawCalls          = 0;
     SLGLVertexArray::totalPrimitivesRendered = 0;
     SLShadowMap::drawCalls                   = 0;
+    SLShadowMap::facesRendered               = 0;
+    SLShadowMap::facesCached                 = 0;
 
     if (_s && _camera)
     { // Render the 3D scenegraph by raytracing, pathtracing or OpenGL
@@ -785,14 +790,34 @@ void SLSceneView::draw3DGLAll()
     PROFILE_FUNCTION();
 
     // a) Draw nodes with meshes with opaque materials and all helper lines sorted by material
-    for (auto material : _visibleMaterials3D)
+    if (_doStateSorting)
     {
-        if (!material->hasAlpha())
+        // Record all opaque meshes and replay them sorted by GL state
+        for (auto material : _visibleMaterials3D)
         {
-            draw3DGLNodes(material->nodesVisible3D(), false, false);
-            _stats3D.numNodesOpaque += (SLuint)material->nodesVisible3D().size();
+            if (!material->hasAlpha())
+            {
+                _drawList3D.addNodes(material->nodesVisible3D());
+                _stats3D.numNodesOpaque += (SLuint)material->nodesVisible3D().size();
+            }
+        }
+        _drawList3D.sort();
+        _drawList3D.draw(this);
+
+        for (auto material : _visibleMaterials3D)
+            draw3DGLLines(material->nodesVisible3D());
+    }
+    else
+    {
+        for (auto material : _visibleMaterials3D)
+        {
+            if (!material->hasAlpha())
+            {
+                draw3DGLNodes(material->nodesVisible3D(), false, false);
+                _stats3D.numNodesOpaque += (SLuint)material->nodesVisible3D().size();
+            }
+            draw3DGLLines(material->nodesVisible3D());
         }
-        draw3DGLLines(material->nodesVisible3D());
     }
 
     // b) Draw remaining opaque nodes without meshes
@@ -1487,6 +1512,19 @@ SLbool SLSceneView::onDoubleClick(SLMouseButton button,
             _s->root3D()->updateAABBRec(true);
 
             _s->root3D()->hitRec(&pickRay);
+
+            // A hit on a batch selects the source node of the hit triangle
+            SLMeshBatch* batch = dynamic_cast<SLMeshBatch*>(pickRay.hitMesh);
+            if (batch && pickRay.hitTriangle >= 0)
+            {
+                SLNode* srcNode = batch->sourceNode((SLuint)pickRay.hitTriangle);
+                if (srcNode)
+                {
+                    pickRay.hitNode = srcNode;
+                    pickRay.hitMesh = nullptr;
+                }
+            }
+
             if (pickRay.hitNode)
                 cout << "NODE HIT: " << pickRay.hitNode->name() << endl;
         }
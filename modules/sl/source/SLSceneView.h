@@ -13,6 +13,7 @@
 #include <SLAABBox.h>
 #include <SLDrawBits.h>
 #include <SLEventHandler.h>
+#include <SLGLDrawList.h>
 #include <SLGLOculusFB.h>
 #include <SLGLVertexArrayExt.h>
 #include <SLNode.h>
@@ -146,6 +147,7 @@ public:
     void doDepthTest(SLbool doDT) { _doDepthTest = doDT; }
     void doFrustumCulling(SLbool doFC) { _doFrustumCulling = doFC; }
     void doAlphaSorting(SLbool doAS) { _doAlphaSorting = doAS; }
+    void doStateSorting(SLbool doSS) { _doStateSorting = doSS; }
     void renderType(SLRenderType rt) { _renderType = rt; }
     void viewportSameAsVideo(bool sameAsVideo) { _viewportSameAsVideo = sameAsVideo; }
     void screenCaptureIsRequested(bool doScreenCap)
@@ -178,6 +180,7 @@ public:
     SLUiInterface*  gui() { return _gui; }
     SLbool          doFrustumCulling() const { return _doFrustumCulling; }
     SLbool          doAlphaSorting() const { return _doAlphaSorting; }
+    SLbool          doStateSorting() const { return _doStateSorting; }
     SLbool          doMultiSampling() const { return _doMultiSampling; }
     SLbool          doDepthTest() const { return _doDepthTest; }
     SLbool          doWaitOnIdle() const { return _doWaitOnIdle; }
@@ -198,6 +201,7 @@ public:
     AvgFloat&       draw3DTimesMS() { return _draw3DTimesMS; }
     SLNodeStats&    stats2D() { return _stats2D; }
     SLNodeStats&    stats3D() { return _stats3D; }
+    SLGLDrawList&   drawList3D() { return _drawList3D; }
     SLbool          screenCaptureIsRequested() { return _screenCaptureIsRequested; }
 
     std::unordered_set<SLMaterial*>& visibleMaterials2D() { return _visibleMaterials2D; }
@@ -229,6 +233,7 @@ protected:
     SLbool     _doMultiSampling;  //!< Flag if multisampling is on
     SLbool     _doFrustumCulling; //!< Flag if view frustum culling is on
     SLbool     _doAlphaSorting;   //!< Flag if alpha sorting in blending is on
+    SLbool     _doStateSorting;   //!< Flag if opaque meshes are drawn by a state sorted draw list
     SLbool     _doWaitOnIdle;     //!< Flag for Event waiting
     SLbool     _isFirstFrame;     //!< Flag if it is the first frame rendering
     SLDrawBits _drawBits;         //!< Sceneview level drawing flags
@@ -272,6 +277,8 @@ protected:
     SLVNode _nodesBlended3D; //!< Vector of visible blended nodes not in _visibleMaterials3D rendered in 3D
     SLVNode _nodesOverdrawn; //!< Vector of helper nodes drawn over all others
 
+    SLGLDrawList _drawList3D; //!< State sorted draw list for opaque 3D meshes
+
     SLRaytracer                     _raytracer;  //!< Whitted style raytracer
     SLbool                          _stopRT;     //!< Flag to stop the RT
     SLPathtracer                    _pathtracer; //!< Pathtracer
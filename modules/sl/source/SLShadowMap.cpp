@@ -24,9 +24,15 @@
 #include <SLLightSpot.h>
 #include <SLLightRect.h>
 #include <SLLightDirect.h>
+#include <SLParticleSystem.h>
 
 //-----------------------------------------------------------------------------
-SLuint SLShadowMap::drawCalls = 0; //!< NO. of draw calls for shadow mapping
+SLuint SLShadowMap::drawCalls     = 0; //!< NO. of draw calls for shadow mapping
+SLuint SLShadowMap::facesRendered = 0; //!< NO. of shadow map faces rendered in the current frame
+SLuint SLShadowMap::facesCached   = 0; //!< NO. of shadow map faces reused from the cache in the current frame
+//-----------------------------------------------------------------------------
+//! NO. of frames a caster must not move to get back into the static layer
+static const SLuint SL_SHADOW_STATIC_FRAMES = 30;
 //-----------------------------------------------------------------------------
 /*! Ctor for standard fixed size shadow map for any type of light
  * @param light Pointer to the light for which the shadow is created
@@ -70,6 +76,12 @@ SLShadowMap::SLShadowMap(SLLight*       light,
     _textureSize   = texSize;
     _camera        = nullptr;
     _numCascades   = 0;
+
+    _useCaching        = false;
+    _numFacesPerFrame  = 0;
+    _nextFace          = 0;
+    _staticDepthBuffer = nullptr;
+    invalidateCache();
 }
 //-----------------------------------------------------------------------------
 /*! Ctor for auto sized cascaded shadow mapping
@@ -111,11 +123,18 @@ SLShadowMap::SLShadowMap(SLLight*       light,
     _lightClipNear  = 0.1f;          // will be ignored and automatically calculated
     _lightClipFar   = 20.f;          // will be ignored and automatically calculated
     _cascadesFactor = 30.f;
+
+    _useCaching        = false; // the cascades follow the camera every frame
+    _numFacesPerFrame  = 0;
+    _nextFace          = 0;
+    _staticDepthBuffer = nullptr;
+    invalidateCache();
 }
 //-----------------------------------------------------------------------------
 SLShadowMap::~SLShadowMap()
 {
     _depthBuffers.erase(_depthBuffers.begin(), _depthBuffers.end());
+    delete _staticDepthBuffer;
     delete _frustumVAO;
     delete _material;
 }
@@ -489,6 +508,7 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
          (_depthBuffers[0]->target() == GL_TEXTURE_CUBE_MAP) != _useCubemap))
     {
         _depthBuffers.erase(_depthBuffers.begin(), _depthBuffers.end());
+        invalidateCache();
     }
 
     if (_depthBuffers.size() == 0)
@@ -503,6 +523,12 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
                                                       : GL_TEXTURE_2D));
     }
 
+    if (_useCaching)
+    {
+        renderShadowsCached(sv, root);
+        return;
+    }
+
     _depthBuffers[0]->bind();
 
     for (SLint i = 0; i < (_useCubemap ? 6 : 1); ++i)
@@ -526,6 +552,264 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
     _depthBuffers[0]->unbind();
 }
 //-----------------------------------------------------------------------------
+//! Marks all faces of the static layer as invalid and deletes its depth buffer
+void SLShadowMap::invalidateCache()
+{
+    delete _staticDepthBuffer;
+    _staticDepthBuffer = nullptr;
+
+    for (SLint i = 0; i < 6; ++i)
+    {
+        _staticHash[i]     = 0;
+        _faceIsValid[i]    = false;
+        _faceHasDynamic[i] = false;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Collects recursively all visible nodes with meshes that cast shadows
+void SLShadowMap::collectCastersRec(SLNode* node, SLVNode& casters)
+{
+    if (node->drawBit(SL_DB_HIDDEN))
+        return;
+
+    if (node->castsShadows() &&
+        node->mesh() &&
+        node->mesh()->primitive() >= GL_TRIANGLES)
+        casters.push_back(node);
+
+    for (SLNode* child : node->children())
+        collectCastersRec(child, casters);
+}
+//-----------------------------------------------------------------------------
+/*! Updates the movement states of the casters. Casters that are seen the first
+ time are static. A caster that moves gets dynamic until it did not move for
+ SL_SHADOW_STATIC_FRAMES frames. The states of removed casters are dropped.
+ */
+void SLShadowMap::updateCasterStates(const SLVNode& casters)
+{
+    SLShadowCasterStateMap states;
+
+    for (SLNode* node : casters)
+    {
+        SLShadowCasterState state;
+        state.wm          = node->updateAndGetWM();
+        state.stillFrames = SL_SHADOW_STATIC_FRAMES;
+
+        auto it = _casterStates.find(node);
+        if (it != _casterStates.end())
+        {
+            if (memcmp(&it->second.wm, &state.wm, sizeof(SLMat4f)) == 0)
+                state.stillFrames = std::min(it->second.stillFrames + 1,
+                                             SL_SHADOW_STATIC_FRAMES);
+            else
+                state.stillFrames = 0;
+        }
+
+        states[node] = state;
+    }
+
+    _casterStates.swap(states);
+}
+//-----------------------------------------------------------------------------
+/*! Returns true if the caster belongs to the dynamic layer. Besides moving
+ casters also meshes that change their vertices every frame (skinning, blend
+ shapes and particle systems) are dynamic.
+ */
+SLbool SLShadowMap::isDynamicCaster(SLNode* node)
+{
+    SLMesh* mesh = node->mesh();
+    if (mesh->skeleton() ||
+        mesh->bsCount > 0 ||
+        dynamic_cast<SLParticleSystem*>(mesh))
+        return true;
+
+    return _casterStates[node].stillFrames < SL_SHADOW_STATIC_FRAMES;
+}
+//-----------------------------------------------------------------------------
+//! Adds the bytes of a value to a 64 bit FNV-1a hash
+static void hashBytes(SLuint64& hash, const void* data, size_t numBytes)
+{
+    const SLubyte* bytes = (const SLubyte*)data;
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+//-----------------------------------------------------------------------------
+/*! Renders the shadow map faces with the static layer cache. For every face
+ the casters within the light frustum are split into static and dynamic ones.
+ The static layer of a face gets only re-rendered if the light space matrix or
+ the hash over the static casters (node, mesh, world matrix) changed. The
+ final face is the copied static layer with the dynamic casters on top. Faces
+ without any change are not touched at all. If SLShadowMap::numFacesPerFrame
+ is set, only that many faces get updated per frame in a round robin order.
+ The skipped faces keep the light space matrix of their content.
+ @param sv Pointer of the sceneview
+ @param root Pointer to the root node of the scene
+ */
+void SLShadowMap::renderShadowsCached(SLSceneView* sv, SLNode* root)
+{
+    PROFILE_FUNCTION();
+
+    static SLfloat borderColor[] = {1.0, 1.0, 1.0, 1.0};
+    SLint          numFaces      = _useCubemap ? 6 : 1;
+
+#ifdef SL_GLES
+    SLint wrapMode = GL_CLAMP_TO_EDGE;
+#else
+    SLint wrapMode = GL_CLAMP_TO_BORDER;
+#endif
+
+    // The static layer has the same layout as the final depth buffer
+    if (_staticDepthBuffer == nullptr)
+    {
+        invalidateCache();
+        _staticDepthBuffer = new SLGLDepthBuffer(_textureSize,
+                                                 GL_NEAREST,
+                                                 GL_NEAREST,
+                                                 wrapMode,
+                                                 borderColor,
+                                                 _depthBuffers[0]->target(),
+                                                 "SM-StaticDepthBuffer");
+    }
+
+    // Collect all casters and update their movement states
+    SLVNode casters;
+    collectCastersRec(root, casters);
+    updateCasterStates(casters);
+
+    SLGLState* stateGL        = SLGLState::instance();
+    SLint      numFacesToDraw = _numFacesPerFrame > 0 ? _numFacesPerFrame : numFaces;
+    SLint      firstFace      = _nextFace % numFaces;
+    SLbool     isFaceDrawn[6] = {false, false, false, false, false, false};
+
+    for (SLint f = 0; f < numFaces; ++f)
+    {
+        SLint  i    = (firstFace + f) % numFaces;
+        SLenum face = _useCubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + i : GL_TEXTURE_2D;
+
+        // Split the casters within the faces frustum into both layers
+        SLPlane planes[6];
+        SLFrustum::viewToFrustumPlanes(planes, _lightProj[0], _lightView[i]);
+
+        SLVNode  staticCasters;
+        SLVNode  dynamicCasters;
+        SLuint64 staticHash = 14695981039346656037ull;
+
+        for (SLNode* node : casters)
+        {
+            SLbool isInFrustum = true;
+            for (auto& plane : planes)
+            {
+                if (plane.distToPoint(node->aabb()->centerWS()) < -node->aabb()->radiusWS())
+                {
+                    isInFrustum = false;
+                    break;
+                }
+            }
+            if (!isInFrustum)
+                continue;
+
+            if (isDynamicCaster(node))
+                dynamicCasters.push_back(node);
+            else
+            {
+                SLMesh* mesh = node->mesh();
+                SLuint  numI = mesh->numI();
+                staticCasters.push_back(node);
+                hashBytes(staticHash, &node, sizeof(SLNode*));
+                hashBytes(staticHash, &mesh, sizeof(SLMesh*));
+                hashBytes(staticHash, &numI, sizeof(SLuint));
+                hashBytes(staticHash, &_casterStates[node].wm, sizeof(SLMat4f));
+            }
+        }
+
+        SLbool staticIsDirty = !_faceIsValid[i] ||
+                               _staticHash[i] != staticHash ||
+                               memcmp(&_cachedLightSpace[i],
+                                      &_lightSpace[i],
+                                      sizeof(SLMat4f)) != 0;
+
+        // Nothing changed and no dynamic casters to add or to remove
+        if (!staticIsDirty && dynamicCasters.empty() && !_faceHasDynamic[i])
+        {
+            SLShadowMap::facesCached++;
+            continue;
+        }
+
+        // Time slicing: Faces that were never drawn can not wait
+        if (numFacesToDraw <= 0 && _faceIsValid[i])
+        {
+            SLShadowMap::facesCached++;
+            continue;
+        }
+
+        numFacesToDraw--;
+        isFaceDrawn[i] = true;
+        _nextFace      = (i + 1) % numFaces;
+
+        stateGL->projectionMatrix = _lightProj[0];
+
+        // Re-render the static layer
+        if (staticIsDirty)
+        {
+            _staticDepthBuffer->bind();
+            if (_useCubemap)
+                _staticDepthBuffer->bindFace(face);
+
+            stateGL->viewport(0, 0, _textureSize.x, _textureSize.y);
+            stateGL->viewMatrix = _lightView[i];
+            stateGL->clearColor(SLCol4f::BLACK);
+            stateGL->clearColorDepthBuffer();
+
+            for (SLNode* node : staticCasters)
+            {
+                stateGL->viewMatrix  = _lightView[i];
+                stateGL->modelMatrix = node->updateAndGetWM();
+                node->mesh()->drawIntoDepthBuffer(sv, node, _material);
+                SLShadowMap::drawCalls++;
+            }
+
+            _staticDepthBuffer->unbind();
+
+            _cachedLightSpace[i] = _lightSpace[i];
+            _staticHash[i]       = staticHash;
+            _faceIsValid[i]      = true;
+        }
+
+        // The final face is the static layer plus the dynamic casters
+        _depthBuffers[0]->copyFrom(_staticDepthBuffer, face);
+
+        if (!dynamicCasters.empty())
+        {
+            _depthBuffers[0]->bind();
+            if (_useCubemap)
+                _depthBuffers[0]->bindFace(face);
+
+            stateGL->viewport(0, 0, _textureSize.x, _textureSize.y);
+
+            for (SLNode* node : dynamicCasters)
+            {
+                stateGL->viewMatrix  = _lightView[i];
+                stateGL->modelMatrix = node->updateAndGetWM();
+                node->mesh()->drawIntoDepthBuffer(sv, node, _material);
+                SLShadowMap::drawCalls++;
+            }
+
+            _depthBuffers[0]->unbind();
+        }
+
+        _faceHasDynamic[i] = !dynamicCasters.empty();
+        SLShadowMap::facesRendered++;
+    }
+
+    // Skipped faces are still in the light space of their last update
+    for (SLint i = 0; i < numFaces; ++i)
+        if (!isFaceDrawn[i] && _faceIsValid[i])
+            _lightSpace[i] = _cachedLightSpace[i];
+}
+//-----------------------------------------------------------------------------
 /*! Returns a vector of near and far clip distances for all shadow cascades
  * along the cameras view direction.
  * @param numCascades NO. of cascades
@@ -16,6 +16,7 @@
 #include <SLMat4.h>
 #include <SLNode.h>
 #include <SLGLDepthBuffer.h>
+#include <unordered_map>
 
 class SLGLVertexArrayExt;
 class SLLight;
@@ -26,6 +27,14 @@ class SLMaterial;
 class SLSceneView;
 class SLCamera;
 //-----------------------------------------------------------------------------
+//! Movement state of a shadow caster used for the shadow map caching
+struct SLShadowCasterState
+{
+    SLMat4f wm;          //!< World matrix of the caster in the last frame
+    SLuint  stillFrames; //!< NO. of frames the caster did not move
+};
+typedef std::unordered_map<SLNode*, SLShadowCasterState> SLShadowCasterStateMap;
+//-----------------------------------------------------------------------------
 //! Class for standard and cascaded shadow mapping
 /*! Shadow mapping is a technique to render shadows. The scene gets rendered
  * from the point of view of the lights which cast shadows. The resulting
@@ -34,6 +43,14 @@ class SLCamera;
  * with all light types. The auto sized shadow maps get automatically sized
  * to a specified camera. At the moment only directional light get supported
  * with multiple cascaded shadow maps.
+ * With SLShadowMap::useCaching the fixed size shadow maps are split into a
+ * static and a dynamic layer: The casters that did not move for a while are
+ * rendered into a separate static depth buffer only if the light space or the
+ * set of static casters within the light frustum changes. Every frame in which
+ * moving casters are in the light frustum the static layer is copied into the
+ * final depth buffer and only the moving casters are drawn on top. The caching
+ * is off by default because it needs a second depth buffer per light. With
+ * SLShadowMap::numFacesPerFrame the updates of cube maps can be time sliced.
  */
 class SLShadowMap
 {
@@ -71,6 +88,12 @@ public:
     void textureSize(const SLVec2i& textureSize) { _textureSize.set(textureSize); }
     void numCascades(int numCascades) { _numCascades = numCascades; }
     void cascadesFactor(float factor) { _cascadesFactor = factor; }
+    void useCaching(SLbool useCaching)
+    {
+        _useCaching = useCaching;
+        invalidateCache();
+    }
+    void numFacesPerFrame(SLint numFaces) { _numFacesPerFrame = numFaces; }
 
     // Getters
     SLProjType       projection() { return _projection; }
@@ -88,8 +111,12 @@ public:
     int              maxCascades() { return _maxCascades; }
     float            cascadesFactor() { return _cascadesFactor; }
     SLCamera*        camera() { return _camera; }
+    SLbool           useCaching() const { return _useCaching; }
+    SLint            numFacesPerFrame() const { return _numFacesPerFrame; }
 
-    static SLuint drawCalls; //!< NO. of draw calls for shadow mapping
+    static SLuint drawCalls;     //!< NO. of draw calls for shadow mapping
+    static SLuint facesRendered; //!< NO. of shadow map faces rendered in the current frame
+    static SLuint facesCached;   //!< NO. of shadow map faces reused from the cache in the current frame
 
 private:
     void     updateLightSpaces();
@@ -108,6 +135,11 @@ private:
     void     drawNodesDirectionalCulling(SLVNode      visibleNodes,
                                          SLSceneView* sv,
                                          SLMat4f&     lightView);
+    void     renderShadowsCached(SLSceneView* sv, SLNode* root);
+    void     invalidateCache();
+    void     collectCastersRec(SLNode* node, SLVNode& casters);
+    void     updateCasterStates(const SLVNode& casters);
+    SLbool   isDynamicCaster(SLNode* node);
 
 private:
     SLLight*            _light;          //!< The light which uses this shadow map
@@ -130,6 +162,17 @@ private:
     SLVec2f             _halfSize;       //!< _size divided by two (only for SLLightDirect non cascaded)
     SLVec2i             _textureSize;    //!< Size of the shadow map texture
     SLCamera*           _camera;         //!< Camera to witch the light frustums are adapted
+
+    // Shadow map caching of static casters
+    SLbool                 _useCaching;          //!< Flag if the static casters are cached in a separate depth buffer
+    SLint                  _numFacesPerFrame;    //!< Max. NO. of faces updated per frame (0 = all)
+    SLint                  _nextFace;            //!< Face to start with the time sliced updates
+    SLGLDepthBuffer*       _staticDepthBuffer;   //!< Depth buffer with the static casters only
+    SLMat4f                _cachedLightSpace[6]; //!< Light space matrices of the cached faces
+    SLuint64               _staticHash[6];       //!< Hash of the static casters of the cached faces
+    SLbool                 _faceIsValid[6];      //!< Flag if the static layer of a face is valid
+    SLbool                 _faceHasDynamic[6];   //!< Flag if a face contains dynamic casters
+    SLShadowCasterStateMap _casterStates;        //!< Movement states of all casters
 };
 //-----------------------------------------------------------------------------
 #endif // SLSHADOWMAP_H
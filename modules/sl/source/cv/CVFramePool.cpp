@@ -0,0 +1,85 @@
+//#############################################################################
+//  File:      CVFramePool.cpp
+//  Purpose:   Ring buffer of reusable video frame buffers
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <cv/CVFramePool.h>
+
+//-----------------------------------------------------------------------------
+CVFramePool::CVFramePool(int numFrames)
+{
+    assert(numFrames > 0 && "CVFramePool: At least one frame is needed");
+    _frames.resize((size_t)numFrames);
+}
+//-----------------------------------------------------------------------------
+/*! Returns true if the buffer of the frame is referenced by another CVMat
+ header than the passed one. The reference counter of OpenCV is changed
+ atomically by other threads, so it is read with an atomic add of zero.
+ */
+bool CVFramePool::isReferenced(const CVMat& frame)
+{
+    if (!frame.u)
+        return false;
+    return CV_XADD(&frame.u->refcount, 0) > 1;
+}
+//-----------------------------------------------------------------------------
+/*! Returns the next buffer of the ring that is not referenced outside of the
+ pool. Write the new frame directly into the returned CVMat and hand out only
+ copies of the header or ROIs on it. Never assign another CVMat to the returned
+ reference, because this would replace the pooled buffer.
+ */
+CVMat& CVFramePool::nextFree()
+{
+    int numFrames = (int)_frames.size();
+
+    for (int i = 0; i < numFrames; ++i)
+    {
+        int    index = (_next + i) % numFrames;
+        CVMat& frame = _frames[(size_t)index];
+
+        if (!isReferenced(frame))
+        {
+            // Frames that wrap foreign memory must not be written into
+            if (!frame.empty() && !frame.u)
+                frame.release();
+
+            _next = (index + 1) % numFrames;
+            return frame;
+        }
+    }
+
+    // All buffers are still in use: Grow the ring by one buffer
+    _frames.emplace_back();
+    _next = 0;
+    return _frames.back();
+}
+//-----------------------------------------------------------------------------
+/*! Returns the next free buffer of the ring with the passed size and type.
+ A new image is only allocated if the buffer had a different size or type.
+ */
+CVMat& CVFramePool::nextFree(int rows, int cols, int type)
+{
+    CVMat& frame      = nextFree();
+    uchar* dataBefore = frame.data;
+
+    frame.create(rows, cols, type);
+
+    if (frame.data != dataBefore)
+        _numAllocations++;
+
+    return frame;
+}
+//-----------------------------------------------------------------------------
+//! Releases all buffers of the ring
+void CVFramePool::clear()
+{
+    for (auto& frame : _frames)
+        frame.release();
+    _next           = 0;
+    _numAllocations = 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,50 @@
+//#############################################################################
+//  File:      CVFramePool.h
+//  Purpose:   Ring buffer of reusable video frame buffers
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef CVFRAMEPOOL_H
+#define CVFRAMEPOOL_H
+
+#include <cv/CVTypedefs.h>
+
+//-----------------------------------------------------------------------------
+//! Ring buffer of video frame buffers that are reused from frame to frame
+/*! A video frame is usually written into a new CVMat for every captured
+ image. The allocation of a full resolution image per frame is expensive on
+ mobile devices. CVFramePool holds a small ring of CVMat buffers that keep
+ their memory from frame to frame.\n
+ CVFramePool::nextFree returns the next buffer in the ring that is not
+ referenced anymore outside of the pool. The caller writes the new frame into
+ this buffer (e.g. with cv::VideoCapture::read, cv::cvtColor or CVMat::create)
+ which only allocates if the size or type has changed. Consumers then hold
+ reference counted views (CVMat headers or ROIs) on the buffer. As long as a
+ view exists, the buffer is not handed out again. If all buffers are still
+ referenced the ring grows by one buffer.
+*/
+class CVFramePool
+{
+public:
+    explicit CVFramePool(int numFrames = 3);
+
+    CVMat& nextFree();
+    CVMat& nextFree(int rows, int cols, int type);
+    void   clear();
+
+    // Getters
+    int numFrames() const { return (int)_frames.size(); }
+    int numAllocations() const { return _numAllocations; }
+
+    static bool isReferenced(const CVMat& frame);
+
+private:
+    CVVMat _frames;             //!< Ring of frame buffers
+    int    _next           = 0; //!< Index of the buffer that is checked first
+    int    _numAllocations = 0; //!< NO. of buffers allocated by nextFree with size
+};
+//-----------------------------------------------------------------------------
+#endif // CVFRAMEPOOL_H
@@ -208,6 +208,7 @@ done.
 /param data Pointer to the first byte of the image data
 /param isContinuous True if the memory is continuous and has no stride bytes at the end of the line
 /param isTopLeft True if image data starts at top left of image (else bottom left)
+/param srcBytesPerLine Stride of the source in bytes (e.g. of an OpenCV ROI). If 0 it is calculated from the width and isContinuous.
 */
 bool CVImage::load(int             width,
                    int             height,
@@ -215,7 +216,8 @@ bool CVImage::load(int             width,
                    CVPixelFormatGL dstPixelFormatGL,
                    uchar*          data,
                    bool            isContinuous,
-                   bool            isTopLeft)
+                   bool            isTopLeft,
+                   uint            srcBytesPerLine)
 {
 
     bool needsTextureRebuild = allocate(width,
@@ -225,7 +227,7 @@ bool CVImage::load(int             width,
     uint dstBPL              = _bytesPerLine;
     uint dstBPP              = _bytesPerPixel;
     uint srcBPP              = bytesPerPixel(srcPixelFormatGL);
-    uint srcBPL              = bytesPerLine((uint)width, srcPixelFormatGL, isContinuous);
+    uint srcBPL              = srcBytesPerLine ? srcBytesPerLine : bytesPerLine((uint)width, srcPixelFormatGL, isContinuous);
 
     if (isTopLeft)
     {
@@ -300,10 +302,17 @@ bool CVImage::load(int             width,
     }
     else // bottom left (no flipping)
     {
-        if (srcPixelFormatGL == dstPixelFormatGL)
+        if (srcPixelFormatGL == dstPixelFormatGL && srcBPL == dstBPL)
         {
             memcpy(_cvMat.data, data, (unsigned long)_bytesPerImage);
         }
+        else if (srcPixelFormatGL == dstPixelFormatGL)
+        {
+            uchar* dstStart = _cvMat.data;
+            uchar* srcStart = data;
+            for (int h = 0; h < _cvMat.rows; ++h, srcStart += srcBPL, dstStart += dstBPL)
+                memcpy(dstStart, srcStart, (unsigned long)dstBPL);
+        }
         else
         {
             uchar* dstStart = _cvMat.data;
@@ -91,7 +91,8 @@ public:
                                 CVPixelFormatGL dstPixelFormatGL,
                                 uchar*          data,
                                 bool            isContinuous,
-                                bool            isTopLeft);
+                                bool            isTopLeft,
+                                uint            srcBytesPerLine = 0);
     void                   savePNG(const string& filename,
                                    int           compressionLevel = 6,
                                    bool          flipY            = true,
@@ -20,13 +20,13 @@ for a good top down information.
 
 //-----------------------------------------------------------------------------
 // Static declarations
-AvgFloat CVTracked::trackingTimesMS;
-AvgFloat CVTracked::detectTimesMS;
-AvgFloat CVTracked::detect1TimesMS;
-AvgFloat CVTracked::detect2TimesMS;
-AvgFloat CVTracked::matchTimesMS;
-AvgFloat CVTracked::optFlowTimesMS;
-AvgFloat CVTracked::poseTimesMS;
+CVAvgTimeMS CVTracked::trackingTimesMS;
+CVAvgTimeMS CVTracked::detectTimesMS;
+CVAvgTimeMS CVTracked::detect1TimesMS;
+CVAvgTimeMS CVTracked::detect2TimesMS;
+CVAvgTimeMS CVTracked::matchTimesMS;
+CVAvgTimeMS CVTracked::optFlowTimesMS;
+CVAvgTimeMS CVTracked::poseTimesMS;
 //-----------------------------------------------------------------------------
 void CVTracked::resetTimes()
 {
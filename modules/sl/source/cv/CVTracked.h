@@ -27,9 +27,39 @@ for a good top down information.
 #include <opencv2/xfeatures2d.hpp>
 
 #include <SLQuat4.h>
+#include <mutex>
 
 using Utils::AvgFloat;
 
+//-----------------------------------------------------------------------------
+//! Averaged time in ms that can be set and read from different threads
+/*! The tracking times are set by the tracker, that can run in the thread of a
+ CVTrackingWorker, and are read by the GUI in the render thread.
+*/
+class CVAvgTimeMS
+{
+public:
+    void init(int numValues, float initValueMS)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _times.init(numValues, initValueMS);
+    }
+    void set(float timeMS)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _times.set(timeMS);
+    }
+    float average()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _times.average();
+    }
+
+private:
+    std::mutex _mutex; //!< Mutex for the averaged times
+    AvgFloat   _times; //!< Averaged times in ms
+};
+
 //-----------------------------------------------------------------------------
 //! CVTracked is the pure virtual base class for tracking features in video.
 /*! The static vector trackers can hold multiple of CVTracked that are
@@ -75,14 +105,14 @@ public:
                                          vector<float>    weights);
 
     // Statics: These statics are used directly in application code (e.g. in )
-    static void     resetTimes();    //!< Resets all static variables
-    static AvgFloat trackingTimesMS; //!< Averaged time for video tracking in ms
-    static AvgFloat detectTimesMS;   //!< Averaged time for video feature detection & description in ms
-    static AvgFloat detect1TimesMS;  //!< Averaged time for video feature detection subpart 1 in ms
-    static AvgFloat detect2TimesMS;  //!< Averaged time for video feature detection subpart 2 in ms
-    static AvgFloat matchTimesMS;    //!< Averaged time for video feature matching in ms
-    static AvgFloat optFlowTimesMS;  //!< Averaged time for video feature optical flow tracking in ms
-    static AvgFloat poseTimesMS;     //!< Averaged time for video feature pose estimation in ms
+    static void        resetTimes();    //!< Resets all static variables
+    static CVAvgTimeMS trackingTimesMS; //!< Averaged time for video tracking in ms
+    static CVAvgTimeMS detectTimesMS;   //!< Averaged time for video feature detection & description in ms
+    static CVAvgTimeMS detect1TimesMS;  //!< Averaged time for video feature detection subpart 1 in ms
+    static CVAvgTimeMS detect2TimesMS;  //!< Averaged time for video feature detection subpart 2 in ms
+    static CVAvgTimeMS matchTimesMS;    //!< Averaged time for video feature matching in ms
+    static CVAvgTimeMS optFlowTimesMS;  //!< Averaged time for video feature optical flow tracking in ms
+    static CVAvgTimeMS poseTimesMS;     //!< Averaged time for video feature pose estimation in ms
 
 protected:
     bool         _isVisible;     //!< Flag if marker is visible
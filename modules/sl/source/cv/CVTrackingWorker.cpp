@@ -0,0 +1,218 @@
+//#############################################################################
+//  File:      CVTrackingWorker.cpp
+//  Purpose:   Runs a CVTracked instance in its own thread
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <cv/CVTrackingWorker.h>
+#include <GlobalTimer.h>
+#include <SLMat4.h>
+
+//-----------------------------------------------------------------------------
+CVTrackingWorker::CVTrackingWorker() : _frameCalib(CVCameraType::BACKFACING, ""),
+                                       _workCalib(CVCameraType::BACKFACING, "")
+{
+    _latencyMS.init(60, 0.0f);
+}
+//-----------------------------------------------------------------------------
+CVTrackingWorker::~CVTrackingWorker()
+{
+    stop();
+}
+//-----------------------------------------------------------------------------
+//! Starts the worker thread that tracks the pushed frames with the tracker
+void CVTrackingWorker::start(CVTracked* tracker)
+{
+    assert(tracker && "CVTrackingWorker::start: No tracker passed");
+
+    stop();
+
+    _tracker          = tracker;
+    _stop             = false;
+    _hasNewFrame      = false;
+    _lastPose         = CVTrackedPose();
+    _prevPose         = CVTrackedPose();
+    _numFramesTracked = 0;
+    _numFramesDropped = 0;
+    _latencyMS.init(60, 0.0f);
+
+    _thread = std::thread(&CVTrackingWorker::run, this);
+}
+//-----------------------------------------------------------------------------
+//! Stops the worker thread after it finished tracking its current frame
+void CVTrackingWorker::stop()
+{
+    if (!_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_frameMutex);
+        _stop = true;
+    }
+    _frameCondVar.notify_one();
+    _thread.join();
+
+    _tracker     = nullptr;
+    _hasNewFrame = false;
+}
+//-----------------------------------------------------------------------------
+/*! Copies the passed frame into the mailbox and wakes up the worker thread.
+ The image buffers of the mailbox are reused, so there is no allocation for
+ frames of the same size. A frame in the mailbox that was not yet picked up by
+ the worker thread gets overwritten.
+ @param imageGray Grayscale frame for the tracking
+ @param imageRgb RGB frame for the tracking
+ @param calib Calibration of the camera that captured the frame
+ @param frameTimeS Capture time of the frame in s (see GlobalTimer::timeS)
+ */
+void CVTrackingWorker::pushFrame(const CVMat&         imageGray,
+                                 const CVMat&         imageRgb,
+                                 const CVCalibration& calib,
+                                 float                frameTimeS)
+{
+    if (!_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_frameMutex);
+        if (_hasNewFrame)
+            _numFramesDropped++;
+
+        imageGray.copyTo(_frameGray);
+        imageRgb.copyTo(_frameRgb);
+        _frameCalib  = calib;
+        _frameTimeS  = frameTimeS;
+        _hasNewFrame = true;
+    }
+    _frameCondVar.notify_one();
+}
+//-----------------------------------------------------------------------------
+//! Worker thread routine that tracks the latest frame of the mailbox
+void CVTrackingWorker::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_frameMutex);
+            _frameCondVar.wait(lock, [this]
+                               { return _hasNewFrame || _stop; });
+            if (_stop)
+                return;
+
+            // Swap only the image headers so that no pixels get copied
+            std::swap(_frameGray, _workGray);
+            std::swap(_frameRgb, _workRgb);
+            _workCalib   = _frameCalib;
+            _workTimeS   = _frameTimeS;
+            _hasNewFrame = false;
+        }
+
+        bool found = _tracker->track(_workGray, _workRgb, &_workCalib);
+
+        {
+            std::lock_guard<std::mutex> lock(_poseMutex);
+            _prevPose               = _lastPose;
+            _lastPose.found         = found;
+            _lastPose.frameTimeS    = _workTimeS;
+            _lastPose.objectViewMat = _tracker->objectViewMat();
+            _latencyMS.set((GlobalTimer::timeS() - _workTimeS) * 1000.0f);
+        }
+
+        _numFramesTracked++;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the pose of the last tracked frame and true if it was found
+bool CVTrackingWorker::lastPose(CVTrackedPose& pose)
+{
+    std::lock_guard<std::mutex> lock(_poseMutex);
+    pose = _lastPose;
+    return pose.found;
+}
+//-----------------------------------------------------------------------------
+//! Returns the averaged time from the frame capture to the published pose in ms
+float CVTrackingWorker::latencyMS()
+{
+    std::lock_guard<std::mutex> lock(_poseMutex);
+    return _latencyMS.average();
+}
+//-----------------------------------------------------------------------------
+/*! Returns in objectViewMat the pose for the passed display time. If the last
+ two tracked frames were found the pose is extrapolated or interpolated with
+ the constant velocity between them. The extrapolation beyond the last tracked
+ frame is limited to maxExtrapolationS. Returns false if the tracker did not
+ find the pose in the last tracked frame.
+ @param displayTimeS Capture time of the frame that is displayed in s
+ @param objectViewMat Resulting object view matrix
+ */
+bool CVTrackingWorker::poseAtTime(float displayTimeS, CVMatx44f& objectViewMat)
+{
+    CVTrackedPose last, prev;
+    {
+        std::lock_guard<std::mutex> lock(_poseMutex);
+        last = _lastPose;
+        prev = _prevPose;
+    }
+
+    if (!last.found)
+        return false;
+
+    objectViewMat = last.objectViewMat;
+
+    float dt = last.frameTimeS - prev.frameTimeS;
+    if (!_doExtrapolation || !prev.found || dt <= 0.0f)
+        return true;
+
+    // Poses too far apart do not describe a continuous motion anymore
+    if (dt > 4.0f * _maxExtrapolationS)
+        return true;
+
+    float targetTimeS = std::min(displayTimeS, last.frameTimeS + _maxExtrapolationS);
+    float t           = (targetTimeS - prev.frameTimeS) / dt;
+
+    objectViewMat = interpolatePose(prev.objectViewMat, last.objectViewMat, t);
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*! Interpolates between two object view matrices with lerp for the
+ translation and slerp for the rotation. Values of t above 1 extrapolate the
+ motion from ovm1 to ovm2.
+ */
+CVMatx44f CVTrackingWorker::interpolatePose(const CVMatx44f& ovm1,
+                                            const CVMatx44f& ovm2,
+                                            float            t)
+{
+    // clang-format off
+    // convert matrix type CVMatx44f to SLMat4f
+    SLMat4f m1(ovm1.val[0], ovm1.val[1], ovm1.val[2], ovm1.val[3],
+               ovm1.val[4], ovm1.val[5], ovm1.val[6], ovm1.val[7],
+               ovm1.val[8], ovm1.val[9], ovm1.val[10],ovm1.val[11],
+               ovm1.val[12],ovm1.val[13],ovm1.val[14],ovm1.val[15]);
+    SLMat4f m2(ovm2.val[0], ovm2.val[1], ovm2.val[2], ovm2.val[3],
+               ovm2.val[4], ovm2.val[5], ovm2.val[6], ovm2.val[7],
+               ovm2.val[8], ovm2.val[9], ovm2.val[10],ovm2.val[11],
+               ovm2.val[12],ovm2.val[13],ovm2.val[14],ovm2.val[15]);
+    // clang-format on
+
+    SLQuat4f q1(m1.mat3());
+    SLQuat4f q2(m2.mat3());
+    SLQuat4f q = q1.slerp(q2, t);
+    q.normalize();
+
+    SLVec3f t1 = m1.translation();
+    SLVec3f t2 = m2.translation();
+
+    SLMat4f m = q.toMat4();
+    m.translation(t1 + (t2 - t1) * t, true);
+
+    // clang-format off
+    return CVMatx44f(m.m(0), m.m(4), m.m(8),  m.m(12),
+                     m.m(1), m.m(5), m.m(9),  m.m(13),
+                     m.m(2), m.m(6), m.m(10), m.m(14),
+                     m.m(3), m.m(7), m.m(11), m.m(15));
+    // clang-format on
+}
+//-----------------------------------------------------------------------------
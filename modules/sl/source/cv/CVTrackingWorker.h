@@ -0,0 +1,112 @@
+//#############################################################################
+//  File:      CVTrackingWorker.h
+//  Purpose:   Runs a CVTracked instance in its own thread
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef CVTRACKINGWORKER_H
+#define CVTRACKINGWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <cv/CVTypedefs.h>
+#include <cv/CVTracked.h>
+
+//-----------------------------------------------------------------------------
+//! Pose of a tracker together with the capture time of its frame
+struct CVTrackedPose
+{
+    bool      found      = false; //!< Flag if the tracker found the pose
+    CVMatx44f objectViewMat;      //!< Object view matrix of the tracker
+    float     frameTimeS = 0.0f;  //!< Capture time of the tracked frame in s
+};
+//-----------------------------------------------------------------------------
+//! CVTrackingWorker runs the tracking of a CVTracked instance in its own thread
+/*! The synchronous call of CVTracked::track in the frame update adds the
+ whole detection time to the frame time. The tracking worker decouples the
+ tracking from the render loop:\n
+ - The render thread passes every new frame with CVTrackingWorker::pushFrame
+   into a mailbox that holds only the latest frame. A frame that was not yet
+   picked up by the worker thread is overwritten and counted as dropped.
+ - The worker thread tracks the latest frame and publishes the pose together
+   with the capture time of the frame.
+ - The render thread gets with CVTrackingWorker::poseAtTime a pose for the
+   capture time of the displayed frame. The pose is extrapolated from the last
+   two poses with a linear motion model (lerp for the translation and slerp
+   for the rotation).\n
+ While the worker is running the tracker must not be used by other threads.
+ The detection that a tracker draws into the RGB image is drawn into the
+ worker's copy of the frame and is therefore not visible.
+*/
+class CVTrackingWorker
+{
+public:
+    CVTrackingWorker();
+    ~CVTrackingWorker();
+
+    void start(CVTracked* tracker);
+    void stop();
+    void pushFrame(const CVMat&         imageGray,
+                   const CVMat&         imageRgb,
+                   const CVCalibration& calib,
+                   float                frameTimeS);
+    bool lastPose(CVTrackedPose& pose);
+    bool poseAtTime(float displayTimeS, CVMatx44f& objectViewMat);
+
+    static CVMatx44f interpolatePose(const CVMatx44f& ovm1,
+                                     const CVMatx44f& ovm2,
+                                     float            t);
+
+    // Setters
+    void doExtrapolation(bool doExtrapolate) { _doExtrapolation = doExtrapolate; }
+    void maxExtrapolationS(float maxS) { _maxExtrapolationS = maxS; }
+
+    // Getters
+    bool       isRunning() { return _thread.joinable(); }
+    CVTracked* tracker() { return _tracker; }
+    bool       doExtrapolation() { return _doExtrapolation; }
+    float      maxExtrapolationS() { return _maxExtrapolationS; }
+    int        numFramesTracked() { return _numFramesTracked; }
+    int        numFramesDropped() { return _numFramesDropped; }
+    float      latencyMS();
+
+private:
+    void run();
+
+    CVTracked*  _tracker = nullptr; //!< Tracker that is used in the worker thread
+    std::thread _thread;            //!< Worker thread
+
+    // Latest frame mailbox (protected by _frameMutex)
+    std::mutex              _frameMutex;          //!< Mutex for the frame mailbox
+    std::condition_variable _frameCondVar;        //!< Wakes up the worker on a new frame or stop
+    CVMat                   _frameGray;           //!< Latest grayscale frame
+    CVMat                   _frameRgb;            //!< Latest RGB frame
+    CVCalibration           _frameCalib;          //!< Calibration of the latest frame
+    float                   _frameTimeS  = 0.0f;  //!< Capture time of the latest frame in s
+    bool                    _hasNewFrame = false; //!< Flag if the mailbox holds an unprocessed frame
+    bool                    _stop        = false; //!< Flag to stop the worker thread
+
+    // Frame that is tracked in the worker thread
+    CVMat         _workGray;         //!< Grayscale frame in work
+    CVMat         _workRgb;          //!< RGB frame in work
+    CVCalibration _workCalib;        //!< Calibration of the frame in work
+    float         _workTimeS = 0.0f; //!< Capture time of the frame in work in s
+
+    // Published poses (protected by _poseMutex)
+    std::mutex    _poseMutex; //!< Mutex for the published poses
+    CVTrackedPose _lastPose;  //!< Pose of the last tracked frame
+    CVTrackedPose _prevPose;  //!< Pose of the tracked frame before the last one
+    AvgFloat      _latencyMS; //!< Averaged time from frame capture to the published pose in ms
+
+    std::atomic<int> _numFramesTracked{0};      //!< NO. of frames tracked since start
+    std::atomic<int> _numFramesDropped{0};      //!< NO. of frames overwritten in the mailbox since start
+    bool             _doExtrapolation   = true; //!< Flag for pose extrapolation to the display time
+    float            _maxExtrapolationS = 0.1f; //!< Max. time in s a pose gets extrapolated
+};
+//-----------------------------------------------------------------------------
+#endif // CVTRACKINGWORKER_H
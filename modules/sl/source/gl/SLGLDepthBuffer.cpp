@@ -198,3 +198,54 @@ void SLGLDepthBuffer::bindFace(SLenum face) const
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
+/*! Copies the depth values of a depth buffer with the same size and target
+ into this depth buffer with a framebuffer blit. For cube maps only the passed
+ face gets copied. The previously bound framebuffers are restored.
+ @param src Depth buffer to copy from
+ @param face Cube map face (ignored for GL_TEXTURE_2D targets)
+ */
+void SLGLDepthBuffer::copyFrom(SLGLDepthBuffer* src, SLenum face)
+{
+    assert(src && src->_target == _target);
+    assert(src->_dimensions.x == _dimensions.x &&
+           src->_dimensions.y == _dimensions.y);
+
+    SLint prevReadFboID, prevDrawFboID;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevReadFboID);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevDrawFboID);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, src->_fboID);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fboID);
+
+    if (_target == GL_TEXTURE_CUBE_MAP)
+    {
+        assert(face >= GL_TEXTURE_CUBE_MAP_POSITIVE_X &&
+               face <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER,
+                               GL_DEPTH_ATTACHMENT,
+                               face,
+                               src->_texID,
+                               0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER,
+                               GL_DEPTH_ATTACHMENT,
+                               face,
+                               _texID,
+                               0);
+    }
+
+    glBlitFramebuffer(0,
+                      0,
+                      _dimensions.x,
+                      _dimensions.y,
+                      0,
+                      0,
+                      _dimensions.x,
+                      _dimensions.y,
+                      GL_DEPTH_BUFFER_BIT,
+                      GL_NEAREST);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (SLuint)prevReadFboID);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (SLuint)prevDrawFboID);
+    GET_GL_ERROR;
+}
+//-----------------------------------------------------------------------------
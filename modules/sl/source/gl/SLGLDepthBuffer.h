@@ -33,6 +33,7 @@ public:
     void     bind();
     void     unbind();
     void     bindFace(SLenum face) const;
+    void     copyFrom(SLGLDepthBuffer* src, SLenum face = GL_TEXTURE_2D);
     SLfloat* readPixels() const;
     SLVec2i  dimensions() { return _dimensions; }
 
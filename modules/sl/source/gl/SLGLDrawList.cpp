@@ -0,0 +1,198 @@
+//#############################################################################
+//  File:      SLGLDrawList.cpp
+//  Purpose:   Recorded and state sorted list of mesh draw commands
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLDrawBits.h>
+#include <SLGLDrawList.h>
+#include <SLGLProgram.h>
+#include <SLGLState.h>
+#include <SLGLTexture.h>
+#include <SLMaterial.h>
+#include <SLMesh.h>
+#include <SLSceneView.h>
+
+//-----------------------------------------------------------------------------
+//! Removes all recorded commands and resets the statistics
+void SLGLDrawList::clear()
+{
+    _cmds.clear();
+    _matIndices.clear();
+    _stats.clear();
+    _isReplaying = false;
+    _lastProgram = nullptr;
+}
+//-----------------------------------------------------------------------------
+/*! Builds the 64 bit sort key of a draw command. The most significant bits
+ are the most expensive state changes:
+ \n 12 bit: shader program id
+ \n 12 bit: texture id of the first diffuse texture
+ \n 16 bit: material index of the current record pass
+ \n  4 bit: render state bits (face culling & wire frame)
+ \n 20 bit: vertex array object id
+ \n Collisions in the masked ids only worsen the sorting but never the result
+ because all states are applied during the replay.
+ */
+SLuint64 SLGLDrawList::buildSortKey(SLMesh* mesh,
+                                    SLNode* node,
+                                    SLuint  materialIndex)
+{
+    SLMaterial* mat    = mesh->mat();
+    SLuint64    progID = (mat && mat->program()) ? mat->program()->progID() : 0;
+    SLuint64    texID  = 0;
+    if (mat && !mat->textures(TT_diffuse).empty())
+        texID = mat->textures(TT_diffuse)[0]->texID();
+
+    SLuint64 state = 0;
+    if (node->drawBit(SL_DB_CULLOFF)) state |= 1;
+    if (node->drawBit(SL_DB_MESHWIRED)) state |= 2;
+
+    SLuint64 vaoID = (SLuint64)mesh->vao().vaoID();
+
+    return ((progID & 0xFFF) << 52) |
+           ((texID & 0xFFF) << 40) |
+           (((SLuint64)materialIndex & 0xFFFF) << 24) |
+           ((state & 0xF) << 20) |
+           (vaoID & 0xFFFFF);
+}
+//-----------------------------------------------------------------------------
+//! Records a draw command for a node with a mesh
+void SLGLDrawList::add(SLNode* node)
+{
+    if (!node || !node->mesh())
+        return;
+
+    SLMesh* mesh = node->mesh();
+
+    // Materials get consecutive indices in the order they are recorded
+    auto   it       = _matIndices.find(mesh->mat());
+    SLuint matIndex = (SLuint)_matIndices.size();
+    if (it == _matIndices.end())
+        _matIndices[mesh->mat()] = matIndex;
+    else
+        matIndex = it->second;
+
+    SLGLDrawCmd cmd;
+    cmd.node    = node;
+    cmd.mesh    = mesh;
+    cmd.wm      = node->updateAndGetWM();
+    cmd.sortKey = buildSortKey(mesh, node, matIndex);
+    _cmds.push_back(cmd);
+}
+//-----------------------------------------------------------------------------
+//! Records draw commands for all nodes with meshes
+void SLGLDrawList::addNodes(SLVNode& nodes)
+{
+    for (auto* node : nodes)
+        add(node);
+}
+//-----------------------------------------------------------------------------
+//! Sorts the recorded commands by their sort key
+void SLGLDrawList::sort()
+{
+    std::stable_sort(_cmds.begin(),
+                     _cmds.end(),
+                     [](const SLGLDrawCmd& a, const SLGLDrawCmd& b)
+                     { return a.sortKey < b.sortKey; });
+}
+//-----------------------------------------------------------------------------
+/*! Replays all recorded commands in their current order. The vertex array
+ objects are kept bound between the draw calls and the matrix uniforms are
+ passed in SLGLDrawList::passMatrices only if they changed. After the replay
+ the recorded commands are removed but the statistics are kept until the next
+ replay.
+ */
+void SLGLDrawList::draw(SLSceneView* sv)
+{
+    _stats.clear();
+
+    if (_cmds.empty())
+        return;
+
+    SLGLState* stateGL = SLGLState::instance();
+    stateGL->blend(false);
+    stateGL->depthMask(true);
+    stateGL->keepVertexArrayBound(true);
+
+    _isReplaying = true;
+    _lastProgram = nullptr;
+
+    SLMaterial* lastMat = nullptr;
+
+    // Program changes and VAO binds are counted by SLGLState where the GL
+    // calls are made or skipped
+    SLuint programChanges      = stateGL->numProgramChanges();
+    SLuint programChangesSaved = stateGL->numProgramChangesSaved();
+    SLuint vaoBinds            = stateGL->numVAOBinds();
+    SLuint vaoBindsSaved       = stateGL->numVAOBindsSaved();
+
+    for (auto& cmd : _cmds)
+    {
+        // Set model matrix as the nodes model to world matrix
+        stateGL->modelMatrix = cmd.wm;
+
+        cmd.node->drawMesh(sv);
+
+        // Count the applied and the saved material activations
+        SLMaterial* mat = cmd.mesh->mat();
+
+        if (mat == lastMat)
+            _stats.numMaterialChangesSaved++;
+        else
+            _stats.numMaterialChanges++;
+
+        lastMat = mat;
+        _stats.numCommands++;
+    }
+
+    stateGL->keepVertexArrayBound(false);
+    stateGL->bindVertexArray(0);
+
+    _stats.numProgramChanges      = stateGL->numProgramChanges() - programChanges;
+    _stats.numProgramChangesSaved = stateGL->numProgramChangesSaved() - programChangesSaved;
+    _stats.numVAOBinds            = stateGL->numVAOBinds() - vaoBinds;
+    _stats.numVAOBindsSaved       = stateGL->numVAOBindsSaved() - vaoBindsSaved;
+
+    _isReplaying = false;
+    _lastProgram = nullptr;
+    _cmds.clear();
+    _matIndices.clear();
+
+    GET_GL_ERROR;
+}
+//-----------------------------------------------------------------------------
+/*! Passes the model, view and projection matrix to the shader program during
+ a replay. The view and projection matrix are constant during a replay and
+ need to be passed only once after a program change. The model matrix is only
+ passed if it differs from the last passed one. All other programs that are
+ used during a replay (e.g. for edges or normals) pass their own uniforms.
+ */
+void SLGLDrawList::passMatrices(SLGLProgram* sp)
+{
+    SLGLState* stateGL = SLGLState::instance();
+
+    if (sp != _lastProgram)
+    {
+        sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&stateGL->modelMatrix);
+        sp->uniformMatrix4fv("u_vMatrix", 1, (SLfloat*)&stateGL->viewMatrix);
+        sp->uniformMatrix4fv("u_pMatrix", 1, (SLfloat*)&stateGL->projectionMatrix);
+        _lastProgram = sp;
+        _lastMMatrix = stateGL->modelMatrix;
+        return;
+    }
+
+    _stats.numUniformsSaved += 2;
+
+    if (memcmp(&_lastMMatrix, &stateGL->modelMatrix, sizeof(SLMat4f)) == 0)
+        _stats.numUniformsSaved++;
+    else
+    {
+        sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&stateGL->modelMatrix);
+        _lastMMatrix = stateGL->modelMatrix;
+    }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+//#############################################################################
+//  File:      SLGLDrawList.h
+//  Purpose:   Recorded and state sorted list of mesh draw commands
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLGLDRAWLIST_H
+#define SLGLDRAWLIST_H
+
+#include <map>
+#include <SLNode.h>
+
+class SLMesh;
+class SLMaterial;
+class SLGLProgram;
+class SLSceneView;
+
+//-----------------------------------------------------------------------------
+//! One recorded mesh draw command of an SLGLDrawList
+struct SLGLDrawCmd
+{
+    SLuint64 sortKey; //!< Sort key: program, texture, material, state, VAO
+    SLNode*  node;    //!< Node that draws the mesh
+    SLMesh*  mesh;    //!< Mesh of the node
+    SLMat4f  wm;      //!< World matrix of the node at record time
+};
+typedef vector<SLGLDrawCmd> SLVGLDrawCmd;
+//-----------------------------------------------------------------------------
+//! Statistic counters of the last SLGLDrawList::draw call
+struct SLGLDrawListStats
+{
+    SLuint numCommands;             //!< NO. of replayed draw commands
+    SLuint numProgramChanges;       //!< NO. of glUseProgram calls
+    SLuint numProgramChangesSaved;  //!< NO. of avoided glUseProgram calls
+    SLuint numMaterialChanges;      //!< NO. of material activations
+    SLuint numMaterialChangesSaved; //!< NO. of avoided material activations
+    SLuint numVAOBinds;             //!< NO. of glBindVertexArray calls
+    SLuint numVAOBindsSaved;        //!< NO. of avoided glBindVertexArray calls
+    SLuint numUniformsSaved;        //!< NO. of avoided matrix uniform uploads
+
+    //! Resets all counters to zero
+    void clear()
+    {
+        numCommands             = 0;
+        numProgramChanges       = 0;
+        numProgramChangesSaved  = 0;
+        numMaterialChanges      = 0;
+        numMaterialChangesSaved = 0;
+        numVAOBinds             = 0;
+        numVAOBindsSaved        = 0;
+        numUniformsSaved        = 0;
+    }
+};
+//-----------------------------------------------------------------------------
+//! Recorded and state sorted list of opaque mesh draw commands
+/*!
+ Instead of drawing the visible nodes directly as they are collected per
+ material, SLSceneView::draw3DGLAll can record all opaque meshes into an
+ SLGLDrawList. Every command gets a 64 bit sort key built from the shader
+ program, the first diffuse texture, the material, the render state and the
+ vertex array object. After sorting by this key the commands are replayed with
+ SLGLDrawList::draw so that equal states follow each other.\n
+ During the replay redundant state changes are eliminated:
+ - Material activations are skipped by SLMaterial::activate if the material
+ of the previous command is the same.
+ - Shader program switches are skipped by SLGLState::useProgram.
+ - The view and projection matrix uniforms are only passed once per program
+ and the model matrix only if it differs (see SLGLDrawList::passMatrices).
+ - Vertex array objects stay bound between commands (see
+ SLGLState::keepVertexArrayBound) and are only rebound if they differ.\n
+ The counters of the saved state changes of the last replay are available in
+ SLGLDrawList::stats.
+ */
+class SLGLDrawList
+{
+public:
+    SLGLDrawList() { clear(); }
+
+    void clear();
+    void add(SLNode* node);
+    void addNodes(SLVNode& nodes);
+    void sort();
+    void draw(SLSceneView* sv);
+    void passMatrices(SLGLProgram* sp);
+
+    // Getters
+    SLbool                   isReplaying() const { return _isReplaying; }
+    SLuint                   size() const { return (SLuint)_cmds.size(); }
+    const SLGLDrawListStats& stats() const { return _stats; }
+
+    static SLuint64 buildSortKey(SLMesh* mesh,
+                                 SLNode* node,
+                                 SLuint  materialIndex);
+
+private:
+    SLVGLDrawCmd                  _cmds;        //!< Recorded draw commands
+    std::map<SLMaterial*, SLuint> _matIndices;  //!< Material index per record pass
+    SLGLDrawListStats             _stats;       //!< Counters of the last replay
+    SLbool                        _isReplaying; //!< Flag if draw is in progress
+    SLGLProgram*                  _lastProgram; //!< Program with passed view & projection
+    SLMat4f                       _lastMMatrix; //!< Last passed model matrix
+};
+//-----------------------------------------------------------------------------
+#endif // SLGLDRAWLIST_H
@@ -240,7 +240,7 @@ void SLGLImGui::createOpenGLObjects()
     glGenBuffers(1, &_elementsHandle);
 
     glGenVertexArrays(1, &_vaoHandle);
-    glBindVertexArray(_vaoHandle);
+    state->bindVertexArray(_vaoHandle);
     glBindBuffer(GL_ARRAY_BUFFER, _vboHandle);
     glEnableVertexAttribArray((SLuint)_attribLocPosition);
     glEnableVertexAttribArray((SLuint)_attribLocUV);
@@ -302,7 +302,7 @@ void SLGLImGui::createOpenGLObjects()
     // Restore modified GL state
     glBindTexture(GL_TEXTURE_2D, (SLuint)last_texture);
     glBindBuffer(GL_ARRAY_BUFFER, (SLuint)last_array_buffer);
-    glBindVertexArray((SLuint)last_vertex_array);
+    state->bindVertexArray((SLuint)last_vertex_array);
 
     GET_GL_ERROR;
 }
@@ -311,7 +311,10 @@ void SLGLImGui::createOpenGLObjects()
 void SLGLImGui::deleteOpenGLObjects()
 {
     if (_vaoHandle)
+    {
         glDeleteVertexArrays(1, &_vaoHandle);
+        SLGLState::vertexArrayDeleted(_vaoHandle);
+    }
     _vaoHandle = 0;
 
     if (_vboHandle)
@@ -499,7 +502,8 @@ void SLGLImGui::onPaint(const SLRecti& viewportRect)
     glUseProgram((SLuint)_progHandle);
     glUniform1i(_attribLocTex, 0);
     glUniformMatrix4fv(_attribLocProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
-    glBindVertexArray((SLuint)_vaoHandle);
+    SLGLState* stateGL = SLGLState::instance();
+    stateGL->bindVertexArray((SLuint)_vaoHandle);
 
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
@@ -553,7 +557,7 @@ void SLGLImGui::onPaint(const SLRecti& viewportRect)
     glUseProgram((SLuint)last_program);
     glBindTexture(GL_TEXTURE_2D, (SLuint)last_texture);
     glActiveTexture((SLuint)last_active_texture);
-    glBindVertexArray((SLuint)last_vertex_array);
+    stateGL->bindVertexArray((SLuint)last_vertex_array);
     glBindBuffer(GL_ARRAY_BUFFER, (SLuint)last_array_buffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, (SLuint)last_element_array_buffer);
     glBlendEquationSeparate((SLuint)last_blend_equation_rgb,
@@ -44,8 +44,9 @@ SLGLProgram::SLGLProgram(SLAssetManager* am,
                          const string&   geomShaderFile,
                          const string&   programName) : SLObject(programName)
 {
-    _isLinked = false;
-    _progID   = 0;
+    _isLinked    = false;
+    _progID      = 0;
+    _vertCompact = -1;
 
     // optional load vertex and/or fragment shaders
     addShader(new SLGLShader(vertShaderFile, ST_vertex));
@@ -199,7 +200,8 @@ void SLGLProgram::initTF(const char* writeBackAttrib[], int size)
 
     if (linked)
     {
-        _isLinked = true;
+        _isLinked    = true;
+        _vertCompact = -1;
 
         // if name is empty concatenate shader names
         if (_name.empty())
@@ -294,7 +296,8 @@ void SLGLProgram::init(SLVLight* lights)
 
     if (linked)
     {
-        _isLinked = true;
+        _isLinked    = true;
+        _vertCompact = -1;
 
         // if name is empty concatenate shader names
         if (_name.empty())
@@ -622,6 +625,20 @@ SLint SLGLProgram::uniform4f(const SLchar* name,
     return loc;
 }
 //-----------------------------------------------------------------------------
+/*! Passes the vertex format flag to the uniform u_vertCompact if it differs
+ from the last one passed to this program. The meshes with the compact vertex
+ format are often drawn in a row, so most draw calls skip the uniform.
+ */
+void SLGLProgram::vertCompact(SLbool isCompact)
+{
+    SLint value = isCompact ? 1 : 0;
+    if (value == _vertCompact)
+        return;
+
+    uniform1i("u_vertCompact", value);
+    _vertCompact = value;
+}
+//-----------------------------------------------------------------------------
 //! Passes the int values v0 to the uniform variable "name"
 SLint SLGLProgram::uniform1i(const SLchar* name, SLint v0) const
 {
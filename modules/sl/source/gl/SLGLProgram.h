@@ -110,6 +110,8 @@ public:
     SLint uniform4fv(const SLchar* name, SLsizei count, const SLfloat* value) const;
 
     SLint uniform1iv(const SLchar* name, SLsizei count, const SLint* value) const;
+
+    void vertCompact(SLbool isCompact);
     SLint uniform2iv(const SLchar* name, SLsizei count, const SLint* value) const;
     SLint uniform3iv(const SLchar* name, SLsizei count, const SLint* value) const;
     SLint uniform4iv(const SLchar* name, GLsizei count, const SLint* value) const;
@@ -140,11 +142,12 @@ public:
                            GLboolean      transpose = false) const;
 
 protected:
-    SLuint       _progID;     //!< OpenGL shader program object ID
-    SLbool       _isLinked;   //!< Flag if program is linked
-    SLVGLShader  _shaders;    //!< Vector of all shader objects
-    SLVUniform1f _uniforms1f; //!< Vector of uniform1f variables
-    SLVUniform1i _uniforms1i; //!< Vector of uniform1i variables
+    SLuint       _progID;      //!< OpenGL shader program object ID
+    SLbool       _isLinked;    //!< Flag if program is linked
+    SLVGLShader  _shaders;     //!< Vector of all shader objects
+    SLVUniform1f _uniforms1f;  //!< Vector of uniform1f variables
+    SLVUniform1i _uniforms1i;  //!< Vector of uniform1i variables
+    SLint        _vertCompact; //!< Last value passed to u_vertCompact (-1 = none since linking)
 };
 //-----------------------------------------------------------------------------
 //! STL vector of SLGLProgram pointers
@@ -56,6 +56,11 @@ const string vertInput_u_matrices_all = R"(
 uniform mat4  u_mMatrix;    // Model matrix (object to world transform)
 uniform mat4  u_vMatrix;    // View matrix (world to camera transform)
 uniform mat4  u_pMatrix;    // Projection matrix (camera to normalize device coords.))";
+const string vertInput_u_vertDecode   = R"(
+
+uniform bool  u_vertCompact;    // Flag for compact quantized vertex attributes
+uniform vec3  u_vertPosMin;     // Min. corner of the quantized positions
+uniform vec3  u_vertPosSize;    // Size of the quantized positions)";
 const string vertInput_u_matrix_vOmv  = R"(
 uniform mat4  u_vOmvMatrix;         // view or modelview matrix)";
 //-----------------------------------------------------------------------------
@@ -129,6 +134,17 @@ vec3 colorByAge(float age)
     return color;
 })";
 
+const string vertFunction_octDecode = R"(
+
+vec3 octDecode(vec2 e)
+{
+    // Decodes an octahedral encoded unit vector (see SLGLVertexBuffer::octEncode)
+    vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0,
+                                         v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+})";
 //-----------------------------------------------------------------------------
 const string vertOutput_PS_struct_Begin  = R"(
 
@@ -170,15 +186,29 @@ const string vertMain_Begin              = R"(
 
 void main()
 {)";
+const string vertMain_decode_PN          = R"(
+    vec4 P_OS = a_position;
+    vec3 N_OS = a_normal;
+    if (u_vertCompact)
+    {   // Decode the compact vertex format (see SLMesh::compactVertices)
+        P_OS = vec4(u_vertPosMin + a_position.xyz * u_vertPosSize, 1.0);
+        N_OS = octDecode(a_normal.xy);
+    }
+)";
+const string vertMain_decode_T           = R"(
+    vec4 T_OS = a_tangent;
+    if (u_vertCompact)
+        T_OS = vec4(octDecode(a_tangent.xy), a_tangent.z);
+)";
 const string vertMain_v_P_VS             = R"(
     mat4 mvMatrix = u_vMatrix * u_mMatrix;
-    v_P_VS = vec3(mvMatrix *  a_position);   // vertex position in view space)";
+    v_P_VS = vec3(mvMatrix *  P_OS);         // vertex position in view space)";
 const string vertMain_v_P_WS_Sm          = R"(
-    v_P_WS = vec3(u_mMatrix * a_position);   // vertex position in world space)";
+    v_P_WS = vec3(u_mMatrix * P_OS);         // vertex position in world space)";
 const string vertMain_v_N_VS             = R"(
     mat3 invMvMatrix = mat3(inverse(mvMatrix));
     mat3 nMatrix = transpose(invMvMatrix);
-    v_N_VS = vec3(nMatrix * a_normal);       // vertex normal in view space)";
+    v_N_VS = vec3(nMatrix * N_OS);           // vertex normal in view space)";
 const string vertMain_v_R_OS             = R"(
     vec3 I = normalize(v_P_VS);
     vec3 N = normalize(v_N_VS);
@@ -192,9 +222,9 @@ const string vertMain_TBN_Nm             = R"(
 
     // Building the matrix Eye Space -> Tangent Space
     // See the math behind at: http://www.terathon.com/code/tangent.html
-    vec3 n = normalize(nMatrix * a_normal);
-    vec3 t = normalize(nMatrix * a_tangent.xyz);
-    vec3 b = cross(n, t) * a_tangent.w; // bitangent w. corrected handedness
+    vec3 n = normalize(nMatrix * N_OS);
+    vec3 t = normalize(nMatrix * T_OS.xyz);
+    vec3 b = cross(n, t) * T_OS.w; // bitangent w. corrected handedness
     mat3 TBN = mat3(t,b,n);
 
     // Transform vector to the eye into tangent space
@@ -264,7 +294,7 @@ const string vertMain_PS_EndAll_VertBillboard = R"(
 const string vertMain_EndAll = R"(
 
     // pass the vertex w. the fix-function transform
-    gl_Position = u_pMatrix * mvMatrix * a_position;
+    gl_Position = u_pMatrix * mvMatrix * P_OS;
 }
 )";
 //-----------------------------------------------------------------------------
@@ -1782,6 +1812,7 @@ void SLGLProgramGenerated::buildPerPixCook(SLMaterial* mat, SLVLight* lights)
     if (uv0) vertCode += vertInput_a_uv0;
     if (Nm) vertCode += vertInput_a_tangent;
     vertCode += vertInput_u_matrices_all;
+    vertCode += vertInput_u_vertDecode;
     // if (sky) vertCode += vertInput_u_matrix_invMv;
     if (Nm) vertCode += vertInput_u_lightNm;
 
@@ -1793,8 +1824,13 @@ void SLGLProgramGenerated::buildPerPixCook(SLMaterial* mat, SLVLight* lights)
     if (uv0) vertCode += vertOutput_v_uv0;
     if (Nm) vertCode += vertOutput_v_lightVecTS;
 
+    // Vertex shader functions
+    vertCode += vertFunction_octDecode;
+
     // Vertex shader main loop
     vertCode += vertMain_Begin;
+    vertCode += vertMain_decode_PN;
+    if (Nm) vertCode += vertMain_decode_T;
     vertCode += vertMain_v_P_VS;
     if (Sm) vertCode += vertMain_v_P_WS_Sm;
     vertCode += vertMain_v_N_VS;
@@ -1897,6 +1933,7 @@ void SLGLProgramGenerated::buildPerPixBlinn(SLMaterial* mat, SLVLight* lights)
     if (uv1) vertCode += vertInput_a_uv1;
     if (Nm) vertCode += vertInput_a_tangent;
     vertCode += vertInput_u_matrices_all;
+    vertCode += vertInput_u_vertDecode;
     if (Nm) vertCode += vertInput_u_lightNm;
 
     // Vertex shader outputs
@@ -1907,8 +1944,13 @@ void SLGLProgramGenerated::buildPerPixBlinn(SLMaterial* mat, SLVLight* lights)
     if (uv1) vertCode += vertOutput_v_uv1;
     if (Nm) vertCode += vertOutput_v_lightVecTS;
 
+    // Vertex shader functions
+    vertCode += vertFunction_octDecode;
+
     // Vertex shader main loop
     vertCode += vertMain_Begin;
+    vertCode += vertMain_decode_PN;
+    if (Nm) vertCode += vertMain_decode_T;
     vertCode += vertMain_v_P_VS;
     if (Sm) vertCode += vertMain_v_P_WS_Sm;
     vertCode += vertMain_v_N_VS;
@@ -2219,10 +2261,13 @@ void SLGLProgramGenerated::buildPerPixVideoBkgdSm(SLVLight* lights)
     vertCode += shaderHeader((int)lights->size());
     vertCode += vertInput_a_pn;
     vertCode += vertInput_u_matrices_all;
+    vertCode += vertInput_u_vertDecode;
     vertCode += vertOutput_v_P_VS;
     vertCode += vertOutput_v_P_WS;
     vertCode += vertOutput_v_N_VS;
+    vertCode += vertFunction_octDecode;
     vertCode += vertMain_Begin;
+    vertCode += vertMain_decode_PN;
     vertCode += vertMain_v_P_VS;
     vertCode += vertMain_v_P_WS_Sm;
     vertCode += vertMain_v_N_VS;
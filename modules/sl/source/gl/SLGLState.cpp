@@ -84,11 +84,17 @@ void SLGLState::initAll()
     _clearColor.set(-1, -1, -1, -1);
 
     // Reset all cached states to an invalid state
-    _programID     = 0;
-    _colorMaskR    = -1;
-    _colorMaskG    = -1;
-    _colorMaskB    = -1;
-    _colorMaskA    = -1;
+    _programID              = 0;
+    _vaoID                  = 0;
+    _keepVAOBound           = false;
+    _numProgramChanges      = 0;
+    _numProgramChangesSaved = 0;
+    _numVAOBinds            = 0;
+    _numVAOBindsSaved       = 0;
+    _colorMaskR             = -1;
+    _colorMaskG             = -1;
+    _colorMaskB             = -1;
+    _colorMaskA             = -1;
 
     _isInitialized = true;
 
@@ -398,9 +404,12 @@ void SLGLState::useProgram(SLuint progID)
     {
         glUseProgram(progID);
         _programID = progID;
+        _numProgramChanges++;
 
         GET_GL_ERROR;
     }
+    else
+        _numProgramChangesSaved++;
 }
 //-----------------------------------------------------------------------------
 /*! SLGLState::bindTexture sets the current active texture.
@@ -445,6 +454,27 @@ void SLGLState::activeTexture(SLenum textureUnit)
     }
 }
 //-----------------------------------------------------------------------------
+/*! SLGLState::bindVertexArray binds a vertex array object but only if it
+ differs from the current one. All VAO binds of SLGLVertexArray go through this
+ method so that the cached id stays valid. Code outside of SL that binds VAOs
+ directly with glBindVertexArray must restore the previous binding afterwards.
+ The counters numVAOBinds and numVAOBindsSaved count the GL calls that were
+ made and avoided since the initialization of the state.
+ */
+void SLGLState::bindVertexArray(SLuint vaoID)
+{
+    if (_vaoID != vaoID)
+    {
+        glBindVertexArray(vaoID);
+        _vaoID = vaoID;
+        _numVAOBinds++;
+
+        GET_GL_ERROR;
+    }
+    else
+        _numVAOBindsSaved++;
+}
+//-----------------------------------------------------------------------------
 /*! SLGLState::unbindAnythingAndFlush unbinds all shaderprograms and buffers in
  use and calls glFinish. This should be the last call to GL before buffer
  swapping.
@@ -452,6 +482,7 @@ void SLGLState::activeTexture(SLenum textureUnit)
 void SLGLState::unbindAnythingAndFlush()
 {
     useProgram(0);
+    bindVertexArray(0);
 
     // reset the bound texture unit
     // This is needed since leaving one texture unit bound over multiple windows
@@ -113,6 +113,8 @@ public:
     void useProgram(SLuint progID);
     void bindTexture(SLenum target, SLuint textureID);
     void activeTexture(SLenum textureUnit);
+    void bindVertexArray(SLuint vaoID);
+    void keepVertexArrayBound(SLbool keep) { _keepVAOBound = keep; }
     void clearColor(const SLCol4f& c);
     void currentMaterial(SLMaterial* mat) { _currentMaterial = mat; }
     void clearColorBuffer() { glClear(GL_COLOR_BUFFER_BIT); }
@@ -121,6 +123,11 @@ public:
 
     // state getters
     SLbool   blend() const { return _blend; }
+    SLbool   keepVertexArrayBound() const { return _keepVAOBound; }
+    SLuint   numProgramChanges() const { return _numProgramChanges; }
+    SLuint   numProgramChangesSaved() const { return _numProgramChangesSaved; }
+    SLuint   numVAOBinds() const { return _numVAOBinds; }
+    SLuint   numVAOBindsSaved() const { return _numVAOBindsSaved; }
     SLstring glVersion() { return _glVersion; }
     SLstring glVersionNO() { return _glVersionNO; }
     SLfloat  glVersionNOf() const { return _glVersionNOf; }
@@ -145,6 +152,13 @@ public:
     }
     SLMaterial* currentMaterial() { return _currentMaterial; }
 
+    //! Resets the cached VAO id because OpenGL unbinds a deleted bound VAO
+    static void vertexArrayDeleted(SLuint vaoID)
+    {
+        if (_instance && _instance->_vaoID == vaoID)
+            _instance->_vaoID = 0;
+    }
+
     //! Checks if an OpenGL error occurred
     static void getGLError(const char* file, int line, bool quit);
 
@@ -188,14 +202,20 @@ private:
     SLCol4f _clearColor;                //!< clear color
 
     // states
-    SLuint    _programID;     //!< current shader program id
-    SLenum    _textureUnit;   //!< current texture unit
-    SLenum    _textureTarget; //!< current texture target
-    SLuint    _textureID;     //!< current texture id
-    GLboolean _colorMaskR;    //!< current color mask for R
-    GLboolean _colorMaskG;    //!< current color mask for G
-    GLboolean _colorMaskB;    //!< current color mask for B
-    GLboolean _colorMaskA;    //!< current color mask for A
+    SLuint    _programID;              //!< current shader program id
+    SLenum    _textureUnit;            //!< current texture unit
+    SLenum    _textureTarget;          //!< current texture target
+    SLuint    _textureID;              //!< current texture id
+    SLuint    _vaoID;                  //!< current vertex array object id
+    SLbool    _keepVAOBound;           //!< Flag if VAOs stay bound after drawing
+    SLuint    _numProgramChanges;      //!< NO. of glUseProgram calls made
+    SLuint    _numProgramChangesSaved; //!< NO. of glUseProgram calls avoided
+    SLuint    _numVAOBinds;            //!< NO. of glBindVertexArray calls made
+    SLuint    _numVAOBindsSaved;       //!< NO. of glBindVertexArray calls avoided
+    GLboolean _colorMaskR;             //!< current color mask for R
+    GLboolean _colorMaskG;             //!< current color mask for G
+    GLboolean _colorMaskB;             //!< current color mask for B
+    GLboolean _colorMaskA;             //!< current color mask for A
 
     SLVstring errors; //!< vector for errors collected in getGLError
 
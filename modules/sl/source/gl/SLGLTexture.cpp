@@ -600,6 +600,8 @@ void SLGLTexture::load(const SLVCol4f& colors)
 @param data Pointer to the first byte of the first pixel
 @param isContinuous Flag if the next line comes after the last byte of the prev. line
 @param isTopLeft Flag if the data pointer points to the top left pixel
+@param srcBytesPerLine Stride of the source in bytes (e.g. CVMat::step of a
+cropped ROI). If 0 the stride is derived from camWidth and isContinuous.
 @return Returns true if the texture was rebuilt
 It is important that passed pixel format is either PF_LUMINANCE, RGB or RGBA.
 otherwise an expensive conversion must be done.
@@ -609,7 +611,8 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                    CVPixelFormatGL srcFormat,
                                    SLuchar*        data,
                                    SLbool          isContinuous,
-                                   SLbool          isTopLeft)
+                                   SLbool          isTopLeft,
+                                   SLuint          srcBytesPerLine)
 {
     PROFILE_FUNCTION();
 
@@ -627,7 +630,8 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                        PF_rgb,
                                        data,
                                        isContinuous,
-                                       isTopLeft);
+                                       isTopLeft,
+                                       srcBytesPerLine);
 
     if (!_images.empty())
     {
@@ -659,7 +663,8 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                    CVPixelFormatGL dstFormat,
                                    SLuchar*        data,
                                    SLbool          isContinuous,
-                                   SLbool          isTopLeft)
+                                   SLbool          isTopLeft,
+                                   SLuint          srcBytesPerLine)
 {
     PROFILE_FUNCTION();
 
@@ -677,7 +682,8 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                        dstFormat,
                                        data,
                                        isContinuous,
-                                       isTopLeft);
+                                       isTopLeft,
+                                       srcBytesPerLine);
     if (!_images.empty())
     {
         _width         = _images[0]->width();
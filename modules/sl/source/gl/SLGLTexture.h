@@ -236,7 +236,8 @@ public:
                           CVPixelFormatGL glFormat,
                           SLuchar*    data,
                           SLbool      isContinuous,
-                          SLbool      isTopLeft);
+                          SLbool      isTopLeft,
+                          SLuint      srcBytesPerLine = 0);
 
     SLbool copyVideoImage(SLint       camWidth,
                           SLint       camHeight,
@@ -244,7 +245,8 @@ public:
                           CVPixelFormatGL dstFormat,
                           SLuchar*    data,
                           SLbool      isContinuous,
-                          SLbool      isTopLeft);
+                          SLbool      isTopLeft,
+                          SLuint      srcBytesPerLine = 0);
 
     void calc3DGradients(SLint sampleRadius, const function<void(int)>& onUpdateProgress);
     void smooth3DGradients(SLint smoothRadius, function<void(int)> onUpdateProgress);
@@ -91,10 +91,12 @@ SLGLTextureIBL::~SLGLTextureIBL()
     deleteData();
 
     glDeleteVertexArrays(1, &_cubeVAO);
+    SLGLState::vertexArrayDeleted(_cubeVAO);
     _cubeVAO = 0;
     glDeleteBuffers(1, &_cubeVBO);
     _cubeVBO = 0;
     glDeleteVertexArrays(1, &_quadVAO);
+    SLGLState::vertexArrayDeleted(_quadVAO);
     _quadVAO = 0;
     glDeleteBuffers(1, &_quadVBO);
     _quadVBO = 0;
@@ -350,6 +352,8 @@ void SLGLTextureIBL::build(SLint texUnit)
 //! Renders 2x2 cube, used to project a texture to a cube texture with 6 sides
 void SLGLTextureIBL::renderCube()
 {
+    SLGLState* stateGL = SLGLState::instance();
+
     // initialize (if necessary)
     if (_cubeVAO == 0)
     {
@@ -413,22 +417,24 @@ void SLGLTextureIBL::renderCube()
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
         // link vertex attributes
-        glBindVertexArray(_cubeVAO);
+        stateGL->bindVertexArray(_cubeVAO);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+        stateGL->bindVertexArray(0);
     }
 
     // render inwards facing cube with face culling enabled
-    glBindVertexArray(_cubeVAO);
+    stateGL->bindVertexArray(_cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+    stateGL->bindVertexArray(0);
 }
 //-----------------------------------------------------------------------------
 //! Renders a 2x2 XY quad, used for rendering and capturing the BRDF integral
 void SLGLTextureIBL::renderQuad()
 {
+    SLGLState* stateGL = SLGLState::instance();
+
     if (_quadVAO == 0)
     {
         // clang-format off
@@ -445,7 +451,7 @@ void SLGLTextureIBL::renderQuad()
         // setup plane VAO
         glGenVertexArrays(1, &_quadVAO);
         glGenBuffers(1, &_quadVBO);
-        glBindVertexArray(_quadVAO);
+        stateGL->bindVertexArray(_quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, _quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -455,9 +461,9 @@ void SLGLTextureIBL::renderQuad()
     }
 
     // Render quad
-    glBindVertexArray(_quadVAO);
+    stateGL->bindVertexArray(_quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    stateGL->bindVertexArray(0);
 }
 //-----------------------------------------------------------------------------
 //! Reads back the pixels into an image
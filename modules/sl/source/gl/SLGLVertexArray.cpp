@@ -37,7 +37,10 @@ The vector _attribs with the attribute information is not cleared.
 void SLGLVertexArray::deleteGL()
 {
     if (_vaoID)
+    {
         glDeleteVertexArrays(1, &_vaoID);
+        SLGLState::vertexArrayDeleted(_vaoID);
+    }
     _vaoID = 0;
 
     if (_VBOf.id())
@@ -60,12 +63,16 @@ will be interpreted as an interleaved array. See example in SLGLOculus::init.
 Be aware that the VBO for the attribute will not be generated until generate
 is called. The data pointer must still be valid when SLGLVertexArray::generate
 is called.
+Integer attributes (e.g. the compact vertex format of SLMesh) can be passed
+with normalized set to true so that the shader gets them as floats in the
+range [0,1] for unsigned and [-1,1] for signed types.
 */
 void SLGLVertexArray::setAttrib(SLGLAttributeType type,
                                 SLint             elementSize,
                                 SLint             location,
                                 void*             dataPointer,
-                                SLGLBufferType    dataType)
+                                SLGLBufferType    dataType,
+                                SLbool            normalized)
 {
     assert(dataPointer);
     assert(elementSize);
@@ -80,6 +87,7 @@ void SLGLVertexArray::setAttrib(SLGLAttributeType type,
     va.type            = type;
     va.elementSize     = elementSize;
     va.dataType        = dataType;
+    va.normalized      = normalized;
     va.dataPointer     = dataPointer;
     va.location        = location;
     va.bufferSizeBytes = 0;
@@ -131,13 +139,13 @@ void SLGLVertexArray::updateAttrib(SLGLAttributeType type,
 
     if (!_vaoID)
         glGenVertexArrays(1, &_vaoID);
-    glBindVertexArray(_vaoID);
+    SLGLState::instance()->bindVertexArray(_vaoID);
 
     // update the appropriate VBO
     if (indexf > -1)
         _VBOf.updateAttrib(type, elementSize, dataPointer);
 
-    glBindVertexArray(0);
+    SLGLState::instance()->bindVertexArray(0);
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
@@ -185,7 +193,7 @@ void SLGLVertexArray::generate(SLuint          numVertices,
 
     // Generate and bind VAO
     glGenVertexArrays(1, &_vaoID);
-    glBindVertexArray(_vaoID);
+    SLGLState::instance()->bindVertexArray(_vaoID);
 
     ///////////////////////////////
     // Create Vertex Buffer Objects
@@ -233,7 +241,7 @@ void SLGLVertexArray::generate(SLuint          numVertices,
         SLGLVertexBuffer::totalBufferSize += _numIndicesElements * (SLuint)typeSize;
     }
 
-    glBindVertexArray(0);
+    SLGLState::instance()->bindVertexArray(0);
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
@@ -254,7 +262,7 @@ void SLGLVertexArray::generateTF(SLuint          numVertices,
 
     // Generate and bind VAO
     glGenVertexArrays(1, &_vaoID);
-    glBindVertexArray(_vaoID);
+    SLGLState::instance()->bindVertexArray(_vaoID);
 
     ///////////////////////////////
     // Create Vertex Buffer Objects
@@ -309,7 +317,7 @@ void SLGLVertexArray::generateTF(SLuint          numVertices,
         SLGLVertexBuffer::totalBufferSize += _numIndicesElements * (SLuint)typeSize;
     }
 
-    glBindVertexArray(0);
+    SLGLState::instance()->bindVertexArray(0);
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
@@ -355,7 +363,9 @@ void SLGLVertexArray::drawElementsAs(SLGLPrimitiveType primitiveType,
 
     // From OpenGL 3.0 on we have the OpenGL Vertex Arrays
     // Binding the VAO saves all the commands after the else (per draw call!)
-    glBindVertexArray(_vaoID);
+    // The bind is skipped if the VAO is still bound from the last draw call.
+    SLGLState* stateGL = SLGLState::instance();
+    stateGL->bindVertexArray(_vaoID);
     GET_GL_ERROR;
 
     // Do the draw call with indices
@@ -387,7 +397,8 @@ void SLGLVertexArray::drawElementsAs(SLGLPrimitiveType primitiveType,
         default: break;
     }
 
-    glBindVertexArray(0);
+    if (!stateGL->keepVertexArrayBound())
+        stateGL->bindVertexArray(0);
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
@@ -400,7 +411,8 @@ void SLGLVertexArray::drawArrayAs(SLGLPrimitiveType primitiveType,
 {
     assert((_VBOf.id()) && "No VBO generated for VAO.");
 
-    glBindVertexArray(_vaoID);
+    SLGLState* stateGL = SLGLState::instance();
+    stateGL->bindVertexArray(_vaoID);
 
     if (countVertices == 0)
         countVertices = (SLsizei)_numVertices;
@@ -426,7 +438,8 @@ void SLGLVertexArray::drawArrayAs(SLGLPrimitiveType primitiveType,
         default: break;
     }
 
-    glBindVertexArray(0);
+    if (!stateGL->keepVertexArrayBound())
+        stateGL->bindVertexArray(0);
 
     GET_GL_ERROR;
 }
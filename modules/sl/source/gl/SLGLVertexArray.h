@@ -22,7 +22,8 @@
  VBO of type SLGLVertexBuffer.\n
  VAOs where introduces OpenGL 3.0 and reduce the overhead per draw call.
  All vertex attributes (e.g. position, normals, texture coords, etc.) must be
- float at the input. All float attributes will be in one VBO (_VBOf).
+ float, half float or normalized integers at the input. All attributes will be
+ in one VBO (_VBOf).
  Vertices can be drawn either directly as in the array (SLGLVertexArray::drawArrayAs)
  or by element (SLGLVertexArray::drawElementsAs) with a separate indices buffer.\n
  The setup of a VAO has multiple steps:\n
@@ -63,7 +64,8 @@ public:
                    SLint             elementSize,
                    SLint             location,
                    void*             dataPointer,
-                   SLGLBufferType    dataType = BT_float);
+                   SLGLBufferType    dataType   = BT_float,
+                   SLbool            normalized = false);
 
     //! Adds a vertex attribute with vector of SLuint
     void setAttrib(SLGLAttributeType type,
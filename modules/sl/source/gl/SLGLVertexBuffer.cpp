@@ -212,7 +212,7 @@ void SLGLVertexBuffer::generate(SLuint          numVertices,
                     glVertexAttribPointer((SLuint)a.location,
                                           a.elementSize,
                                           a.dataType,
-                                          GL_FALSE,
+                                          a.normalized ? GL_TRUE : GL_FALSE,
                                           (SLint)_strideBytes,
                                           (void*)(size_t)a.offsetBytes);
                 }
@@ -260,7 +260,7 @@ void SLGLVertexBuffer::generate(SLuint          numVertices,
                         glVertexAttribPointer((SLuint)a.location,
                                               a.elementSize,
                                               a.dataType,
-                                              GL_FALSE,
+                                              a.normalized ? GL_TRUE : GL_FALSE,
                                               (SLint)_strideBytes,
                                               (void*)(size_t)a.offsetBytes);
                     }
@@ -302,7 +302,7 @@ void SLGLVertexBuffer::generate(SLuint          numVertices,
                         glVertexAttribPointer((SLuint)a.location,
                                               a.elementSize,
                                               a.dataType,
-                                              GL_FALSE,
+                                              a.normalized ? GL_TRUE : GL_FALSE,
                                               0,
                                               (void*)(size_t)a.offsetBytes);
                     }
@@ -337,7 +337,7 @@ void SLGLVertexBuffer::bindAndEnableAttrib()
                 glVertexAttribPointer((SLuint)a.location,
                                       a.elementSize,
                                       a.dataType,
-                                      GL_FALSE,
+                                      a.normalized ? GL_TRUE : GL_FALSE,
                                       (SLsizei)_strideBytes,
                                       (void*)(size_t)a.offsetBytes);
 
@@ -368,6 +368,8 @@ SLuint SLGLVertexBuffer::sizeOfType(SLGLBufferType type)
     switch (type)
     {
         case BT_float: return sizeof(float);
+        case BT_half: return sizeof(unsigned short);
+        case BT_short: return sizeof(short);
         case BT_ubyte: return sizeof(unsigned char);
         case BT_ushort: return sizeof(unsigned short);
         case BT_uint: return sizeof(unsigned int);
@@ -376,3 +378,64 @@ SLuint SLGLVertexBuffer::sizeOfType(SLGLBufferType type)
     return 0;
 }
 //-----------------------------------------------------------------------------
+/*! Converts a 32-bit float to a 16-bit half float with rounding to the
+nearest. Values that are too large become infinity and values that are too
+small become zero or denormalized half floats.
+*/
+SLushort SLGLVertexBuffer::floatToHalf(SLfloat f)
+{
+    SLuint x;
+    memcpy(&x, &f, sizeof(SLuint));
+
+    SLuint sign = (x >> 16) & 0x8000;
+    SLint  exp  = (SLint)((x >> 23) & 0xFF) - 127 + 15;
+    SLuint mant = x & 0x007FFFFF;
+
+    // NaN and infinity
+    if (((x >> 23) & 0xFF) == 0xFF)
+        return (SLushort)(sign | 0x7C00 | (mant ? 0x0200 : 0));
+
+    // Overflow to infinity
+    if (exp >= 31)
+        return (SLushort)(sign | 0x7C00);
+
+    // Denormalized half float or zero
+    if (exp <= 0)
+    {
+        if (exp < -10)
+            return (SLushort)sign;
+
+        mant |= 0x00800000;
+        SLuint shift = (SLuint)(14 - exp);
+        SLuint half  = mant >> shift;
+        if ((mant >> (shift - 1)) & 1) half++;
+        return (SLushort)(sign | half);
+    }
+
+    // Normalized half float (a rounding carry correctly increments the exponent)
+    SLuint half = sign | ((SLuint)exp << 10) | (mant >> 13);
+    if (mant & 0x1000) half++;
+    return (SLushort)half;
+}
+//-----------------------------------------------------------------------------
+/*! Encodes a unit vector with the octahedral mapping into 2 components in the
+range [-1,1]. The vector is projected onto the octahedron |x|+|y|+|z|=1 and
+the lower hemisphere gets folded over the diagonals. The decoding is done in
+the vertex shader (see octDecode in SLGLProgramGenerated).
+*/
+SLVec2f SLGLVertexBuffer::octEncode(const SLVec3f& v)
+{
+    SLfloat l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    if (l1 < FLT_EPSILON)
+        return SLVec2f(0, 0);
+
+    SLVec2f e(v.x / l1, v.y / l1);
+    if (v.z < 0.0f)
+    {
+        SLfloat ex = (1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+        SLfloat ey = (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+        e.set(ex, ey);
+    }
+    return e;
+}
+//-----------------------------------------------------------------------------
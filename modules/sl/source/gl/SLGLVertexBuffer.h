@@ -22,7 +22,8 @@ struct SLGLAttribute
 {
     SLGLAttributeType type;            //!< type of vertex attribute
     SLint             elementSize;     //!< size of attribute element (SLVec3f has 3)
-    SLGLBufferType    dataType;       //! Data Type (BT_float, BT_ubyte,...)
+    SLGLBufferType    dataType;        //! Data Type (BT_float, BT_ubyte,...)
+    SLbool            normalized;      //!< Flag if integer data is mapped to [0,1] or [-1,1]
     SLuint            offsetBytes;     //!< offset of the attribute data in the buffer
     SLuint            bufferSizeBytes; //!< size of the attribute part in the buffer
     void*             dataPointer;     //!< pointer to the attributes source data
@@ -107,6 +108,12 @@ public:
     //! Returns the size of a buffer data type
     static SLuint sizeOfType(SLGLBufferType type);
 
+    //! Converts a float to a 16-bit half float
+    static SLushort floatToHalf(SLfloat f);
+
+    //! Encodes a unit vector into 2 components with octahedral mapping
+    static SLVec2f octEncode(const SLVec3f& v);
+
 protected:
     SLuint          _id;                //! OpenGL id of vertex buffer object
     SLuint          _numVertices;       //! NO. of vertices in array
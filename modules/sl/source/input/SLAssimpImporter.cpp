@@ -348,10 +348,13 @@ SLNode* SLAssimpImporter::load(SLAnimManager&     aniMan,                 //!< R
         if (isFaceAnim) 
             mesh = loadFaceMesh(assetMgr, scene->mMeshes[i]);
         else
-            SLMesh* mesh = loadMesh(assetMgr, scene->mMeshes[i]);
+            mesh = loadMesh(assetMgr, scene->mMeshes[i]);
 
         if (mesh != nullptr)
         {
+            if (_optimizeMeshes && !isFaceAnim)
+                mesh->optimize();
+
             if (overrideMat)
                 mesh->mat(overrideMat);
             else
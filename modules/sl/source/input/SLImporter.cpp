@@ -17,6 +17,7 @@
 SLImporter::SLImporter()
   : _logConsoleVerbosity(LV_quiet),
     _logFileVerbosity(LV_quiet),
+    _optimizeMeshes(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
@@ -27,6 +28,7 @@ SLImporter::SLImporter()
 SLImporter::SLImporter(SLLogVerbosity consoleVerb)
   : _logConsoleVerbosity(consoleVerb),
     _logFileVerbosity(LV_quiet),
+    _optimizeMeshes(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
@@ -39,6 +41,7 @@ SLImporter::SLImporter(const SLstring& logFile,
                        SLLogVerbosity  logFileVerb)
   : _logConsoleVerbosity(logConsoleVerb),
     _logFileVerbosity(logFileVerb),
+    _optimizeMeshes(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
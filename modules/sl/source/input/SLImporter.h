@@ -74,6 +74,7 @@ public:
 
     void logConsoleVerbosity(SLLogVerbosity verb) { _logConsoleVerbosity = verb; }
     void logFileVerbosity(SLLogVerbosity verb) { _logFileVerbosity = verb; }
+    void optimizeMeshes(SLbool optimize) { _optimizeMeshes = optimize; }
 
     virtual SLNode* load(SLAnimManager&     aniMan,
                          SLAssetManager*    assetMgr,
@@ -126,6 +127,7 @@ protected:
     SLstring       _logFile;             //!< name of the log file
     SLLogVerbosity _logConsoleVerbosity; //!< verbosity level of log output to the console
     SLLogVerbosity _logFileVerbosity;    //!< verbosity level of log output to the file
+    SLbool         _optimizeMeshes;      //!< flag if the loaded meshes get optimized with SLMesh::optimize
 
     // the imported data for easy access after importing it
     SLNode*         _sceneRoot;      //!< the root node of the scene
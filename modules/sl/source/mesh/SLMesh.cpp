@@ -14,7 +14,9 @@
 #include <SLSceneView.h>
 #include <SLSkybox.h>
 #include <SLMesh.h>
+#include <SLMeshOptimizer.h>
 #include <SLAssetManager.h>
+#include <SLGLProgramGenerated.h>
 #include <Profiler.h>
 
 using std::set;
@@ -56,6 +58,10 @@ SLMesh::SLMesh(SLAssetManager* assetMgr, const SLstring& name) : SLObject(name)
     _edgeWidth              = 2.0f;
     _edgeColor              = SLCol4f::WHITE;
     _vertexPosEpsilon       = 0.001f;
+    _compactVertices        = false;
+    _vaoIsCompact           = false;
+    _doClusterCulling       = true;
+    _numClustersDrawn       = 0;
 
     // Add this mesh to the global resource vector for deallocation
     if (assetMgr)
@@ -91,6 +97,7 @@ void SLMesh::deleteData()
     IS32.clear();
     IE16.clear();
     IE32.clear();
+    _clusters.clear();
 
     _jointMatrices.clear();
     skinnedP.clear();
@@ -215,7 +222,8 @@ void SLMesh::deleteSelected(SLNode* node)
     if (mat()->needsTangents() && !UV[0].empty() && T.empty())
         calcTangents();
 
-    // delete vertex array object so it gets regenerated
+    // delete vertex array object and clusters so they get regenerated
+    _clusters.clear();
     _vao.clearAttribs();
     _vaoS.deleteGL();
     _vaoN.deleteGL();
@@ -281,6 +289,316 @@ void SLMesh::deleteUnused()
     }
 }
 //-----------------------------------------------------------------------------
+//! Moves the element i of a per vertex vector to the position remap[i]
+template<class T>
+static void remapVertexVector(vector<T>&     data,
+                              const SLVuint& remap,
+                              SLuint         numNewVertices)
+{
+    if (data.empty())
+        return;
+
+    vector<T> newData(numNewVertices);
+    for (SLuint i = 0; i < (SLuint)remap.size(); ++i)
+        if (remap[i] != SLMeshOptimizer::INVALID_INDEX)
+            newData[remap[i]] = data[i];
+    data.swap(newData);
+}
+//-----------------------------------------------------------------------------
+/*! Reorders all per vertex attributes with a remap table from the old to the
+ new vertex index. Multiple old vertices can map to the same new vertex and
+ vertices with SLMeshOptimizer::INVALID_INDEX are removed. The indices must
+ be remapped by the caller.
+ */
+void SLMesh::remapVertices(const SLVuint& remap, SLuint numNewVertices)
+{
+    remapVertexVector(P, remap, numNewVertices);
+    remapVertexVector(N, remap, numNewVertices);
+    remapVertexVector(UV[0], remap, numNewVertices);
+    remapVertexVector(UV[1], remap, numNewVertices);
+    remapVertexVector(C, remap, numNewVertices);
+    remapVertexVector(T, remap, numNewVertices);
+    remapVertexVector(Ji, remap, numNewVertices);
+    remapVertexVector(Jw, remap, numNewVertices);
+    remapVertexVector(skinnedP, remap, numNewVertices);
+    remapVertexVector(skinnedN, remap, numNewVertices);
+    for (SLint i = 0; i < bsCount; ++i)
+        remapVertexVector(BS[i], remap, numNewVertices);
+}
+//-----------------------------------------------------------------------------
+/*! Optimizes the order of the vertices and triangles of a triangle mesh for
+ the GPU without changing its appearance. It should be called after loading
+ and before the mesh gets drawn the first time (see e.g.
+ SLImporter::optimizeMeshes). The following steps are done:
+ \n 1) Vertex deduplication: Vertices with identical attributes get merged.
+ Skinned meshes and meshes with blend shapes are not deduplicated.
+ \n 2) Vertex cache reordering of the triangles (Forsyth).
+ \n 3) Overdraw reordering of triangle clusters (optional).
+ \n 4) Vertex fetch reordering in the order of the first usage.
+ \n The average cache miss ratio (ACMR) before and after is logged and the
+ result can be seen in the scene statistics (see SLMesh::addStats).
+ See SLMeshOptimizer for the algorithms.
+ */
+void SLMesh::optimize(SLbool deduplicate, SLbool reduceOverdraw)
+{
+    if (_primitive != PT_triangles || P.empty() || (I16.empty() && I32.empty()))
+        return;
+
+    PROFILE_FUNCTION();
+
+    SLVuint indices;
+    if (!I16.empty())
+        indices.assign(I16.begin(), I16.end());
+    else
+        indices = I32;
+
+    SLuint  numV       = (SLuint)P.size();
+    SLuint  numVBefore = numV;
+    SLfloat acmrBefore = SLMeshOptimizer::calcACMR(indices, numV);
+    SLVuint remap;
+
+    // 1) Merge vertices with bitwise identical attributes
+    if (deduplicate && Ji.empty() && bsCount == 0)
+    {
+        // Build a key of all attribute floats per vertex
+        SLuint floatsPerV = 3;
+        if (!N.empty()) floatsPerV += 3;
+        if (!UV[0].empty()) floatsPerV += 2;
+        if (!UV[1].empty()) floatsPerV += 2;
+        if (!C.empty()) floatsPerV += 4;
+        if (!T.empty()) floatsPerV += 4;
+
+        SLVfloat keys(numV * floatsPerV);
+        for (SLuint v = 0; v < numV; ++v)
+        {
+            SLfloat* k = &keys[v * floatsPerV];
+            memcpy(k, &P[v], sizeof(SLVec3f)), k += 3;
+            if (!N.empty()) memcpy(k, &N[v], sizeof(SLVec3f)), k += 3;
+            if (!UV[0].empty()) memcpy(k, &UV[0][v], sizeof(SLVec2f)), k += 2;
+            if (!UV[1].empty()) memcpy(k, &UV[1][v], sizeof(SLVec2f)), k += 2;
+            if (!C.empty()) memcpy(k, &C[v], sizeof(SLCol4f)), k += 4;
+            if (!T.empty()) memcpy(k, &T[v], sizeof(SLVec4f));
+        }
+
+        // Sort the vertex indices by their keys so that duplicates are neighbours
+        SLVuint sorted(numV);
+        for (SLuint v = 0; v < numV; ++v)
+            sorted[v] = v;
+
+        size_t keyBytes = floatsPerV * sizeof(SLfloat);
+        std::sort(sorted.begin(),
+                  sorted.end(),
+                  [&](SLuint a, SLuint b)
+                  {
+                      int cmp = memcmp(&keys[a * floatsPerV], &keys[b * floatsPerV], keyBytes);
+                      return cmp < 0 || (cmp == 0 && a < b);
+                  });
+
+        // The first vertex of each group of duplicates survives
+        SLVuint firstOf(numV);
+        for (SLuint i = 0; i < numV; ++i)
+        {
+            SLuint v = sorted[i];
+            if (i > 0 &&
+                memcmp(&keys[v * floatsPerV],
+                       &keys[sorted[i - 1] * floatsPerV],
+                       keyBytes) == 0)
+                firstOf[v] = firstOf[sorted[i - 1]];
+            else
+                firstOf[v] = v;
+        }
+
+        for (SLuint& i : indices)
+            i = firstOf[i];
+    }
+
+    // 2) Vertex cache optimization
+    SLMeshOptimizer::optimizeVertexCache(indices, numV);
+
+    // 3) Overdraw optimization with max. 5% loss of cache efficiency
+    if (reduceOverdraw)
+        SLMeshOptimizer::optimizeOverdraw(indices, P, 1.05f);
+
+    // 4) Vertex fetch optimization that also removes the unused vertices
+    numV = SLMeshOptimizer::buildFetchRemap(indices, numV, remap);
+    for (SLuint& i : indices)
+        i = remap[i];
+    remapVertices(remap, numV);
+
+    // Store the indices with the smallest possible type
+    I16.clear();
+    I32.clear();
+    if (numV < 65536)
+        I16.assign(indices.begin(), indices.end());
+    else
+        I32.swap(indices);
+
+    // Previous selections, hard edges, GPU data and acceleration structures are invalid
+    IS32.clear();
+    IE16.clear();
+    IE32.clear();
+    _clusters.clear();
+    _vao.clearAttribs();
+    _accelStructIsOutOfDate = true;
+
+    SLfloat acmrAfter = SLMeshOptimizer::calcACMR(I16.empty() ? I32 : SLVuint(I16.begin(), I16.end()), numV);
+    SL_LOG("Optimized %-20s: vertices %u -> %u, ACMR %4.2f -> %4.2f",
+           _name.c_str(),
+           numVBefore,
+           numV,
+           acmrBefore,
+           acmrAfter);
+}
+//-----------------------------------------------------------------------------
+/*! Splits a static triangle mesh into clusters of max. maxTriangles connected
+ triangles for the cluster culling in SLMesh::drawElements. The clusters grow
+ in breadth first order over the triangles that share a vertex, so that they
+ form compact patches. The triangles are reordered so that every cluster is a
+ contiguous range of the indices. For every cluster the bounding sphere and
+ the cone of its face normals is calculated. If the face normals spread too
+ much the cone axis is zero and the cluster is never back face culled.
+ Skinned meshes and meshes with blend shapes have no clusters because their
+ vertices move. If the mesh gets optimized with SLMesh::optimize, it should be
+ done before because the optimization destroys the cluster order.
+ */
+void SLMesh::buildClusters(SLuint maxTriangles)
+{
+    _clusters.clear();
+
+    if (_primitive != PT_triangles ||
+        P.empty() ||
+        (I16.empty() && I32.empty()) ||
+        _skeleton || !Ji.empty() || bsCount > 0)
+        return;
+
+    PROFILE_FUNCTION();
+
+    SLVuint indices;
+    if (!I16.empty())
+        indices.assign(I16.begin(), I16.end());
+    else
+        indices = I32;
+
+    SLuint numV = (SLuint)P.size();
+    SLuint numT = (SLuint)indices.size() / 3;
+    assert(maxTriangles > 0);
+
+    // Build the triangle adjacency per vertex in one compact array
+    SLVuint adjOffsets(numV + 1, 0);
+    for (SLuint i : indices)
+        adjOffsets[i + 1]++;
+    for (SLuint v = 0; v < numV; ++v)
+        adjOffsets[v + 1] += adjOffsets[v];
+
+    SLVuint adjTriangles(indices.size());
+    SLVuint adjFill(adjOffsets.begin(), adjOffsets.end() - 1);
+    for (SLuint i = 0; i < (SLuint)indices.size(); ++i)
+        adjTriangles[adjFill[indices[i]]++] = i / 3;
+
+    vector<bool> isUsed(numT, false);
+    SLVuint      newIndices;
+    SLVuint      queue;
+    newIndices.reserve(indices.size());
+
+    for (SLuint seed = 0; seed < numT; ++seed)
+    {
+        if (isUsed[seed])
+            continue;
+
+        SLMeshCluster cluster;
+        cluster.indexOffset = (SLuint)newIndices.size();
+
+        // Grow the cluster in breadth first order from the seed triangle
+        SLuint numClusterT = 0;
+        queue.clear();
+        queue.push_back(seed);
+        for (SLuint q = 0; q < queue.size() && numClusterT < maxTriangles; ++q)
+        {
+            SLuint t = queue[q];
+            if (isUsed[t])
+                continue;
+
+            isUsed[t] = true;
+            numClusterT++;
+            for (SLuint c = 0; c < 3; ++c)
+            {
+                SLuint v = indices[t * 3 + c];
+                newIndices.push_back(v);
+                for (SLuint a = adjOffsets[v]; a < adjOffsets[v + 1]; ++a)
+                    if (!isUsed[adjTriangles[a]])
+                        queue.push_back(adjTriangles[a]);
+            }
+        }
+
+        cluster.numIndices = (SLuint)newIndices.size() - cluster.indexOffset;
+
+        // Bounding sphere around the center of the AABB of the cluster
+        SLVec3f minC(FLT_MAX, FLT_MAX, FLT_MAX);
+        SLVec3f maxC(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (SLuint i = cluster.indexOffset; i < newIndices.size(); ++i)
+        {
+            minC.setMin(P[newIndices[i]]);
+            maxC.setMax(P[newIndices[i]]);
+        }
+        cluster.center = (minC + maxC) * 0.5f;
+        cluster.radius = 0.0f;
+        for (SLuint i = cluster.indexOffset; i < newIndices.size(); ++i)
+            cluster.radius = std::max(cluster.radius,
+                                      (P[newIndices[i]] - cluster.center).length());
+
+        // Normal cone around the average face normal
+        SLVVec3f faceNormals;
+        SLVec3f  axis = SLVec3f::ZERO;
+        for (SLuint i = cluster.indexOffset; i < newIndices.size(); i += 3)
+        {
+            const SLVec3f& p0 = P[newIndices[i]];
+            SLVec3f        n  = (P[newIndices[i + 1]] - p0) ^ (P[newIndices[i + 2]] - p0);
+            SLfloat        l  = n.length();
+            if (l > FLT_EPSILON)
+            {
+                n /= l;
+                faceNormals.push_back(n);
+                axis += n;
+            }
+        }
+
+        SLfloat minDot = -1.0f;
+        if (!faceNormals.empty() && axis.length() > FLT_EPSILON)
+        {
+            axis.normalize();
+            minDot = 1.0f;
+            for (auto& n : faceNormals)
+                minDot = std::min(minDot, axis.dot(n));
+        }
+
+        if (minDot > 0.1f)
+        {
+            cluster.coneAxis   = axis;
+            cluster.coneCutoff = sqrt(1.0f - minDot * minDot);
+        }
+        else
+        {
+            cluster.coneAxis   = SLVec3f::ZERO;
+            cluster.coneCutoff = 1.0f;
+        }
+
+        _clusters.push_back(cluster);
+    }
+
+    if (!I16.empty())
+        I16.assign(newIndices.begin(), newIndices.end());
+    else
+        I32.swap(newIndices);
+
+    _vao.clearAttribs();
+    _accelStructIsOutOfDate = true;
+
+    SL_LOG("Clustered %-20s: %u triangles in %u clusters",
+           _name.c_str(),
+           numT,
+           (SLuint)_clusters.size());
+}
+//-----------------------------------------------------------------------------
 //! SLMesh::shapeInit sets the transparency flag of the AABB
 void SLMesh::init(SLNode* node)
 {
@@ -348,7 +666,16 @@ void SLMesh::drawIntoDepthBuffer(SLSceneView* sv,
     SLGLProgram* sp    = depthMat->program();
     SLGLState*   state = SLGLState::instance();
     sp->useProgram();
-    sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&stateGL->modelMatrix);
+
+    // The depth shader decodes compact positions with the model matrix
+    SLMat4f mMatrix = stateGL->modelMatrix;
+    if (_vaoIsCompact)
+    {
+        mMatrix.translate(_compactPosMin);
+        mMatrix.scale(_compactPosSize);
+    }
+
+    sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&mMatrix);
     sp->uniformMatrix4fv("u_vMatrix", 1, (SLfloat*)&stateGL->viewMatrix);
     sp->uniformMatrix4fv("u_pMatrix", 1, (SLfloat*)&stateGL->projectionMatrix);
 
@@ -369,6 +696,7 @@ Optionally you can draw the normals and/or the uniform grid voxels.
 3) Apply the uniform variables to the shader<br>
 3a) Activate a shader program if it is not yet in use and apply all its material parameters.<br>
 3b) Pass the standard matrices to the shader program.<br>
+3c) Pass the decoding parameters of the compact vertex format.<br>
 4) Finally do the draw call by calling SLGLVertexArray::drawElementsAs<br>
 5) Draw optional normals & tangents<br>
 6) Draw optional acceleration structure<br>
@@ -438,10 +766,24 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
     _mat->activate(sv->camera(), &sv->s()->lights());
 
     // 3.b) Pass the standard matrices to the shader program
+    // During a draw list replay only the changed matrices are passed
     SLGLProgram* sp = _mat->program();
-    sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&stateGL->modelMatrix);
-    sp->uniformMatrix4fv("u_vMatrix", 1, (SLfloat*)&stateGL->viewMatrix);
-    sp->uniformMatrix4fv("u_pMatrix", 1, (SLfloat*)&stateGL->projectionMatrix);
+    if (sv->drawList3D().isReplaying())
+        sv->drawList3D().passMatrices(sp);
+    else
+    {
+        sp->uniformMatrix4fv("u_mMatrix", 1, (SLfloat*)&stateGL->modelMatrix);
+        sp->uniformMatrix4fv("u_vMatrix", 1, (SLfloat*)&stateGL->viewMatrix);
+        sp->uniformMatrix4fv("u_pMatrix", 1, (SLfloat*)&stateGL->projectionMatrix);
+    }
+
+    // 3.c) Pass the decoding parameters of the compact vertex format
+    sp->vertCompact(_vaoIsCompact);
+    if (_vaoIsCompact)
+    {
+        sp->uniform3fv("u_vertPosMin", 1, (SLfloat*)&_compactPosMin);
+        sp->uniform3fv("u_vertPosSize", 1, (SLfloat*)&_compactPosSize);
+    }
 
     SLint locTM = sp->getUniformLocation("u_tMatrix");
     if (locTM >= 0)
@@ -459,20 +801,20 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
 
     if ((sv->drawBit(SL_DB_ONLYEDGES) || node->drawBit(SL_DB_ONLYEDGES)) &&
         (!IE32.empty() || !IE16.empty()))
-        _vao.drawEdges(_edgeColor, _edgeWidth);
+        drawHardEdges();
     else
     {
         if (_primitive == PT_points)
             _vao.drawArrayAs(PT_points);
         else
         {
-            _vao.drawElementsAs(primitiveType);
+            drawElements(sv, node, primitiveType);
 
             if ((sv->drawBit(SL_DB_WITHEDGES) || node->drawBit(SL_DB_WITHEDGES)) &&
                 (!IE32.empty() || !IE16.empty()))
             {
                 stateGL->polygonOffsetLine(true, 1.0f, 1.0f);
-                _vao.drawEdges(_edgeColor, _edgeWidth);
+                drawHardEdges();
                 stateGL->polygonOffsetLine(false);
             }
         }
@@ -560,6 +902,84 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         stateGL->blend(true);
 }
 //-----------------------------------------------------------------------------
+/*! SLMesh::drawElements does the indexed draw call of step 4 in SLMesh::draw.
+If the mesh has clusters (see SLMesh::buildClusters) only the clusters that
+are within the view frustum and not completely back facing are drawn. For
+mirrored nodes the back facing test is inverted like the GL face culling.
+Derived meshes such as SLMeshBatch override it to draw only parts of the index
+buffer.
+*/
+void SLMesh::drawElements(SLSceneView*      sv,
+                          SLNode*           node,
+                          SLGLPrimitiveType primitiveType)
+{
+    SLCamera* cam = sv->camera();
+
+    if (!_doClusterCulling ||
+        _clusters.size() < 2 ||
+        primitiveType != PT_triangles ||
+        !cam)
+    {
+        _vao.drawElementsAs(primitiveType);
+        _numClustersDrawn = (SLuint)_clusters.size();
+        return;
+    }
+
+    // The radius of the spheres gets scaled with the max. scale of the node
+    const SLMat4f& wm     = node->updateAndGetWM();
+    SLfloat        scaleX = wm.axisX().length();
+    SLfloat        scaleY = wm.axisY().length();
+    SLfloat        scaleZ = wm.axisZ().length();
+    SLfloat        scale  = std::max(scaleX, std::max(scaleY, scaleZ));
+
+    // The normal cones are only valid with face culling and without non-uniform scaling
+    SLbool doConeCulling = !sv->drawBit(SL_DB_CULLOFF) &&
+                           !node->drawBit(SL_DB_CULLOFF) &&
+                           std::min(scaleX, std::min(scaleY, scaleZ)) > scale * 0.99f;
+
+    // A mirrored node (negative scale) flips the triangle winding in screen
+    // space. The GL face culling then removes the faces that point towards the
+    // camera in object space, so the cone axis must be flipped as well.
+    SLfloat coneSign = ((wm.axisX() ^ wm.axisY()) * wm.axisZ()) < 0.0f ? -1.0f : 1.0f;
+
+    // The cone test is done in object space
+    SLVec3f camPosOS = node->updateAndGetWMI().multVec(cam->updateAndGetWM().translation());
+
+    SLuint firstIndex = 0;
+    SLuint numIndices = 0;
+    _numClustersDrawn = 0;
+
+    for (auto& cluster : _clusters)
+    {
+        SLbool isVisible = cam->isInFrustum(wm.multVec(cluster.center),
+                                            cluster.radius * scale);
+
+        if (isVisible && doConeCulling)
+        {
+            SLVec3f camToCenter = cluster.center - camPosOS;
+            if (coneSign * camToCenter.dot(cluster.coneAxis) >=
+                cluster.coneCutoff * camToCenter.length() + cluster.radius)
+                isVisible = false;
+        }
+
+        if (isVisible)
+        {
+            if (numIndices == 0)
+                firstIndex = cluster.indexOffset;
+            numIndices += cluster.numIndices;
+            _numClustersDrawn++;
+        }
+        else if (numIndices)
+        {
+            _vao.drawElementsAs(primitiveType, numIndices, firstIndex);
+            numIndices = 0;
+        }
+    }
+
+    if (numIndices)
+        _vao.drawElementsAs(primitiveType, numIndices, firstIndex);
+}
+//-----------------------------------------------------------------------------
 //! Handles the rectangle section of mesh vertices (partial selection)
 /*
  There are two different selection modes: Full or partial mesh selection.
@@ -710,12 +1130,31 @@ void SLMesh::generateVAO(SLGLVertexArray& vao)
 {
     PROFILE_FUNCTION();
 
-    vao.setAttrib(AT_position, AT_position, _finalP);
-    if (!N.empty()) vao.setAttrib(AT_normal, AT_normal, _finalN);
-    if (!UV[0].empty()) vao.setAttrib(AT_uv1, AT_uv1, &UV[0]);
-    if (!UV[1].empty()) vao.setAttrib(AT_uv2, AT_uv2, &UV[1]);
-    if (!C.empty()) vao.setAttrib(AT_color, AT_color, &C);
-    if (!T.empty()) vao.setAttrib(AT_tangent, AT_tangent, &T);
+    // The compact attributes only need to exist until vao.generate
+    SLVushort cP, cUV0, cUV1;
+    SLVshort  cN, cT;
+    SLVubyte  cC;
+
+    // Only static meshes drawn with generated shaders can be compact
+    SLGLProgram* sp = _mat ? _mat->program() : nullptr;
+    _vaoIsCompact   = &vao == &_vao &&
+                    _compactVertices &&
+                    _primitive == PT_triangles &&
+                    Ji.empty() &&
+                    bsCount == 0 &&
+                    (!sp || dynamic_cast<SLGLProgramGenerated*>(sp));
+
+    if (_vaoIsCompact)
+        generateCompactAttribs(vao, cP, cN, cUV0, cUV1, cC, cT);
+    else
+    {
+        vao.setAttrib(AT_position, AT_position, _finalP);
+        if (!N.empty()) vao.setAttrib(AT_normal, AT_normal, _finalN);
+        if (!UV[0].empty()) vao.setAttrib(AT_uv1, AT_uv1, &UV[0]);
+        if (!UV[1].empty()) vao.setAttrib(AT_uv2, AT_uv2, &UV[1]);
+        if (!C.empty()) vao.setAttrib(AT_color, AT_color, &C);
+        if (!T.empty()) vao.setAttrib(AT_tangent, AT_tangent, &T);
+    }
 
     if (!I16.empty() || !I32.empty())
     {
@@ -741,6 +1180,132 @@ void SLMesh::generateVAO(SLGLVertexArray& vao)
                  Ji.empty() && bsCount == 0);
 }
 //-----------------------------------------------------------------------------
+/*! Encodes the vertex attributes into the compact vertex format and adds them
+ to the VAO. The encoded vectors are passed from SLMesh::generateVAO because
+ they must exist until the VAO is generated:
+ \n P:  4 x 16 bit unsigned normalized, quantized in the AABB of the mesh
+ \n N:  2 x 16 bit signed normalized, octahedral encoded
+ \n UV: 2 x 16 bit half float (float if the coords. exceed +/-4)
+ \n C:  4 x 8 bit unsigned normalized
+ \n T:  4 x 16 bit signed normalized, octahedral encoded + handedness
+ \n The vertex shader decodes the positions with the uniforms u_vertPosMin and
+ u_vertPosSize. All other attributes are decoded by OpenGL or by octDecode.
+ */
+void SLMesh::generateCompactAttribs(SLGLVertexArray& vao,
+                                    SLVushort&       cP,
+                                    SLVshort&        cN,
+                                    SLVushort&       cUV0,
+                                    SLVushort&       cUV1,
+                                    SLVubyte&        cC,
+                                    SLVshort&        cT)
+{
+    SLuint numV = (SLuint)P.size();
+
+    // Quantize positions relative to their min. corner
+    _compactPosMin.set(FLT_MAX, FLT_MAX, FLT_MAX);
+    SLVec3f posMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (auto& p : P)
+    {
+        _compactPosMin.setMin(p);
+        posMax.setMax(p);
+    }
+    _compactPosSize = posMax - _compactPosMin;
+
+    cP.resize(numV * 4);
+    for (SLuint v = 0; v < numV; ++v)
+    {
+        for (SLuint c = 0; c < 3; ++c)
+        {
+            SLfloat size = _compactPosSize.comp[c];
+            SLfloat q    = size > 0.0f ? (P[v].comp[c] - _compactPosMin.comp[c]) / size : 0.0f;
+            cP[v * 4 + c] = (SLushort)(Utils::clamp(q, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        }
+        cP[v * 4 + 3] = 65535; // w = 1
+    }
+    vao.setAttrib(AT_position, 4, AT_position, &cP[0], BT_ushort, true);
+
+    if (!N.empty())
+    {
+        cN.resize(numV * 2);
+        for (SLuint v = 0; v < numV; ++v)
+        {
+            SLVec2f e     = SLGLVertexBuffer::octEncode(N[v]);
+            cN[v * 2]     = (SLshort)std::round(e.x * 32767.0f);
+            cN[v * 2 + 1] = (SLshort)std::round(e.y * 32767.0f);
+        }
+        vao.setAttrib(AT_normal, 2, AT_normal, &cN[0], BT_short, true);
+    }
+
+    // Tex. coords. as half floats if the precision is sufficient
+    SLVushort* cUV[2]  = {&cUV0, &cUV1};
+    SLint      uvAT[2] = {AT_uv1, AT_uv2};
+    for (SLuint i = 0; i < 2; ++i)
+    {
+        if (UV[i].empty())
+            continue;
+
+        SLfloat maxAbsUV = 0.0f;
+        for (auto& uv : UV[i])
+            maxAbsUV = std::max(maxAbsUV, std::max(std::abs(uv.x), std::abs(uv.y)));
+
+        if (maxAbsUV > 4.0f)
+        {
+            vao.setAttrib((SLGLAttributeType)uvAT[i], uvAT[i], &UV[i]);
+            continue;
+        }
+
+        cUV[i]->resize(numV * 2);
+        for (SLuint v = 0; v < numV; ++v)
+        {
+            (*cUV[i])[v * 2]     = SLGLVertexBuffer::floatToHalf(UV[i][v].x);
+            (*cUV[i])[v * 2 + 1] = SLGLVertexBuffer::floatToHalf(UV[i][v].y);
+        }
+        vao.setAttrib((SLGLAttributeType)uvAT[i], 2, uvAT[i], &(*cUV[i])[0], BT_half);
+    }
+
+    if (!C.empty())
+    {
+        cC.resize(numV * 4);
+        for (SLuint v = 0; v < numV; ++v)
+            for (SLuint c = 0; c < 4; ++c)
+                cC[v * 4 + c] = (SLubyte)(Utils::clamp(C[v].comp[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+        vao.setAttrib(AT_color, 4, AT_color, &cC[0], BT_ubyte, true);
+    }
+
+    if (!T.empty())
+    {
+        cT.resize(numV * 4);
+        for (SLuint v = 0; v < numV; ++v)
+        {
+            SLVec2f e     = SLGLVertexBuffer::octEncode(SLVec3f(T[v].x, T[v].y, T[v].z));
+            cT[v * 4]     = (SLshort)std::round(e.x * 32767.0f);
+            cT[v * 4 + 1] = (SLshort)std::round(e.y * 32767.0f);
+            cT[v * 4 + 2] = T[v].w < 0.0f ? -32767 : 32767;
+            cT[v * 4 + 3] = 0;
+        }
+        vao.setAttrib(AT_tangent, 4, AT_tangent, &cT[0], BT_short, true);
+    }
+}
+//-----------------------------------------------------------------------------
+/*! Draws the hard edges. The edge shader has no decoding of compact vertex
+ positions. They are therefore decoded with the model matrix.
+ */
+void SLMesh::drawHardEdges()
+{
+    if (!_vaoIsCompact)
+    {
+        _vao.drawEdges(_edgeColor, _edgeWidth);
+        return;
+    }
+
+    SLGLState* stateGL = SLGLState::instance();
+    SLMat4f    mMatrix = stateGL->modelMatrix;
+    stateGL->modelMatrix.translate(_compactPosMin);
+    stateGL->modelMatrix.scale(_compactPosSize);
+    _vao.drawEdges(_edgeColor, _edgeWidth);
+    stateGL->modelMatrix = mMatrix;
+}
+//-----------------------------------------------------------------------------
 //! computes the hard edges and stores the vertex indexes separately
 /*! Hard edges are edges between faces where there normals have an angle
  greater than angleDEG (by default 30°). If a mesh has only smooth edges such
@@ -888,6 +1453,15 @@ void SLMesh::addStats(SLNodeStats& stats)
 
     stats.numMeshes++;
     if (_primitive == PT_triangles) stats.numTriangles += numI() / 3;
+
+    // Simulated vertex cache misses for the average cache miss ratio (ACMR)
+    if (_primitive == PT_triangles)
+    {
+        if (!I16.empty())
+            stats.numCacheMisses += SLMeshOptimizer::calcCacheMisses(SLVuint(I16.begin(), I16.end()), (SLuint)P.size());
+        else
+            stats.numCacheMisses += SLMeshOptimizer::calcCacheMisses(I32, (SLuint)P.size());
+    }
     if (_primitive == PT_lines) stats.numLines += numI() / 2;
 
     if (_accelStruct)
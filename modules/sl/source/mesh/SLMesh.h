@@ -111,13 +111,43 @@ All vertex attributes are added to the vertex array object _vao (SLVertexArray).
 All arrays remain in the main memory for ray tracing.
 A mesh uses only one material referenced by the SLMesh::mat pointer.
 \n
+With SLMesh::compactVertices the main VAO is generated with a compact
+interleaved vertex format instead of 32-bit floats: The positions are
+quantized to 16 bit relative to the mesh's bounding box, normals and tangents
+are octahedral encoded in 16 bit components, tex. coords. are half floats and
+colors are 8 bit. This reduces the vertex size e.g. from 72 to 32 bytes. The
+attributes are decoded in the vertex shaders of SLGLProgramGenerated. The
+float attributes in main memory are kept for ray tracing and picking. Meshes
+with skinning or blend shapes and materials with custom shader programs
+always use the float format.
+\n
 If a mesh is associated with a skeleton all its vertices and normals are
 transformed every frame by the joint weights. Every vertex of a mesh has
 weights for 1-n joints by which it can be influenced. This transform is
 called skinning and is done in CPU in the method transformSkin. The final
 transformed vertices and normals are stored in _finalP and _finalN.
+\n
+Large static triangle meshes (e.g. from photogrammetry) can be split with
+SLMesh::buildClusters into clusters of about 128 connected triangles. Each
+cluster (SLMeshCluster) has a bounding sphere and a cone of its face normals.
+If SLMesh::doClusterCulling is on, the clusters outside the view frustum and
+the clusters that face completely away from the camera are skipped in
+SLMesh::drawElements. Adjacent visible clusters are drawn with one draw call.
 */
 
+//-----------------------------------------------------------------------------
+//! Contiguous range of triangles of a mesh with its culling bounds (meshlet)
+struct SLMeshCluster
+{
+    SLuint  indexOffset; //!< Index of the first vertex index in I16 or I32
+    SLuint  numIndices;  //!< NO. of vertex indices of the cluster
+    SLVec3f center;      //!< Center of the bounding sphere in OS
+    SLfloat radius;      //!< Radius of the bounding sphere in OS
+    SLVec3f coneAxis;    //!< Average face normal in OS (zero if the cone is too wide)
+    SLfloat coneCutoff;  //!< Sine of the half opening angle of the normal cone
+};
+typedef vector<SLMeshCluster> SLVMeshCluster;
+//-----------------------------------------------------------------------------
 class SLMesh : public SLObject
 #ifdef SL_HAS_OPTIX
   , public SLOptixAccelStruct
@@ -154,6 +184,9 @@ public:
     void         transformSkin(const std::function<void(SLMesh*)>& cbInformNodes);
     void         transformSkinWithBlendShapes(SLint bsID);
     void         deselectPartialSelection();
+    void         optimize(SLbool deduplicate    = true,
+                          SLbool reduceOverdraw = true);
+    void         buildClusters(SLuint maxTriangles = 128);
 
 #ifdef SL_HAS_OPTIX
     void                allocAndUploadData();
@@ -179,6 +212,11 @@ public:
     SLVec3f               finalP(SLuint i) { return _finalP->operator[](i); }
     SLVec3f               finalN(SLuint i) { return _finalN->operator[](i); }
     SLbool                accelStructIsOutOfDate() { return _accelStructIsOutOfDate; }
+    SLbool                compactVertices() const { return _compactVertices; }
+    SLbool                vaoIsCompact() const { return _vaoIsCompact; }
+    const SLVMeshCluster& clusters() const { return _clusters; }
+    SLbool                doClusterCulling() const { return _doClusterCulling; }
+    SLuint                numClustersDrawn() const { return _numClustersDrawn; }
 
     // Setters
     void mat(SLMaterial* m) { _mat = m; }
@@ -190,6 +228,12 @@ public:
     void edgeAngleDEG(SLfloat ea) { _edgeAngleDEG = ea; }
     void edgeColor(const SLCol4f& ec) { _edgeColor = ec; }
     void vertexPosEpsilon(SLfloat eps) { _vertexPosEpsilon = eps; }
+    void compactVertices(SLbool cv)
+    {
+        _compactVertices = cv;
+        _vao.clearAttribs();
+    }
+    void doClusterCulling(SLbool doCC) { _doClusterCulling = doCC; }
 
     // vertex attributes
     SLVVec3f  P;        //!< Vector for vertex positions                   layout (location = 0)
@@ -219,12 +263,25 @@ public:
 
 private:
     void calcTangents();
+    void remapVertices(const SLVuint& remap, SLuint numNewVertices);
     void drawSelectedVertices();
+    void drawHardEdges();
+    void generateCompactAttribs(SLGLVertexArray& vao,
+                                SLVushort&       cP,
+                                SLVshort&        cN,
+                                SLVushort&       cUV0,
+                                SLVushort&       cUV1,
+                                SLVubyte&        cC,
+                                SLVshort&        cT);
     void handleRectangleSelection(SLSceneView* sv,
                                   SLGLState*   stateGL,
                                   SLNode*      node);
 
 protected:
+    virtual void drawElements(SLSceneView*      sv,
+                              SLNode*           node,
+                              SLGLPrimitiveType primitiveType);
+
     SLGLPrimitiveType  _primitive;        //!< Primitive type (default triangles)
     SLMaterial*        _mat;              //!< Pointer to the inside material
     SLMaterial*        _matOut;           //!< Pointer to the outside material
@@ -237,6 +294,13 @@ protected:
     SLfloat            _edgeWidth;        //!< Line width for hard edge drawing
     SLCol4f            _edgeColor;        //!< Color for hard edge drawing
     SLfloat            _vertexPosEpsilon; //!< Vertex position epsilon used in computeHardEdgesIndices
+    SLbool             _compactVertices;  //!< Flag if the VAO should use the compact vertex format
+    SLbool             _vaoIsCompact;     //!< Flag if the main VAO was generated with the compact vertex format
+    SLVec3f            _compactPosMin;    //!< Min. corner of the quantized positions in OS
+    SLVec3f            _compactPosSize;   //!< Size of the quantized positions in OS
+    SLVMeshCluster     _clusters;         //!< Triangle clusters for the cluster culling
+    SLbool             _doClusterCulling; //!< Flag if the clusters get culled in drawElements
+    SLuint             _numClustersDrawn; //!< NO. of clusters drawn in the last draw call
 
 #ifdef SL_HAS_OPTIX
     SLOptixCudaBuffer<SLVec3f>  _vertexBuffer;
@@ -0,0 +1,340 @@
+//#############################################################################
+//  File:      SLMeshBatch.cpp
+//  Purpose:   Static mesh that merges the meshes of nodes with equal material
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <SLAnimManager.h>
+#include <SLCamera.h>
+#include <SLMaterial.h>
+#include <SLMeshBatch.h>
+#include <SLNode.h>
+#include <SLParticleSystem.h>
+#include <SLSceneView.h>
+
+//-----------------------------------------------------------------------------
+//! Bit mask of the optional vertex attributes that a batch must have in common
+static SLuint batchAttribMask(SLMesh* mesh)
+{
+    SLuint mask = 0;
+    if (!mesh->N.empty()) mask |= 1;
+    if (!mesh->UV[0].empty()) mask |= 2;
+    if (!mesh->UV[1].empty()) mask |= 4;
+    if (!mesh->C.empty()) mask |= 8;
+    if (!mesh->T.empty()) mask |= 16;
+    return mask;
+}
+//-----------------------------------------------------------------------------
+//! Returns true if the node is animated by any animation of the anim. manager
+static SLbool isNodeAnimated(SLNode* node, SLAnimManager* animManager)
+{
+    if (node->animation())
+        return true;
+
+    if (animManager)
+        for (auto& it : animManager->animations())
+            if (it.second->affectsNode(node))
+                return true;
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+//! Collects recursively all nodes whose meshes can be merged into a batch
+static void collectBatchCandidatesRec(SLNode*        node,
+                                      SLAnimManager* animManager,
+                                      SLbool         parentIsAnimated,
+                                      SLVNode&       candidates)
+{
+    SLbool isAnimated = parentIsAnimated || isNodeAnimated(node, animManager);
+
+    SLMesh* mesh = node->mesh();
+    if (!isAnimated &&
+        mesh &&
+        typeid(*node) == typeid(SLNode) &&
+        !dynamic_cast<SLMeshBatch*>(mesh) &&
+        !dynamic_cast<SLParticleSystem*>(mesh) &&
+        mesh->primitive() == PT_triangles &&
+        !mesh->skeleton() &&
+        mesh->Ji.empty() &&
+        mesh->bsCount == 0 &&
+        mesh->mat() &&
+        !mesh->mat()->hasAlpha() &&
+        !mesh->matOut() &&
+        !node->drawBit(SL_DB_HIDDEN))
+        candidates.push_back(node);
+
+    for (auto* child : node->children())
+        collectBatchCandidatesRec(child, animManager, isAnimated, candidates);
+}
+//-----------------------------------------------------------------------------
+SLMeshBatch::SLMeshBatch(SLAssetManager* assetMgr,
+                         const SLstring& name) : SLMesh(assetMgr, name)
+{
+    _doRangeCulling = true;
+    _numRangesDrawn = 0;
+}
+//-----------------------------------------------------------------------------
+/*! Appends the vertices and indices of the passed mesh transformed by the
+ matrix m to the batch. The indices are collected in I32 until
+ SLMeshBatch::finalizeIndices is called. The normals are transformed with the
+ inverse transposed matrix and the triangle winding is flipped if the matrix
+ mirrors the geometry.
+ */
+void SLMeshBatch::addMesh(SLMesh*         mesh,
+                          const SLMat4f&  m,
+                          const SLstring& rangeName,
+                          SLNode*         srcNode)
+{
+    assert(mesh && mesh->primitive() == PT_triangles);
+    assert((P.empty() || batchAttribMask(mesh) == batchAttribMask(this)) &&
+           "Meshes of a batch must have the same vertex attributes");
+
+    SLuint  vertexOffset = (SLuint)P.size();
+    SLMat4f mCopy(m);
+    SLMat3f mN         = mCopy.inverseTransposed();
+    SLMat3f mT         = m.mat3();
+    SLbool  isMirrored = mT.det() < 0.0f;
+
+    SLMeshBatchRange range;
+    range.name        = rangeName;
+    range.node        = srcNode;
+    range.indexOffset = (SLuint)I32.size();
+    range.numIndices  = mesh->numI();
+    range.numVertices = (SLuint)mesh->P.size();
+
+    // Transform the positions and calculate the bounding sphere of the range
+    SLVec3f rangeMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    SLVec3f rangeMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (auto& p : mesh->P)
+    {
+        SLVec3f pB = m.multVec(p);
+        rangeMin.setMin(pB);
+        rangeMax.setMax(pB);
+        P.push_back(pB);
+    }
+    range.center = (rangeMin + rangeMax) * 0.5f;
+    range.radius = (rangeMax - rangeMin).length() * 0.5f;
+
+    for (auto& n : mesh->N)
+    {
+        SLVec3f nB = mN * n;
+        nB.normalize();
+        N.push_back(nB);
+    }
+
+    for (auto& t : mesh->T)
+    {
+        SLVec3f tB = mT * SLVec3f(t.x, t.y, t.z);
+        tB.normalize();
+        T.push_back(SLVec4f(tB.x, tB.y, tB.z, isMirrored ? -t.w : t.w));
+    }
+
+    UV[0].insert(UV[0].end(), mesh->UV[0].begin(), mesh->UV[0].end());
+    UV[1].insert(UV[1].end(), mesh->UV[1].begin(), mesh->UV[1].end());
+    C.insert(C.end(), mesh->C.begin(), mesh->C.end());
+
+    // Append the indices with the vertex offset of this range
+    SLuint numI = mesh->numI();
+    for (SLuint i = 0; i < numI; i += 3)
+    {
+        SLuint i0 = mesh->I16.empty() ? mesh->I32[i] : mesh->I16[i];
+        SLuint i1 = mesh->I16.empty() ? mesh->I32[i + 1] : mesh->I16[i + 1];
+        SLuint i2 = mesh->I16.empty() ? mesh->I32[i + 2] : mesh->I16[i + 2];
+        if (isMirrored) std::swap(i1, i2);
+        I32.push_back(vertexOffset + i0);
+        I32.push_back(vertexOffset + i1);
+        I32.push_back(vertexOffset + i2);
+    }
+
+    _ranges.push_back(range);
+}
+//-----------------------------------------------------------------------------
+/*! Returns the index of the range that contains the vertex index at the passed
+ position in I16 or I32 (e.g. SLRay::hitTriangle) or -1 if there is none.
+ */
+SLint SLMeshBatch::rangeIndex(SLuint index) const
+{
+    auto it = std::upper_bound(_ranges.begin(),
+                               _ranges.end(),
+                               index,
+                               [](SLuint i, const SLMeshBatchRange& range)
+                               { return i < range.indexOffset; });
+    if (it == _ranges.begin())
+        return -1;
+
+    --it;
+    if (index >= it->indexOffset + it->numIndices)
+        return -1;
+
+    return (SLint)(it - _ranges.begin());
+}
+//-----------------------------------------------------------------------------
+//! Returns the source node of the range that contains the passed index position
+SLNode* SLMeshBatch::sourceNode(SLuint index) const
+{
+    SLint i = rangeIndex(index);
+    return i < 0 ? nullptr : _ranges[(SLuint)i].node;
+}
+//-----------------------------------------------------------------------------
+/*! Converts the collected 32 bit indices to 16 bit indices if the batch has
+ less than 65535 vertices and calculates the min. and max. vertex.
+ */
+void SLMeshBatch::finalizeIndices()
+{
+    if (P.size() < 65535 && !I32.empty())
+    {
+        I16.resize(I32.size());
+        for (SLuint i = 0; i < I32.size(); ++i)
+            I16[i] = (SLushort)I32[i];
+        I32.clear();
+        I32.shrink_to_fit();
+    }
+
+    calcMinMax();
+}
+//-----------------------------------------------------------------------------
+/*! Merges the meshes of all static nodes below the root node into batches.
+ All candidate nodes with the same material, draw bits, shadow casting flag
+ and vertex attributes form one group. Groups with at least minNodes nodes get
+ merged into one SLMeshBatch in the object space of the root node. The source
+ nodes keep their transform and children but lose their mesh. The source
+ meshes stay in the asset manager because they can be used by other nodes.
+ Returns the NO. of created batches.
+ @param assetMgr Asset manager that will own the created batch meshes
+ @param root Root node of the static sub-graph
+ @param animManager Animation manager to check for animated nodes (optional)
+ @param minNodes Min. NO. of nodes to create a batch for
+ */
+SLuint SLMeshBatch::batchStaticNodes(SLAssetManager* assetMgr,
+                                     SLNode*         root,
+                                     SLAnimManager*  animManager,
+                                     SLuint          minNodes)
+{
+    assert(root && "No root node passed to batchStaticNodes");
+
+    // Animations of the root and above move the batches with the root node
+    SLVNode candidates;
+    for (auto* child : root->children())
+        collectBatchCandidatesRec(child, animManager, false, candidates);
+
+    // Group the candidates in the order they appear in the scene graph
+    typedef std::tuple<SLMaterial*, SLuint, SLbool, SLuint> SLBatchKey;
+    std::map<SLBatchKey, SLuint> groupIndices;
+    vector<vector<SLNode*>>      groups;
+
+    for (auto* node : candidates)
+    {
+        SLMesh*    mesh = node->mesh();
+        SLBatchKey key(mesh->mat(),
+                       node->drawBits()->bits(),
+                       node->castsShadows(),
+                       batchAttribMask(mesh));
+
+        auto it = groupIndices.find(key);
+        if (it == groupIndices.end())
+        {
+            groupIndices[key] = (SLuint)groups.size();
+            groups.push_back(vector<SLNode*>());
+            groups.back().push_back(node);
+        }
+        else
+            groups[it->second].push_back(node);
+    }
+
+    SLMat4f rootWMI    = root->updateAndGetWMI();
+    SLuint  numBatches = 0;
+
+    for (auto& group : groups)
+    {
+        if (group.size() < minNodes)
+            continue;
+
+        SLNode*     firstNode = group[0];
+        SLMaterial* mat       = firstNode->mesh()->mat();
+
+        auto* batch = new SLMeshBatch(assetMgr, "Batch " + mat->name());
+        batch->mat(mat);
+
+        for (auto* node : group)
+        {
+            SLMat4f m = rootWMI * node->updateAndGetWM();
+            batch->addMesh(node->mesh(), m, node->name(), node);
+            node->removeMesh();
+            node->needAABBUpdate();
+        }
+        batch->finalizeIndices();
+
+        auto* batchNode = new SLNode(batch, "Batch " + mat->name());
+        batchNode->drawBits()->bits(firstNode->drawBits()->bits());
+        batchNode->castsShadows(firstNode->castsShadows());
+        root->addChild(batchNode);
+        numBatches++;
+
+        SL_LOG("Batched %u nodes into %s (%u vertices, %u indices)",
+               (SLuint)group.size(),
+               batch->name().c_str(),
+               (SLuint)batch->P.size(),
+               batch->numI());
+    }
+
+    if (numBatches)
+    {
+        root->needAABBUpdate();
+        root->updateAABBRec(true);
+    }
+
+    return numBatches;
+}
+//-----------------------------------------------------------------------------
+/*! Draws only the index ranges whose bounding spheres are within the view
+ frustum. Adjacent visible ranges are drawn with one draw call.
+ */
+void SLMeshBatch::drawElements(SLSceneView*      sv,
+                               SLNode*           node,
+                               SLGLPrimitiveType primitiveType)
+{
+    SLCamera* cam = sv->camera();
+
+    if (!_doRangeCulling || !cam || _ranges.size() < 2)
+    {
+        _vao.drawElementsAs(primitiveType);
+        _numRangesDrawn = (SLuint)_ranges.size();
+        return;
+    }
+
+    // The radius of the spheres gets scaled with the max. scale of the node
+    const SLMat4f& wm    = node->updateAndGetWM();
+    SLfloat        scale = std::max(wm.axisX().length(),
+                                    std::max(wm.axisY().length(),
+                                             wm.axisZ().length()));
+
+    SLuint firstIndex = 0;
+    SLuint numIndices = 0;
+    _numRangesDrawn   = 0;
+
+    for (auto& range : _ranges)
+    {
+        if (cam->isInFrustum(wm.multVec(range.center), range.radius * scale))
+        {
+            if (numIndices == 0)
+                firstIndex = range.indexOffset;
+            numIndices += range.numIndices;
+            _numRangesDrawn++;
+        }
+        else if (numIndices)
+        {
+            _vao.drawElementsAs(primitiveType, numIndices, firstIndex);
+            numIndices = 0;
+        }
+    }
+
+    if (numIndices)
+        _vao.drawElementsAs(primitiveType, numIndices, firstIndex);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,89 @@
+//#############################################################################
+//  File:      SLMeshBatch.h
+//  Purpose:   Static mesh that merges the meshes of nodes with equal material
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMESHBATCH_H
+#define SLMESHBATCH_H
+
+#include <SLMesh.h>
+
+class SLAnimManager;
+
+//-----------------------------------------------------------------------------
+//! Contiguous range of indices of one source mesh within an SLMeshBatch
+struct SLMeshBatchRange
+{
+    SLstring name;        //!< Name of the source node
+    SLNode*  node;        //!< Source node that lost its mesh (nullptr if unknown)
+    SLuint   indexOffset; //!< Index of the first vertex index in I16 or I32
+    SLuint   numIndices;  //!< NO. of vertex indices of the range
+    SLuint   numVertices; //!< NO. of vertices of the range
+    SLVec3f  center;      //!< Center of the bounding sphere in OS of the batch
+    SLfloat  radius;      //!< Radius of the bounding sphere in OS of the batch
+};
+typedef vector<SLMeshBatchRange> SLVMeshBatchRange;
+//-----------------------------------------------------------------------------
+//! Triangle mesh that merges the meshes of static nodes into one mesh
+/*!
+Scenes that are imported from large assets (e.g. architectural models) often
+have thousands of small nodes that share only a few materials. Every node
+causes its own draw call with its own material activation and matrix uploads.
+SLMeshBatch::batchStaticNodes merges the meshes of all static nodes below a
+root node that share the same material, the same draw bits and the same
+vertex attributes into one SLMeshBatch. The vertices of the source meshes are
+transformed into the object space of the root node and the source nodes lose
+their mesh. The batches are added as new children to the root node.\n
+A node is static if neither the node itself nor any of its parents up to the
+root node is animated. Nodes of derived classes (e.g. lights, cameras), skinned
+meshes, meshes with blend shapes, hidden nodes and transparent materials are
+never merged.\n
+Every source mesh keeps its index range in SLMeshBatch::ranges together with
+a bounding sphere. In SLMeshBatch::drawElements the ranges outside the view
+frustum are culled and the adjacent visible ranges are drawn with one draw
+call so that the culling granularity of the source nodes is not lost.
+SLMeshBatch::sourceNode returns the source node of a hit triangle, so that
+picking selects the source node and not the whole batch.
+*/
+class SLMeshBatch : public SLMesh
+{
+public:
+    explicit SLMeshBatch(SLAssetManager* assetMgr,
+                         const SLstring& name = "Batched mesh");
+
+    void          addMesh(SLMesh*         mesh,
+                          const SLMat4f&  m,
+                          const SLstring& rangeName,
+                          SLNode*         srcNode = nullptr);
+    SLint         rangeIndex(SLuint index) const;
+    SLNode*       sourceNode(SLuint index) const;
+    void          finalizeIndices();
+    static SLuint batchStaticNodes(SLAssetManager* assetMgr,
+                                   SLNode*         root,
+                                   SLAnimManager*  animManager,
+                                   SLuint          minNodes = 2);
+
+    // Getters
+    const SLVMeshBatchRange& ranges() const { return _ranges; }
+    SLbool                   doRangeCulling() const { return _doRangeCulling; }
+    SLuint                   numRangesDrawn() const { return _numRangesDrawn; }
+
+    // Setters
+    void doRangeCulling(SLbool doRC) { _doRangeCulling = doRC; }
+
+protected:
+    void drawElements(SLSceneView*      sv,
+                      SLNode*           node,
+                      SLGLPrimitiveType primitiveType) override;
+
+private:
+    SLVMeshBatchRange _ranges;         //!< Index ranges of the merged meshes
+    SLbool            _doRangeCulling; //!< Flag for frustum culling of the ranges
+    SLuint            _numRangesDrawn; //!< NO. of ranges drawn in the last draw call
+};
+//-----------------------------------------------------------------------------
+#endif // SLMESHBATCH_H
@@ -0,0 +1,372 @@
+//#############################################################################
+//  File:      SLMeshOptimizer.cpp
+//  Purpose:   Index & vertex reordering algorithms for triangle meshes
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <algorithm>
+#include <SLMeshOptimizer.h>
+
+//-----------------------------------------------------------------------------
+//! Max. cache size for the scoring in optimizeVertexCache
+static const SLint FORSYTH_CACHE_SIZE = 32;
+//-----------------------------------------------------------------------------
+const SLuint SLMeshOptimizer::INVALID_INDEX;
+//-----------------------------------------------------------------------------
+//! Vertex score of Tom Forsyth's linear speed vertex cache optimization
+/*! A vertex scores high if it was used by the last triangle (but not too
+high so that the same triangle strip direction is continued) or if it is high
+in the cache. Vertices with only a few remaining triangles get a boost so that
+no lonely triangles are left behind.
+ */
+static SLfloat forsythVertexScore(SLint cachePos, SLuint numLiveTris)
+{
+    if (numLiveTris == 0)
+        return -1.0f;
+
+    SLfloat score = 0.0f;
+    if (cachePos >= 0)
+    {
+        if (cachePos < 3)
+            score = 0.75f;
+        else
+        {
+            const SLfloat scaler = 1.0f / (SLfloat)(FORSYTH_CACHE_SIZE - 3);
+            score                = powf(1.0f - (SLfloat)(cachePos - 3) * scaler, 1.5f);
+        }
+    }
+
+    score += 2.0f * powf((SLfloat)numLiveTris, -0.5f);
+    return score;
+}
+//-----------------------------------------------------------------------------
+/*! Reorders the triangles of an indexed triangle list for the post-transform
+ vertex cache of the GPU with Tom Forsyth's algorithm. See:
+ https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+ The triangle with the highest score of all triangles that use a vertex in the
+ simulated LRU cache is emitted next. If no such triangle exists the next not
+ yet emitted triangle in the input order is taken.
+ */
+void SLMeshOptimizer::optimizeVertexCache(SLVuint& indices,
+                                          SLuint   numVertices)
+{
+    SLuint numTris = (SLuint)indices.size() / 3;
+    if (numTris < 2)
+        return;
+
+    // Build vertex to triangle adjacency in one flat array
+    SLVuint numLiveTris(numVertices, 0);
+    for (SLuint i : indices)
+        numLiveTris[i]++;
+
+    SLVuint triOffsets(numVertices + 1, 0);
+    for (SLuint v = 0; v < numVertices; ++v)
+        triOffsets[v + 1] = triOffsets[v] + numLiveTris[v];
+
+    SLVuint triList(indices.size());
+    SLVuint fill(triOffsets.begin(), triOffsets.end() - 1);
+    for (SLuint t = 0; t < numTris; ++t)
+        for (SLuint k = 0; k < 3; ++k)
+            triList[fill[indices[t * 3 + k]]++] = t;
+
+    // Initial scores
+    vector<SLint>   cachePos(numVertices, -1);
+    vector<SLfloat> vertexScore(numVertices);
+    vector<SLfloat> triScore(numTris, 0.0f);
+    vector<SLbool>  isEmitted(numTris, false);
+
+    for (SLuint v = 0; v < numVertices; ++v)
+        vertexScore[v] = forsythVertexScore(-1, numLiveTris[v]);
+
+    for (SLuint t = 0; t < numTris; ++t)
+        for (SLuint k = 0; k < 3; ++k)
+            triScore[t] += vertexScore[indices[t * 3 + k]];
+
+    SLVuint cache, newCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    SLVuint output;
+    output.reserve(indices.size());
+
+    SLuint inputCursor = 0;
+    SLint  bestTri     = 0;
+
+    for (SLuint numEmitted = 0; numEmitted < numTris; ++numEmitted)
+    {
+        // Take the next triangle in input order if no candidate was found
+        if (bestTri < 0)
+        {
+            while (isEmitted[inputCursor])
+                inputCursor++;
+            bestTri = (SLint)inputCursor;
+        }
+
+        SLuint t     = (SLuint)bestTri;
+        isEmitted[t] = true;
+
+        // Emit the triangle and remove it from the live triangles of its vertices
+        newCache.clear();
+        for (SLuint k = 0; k < 3; ++k)
+        {
+            SLuint v = indices[t * 3 + k];
+            output.push_back(v);
+            newCache.push_back(v);
+
+            SLuint begin = triOffsets[v];
+            SLuint end   = begin + numLiveTris[v];
+            for (SLuint i = begin; i < end; ++i)
+            {
+                if (triList[i] == t)
+                {
+                    std::swap(triList[i], triList[end - 1]);
+                    break;
+                }
+            }
+            numLiveTris[v]--;
+        }
+
+        // Move the vertices of the triangle to the front of the LRU cache
+        for (SLuint v : cache)
+            if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+                newCache.push_back(v);
+
+        // Update the cache positions and the scores of the affected vertices
+        for (SLuint i = 0; i < (SLuint)newCache.size(); ++i)
+        {
+            SLuint v    = newCache[i];
+            cachePos[v] = i < (SLuint)FORSYTH_CACHE_SIZE ? (SLint)i : -1;
+        }
+
+        bestTri           = -1;
+        SLfloat bestScore = -1.0f;
+        for (SLuint v : newCache)
+        {
+            SLfloat newScore = forsythVertexScore(cachePos[v], numLiveTris[v]);
+            SLfloat delta    = newScore - vertexScore[v];
+            vertexScore[v]   = newScore;
+
+            SLuint begin = triOffsets[v];
+            SLuint end   = begin + numLiveTris[v];
+            for (SLuint i = begin; i < end; ++i)
+            {
+                SLuint lt = triList[i];
+                triScore[lt] += delta;
+                if (triScore[lt] > bestScore)
+                {
+                    bestScore = triScore[lt];
+                    bestTri   = (SLint)lt;
+                }
+            }
+        }
+
+        // Vertices that fell out of the cache are no longer tracked
+        if (newCache.size() > (SLuint)FORSYTH_CACHE_SIZE)
+            newCache.resize(FORSYTH_CACHE_SIZE);
+        std::swap(cache, newCache);
+    }
+
+    indices.swap(output);
+}
+//-----------------------------------------------------------------------------
+/*! Reorders clusters of triangles so that the clusters facing to the outside
+ of the mesh are drawn first. The indices must be vertex cache optimized. The
+ triangle sequence is first split at all positions where the simulated FIFO
+ cache misses all 3 vertices (hard boundaries). Each of these clusters is
+ split again where the ACMR of the sub-cluster is not worse than threshold
+ times the ACMR of the whole cluster. The clusters are then sorted by the dot
+ product of their average normal and the vector from the mesh centroid to the
+ cluster centroid in descending order.
+ */
+void SLMeshOptimizer::optimizeOverdraw(SLVuint&        indices,
+                                       const SLVVec3f& positions,
+                                       SLfloat         threshold)
+{
+    SLuint numTris = (SLuint)indices.size() / 3;
+    if (numTris < 2)
+        return;
+
+    const SLuint cacheSize   = 16;
+    SLuint       numVertices = (SLuint)positions.size();
+    SLVuint      timestamps(numVertices, 0);
+    SLuint       time = cacheSize + 1;
+
+    // Simulates a FIFO cache with timestamps and returns the NO. of misses
+    auto simulateTri = [&](SLuint t) -> SLuint
+    {
+        SLuint misses = 0;
+        for (SLuint k = 0; k < 3; ++k)
+        {
+            SLuint v = indices[t * 3 + k];
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    };
+
+    auto resetCache = [&]()
+    {
+        time += cacheSize + 1;
+    };
+
+    // 1) Hard boundaries where the cache misses all 3 vertices. The first
+    // triangle always starts a cluster, even if it is degenerated.
+    SLVuint hardBounds;
+    hardBounds.push_back(0);
+    for (SLuint t = 0; t < numTris; ++t)
+        if (simulateTri(t) == 3 && t > 0)
+            hardBounds.push_back(t);
+    hardBounds.push_back(numTris);
+
+    // 2) Soft boundaries within the hard clusters
+    SLVuint clusters;
+    for (SLuint c = 0; c + 1 < (SLuint)hardBounds.size(); ++c)
+    {
+        SLuint start = hardBounds[c];
+        SLuint end   = hardBounds[c + 1];
+
+        resetCache();
+        SLuint clusterMisses = 0;
+        for (SLuint t = start; t < end; ++t)
+            clusterMisses += simulateTri(t);
+        SLfloat clusterThreshold = threshold * (SLfloat)clusterMisses / (SLfloat)(end - start);
+
+        clusters.push_back(start);
+        resetCache();
+        SLuint misses = 0;
+        SLuint first  = start;
+        for (SLuint t = start; t < end; ++t)
+        {
+            misses += simulateTri(t);
+            if (t + 1 < end &&
+                (SLfloat)misses / (SLfloat)(t - first + 1) <= clusterThreshold)
+            {
+                clusters.push_back(t + 1);
+                resetCache();
+                misses = 0;
+                first  = t + 1;
+            }
+        }
+    }
+    clusters.push_back(numTris);
+
+    // 3) Mesh centroid weighted by the triangle areas
+    SLVec3f meshCentroid = SLVec3f::ZERO;
+    SLfloat meshArea     = 0.0f;
+    for (SLuint t = 0; t < numTris; ++t)
+    {
+        const SLVec3f& p0   = positions[indices[t * 3]];
+        const SLVec3f& p1   = positions[indices[t * 3 + 1]];
+        const SLVec3f& p2   = positions[indices[t * 3 + 2]];
+        SLfloat        area = ((p1 - p0) ^ (p2 - p0)).length();
+        meshCentroid += (p0 + p1 + p2) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    // 4) Sort key of the clusters
+    SLuint          numClusters = (SLuint)clusters.size() - 1;
+    vector<SLfloat> sortKeys(numClusters);
+    for (SLuint c = 0; c < numClusters; ++c)
+    {
+        SLVec3f centroid = SLVec3f::ZERO;
+        SLVec3f normal   = SLVec3f::ZERO;
+        SLfloat area     = 0.0f;
+
+        for (SLuint t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const SLVec3f& p0 = positions[indices[t * 3]];
+            const SLVec3f& p1 = positions[indices[t * 3 + 1]];
+            const SLVec3f& p2 = positions[indices[t * 3 + 2]];
+            SLVec3f        n  = (p1 - p0) ^ (p2 - p0);
+            SLfloat        a  = n.length();
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+
+        if (area > 0.0f)
+            centroid /= area;
+        if (normal.length() > 0.0f)
+            normal.normalize();
+        sortKeys[c] = (centroid - meshCentroid).dot(normal);
+    }
+
+    SLVuint order(numClusters);
+    for (SLuint c = 0; c < numClusters; ++c)
+        order[c] = c;
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&](SLuint a, SLuint b)
+                     { return sortKeys[a] > sortKeys[b]; });
+
+    // 5) Copy the clusters in the sorted order
+    SLVuint output;
+    output.reserve(indices.size());
+    for (SLuint c : order)
+        output.insert(output.end(),
+                      indices.begin() + clusters[c] * 3,
+                      indices.begin() + clusters[c + 1] * 3);
+
+    indices.swap(output);
+}
+//-----------------------------------------------------------------------------
+/*! Builds a remap table from the old to the new vertex index so that the
+ vertices are in the order of their first usage in the indices. The indices
+ themselves are not changed. Unused vertices get SLMeshOptimizer::INVALID_INDEX.
+ Returns the NO. of used vertices.
+ */
+SLuint SLMeshOptimizer::buildFetchRemap(const SLVuint& indices,
+                                        SLuint         numVertices,
+                                        SLVuint&       remap)
+{
+    remap.assign(numVertices, INVALID_INDEX);
+
+    SLuint numUsed = 0;
+    for (SLuint i : indices)
+        if (remap[i] == INVALID_INDEX)
+            remap[i] = numUsed++;
+
+    return numUsed;
+}
+//-----------------------------------------------------------------------------
+//! Returns the NO. of misses of a simulated FIFO vertex cache
+SLuint SLMeshOptimizer::calcCacheMisses(const SLVuint& indices,
+                                        SLuint         numVertices,
+                                        SLuint         cacheSize)
+{
+    SLVuint timestamps(numVertices, 0);
+    SLuint  time   = cacheSize + 1;
+    SLuint  misses = 0;
+
+    for (SLuint v : indices)
+    {
+        if (time - timestamps[v] > cacheSize)
+        {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+
+    return misses;
+}
+//-----------------------------------------------------------------------------
+//! Returns the average cache miss ratio (misses per triangle)
+SLfloat SLMeshOptimizer::calcACMR(const SLVuint& indices,
+                                  SLuint         numVertices,
+                                  SLuint         cacheSize)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    SLuint misses = calcCacheMisses(indices, numVertices, cacheSize);
+    return (SLfloat)misses / (SLfloat)(indices.size() / 3);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+//#############################################################################
+//  File:      SLMeshOptimizer.h
+//  Purpose:   Index & vertex reordering algorithms for triangle meshes
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMESHOPTIMIZER_H
+#define SLMESHOPTIMIZER_H
+
+#include <SL.h>
+#include <SLVec3.h>
+
+//-----------------------------------------------------------------------------
+//! Static index & vertex reordering algorithms used by SLMesh::optimize
+/*!
+All algorithms work on triangle lists with 32 bit indices:
+\n - SLMeshOptimizer::optimizeVertexCache reorders the triangles for a better
+post-transform vertex cache hit rate with the linear speed algorithm of
+Tom Forsyth.
+\n - SLMeshOptimizer::optimizeOverdraw splits the cache optimized triangles
+into clusters and sorts them front to back from the outside of the mesh so
+that the early depth test can reject more fragments. The clusters are only
+split where the vertex cache efficiency degrades by less than a threshold.
+This follows the approach of Sander et al. "Fast Triangle Reordering for
+Vertex Locality and Reduced Overdraw" (2007).
+\n - SLMeshOptimizer::buildFetchRemap builds a vertex remap table in the order
+of the first usage by the indices so that the vertex fetch is sequential.
+\n - SLMeshOptimizer::calcCacheMisses simulates a FIFO vertex cache. The
+average cache miss ratio (ACMR) is the NO. of misses per triangle. It is 3.0
+in the worst case and about 0.5-0.7 for well ordered regular meshes.
+*/
+class SLMeshOptimizer
+{
+public:
+    static void   optimizeVertexCache(SLVuint& indices,
+                                      SLuint   numVertices);
+    static void   optimizeOverdraw(SLVuint&        indices,
+                                   const SLVVec3f& positions,
+                                   SLfloat         threshold = 1.05f);
+    static SLuint buildFetchRemap(const SLVuint& indices,
+                                  SLuint         numVertices,
+                                  SLVuint&       remap);
+    static SLuint calcCacheMisses(const SLVuint& indices,
+                                  SLuint         numVertices,
+                                  SLuint         cacheSize = 16);
+    static SLfloat calcACMR(const SLVuint& indices,
+                            SLuint         numVertices,
+                            SLuint         cacheSize = 16);
+
+    static const SLuint INVALID_INDEX = 0xFFFFFFFF; //!< Remap value of removed vertices
+};
+//-----------------------------------------------------------------------------
+#endif // SLMESHOPTIMIZER_H
@@ -0,0 +1,520 @@
+//#############################################################################
+//  File:      SLParticleSimulatorCPU.cpp
+//  Purpose:   CPU particle update with a SoA particle pool and SIMD kernels
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <SLParticleSimulatorCPU.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define SL_PARTICLE_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define SL_PARTICLE_SIMD_NEON
+#endif
+
+//-----------------------------------------------------------------------------
+// Minimal 4-wide float wrappers so that the kernel is written only once.
+// Comparisons return a mask with all bits set in the lanes that are true.
+#if defined(SL_PARTICLE_SIMD_SSE2)
+typedef __m128 SLfloat4;
+static inline SLfloat4 load4(const SLfloat* p) { return _mm_loadu_ps(p); }
+static inline void     store4(SLfloat* p, SLfloat4 a) { _mm_storeu_ps(p, a); }
+static inline SLfloat4 set4(SLfloat f) { return _mm_set1_ps(f); }
+static inline SLfloat4 add4(SLfloat4 a, SLfloat4 b) { return _mm_add_ps(a, b); }
+static inline SLfloat4 sub4(SLfloat4 a, SLfloat4 b) { return _mm_sub_ps(a, b); }
+static inline SLfloat4 mul4(SLfloat4 a, SLfloat4 b) { return _mm_mul_ps(a, b); }
+static inline SLfloat4 greaterEqual4(SLfloat4 a, SLfloat4 b) { return _mm_cmpge_ps(a, b); }
+static inline SLfloat4 greater4(SLfloat4 a, SLfloat4 b) { return _mm_cmpgt_ps(a, b); }
+static inline SLfloat4 and4(SLfloat4 a, SLfloat4 b) { return _mm_and_ps(a, b); }
+static inline SLfloat4 andNot4(SLfloat4 a, SLfloat4 b) { return _mm_andnot_ps(b, a); }
+static inline SLfloat4 select4(SLfloat4 mask, SLfloat4 a, SLfloat4 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+static inline SLint maskBits4(SLfloat4 mask) { return _mm_movemask_ps(mask); }
+#elif defined(SL_PARTICLE_SIMD_NEON)
+typedef float32x4_t SLfloat4;
+static inline SLfloat4 load4(const SLfloat* p) { return vld1q_f32(p); }
+static inline void     store4(SLfloat* p, SLfloat4 a) { vst1q_f32(p, a); }
+static inline SLfloat4 set4(SLfloat f) { return vdupq_n_f32(f); }
+static inline SLfloat4 add4(SLfloat4 a, SLfloat4 b) { return vaddq_f32(a, b); }
+static inline SLfloat4 sub4(SLfloat4 a, SLfloat4 b) { return vsubq_f32(a, b); }
+static inline SLfloat4 mul4(SLfloat4 a, SLfloat4 b) { return vmulq_f32(a, b); }
+static inline SLfloat4 greaterEqual4(SLfloat4 a, SLfloat4 b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+static inline SLfloat4 greater4(SLfloat4 a, SLfloat4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+static inline SLfloat4 and4(SLfloat4 a, SLfloat4 b)
+{
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a),
+                                           vreinterpretq_u32_f32(b)));
+}
+static inline SLfloat4 andNot4(SLfloat4 a, SLfloat4 b)
+{
+    return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a),
+                                           vreinterpretq_u32_f32(b)));
+}
+static inline SLfloat4 select4(SLfloat4 mask, SLfloat4 a, SLfloat4 b)
+{
+    return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+}
+static inline SLint maskBits4(SLfloat4 mask)
+{
+    uint32x4_t m = vreinterpretq_u32_f32(mask);
+    return (SLint)((vgetq_lane_u32(m, 0) & 1) |
+                   (vgetq_lane_u32(m, 1) & 2) |
+                   (vgetq_lane_u32(m, 2) & 4) |
+                   (vgetq_lane_u32(m, 3) & 8));
+}
+#endif
+//-----------------------------------------------------------------------------
+//! Persistent worker threads shared by all CPU particle simulators
+/*!
+The threads are created on the first parallel update and wait on a condition
+variable between the frames, so no thread gets created per simulation step.
+SLParticleWorkerPool::parallelFor runs the tasks on the workers and on the
+calling thread. Calls from several threads are serialized.
+*/
+class SLParticleWorkerPool
+{
+public:
+    explicit SLParticleWorkerPool(SLuint numThreads)
+    {
+        for (SLuint i = 1; i < numThreads; ++i)
+            _threads.emplace_back(&SLParticleWorkerPool::run, this);
+    }
+
+    ~SLParticleWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wakeUpCondVar.notify_all();
+        for (auto& thread : _threads)
+            thread.join();
+    }
+
+    //! Calls task(i) for i = 0 to numTasks-1 in parallel and waits for the end
+    void parallelFor(SLuint numTasks, const std::function<void(SLuint)>& task)
+    {
+        if (_threads.empty() || numTasks < 2)
+        {
+            for (SLuint i = 0; i < numTasks; ++i)
+                task(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> callLock(_callMutex);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task     = &task;
+            _numTasks = numTasks;
+            _nextTask = 0;
+            _numBusy  = (SLuint)_threads.size();
+            _generation++;
+        }
+        _wakeUpCondVar.notify_all();
+
+        work(); // the calling thread works as well
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _doneCondVar.wait(lock, [this] { return _numBusy == 0; });
+        _task = nullptr;
+    }
+
+    //! Pool with the max. NO. of threads that is created on the first call
+    static SLParticleWorkerPool& instance()
+    {
+        static SLParticleWorkerPool pool(Utils::maxThreads());
+        return pool;
+    }
+
+private:
+    void work()
+    {
+        SLuint i;
+        while ((i = _nextTask.fetch_add(1)) < _numTasks)
+            (*_task)(i);
+    }
+
+    void run()
+    {
+        unsigned long generation = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeUpCondVar.wait(lock, [&] { return _stop || _generation != generation; });
+                if (_stop)
+                    return;
+                generation = _generation;
+            }
+
+            work();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_numBusy == 0)
+                _doneCondVar.notify_one();
+        }
+    }
+
+    vector<std::thread>                _threads;             //!< Worker threads
+    std::mutex                         _callMutex;           //!< Serializes the calls of parallelFor
+    std::mutex                         _mutex;               //!< Mutex for the members below
+    std::condition_variable            _wakeUpCondVar;       //!< Wakes up the workers for a new loop
+    std::condition_variable            _doneCondVar;         //!< Signals the end of a loop
+    const std::function<void(SLuint)>* _task       = nullptr; //!< Task of the current loop
+    SLuint                             _numTasks   = 0;       //!< NO. of tasks of the current loop
+    std::atomic<SLuint>                _nextTask{0};          //!< Index of the next task to run
+    SLuint                             _numBusy    = 0;       //!< NO. of workers in the current loop
+    unsigned long                      _generation = 0;       //!< Counter of the loops
+    SLbool                             _stop       = false;   //!< Flag to end the worker threads
+};
+//-----------------------------------------------------------------------------
+//! Returns the name of the SIMD instruction set used by the update kernel
+const char* SLParticleSimulatorCPU::simdName()
+{
+#if defined(SL_PARTICLE_SIMD_SSE2)
+    return "SSE2";
+#elif defined(SL_PARTICLE_SIMD_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+//-----------------------------------------------------------------------------
+//! Removes all particles
+void SLParticleSimulatorCPU::clear()
+{
+    _px.clear();
+    _py.clear();
+    _pz.clear();
+    _vx.clear();
+    _vy.clear();
+    _vz.clear();
+    _startTime.clear();
+    _ivx.clear();
+    _ivy.clear();
+    _ivz.clear();
+    _ipx.clear();
+    _ipy.clear();
+    _ipz.clear();
+    _rotation.clear();
+    _angularVelo.clear();
+    _texNum.clear();
+    _P.clear();
+}
+//-----------------------------------------------------------------------------
+/*! Copies the generated particle attributes into the SoA pool. The optional
+ attributes (initial velocities, rotations, angular velocities, flipbook
+ numbers and initial positions) are passed as empty vectors if the particle
+ system does not use them. Their absence switches off the according part of
+ the update.
+ */
+void SLParticleSimulatorCPU::init(const SLVVec3f& positions,
+                                  const SLVVec3f& velocities,
+                                  const SLVfloat& startTimes,
+                                  const SLVVec3f& initVelocities,
+                                  const SLVfloat& rotations,
+                                  const SLVfloat& angularVelos,
+                                  const SLVuint&  texNums,
+                                  const SLVVec3f& initPositions)
+{
+    assert(positions.size() == velocities.size() &&
+           positions.size() == startTimes.size());
+
+    clear();
+
+    for (auto& p : positions)
+    {
+        _px.push_back(p.x);
+        _py.push_back(p.y);
+        _pz.push_back(p.z);
+    }
+    for (auto& v : velocities)
+    {
+        _vx.push_back(v.x);
+        _vy.push_back(v.y);
+        _vz.push_back(v.z);
+    }
+    for (auto& v : initVelocities)
+    {
+        _ivx.push_back(v.x);
+        _ivy.push_back(v.y);
+        _ivz.push_back(v.z);
+    }
+    for (auto& p : initPositions)
+    {
+        _ipx.push_back(p.x);
+        _ipy.push_back(p.y);
+        _ipz.push_back(p.z);
+    }
+
+    _startTime   = startTimes;
+    _rotation    = rotations;
+    _angularVelo = angularVelos;
+    _texNum      = texNums;
+    _P           = positions;
+}
+//-----------------------------------------------------------------------------
+/*! Updates all particles for one frame. With more than one thread the
+ particles are split into blocks of multiples of 4 particles. The blocks are
+ updated on the persistent threads of SLParticleWorkerPool and on the calling
+ thread.
+ */
+void SLParticleSimulatorCPU::update(const SLParticleUpdateParams& params,
+                                    SLuint                        numThreads)
+{
+    SLuint numP = numParticles();
+    if (!numP)
+        return;
+
+    numThreads = std::max(1u, std::min(numThreads, numP / minParticlesPerThread));
+
+    if (numThreads == 1)
+    {
+        updateRange(params, 0, numP);
+        return;
+    }
+
+    SLuint numBlocks       = (numP + 3) / 4;
+    SLuint blocksPerThread = numBlocks / numThreads;
+
+    // The last block gets the rest of the particles
+    SLParticleWorkerPool::instance().parallelFor(numThreads, [&](SLuint t) {
+        SLuint first = t * blocksPerThread * 4;
+        SLuint last  = t + 1 < numThreads ? first + blocksPerThread * 4 : numP;
+        updateRange(params, first, last);
+    });
+}
+//-----------------------------------------------------------------------------
+/*! Updates the particles from index first to last (exclusive). The blocks of
+ 4 particles are updated with the SIMD kernel and the remaining particles at
+ the end with the scalar kernel. Both kernels execute the same floating point
+ operations in the same order.
+ */
+void SLParticleSimulatorCPU::updateRange(const SLParticleUpdateParams& params,
+                                         SLuint                        first,
+                                         SLuint                        last)
+{
+    SLuint i = first;
+
+#if defined(SL_PARTICLE_SIMD_SSE2) || defined(SL_PARTICLE_SIMD_NEON)
+    const SLbool hasShape      = !_ipx.empty();
+    const SLbool hasInitV      = !_ivx.empty();
+    const SLbool doAccConst    = params.doAcc && !params.doAccDiffDir && hasInitV;
+    const SLbool doAccDiffDir  = params.doAcc && params.doAccDiffDir;
+    const SLbool doVelocity    = doAccConst || doAccDiffDir || params.doGravity || hasInitV;
+    const SLbool doRotOrTexNum = !_rotation.empty() || (!_texNum.empty() && params.doFBStep);
+
+    const SLfloat4 t   = set4(params.time);
+    const SLfloat4 dt  = set4(params.deltaTime);
+    const SLfloat4 dif = set4(params.difTime);
+    const SLfloat4 ttl = set4(params.timeToLive);
+    const SLfloat4 ex  = set4(params.emitterPos.x);
+    const SLfloat4 ey  = set4(params.emitterPos.y);
+    const SLfloat4 ez  = set4(params.emitterPos.z);
+    const SLfloat4 ax  = set4(params.acceleration.x);
+    const SLfloat4 ay  = set4(params.acceleration.y);
+    const SLfloat4 az  = set4(params.acceleration.z);
+    const SLfloat4 gx  = set4(params.gravity.x);
+    const SLfloat4 gy  = set4(params.gravity.y);
+    const SLfloat4 gz  = set4(params.gravity.z);
+    const SLfloat4 acc = set4(params.accConst);
+
+    for (; i + 4 <= last; i += 4)
+    {
+        SLfloat4 st      = add4(load4(&_startTime[i]), dif);
+        SLfloat4 age     = sub4(t, st);
+        SLfloat4 isBorn  = greaterEqual4(t, st);
+        SLfloat4 isDead  = and4(isBorn, greater4(age, ttl));
+        SLfloat4 isAlive = andNot4(isBorn, isDead);
+
+        // Unborn particles only get the time difference
+        if (!maskBits4(isBorn))
+        {
+            store4(&_startTime[i], st);
+            continue;
+        }
+
+        // Positions: Restart dead particles and move living ones
+        SLfloat4 px = load4(&_px[i]);
+        SLfloat4 py = load4(&_py[i]);
+        SLfloat4 pz = load4(&_pz[i]);
+        SLfloat4 vx = load4(&_vx[i]);
+        SLfloat4 vy = load4(&_vy[i]);
+        SLfloat4 vz = load4(&_vz[i]);
+
+        SLfloat4 rx = hasShape ? add4(load4(&_ipx[i]), ex) : ex;
+        SLfloat4 ry = hasShape ? add4(load4(&_ipy[i]), ey) : ey;
+        SLfloat4 rz = hasShape ? add4(load4(&_ipz[i]), ez) : ez;
+
+        px = select4(isDead, rx, select4(isAlive, add4(px, mul4(vx, dt)), px));
+        py = select4(isDead, ry, select4(isAlive, add4(py, mul4(vy, dt)), py));
+        pz = select4(isDead, rz, select4(isAlive, add4(pz, mul4(vz, dt)), pz));
+        store4(&_px[i], px);
+        store4(&_py[i], py);
+        store4(&_pz[i], pz);
+
+        // Velocities: Reset dead particles and accelerate living ones
+        if (doVelocity)
+        {
+            SLfloat4 nvx = vx;
+            SLfloat4 nvy = vy;
+            SLfloat4 nvz = vz;
+
+            if (doAccConst)
+            {
+                nvx = add4(nvx, mul4(mul4(load4(&_ivx[i]), dt), acc));
+                nvy = add4(nvy, mul4(mul4(load4(&_ivy[i]), dt), acc));
+                nvz = add4(nvz, mul4(mul4(load4(&_ivz[i]), dt), acc));
+            }
+            else if (doAccDiffDir)
+            {
+                nvx = add4(nvx, mul4(dt, ax));
+                nvy = add4(nvy, mul4(dt, ay));
+                nvz = add4(nvz, mul4(dt, az));
+            }
+
+            if (params.doGravity)
+            {
+                nvx = add4(nvx, mul4(dt, gx));
+                nvy = add4(nvy, mul4(dt, gy));
+                nvz = add4(nvz, mul4(dt, gz));
+            }
+
+            vx = select4(isAlive, nvx, vx);
+            vy = select4(isAlive, nvy, vy);
+            vz = select4(isAlive, nvz, vz);
+
+            if (hasInitV)
+            {
+                vx = select4(isDead, load4(&_ivx[i]), vx);
+                vy = select4(isDead, load4(&_ivy[i]), vy);
+                vz = select4(isDead, load4(&_ivz[i]), vz);
+            }
+
+            store4(&_vx[i], vx);
+            store4(&_vy[i], vy);
+            store4(&_vz[i], vz);
+        }
+
+        // Start times: Restart dead particles
+        SLfloat4 stReset = params.doCounterGap ? add4(t, sub4(age, ttl)) : t;
+        store4(&_startTime[i], select4(isDead, stReset, st));
+
+        // Rotation and flipbook number are rarely used and stay scalar
+        if (doRotOrTexNum)
+        {
+            SLint aliveBits = maskBits4(isAlive);
+            for (SLuint k = 0; k < 4; ++k)
+                if (aliveBits & (1 << k))
+                    updateRotationAndTexNum(params, i + k);
+        }
+
+        for (SLuint k = 0; k < 4; ++k)
+            _P[i + k].set(_px[i + k], _py[i + k], _pz[i + k]);
+    }
+#endif
+
+    for (; i < last; ++i)
+    {
+        updateParticle(params, i);
+        _P[i].set(_px[i], _py[i], _pz[i]);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Scalar update of a single particle (see SLGLProgramGenerated)
+void SLParticleSimulatorCPU::updateParticle(const SLParticleUpdateParams& params,
+                                            SLuint                        i)
+{
+    SLfloat st = _startTime[i] + params.difTime;
+
+    if (params.time >= st)
+    {
+        SLfloat age = params.time - st;
+
+        if (age > params.timeToLive)
+        {
+            // The particle is past its lifetime, recycle.
+            if (_ipx.empty())
+            {
+                _px[i] = params.emitterPos.x;
+                _py[i] = params.emitterPos.y;
+                _pz[i] = params.emitterPos.z;
+            }
+            else
+            {
+                _px[i] = _ipx[i] + params.emitterPos.x;
+                _py[i] = _ipy[i] + params.emitterPos.y;
+                _pz[i] = _ipz[i] + params.emitterPos.z;
+            }
+
+            if (!_ivx.empty())
+            {
+                _vx[i] = _ivx[i];
+                _vy[i] = _ivy[i];
+                _vz[i] = _ivz[i];
+            }
+
+            st = params.doCounterGap ? params.time + (age - params.timeToLive) : params.time;
+        }
+        else
+        {
+            // The particle is alive, update.
+            _px[i] = _px[i] + _vx[i] * params.deltaTime;
+            _py[i] = _py[i] + _vy[i] * params.deltaTime;
+            _pz[i] = _pz[i] + _vz[i] * params.deltaTime;
+
+            updateRotationAndTexNum(params, i);
+
+            if (params.doAcc && !params.doAccDiffDir && !_ivx.empty())
+            {
+                _vx[i] = _vx[i] + _ivx[i] * params.deltaTime * params.accConst;
+                _vy[i] = _vy[i] + _ivy[i] * params.deltaTime * params.accConst;
+                _vz[i] = _vz[i] + _ivz[i] * params.deltaTime * params.accConst;
+            }
+            else if (params.doAcc && params.doAccDiffDir)
+            {
+                _vx[i] = _vx[i] + params.deltaTime * params.acceleration.x;
+                _vy[i] = _vy[i] + params.deltaTime * params.acceleration.y;
+                _vz[i] = _vz[i] + params.deltaTime * params.acceleration.z;
+            }
+
+            if (params.doGravity)
+            {
+                _vx[i] = _vx[i] + params.deltaTime * params.gravity.x;
+                _vy[i] = _vy[i] + params.deltaTime * params.gravity.y;
+                _vz[i] = _vz[i] + params.deltaTime * params.gravity.z;
+            }
+        }
+    }
+
+    _startTime[i] = st;
+}
+//-----------------------------------------------------------------------------
+//! Updates the rotation angle and the flipbook number of a living particle
+void SLParticleSimulatorCPU::updateRotationAndTexNum(const SLParticleUpdateParams& params,
+                                                     SLuint                        i)
+{
+    if (!_rotation.empty())
+    {
+        SLfloat angularVelo = _angularVelo.empty() ? params.angularVelo : _angularVelo[i];
+        SLfloat r           = _rotation[i] + angularVelo * params.deltaTime;
+        _rotation[i]        = r - Utils::TWOPI * std::floor(r / Utils::TWOPI); // GLSL mod
+    }
+
+    if (!_texNum.empty() && params.doFBStep)
+        _texNum[i] = (_texNum[i] + 1) % std::max(1u, params.numFBImages);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+//#############################################################################
+//  File:      SLParticleSimulatorCPU.h
+//  Purpose:   CPU particle update with a SoA particle pool and SIMD kernels
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLPARTICLESIMULATORCPU_H
+#define SLPARTICLESIMULATORCPU_H
+
+#include <SL.h>
+#include <SLVec3.h>
+
+//-----------------------------------------------------------------------------
+//! Per frame parameters of the particle update (same as the TF uniforms)
+struct SLParticleUpdateParams
+{
+    SLfloat time         = 0.0f;            //!< Time since process start in S (u_time)
+    SLfloat deltaTime    = 0.0f;            //!< Time between two updates in S (u_deltaTime)
+    SLfloat difTime      = 0.0f;            //!< Time to add after culling or pause in S (u_difTime)
+    SLfloat timeToLive   = 1.0f;            //!< Time to live of a particle in S (u_tTL)
+    SLVec3f emitterPos   = SLVec3f::ZERO;   //!< Position where dead particles restart (u_pGPosition)
+    SLVec3f acceleration = SLVec3f::ZERO;   //!< Acceleration in different direction (u_acceleration)
+    SLfloat accConst     = 0.0f;            //!< Acceleration along the initial velocity (u_accConst)
+    SLVec3f gravity      = SLVec3f::ZERO;   //!< Gravity vector (u_gravity)
+    SLfloat angularVelo  = 0.0f;            //!< Const. angular velocity in rad/S (u_angularVelo)
+    SLuint  numFBImages  = 1;               //!< NO. of flipbook images (u_col * u_row)
+    SLbool  doFBStep     = false;           //!< Flag if the flipbook image advances (u_condFB)
+    SLbool  doCounterGap = true;            //!< Flag for counter lag/gap at restart
+    SLbool  doAcc        = false;           //!< Flag for acceleration
+    SLbool  doAccDiffDir = false;           //!< Flag for acceleration in different direction
+    SLbool  doGravity    = false;           //!< Flag for gravity
+};
+//-----------------------------------------------------------------------------
+//! CPU backend for the particle update of SLParticleSystem
+/*!
+SLParticleSimulatorCPU holds the particles in a structure of arrays (SoA) so
+that the update kernel can process 4 particles at once with SSE2 on x86 or
+NEON on ARM. Platforms without either of them use the scalar kernel. The
+update is an exact copy of the transform feedback update shader generated in
+SLGLProgramGenerated::buildPerPixParticleUpdate: Unborn particles only get
+the time difference added to their start time, dead particles restart at the
+emitter and living particles integrate their position and velocity.\n
+Emitters with more than SLParticleSimulatorCPU::minParticlesPerThread
+particles per thread are updated in parallel. The particles are split into
+blocks that are a multiple of the SIMD width, so every particle always runs
+through the same code path. Together with a fixed random seed in
+SLParticleSystem the update is therefore deterministic independent of the
+NO. of threads.\n
+After the update the positions are packed into the interleaved array P that
+can be uploaded directly into a plain vertex buffer.
+*/
+class SLParticleSimulatorCPU
+{
+public:
+    void clear();
+    void init(const SLVVec3f& positions,
+              const SLVVec3f& velocities,
+              const SLVfloat& startTimes,
+              const SLVVec3f& initVelocities,
+              const SLVfloat& rotations,
+              const SLVfloat& angularVelos,
+              const SLVuint&  texNums,
+              const SLVVec3f& initPositions);
+    void update(const SLParticleUpdateParams& params,
+                SLuint                        numThreads = 1);
+
+    // Getters
+    SLuint    numParticles() const { return (SLuint)_startTime.size(); }
+    SLVVec3f& P() { return _P; }
+    SLVfloat& startTime() { return _startTime; }
+    SLVfloat& rotation() { return _rotation; }
+    SLVuint&  texNum() { return _texNum; }
+    SLVec3f   position(SLuint i) const { return SLVec3f(_px[i], _py[i], _pz[i]); }
+    SLVec3f   velocity(SLuint i) const { return SLVec3f(_vx[i], _vy[i], _vz[i]); }
+
+    static const char* simdName();
+
+    static const SLuint minParticlesPerThread = 16384; //!< Min. NO. of particles for an extra thread
+
+private:
+    void updateRange(const SLParticleUpdateParams& params,
+                     SLuint                        first,
+                     SLuint                        last);
+    void updateParticle(const SLParticleUpdateParams& params,
+                        SLuint                        i);
+    void updateRotationAndTexNum(const SLParticleUpdateParams& params,
+                                 SLuint                        i);
+
+    // Position, velocity and start time of all particles
+    SLVfloat _px, _py, _pz;    //!< Particle positions
+    SLVfloat _vx, _vy, _vz;    //!< Particle velocities
+    SLVfloat _startTime;       //!< Start times of the particles in S
+    SLVfloat _ivx, _ivy, _ivz; //!< Initial velocities (empty if not needed)
+    SLVfloat _ipx, _ipy, _ipz; //!< Initial positions of shapes (empty if no shape)
+    SLVfloat _rotation;        //!< Rotation angles in rad (empty if no rotation)
+    SLVfloat _angularVelo;     //!< Angular velocities in rad/S (empty if const.)
+    SLVuint  _texNum;          //!< Flipbook image NO. (empty if no flipbook)
+    SLVVec3f _P;               //!< Packed positions for the vertex buffer upload
+};
+//-----------------------------------------------------------------------------
+#endif // SLPARTICLESIMULATORCPU_H
@@ -59,7 +59,7 @@ SLParticleSystem::SLParticleSystem(SLAssetManager* assetMgr,
 //! Function which return a position in a sphere
 SLVec3f SLParticleSystem::getPointInSphere(float radius, SLVec3f randomXs)
 {
-    float u  = Utils::random(0.0f, radius);
+    float u  = random(0.0f, radius);
     float x1 = randomXs.x;
     float x2 = randomXs.y;
     float x3 = randomXs.z;
@@ -100,9 +100,9 @@ SLVec3f SLParticleSystem::getDirectionSphere(SLVec3f position)
 //! Function which return a position in a box
 SLVec3f SLParticleSystem::getPointInBox(SLVec3f boxScale)
 {
-    float x = Utils::random(-boxScale.x, boxScale.x);
-    float y = Utils::random(-boxScale.y, boxScale.y);
-    float z = Utils::random(-boxScale.z, boxScale.z);
+    float x = random(-boxScale.x, boxScale.x);
+    float y = random(-boxScale.y, boxScale.y);
+    float z = random(-boxScale.z, boxScale.z);
 
     return SLVec3f(x, y, z);
 }
@@ -110,45 +110,45 @@ SLVec3f SLParticleSystem::getPointInBox(SLVec3f boxScale)
 //! Function which return a position on a box
 SLVec3f SLParticleSystem::getPointOnBox(SLVec3f boxScale)
 {
-    int   temp = Utils::random(0, 5);
+    int   temp = random(0, 5);
     float x    = 0.0f;
     float y    = 0.0f;
     float z    = 0.0f;
     if (temp == 0)
     { // LEFT side
         x = -boxScale.x;
-        y = Utils::random(-boxScale.y, boxScale.y);
-        z = Utils::random(-boxScale.z, boxScale.z);
+        y = random(-boxScale.y, boxScale.y);
+        z = random(-boxScale.z, boxScale.z);
     }
     else if (temp == 1) // RIGHT side
     {
         x = boxScale.x;
-        y = Utils::random(-boxScale.y, boxScale.y);
-        z = Utils::random(-boxScale.z, boxScale.z);
+        y = random(-boxScale.y, boxScale.y);
+        z = random(-boxScale.z, boxScale.z);
     }
     else if (temp == 2) // FRONT side
     {
-        x = Utils::random(-boxScale.x, boxScale.x);
-        y = Utils::random(-boxScale.y, boxScale.y);
+        x = random(-boxScale.x, boxScale.x);
+        y = random(-boxScale.y, boxScale.y);
         z = boxScale.z;
     }
     else if (temp == 3) // BACK side
     {
-        x = Utils::random(-boxScale.x, boxScale.x);
-        y = Utils::random(-boxScale.y, boxScale.y);
+        x = random(-boxScale.x, boxScale.x);
+        y = random(-boxScale.y, boxScale.y);
         z = -boxScale.z;
     }
     else if (temp == 4) // TOP side
     {
-        x = Utils::random(-boxScale.x, boxScale.x);
+        x = random(-boxScale.x, boxScale.x);
         y = boxScale.y;
-        z = Utils::random(-boxScale.z, boxScale.z);
+        z = random(-boxScale.z, boxScale.z);
     }
     else if (temp == 5) // BOTTOM side
     {
-        x = Utils::random(-boxScale.x, boxScale.x);
+        x = random(-boxScale.x, boxScale.x);
         y = -boxScale.y;
-        z = Utils::random(-boxScale.z, boxScale.z);
+        z = random(-boxScale.z, boxScale.z);
     }
 
     return SLVec3f(x, y, z);
@@ -167,11 +167,11 @@ SLVec3f SLParticleSystem::getPointInCone()
     float radius = _shapeRadius;
     if (!_doShapeSpawnBase) // Spawn inside volume
     {
-        y      = Utils::random(0.0f, _shapeHeight); // NEED TO HAVE MORE value near 1 when we have smaller base that top
+        y      = random(0.0f, _shapeHeight); // NEED TO HAVE MORE value near 1 when we have smaller base that top
         radius = _shapeRadius + tan(_shapeAngle * DEG2RAD) * y;
     }
     float r     = radius * sqrt(random(0.0f, 1.0f));
-    float theta = Utils::random(0.0f, 1.0f) * 2 * PI;
+    float theta = random(0.0f, 1.0f) * 2 * PI;
     float x     = r * cos(theta);
     float z     = r * sin(theta);
 
@@ -185,11 +185,11 @@ SLVec3f SLParticleSystem::getPointOnCone()
     float radius = _shapeRadius;
     if (!_doShapeSpawnBase) // Spawn inside volume
     {
-        y      = Utils::random(0.0f, _shapeHeight); // NEED TO HAVE MORE value near 1 when we have smaller base that top
+        y      = random(0.0f, _shapeHeight); // NEED TO HAVE MORE value near 1 when we have smaller base that top
         radius = _shapeRadius + tan(_shapeAngle * DEG2RAD) * y;
     }
     float r     = radius;
-    float theta = Utils::random(0.0f, 1.0f) * 2 * PI;
+    float theta = random(0.0f, 1.0f) * 2 * PI;
     float x     = r * cos(theta);
     float z     = r * sin(theta);
 
@@ -214,11 +214,11 @@ SLVec3f SLParticleSystem::getPointInPyramid()
     float radius = _shapeWidth;
     if (!_doShapeSpawnBase) // Spawn inside volume
     {
-        y      = Utils::random(0.0f, _shapeHeight);
+        y      = random(0.0f, _shapeHeight);
         radius = _shapeWidth + tan(_shapeAngle * DEG2RAD) * y;
     }
-    float x = Utils::random(-radius, radius);
-    float z = Utils::random(-radius, radius);
+    float x = random(-radius, radius);
+    float z = random(-radius, radius);
 
     return SLVec3f(x, y, z);
 }
@@ -230,32 +230,32 @@ SLVec3f SLParticleSystem::getPointOnPyramid()
     float radius = _shapeWidth;
     if (!_doShapeSpawnBase) // Spawn inside volume
     {
-        y      = Utils::random(0.0f, _shapeHeight);
+        y      = random(0.0f, _shapeHeight);
         radius = _shapeWidth + tan(_shapeAngle * DEG2RAD) * y;
     }
 
-    // int   temp      = Utils::random(0, 5);
-    int   temp = Utils::random(0, 3);
+    // int   temp      = random(0, 5);
+    int   temp = random(0, 3);
     float x    = 0.0f;
     float z    = 0.0f;
     if (temp == 0)
     { // LEFT
         x = -radius;
-        z = Utils::random(-radius, radius);
+        z = random(-radius, radius);
     }
     else if (temp == 1) // RIGHT
     {
         x = radius;
-        z = Utils::random(-radius, radius);
+        z = random(-radius, radius);
     }
     else if (temp == 2) // FRONT
     {
-        x = Utils::random(-radius, radius);
+        x = random(-radius, radius);
         z = radius;
     }
     else if (temp == 3) // BACK
     {
-        x = Utils::random(-radius, radius);
+        x = random(-radius, radius);
         z = -radius;
     }
     // Comments to have top and bottom not filled
@@ -264,15 +264,15 @@ SLVec3f SLParticleSystem::getPointOnPyramid()
         y = _heightPyramid;
         radius = _shapeWidth + tan(_anglePyramid * DEG2RAD) * y;
 
-        x = Utils::random(-radius, radius);
-        z = Utils::random(-radius, radius);
+        x = random(-radius, radius);
+        z = random(-radius, radius);
     }
     else if (temp == 5) // BOTTOM
     {
         y      = 0.0f;
         radius = _shapeWidth;
-        x = Utils::random(-radius, radius);
-        z = Utils::random(-radius, radius);
+        x = random(-radius, radius);
+        z = random(-radius, radius);
     }*/
 
     return SLVec3f(x, y, z);
@@ -292,10 +292,37 @@ SLVec3f SLParticleSystem::getDirectionPyramid(SLVec3f position)
     return SLVec3f(newX, _shapeHeight, newZ).normalize();
 }
 //-----------------------------------------------------------------------------
-//! Function which will generate the particles and attributes them to the VAO
+//! Returns a uniform distributed random float between min and max
+SLfloat SLParticleSystem::random(SLfloat min, SLfloat max)
+{
+    return ((SLfloat)_randomGenerator() / (SLfloat)std::mt19937::max()) * (max - min) + min;
+}
+//-----------------------------------------------------------------------------
+//! Returns a uniform distributed random int between min and max
+SLint SLParticleSystem::random(SLint min, SLint max)
+{
+    return min + (SLint)(_randomGenerator() % (SLuint)(max - min + 1));
+}
+//-----------------------------------------------------------------------------
+//! Generates the particles with the current time as start time
 void SLParticleSystem::generate()
 {
-    SLuint                     seed = (SLuint)chrono::system_clock::now().time_since_epoch().count();
+    generate(GlobalTimer::timeS());
+}
+//-----------------------------------------------------------------------------
+/*! Function which will generate the particles and attributes them to the VAO.
+ The first particle starts at startTimeS and the others are evenly distributed
+ over the time to live. With a random seed other than zero the generation is
+ reproducible. For the CPU simulation the particles are only copied into the
+ SoA pool of the simulator and the vertex buffer is built later in draw.
+ */
+void SLParticleSystem::generate(SLfloat startTimeS)
+{
+    SLuint seed = _randomSeed;
+    if (!seed)
+        seed = (SLuint)chrono::system_clock::now().time_since_epoch().count();
+    _randomGenerator.seed(seed);
+
     default_random_engine      generator(seed);
     normal_distribution<float> distribution(0.0f, 1.0f);
 
@@ -360,9 +387,9 @@ void SLParticleSystem::generate()
         {
             if (_velocityType == 0) // Random value
             {
-                tempV[i].x = Utils::random(_velocityRndMin.x, _velocityRndMax.x); // Random value for x velocity
-                tempV[i].y = Utils::random(_velocityRndMin.y, _velocityRndMax.y); // Random value for y velocity
-                tempV[i].z = Utils::random(_velocityRndMin.z, _velocityRndMax.z); // Random value for z velocity
+                tempV[i].x = random(_velocityRndMin.x, _velocityRndMax.x); // Random value for x velocity
+                tempV[i].y = random(_velocityRndMin.y, _velocityRndMax.y); // Random value for y velocity
+                tempV[i].z = random(_velocityRndMin.z, _velocityRndMax.z); // Random value for z velocity
             }
             else if (_velocityType == 1) // Constant
             {
@@ -389,27 +416,43 @@ void SLParticleSystem::generate()
                 tempDirection = _direction;
 
             if (_doSpeedRange) // Apply speed
-                tempV[i] = tempDirection * Utils::random(_speedRange.x, _speedRange.y);
+                tempV[i] = tempDirection * random(_speedRange.x, _speedRange.y);
             else
                 tempV[i] = tempDirection * _speed;
         }
 
         // When the first particle dies the last one begin to live
-        tempST[i] = GlobalTimer::timeS() + ((float)i * (_timeToLive / (float)_amount)); // Time to start
+        tempST[i] = startTimeS + ((float)i * (_timeToLive / (float)_amount)); // Time to start
 
         if (_doAcceleration || _doGravity) // Acceleration
             tempInitV[i] = tempV[i];
         if (_doRotation)                                                // Rotation (constant angular velocity)
-            tempR[i] = Utils::random(0.0f * DEG2RAD, 360.0f * DEG2RAD); // Start rotation of the particle
+            tempR[i] = random(0.0f * DEG2RAD, 360.0f * DEG2RAD); // Start rotation of the particle
         if (_doRotation && _doRotRange)                                 // Random angular velocity for each particle
-            tempAngulareVelo[i] = Utils::random(_angularVelocityRange.x * DEG2RAD,
+            tempAngulareVelo[i] = random(_angularVelocityRange.x * DEG2RAD,
                                                 _angularVelocityRange.y * DEG2RAD); // Start rotation of the particle
         if (_doFlipBookTexture)                                                     // Flipbook texture
-            tempTexNum[i] = Utils::random(0, _flipbookRows * _flipbookColumns - 1);
+            tempTexNum[i] = random(0, _flipbookRows * _flipbookColumns - 1);
         if (_doShape) // Shape feature
             tempInitP[i] = tempP[i];
     }
 
+    if (_doCPUSimulation)
+    {
+        _simulatorCPU.init(tempP,
+                           tempV,
+                           tempST,
+                           tempInitV,
+                           tempR,
+                           tempAngulareVelo,
+                           tempTexNum,
+                           tempInitP);
+        _vaoCPUIsOutOfDate = true;
+        _isGenerated       = true;
+        return;
+    }
+    _simulatorCPU.clear();
+
     // Need to have two VAO for transform feedback swapping
     // Configure first VAO
     _vao1.deleteGL();
@@ -490,6 +533,89 @@ void SLParticleSystem::generateBernsteinPSize()
     _bernsteinPYSize.w = StaEnd[1];
 }
 //-----------------------------------------------------------------------------
+/*! Updates the particles on the CPU with the same parameters that the
+ transform feedback program gets as uniforms. This function does not call
+ OpenGL and can be used to step a particle system without a context (e.g. for
+ previews on a server). The particles get generated at timeS if they are not
+ yet. The update of the flipbook image depends on deltaTimeS.
+ @param timeS Time since the start in seconds
+ @param deltaTimeS Time since the last update in seconds
+ @param difTimeS Time the particle system was paused or culled in seconds
+ */
+void SLParticleSystem::simulate(SLfloat timeS,
+                                SLfloat deltaTimeS,
+                                SLfloat difTimeS)
+{
+    assert(_doCPUSimulation && "SLParticleSystem::simulate needs doCPUSimulation");
+
+    if (!_isGenerated)
+        generate(timeS);
+
+    SLParticleUpdateParams params;
+    params.time         = timeS;
+    params.deltaTime    = deltaTimeS;
+    params.difTime      = difTimeS;
+    params.timeToLive   = _timeToLive;
+    params.emitterPos   = _doWorldSpace ? _emitterPos : SLVec3f::ZERO;
+    params.doCounterGap = _doCounterGap;
+    params.doAcc        = _doAcceleration;
+    params.doAccDiffDir = _doAccDiffDir;
+    params.acceleration = _acceleration;
+    params.accConst     = _accelerationConst;
+    params.doGravity    = _doGravity;
+    params.gravity      = _gravity;
+    params.angularVelo  = _angularVelocityConst * DEG2RAD;
+
+    if (_doFlipBookTexture)
+    {
+        params.numFBImages = (SLuint)(_flipbookColumns * _flipbookRows);
+        _flipboookLastUpdate += deltaTimeS;
+
+        if (_flipboookLastUpdate > (1.0f / (float)_flipbookFPS))
+        {
+            params.doFBStep      = true;
+            _flipboookLastUpdate = 0.0f;
+        }
+    }
+
+    _simulatorCPU.update(params, Utils::maxThreads());
+    _cpuParticlesChanged = true;
+}
+//-----------------------------------------------------------------------------
+/*! Uploads the particles of the CPU simulation into the vertex buffer of
+ _vao1. The buffer is built with separate attribute arrays as stream buffer
+ so that the attributes can be updated each frame. Only the attributes that
+ the draw program needs are uploaded.
+ */
+void SLParticleSystem::uploadCPUParticles()
+{
+    if (_vaoCPUIsOutOfDate)
+    {
+        _vao1.deleteGL();
+        _vao2.deleteGL();
+        _vao1.setAttrib(AT_position, AT_position, &_simulatorCPU.P());
+        _vao1.setAttrib(AT_startTime, AT_startTime, &_simulatorCPU.startTime());
+        if (_doRotation)
+            _vao1.setAttrib(AT_rotation, AT_rotation, &_simulatorCPU.rotation());
+        if (_doFlipBookTexture)
+            _vao1.setAttrib(AT_texNum, AT_texNum, &_simulatorCPU.texNum());
+        _vao1.generate(_simulatorCPU.numParticles(), BU_stream, false);
+        _vaoCPUIsOutOfDate = false;
+    }
+    else if (_cpuParticlesChanged)
+    {
+        _vao1.updateAttrib(AT_position, &_simulatorCPU.P());
+        _vao1.updateAttrib(AT_startTime, &_simulatorCPU.startTime());
+        if (_doRotation)
+            _vao1.updateAttrib(AT_rotation, &_simulatorCPU.rotation());
+        if (_doFlipBookTexture)
+            _vao1.updateAttrib(AT_texNum, &_simulatorCPU.texNum());
+    }
+
+    _cpuParticlesChanged = false;
+    _vao                 = _vao1;
+}
+//-----------------------------------------------------------------------------
 /*!
 Change the current use texture, this will switch between the normal texture and
 the flipbook texture (and vice versa)
@@ -555,8 +681,8 @@ void SLParticleSystem::draw(SLSceneView* sv, SLNode* node)
     // Generate programs
     ////////////////////
 
-    if (!_mat->program() || !_mat->programTF())
-        _mat->generateProgramPS();
+    if (!_mat->program() || (!_mat->programTF() && !_doCPUSimulation))
+        _mat->generateProgramPS(!_doCPUSimulation);
 
     ////////////////////////////////////////////////
     // Calculate time and paused and frustum culling
@@ -600,7 +726,13 @@ void SLParticleSystem::draw(SLSceneView* sv, SLNode* node)
     _deltaTimeUpdateS = GlobalTimer::timeS() - _startUpdateTimeS;
     _startUpdateTimeS = GlobalTimer::timeS();
 
-    if (!_isPaused) // The updating is paused, therefore no need to send uniforms
+    if (!_isPaused && _doCPUSimulation) // Update on the CPU
+    {
+        emitterPos(node->translationWS());
+        simulate(_startUpdateTimeS, deltaTime, difTime);
+        _updateTime.set(GlobalTimer::timeMS() - _startUpdateTimeMS);
+    }
+    else if (!_isPaused) // The updating is paused, therefore no need to send uniforms
     {
         ///////////
         // UPDATING
@@ -692,6 +824,9 @@ void SLParticleSystem::draw(SLSceneView* sv, SLNode* node)
         _updateTime.set(GlobalTimer::timeMS() - _startUpdateTimeMS);
     }
 
+    if (_doCPUSimulation)
+        uploadCPUParticles();
+
     //////////
     // DRAWING
     //////////
@@ -848,6 +983,7 @@ void SLParticleSystem::deleteDataGpu()
 {
     _vao1.deleteGL();
     _vao2.deleteGL();
+    _vaoCPUIsOutOfDate = true;
     SLMesh::deleteDataGpu();
 }
 //-----------------------------------------------------------------------------
@@ -15,6 +15,8 @@
 #include <Averaged.h>
 #include <SLRnd3f.h>
 #include <SLTexColorLUT.h>
+#include <SLParticleSimulatorCPU.h>
+#include <random>
 
 //-----------------------------------------------------------------------------
 //! SLParticleSystem creates a particle meshes from a point primitive buffer.
@@ -28,7 +30,13 @@
  * The particle system supports many options of which many can be turned on the
  * do* methods. All options can also be modified in the UI when the mesh is
  * selected. See the different demo scenes in the app_demo_slproject under the
- * demo scene group Particle Systems.
+ * demo scene group Particle Systems.\n
+ * With doCPUSimulation the particles are updated on the CPU by an
+ * SLParticleSimulatorCPU instead of the transform feedback program. The
+ * updated particles are uploaded each frame into a plain vertex buffer and
+ * drawn with the same draw program. SLParticleSystem::simulate steps the
+ * particles without any OpenGL calls and with a fixed randomSeed the
+ * generation and the update are deterministic.
  */
 class SLParticleSystem : public SLMesh
 {
@@ -47,6 +55,10 @@ public:
     void deleteDataGpu();
     void buildAABB(SLAABBox& aabb, const SLMat4f& wmNode);
     void generate();
+    void generate(SLfloat startTimeS);
+    void simulate(SLfloat timeS,
+                  SLfloat deltaTimeS,
+                  SLfloat difTimeS = 0.0f);
     void generateBernsteinPAlpha();
     void generateBernsteinPSize();
     void changeTexture();
@@ -74,6 +86,7 @@ public:
     SLbool            doAlphaOverLTCurve() { return _doAlphaOverLTCurve; }
     SLbool            doBlendBrightness() { return _doBlendBrightness; }
     SLbool            doCounterGap() { return _doCounterGap; }
+    SLbool            doCPUSimulation() { return _doCPUSimulation; }
     SLbool            doColor() { return _doColor; }
     SLbool            doColorOverLT() { return _doColorOverLT; }
     SLbool            doGravity() { return _doGravity; }
@@ -97,6 +110,7 @@ public:
     SLbool            isGenerated() { return _isGenerated; }
     SLbool            isPaused() { return _isPaused; }
     SLfloat           radiusW() { return _radiusW; }
+    SLuint            randomSeed() { return _randomSeed; }
     SLfloat           radiusH() { return _radiusH; }
     SLfloat           scale() { return _scale; }
     SLShapeType       shapeType() { return _shapeType; }
@@ -179,6 +193,11 @@ public:
     void doColor(SLbool b) { _doColor = b; }
     void doColorOverLT(SLbool b) { _doColorOverLT = b; }
     void doCounterGap(SLbool b) { _doCounterGap = b; }
+    void doCPUSimulation(SLbool b)
+    {
+        _doCPUSimulation = b;
+        _isGenerated     = false;
+    }
     void doDirectionSpeed(SLbool b) { _doDirectionSpeed = b; }
     void doGravity(SLbool b) { _doGravity = b; }
     void doFlipBookTexture(SLbool b) { _doFlipBookTexture = b; }
@@ -205,6 +224,7 @@ public:
     void frameRateFB(int i) { _flipbookFPS = i; }
     void isGenerated(SLbool b) { _isGenerated = b; }
     void radiusW(SLfloat f) { _radiusW = f; }
+    void randomSeed(SLuint seed) { _randomSeed = seed; }
     void radiusH(SLfloat f) { _radiusH = f; }
     void scale(SLfloat f) { _scale = f; }
     void speed(SLfloat f) { _speed = f; }
@@ -266,6 +286,11 @@ private:
     SLVec3f getPointInPyramid();
     SLVec3f getPointOnPyramid();
     SLVec3f getDirectionPyramid(SLVec3f position);
+    void    uploadCPUParticles();
+
+    // Random numbers of the particle generation from _randomGenerator
+    SLfloat random(SLfloat min, SLfloat max);
+    SLint   random(SLint min, SLint max);
 
     // Core values
     SLint   _amount;         //!< Amount of a particle
@@ -350,6 +375,13 @@ private:
     SLGLVertexArray _vao1; //!< First OpenGL Vertex Array Object for swapping between updating/drawing
     SLGLVertexArray _vao2; //!< Second OpenGL Vertex Array Object for swapping between updating/drawing
 
+    // CPU simulation
+    SLParticleSimulatorCPU _simulatorCPU;                //!< SoA particle pool and update kernel of the CPU simulation
+    SLuint                 _randomSeed          = 0;     //!< Seed for the particle generation (0 = seed from clock)
+    std::mt19937           _randomGenerator;             //!< Random generator of this system (seeded in generate)
+    SLbool                 _vaoCPUIsOutOfDate   = true;  //!< Flag if the CPU particles need a new vertex buffer
+    SLbool                 _cpuParticlesChanged = false; //!< Flag if the CPU particles were updated since the last upload
+
     // Boolean for generation/resume
     SLbool _isVisibleInFrustum = true;  //!< Boolean to set time since node not visible
     SLbool _isPaused           = false; //!< Boolean to stop updating
@@ -360,6 +392,7 @@ private:
     SLbool _doDirectionSpeed   = false; //!< Boolean for direction and speed (override velocity)
     SLbool _doSpeedRange       = false; //!< Boolean for speed range
     SLbool _doCounterGap       = true;  //!< Boolean for counter lag/gap, can create flickering with few particle (explained in documentation) when enable
+    SLbool _doCPUSimulation    = false; //!< Boolean for updating the particles on the CPU instead of with transform feedback
     SLbool _doAcceleration     = false; //!< Boolean for acceleration
     SLbool _doAccDiffDir       = false; //!< Boolean for acceleration (different direction)
     SLbool _doRotation         = true;  //!< Boolean for rotation
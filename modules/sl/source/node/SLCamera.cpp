@@ -1612,6 +1612,18 @@ SLbool SLCamera::isInFrustum(SLAABBox* aabb)
     return true;
 }
 //-----------------------------------------------------------------------------
+//! SLCamera::isInFrustum does the same frustum test for a bounding sphere in WS
+/*! This variant is used for the culling of parts of a mesh such as the ranges
+of an SLMeshBatch that have no own AABB.
+*/
+SLbool SLCamera::isInFrustum(const SLVec3f& centerWS, SLfloat radiusWS)
+{
+    for (auto& i : _plane)
+        if (i.distToPoint(centerWS) < -radiusWS)
+            return false;
+    return true;
+}
+//-----------------------------------------------------------------------------
 //! SLCamera::to_string returns important camera parameter as a string
 SLstring SLCamera::toString() const
 {
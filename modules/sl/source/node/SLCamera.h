@@ -82,6 +82,7 @@ public:
     SLVec2f projectWorldToNDC(const SLVec4f& worldPos) const;
     SLVec3f trackballVec(SLint x, SLint y) const;
     SLbool  isInFrustum(SLAABBox* aabb);
+    SLbool  isInFrustum(const SLVec3f& centerWS, SLfloat radiusWS);
     void    passToUniforms(SLGLProgram* program);
 
     // Apply projection, viewport and view transformations
@@ -45,6 +45,7 @@ struct SLNodeStats
     SLuint  numMeshes;       //!< NO. of meshes in node
     SLuint  numLights;       //!< NO. of lights in mesh
     SLuint  numTriangles;    //!< NO. of triangles in mesh
+    SLuint  numCacheMisses;  //!< NO. of simulated vertex cache misses (ACMR = misses / triangles)
     SLuint  numLines;        //!< NO. of lines in mesh
     SLuint  numVoxels;       //!< NO. of voxels
     SLfloat numVoxEmpty;     //!< NO. of empty voxels
@@ -61,7 +62,8 @@ struct SLNodeStats
         numNodesLeaf  = 0;
         numMeshes     = 0;
         numLights     = 0;
-        numTriangles  = 0;
+        numTriangles   = 0;
+        numCacheMisses = 0;
         numLines      = 0;
         numVoxels     = 0;
         numVoxEmpty   = 0.0f;
@@ -88,6 +90,7 @@ struct SLNodeStats
         SL_LOG("Leaf Nodes     : %d", numNodesLeaf);
         SL_LOG("Meshes         : %d", numMeshes);
         SL_LOG("Triangles      : %d", numTriangles);
+        SL_LOG("Vertex ACMR    : %4.2f", numTriangles ? (SLfloat)numCacheMisses / (SLfloat)numTriangles : 0.0f);
         SL_LOG("Lights         : %d\n", numLights);
     }
 };
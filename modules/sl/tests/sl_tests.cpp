@@ -0,0 +1,101 @@
+//#############################################################################
+//  File:      sl_tests.cpp
+//  Purpose:   Test app for the mesh algorithms of the SLProject library
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLMeshOptimizer.h>
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+//-----------------------------------------------------------------------------
+//! Builds a regular grid of n x n quads in the xy-plane
+static void buildGrid(SLuint n, SLVVec3f& positions, SLVuint& indices)
+{
+    for (SLuint y = 0; y <= n; ++y)
+        for (SLuint x = 0; x <= n; ++x)
+            positions.push_back(SLVec3f((SLfloat)x, (SLfloat)y, 0.0f));
+
+    for (SLuint y = 0; y < n; ++y)
+    {
+        for (SLuint x = 0; x < n; ++x)
+        {
+            SLuint i0 = y * (n + 1) + x;
+            SLuint i1 = i0 + 1;
+            SLuint i2 = i0 + n + 1;
+            SLuint i3 = i2 + 1;
+            indices.insert(indices.end(), {i0, i1, i3, i0, i3, i2});
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the triangles of the indices sorted so that two lists can be compared
+static vector<std::array<SLuint, 3>> sortedTriangles(const SLVuint& indices)
+{
+    vector<std::array<SLuint, 3>> tris;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        tris.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    std::sort(tris.begin(), tris.end());
+    return tris;
+}
+//-----------------------------------------------------------------------------
+//! Checks that optimizeOverdraw keeps all triangles of the input
+static bool testOverdrawKeepsTriangles(const SLchar*   name,
+                                       SLVuint         indices,
+                                       const SLVVec3f& positions)
+{
+    SLVuint input = indices;
+    SLMeshOptimizer::optimizeOverdraw(indices, positions);
+
+    bool ok = indices.size() == input.size() &&
+              sortedTriangles(indices) == sortedTriangles(input);
+
+    cout << "optimizeOverdraw " << name << ": "
+         << input.size() << " -> " << indices.size() << " indices "
+         << (ok ? "OK" : "*** FAILED ***") << endl;
+    return ok;
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    bool ok = true;
+
+    SLVVec3f positions;
+    SLVuint  indices;
+    buildGrid(32, positions, indices);
+    SLuint numVertices = (SLuint)positions.size();
+
+    // Unoptimized grid
+    ok &= testOverdrawKeepsTriangles("grid", indices, positions);
+
+    // Vertex cache optimized grid
+    SLVuint optimized = indices;
+    SLMeshOptimizer::optimizeVertexCache(optimized, numVertices);
+    ok &= optimized.size() == indices.size();
+    ok &= testOverdrawKeepsTriangles("cache optimized grid", optimized, positions);
+
+    // A degenerated first triangle misses less than 3 vertices in the cache
+    SLVuint degenerated = {0, 0, 1};
+    degenerated.insert(degenerated.end(), optimized.begin(), optimized.end());
+    ok &= testOverdrawKeepsTriangles("degenerated first triangle", degenerated, positions);
+
+    // The fetch remap must cover all used vertices
+    SLVuint remap;
+    SLuint  numUsed = SLMeshOptimizer::buildFetchRemap(optimized, numVertices, remap);
+    ok &= numUsed == numVertices;
+    ok &= std::find(remap.begin(), remap.end(), SLMeshOptimizer::INVALID_INDEX) == remap.end();
+
+    cout << "ACMR before: " << SLMeshOptimizer::calcACMR(indices, numVertices)
+         << ", after: " << SLMeshOptimizer::calcACMR(optimized, numVertices) << endl;
+
+    cout << (ok ? "All tests passed." : "*** Some tests FAILED ***") << endl;
+    return ok ? 0 : 1;
+}
+//-----------------------------------------------------------------------------
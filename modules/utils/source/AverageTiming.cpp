@@ -89,6 +89,7 @@ void AverageTiming::doStop(const std::string& name)
             Utils::log("AverageTiming: Block with name %s stopped without being started!", name.c_str());
         (*this)[name]->timer.stop();
         (*this)[name]->val.set((*this)[name]->timer.elapsedTimeInMilliSec());
+        (*this)[name]->totalMS += (*this)[name]->timer.elapsedTimeInMilliSec();
         (*this)[name]->nCalls++;
         (*this)[name]->isStarted = false;
         this->_currentPosH--;
@@ -40,6 +40,7 @@ struct AverageTimingBlock
     int          posV      = 0;
     int          posH      = 0;
     int          nCalls    = 0;
+    float        totalMS   = 0.0f;
     bool         isStarted = false;
 };
 
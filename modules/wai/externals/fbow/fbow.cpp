@@ -221,6 +221,10 @@ void Vocabulary::fromStream(std::istream& str)
     _data = std::unique_ptr<char[], decltype(&AlignedFree)>((char*)AlignedAlloc((int)_params._aligment, (int)_params._total_size), &AlignedFree);
     if (_data.get() == nullptr) throw std::runtime_error("Vocabulary::fromStream Could not allocate data");
     str.read(_data.get(), _params._total_size);
+
+    //detect the host now, so that transform can be called from several threads
+    cpu_info = std::make_shared<cpu>();
+    cpu_info->detect_host();
 }
 
 double fBow::score(const fBow& v1, const fBow& v2)
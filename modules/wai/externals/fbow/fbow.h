@@ -6,6 +6,8 @@
 #include <map>
 #include <memory>
 #include <bitset>
+#include <vector>
+#include <algorithm>
 
 #ifdef __APPLE__
 #    include <TargetConditionals.h> //defines TARGET_OS_IOS
@@ -401,7 +403,11 @@ private:
         }
         inline uint64_t uint64_popcnt(uint64_t n)
         {
+#if defined(__GNUC__) || defined(__clang__)
+            return (uint64_t)__builtin_popcountll(n);
+#else
             return std::bitset<64>(n).count();
+#endif
         }
     };
 
@@ -418,7 +424,11 @@ private:
         }
         inline uint64_t uint64_popcnt(uint64_t n)
         {
+#if defined(__GNUC__) || defined(__clang__)
+            return (uint64_t)__builtin_popcountll(n);
+#else
             return std::bitset<64>(n).count();
+#endif
         }
     };
 
@@ -473,6 +483,13 @@ private:
         std::pair<DType, uint32_t> best_dist_idx(std::numeric_limits<uint32_t>::max(), 0); //minimum distance found
         block_node_info*           bn_info;
 
+        //the words and nodes are first collected in vectors and the maps are filled at the end in
+        //ascending order, which avoids a map lookup per feature
+        std::vector<std::pair<uint32_t, float>>    words;
+        std::vector<std::pair<uint32_t, uint32_t>> nodes;
+        words.reserve(features.rows);
+        nodes.reserve(features.rows);
+
         int nbits = (int)ceil(log2(_params._m_k));
         for (int cur_feature = 0; cur_feature < features.rows; cur_feature++)
         {
@@ -494,15 +511,15 @@ private:
                 }
 
                 if (level == storeLevel) //if reached level,save
-                    r2[curNode].push_back(cur_feature);
+                    nodes.emplace_back(curNode, cur_feature);
 
                 bn_info = c_block.getBlockNodeInfo(best_dist_idx.second);
 
                 if (bn_info->isleaf())
                 {
-                    r1[bn_info->getId()] += bn_info->weight;
+                    words.emplace_back(bn_info->getId(), bn_info->weight);
                     if (level < storeLevel) //store level not reached, save now
-                        r2[curNode].push_back(cur_feature);
+                        nodes.emplace_back(curNode, cur_feature);
                     break;
                 }
                 else
@@ -512,6 +529,25 @@ private:
                 level++;
             } while (!bn_info->isleaf() && bn_info->getId() != 0);
         }
+
+        //stable sorts keep the feature order within a word, so the sums and index lists are the same as before
+        auto byId = [](const std::pair<uint32_t, float>& a, const std::pair<uint32_t, float>& b) { return a.first < b.first; };
+        std::stable_sort(words.begin(), words.end(), byId);
+        for (const auto& w : words)
+        {
+            if (r1.empty() || r1.rbegin()->first != w.first)
+                r1.emplace_hint(r1.end(), w.first, _float());
+            r1.rbegin()->second.var += w.second;
+        }
+
+        auto byNode = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a.first < b.first; };
+        std::stable_sort(nodes.begin(), nodes.end(), byNode);
+        for (const auto& n : nodes)
+        {
+            if (r2.empty() || r2.rbegin()->first != n.first)
+                r2.emplace_hint(r2.end(), n.first, std::vector<uint32_t>());
+            r2.rbegin()->second.push_back(n.second);
+        }
     }
 };
 
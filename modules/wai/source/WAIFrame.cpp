@@ -60,16 +60,18 @@ WAIFrame::WAIFrame(const WAIFrame& frame)
   : mVocabulary(frame.mVocabulary),
     mpORBextractorLeft(frame.mpORBextractorLeft),
     mTimeStamp(frame.mTimeStamp),
-    mK(frame.mK.clone()),
-    mDistCoef(frame.mDistCoef.clone()),
+    mK(frame.mK),
+    mDistCoef(frame.mDistCoef),
     N(frame.N),
     mvKeys(frame.mvKeys),
     mvKeysUn(frame.mvKeysUn), /*mvuRight(frame.mvuRight),
     mvDepth(frame.mvDepth),*/
     mBowVec(frame.mBowVec),
     mFeatVec(frame.mFeatVec),
-    mDescriptors(frame.mDescriptors.clone()),
+    mDescriptors(frame.mDescriptors),
     mvpMapPoints(frame.mvpMapPoints),
+    mGridCellStarts(frame.mGridCellStarts),
+    mGridIndices(frame.mGridIndices),
     mnId(frame.mnId),
     mpReferenceKF(frame.mpReferenceKF),
     mnScaleLevels(frame.mnScaleLevels),
@@ -78,20 +80,23 @@ WAIFrame::WAIFrame(const WAIFrame& frame)
     mvScaleFactors(frame.mvScaleFactors),
     mvInvScaleFactors(frame.mvInvScaleFactors),
     mvLevelSigma2(frame.mvLevelSigma2),
-    mvInvLevelSigma2(frame.mvInvLevelSigma2)
+    mvInvLevelSigma2(frame.mvInvLevelSigma2),
+    imgGray(frame.imgGray),
+    mbOptFlow(frame.mbOptFlow),
+    mvOptFlowPyramid(frame.mvOptFlowPyramid)
 {
-    for (int i = 0; i < FRAME_GRID_COLS; i++)
-        for (int j = 0; j < FRAME_GRID_ROWS; j++)
-            mGrid[i][j] = frame.mGrid[i][j];
-
     if (!frame.mTcw.empty())
         SetPose(frame.mTcw);
-
-    if (!frame.imgGray.empty())
-        imgGray = frame.imgGray.clone();
 }
 //-----------------------------------------------------------------------------
-WAIFrame::WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor* extractor, cv::Mat& K, cv::Mat& distCoef, WAIOrbVocabulary* vocabulary, bool retainImg)
+WAIFrame& WAIFrame::operator=(const WAIFrame& frame)
+{
+    if (this != &frame)
+        *this = WAIFrame(frame);
+    return *this;
+}
+//-----------------------------------------------------------------------------
+WAIFrame::WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor* extractor, cv::Mat& K, cv::Mat& distCoef, WAIOrbVocabulary* vocabulary, bool retainImg, bool extractFeatures)
   : mpORBextractorLeft(extractor), mTimeStamp(timeStamp), /*mK(K.clone()),*/ /*mDistCoef(distCoef.clone()),*/
     mVocabulary(vocabulary)
 {
@@ -112,6 +117,16 @@ WAIFrame::WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor*
     mvLevelSigma2     = mpORBextractorLeft->GetScaleSigmaSquares();
     mvInvLevelSigma2  = mpORBextractorLeft->GetInverseScaleSigmaSquares();
 
+    // The keypoints of optical flow frames are set later with SetOptFlowKeyPoints
+    if (!extractFeatures)
+    {
+        mbOptFlow = true;
+        if (retainImg)
+            imgGray = imGray.clone();
+        AVERAGE_TIMING_STOP("WAIFrame");
+        return;
+    }
+
     // ORB extraction
     ExtractFeaturePoints(imGray);
 
@@ -154,26 +169,60 @@ WAIFrame::WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor*
     AVERAGE_TIMING_STOP("WAIFrame");
 }
 //-----------------------------------------------------------------------------
+/*! Counting sort of the keypoints into the cells of the grid: The keypoints
+ per cell are counted, the counts are summed up to the cell starts and the
+ keypoint indices are filled in ascending order.
+ */
 void WAIFrame::AssignFeaturesToGrid()
 {
-    int nReserve = (int)(0.5f * N / (FRAME_GRID_COLS * FRAME_GRID_ROWS));
-    for (unsigned int i = 0; i < FRAME_GRID_COLS; i++)
-        for (unsigned int j = 0; j < FRAME_GRID_ROWS; j++)
-            mGrid[i][j].reserve(nReserve);
+    vector<int>          keyPointCells(N, -1);
+    vector<unsigned int> cellStarts(FRAME_GRID_COLS * FRAME_GRID_ROWS + 1, 0);
 
     for (int i = 0; i < N; i++)
     {
-        const cv::KeyPoint& kp = mvKeysUn[i];
-
         int nGridPosX, nGridPosY;
-        if (PosInGrid(kp, nGridPosX, nGridPosY))
-            mGrid[nGridPosX][nGridPosY].push_back(i);
+        if (PosInGrid(mvKeysUn[i], nGridPosX, nGridPosY))
+        {
+            keyPointCells[i] = nGridPosX * FRAME_GRID_ROWS + nGridPosY;
+            cellStarts[keyPointCells[i] + 1]++;
+        }
     }
+
+    for (size_t c = 1; c < cellStarts.size(); c++)
+        cellStarts[c] += cellStarts[c - 1];
+
+    // The cell starts are used as insert positions and afterwards moved back
+    vector<unsigned int> indices(cellStarts.back());
+    for (int i = 0; i < N; i++)
+        if (keyPointCells[i] >= 0)
+            indices[cellStarts[keyPointCells[i]]++] = (unsigned int)i;
+
+    for (size_t c = cellStarts.size() - 1; c > 0; c--)
+        cellStarts[c] = cellStarts[c - 1];
+    cellStarts[0] = 0;
+
+    mGridCellStarts = std::move(cellStarts);
+    mGridIndices    = std::move(indices);
 }
 //-----------------------------------------------------------------------------
 void WAIFrame::ExtractFeaturePoints(const cv::Mat& im)
 {
-    (*mpORBextractorLeft)(im, mvKeys, mDescriptors);
+    vector<cv::KeyPoint> keyPts;
+    (*mpORBextractorLeft)(im, keyPts, mDescriptors);
+    mvKeys = std::move(keyPts);
+}
+//-----------------------------------------------------------------------------
+void WAIFrame::SetOptFlowKeyPoints(const vector<cv::KeyPoint>& keyPts, const vector<WAIMapPoint*>& mapPts)
+{
+    mvKeys       = vector<cv::KeyPoint>(keyPts);
+    mvpMapPoints = mapPts;
+    N            = (int)mvKeys.size();
+
+    if (N > 0)
+        UndistortKeyPoints();
+    else
+        mvKeysUn.clear();
+    AssignFeaturesToGrid();
 }
 //-----------------------------------------------------------------------------
 void WAIFrame::SetPose(cv::Mat Tcw)
@@ -194,14 +243,15 @@ bool WAIFrame::isInFrustum(WAIMapPoint* pMP, float viewingCosLimit)
 {
     pMP->mbTrackInView = false;
 
-    // 3D in absolute coordinates
-    cv::Mat P = pMP->GetWorldPos();
+    // Position, normal and distances are read without locking the map point
+    WAIMapPointSnapshot mp;
+    pMP->GetSnapshot(mp);
+    const float* P = mp.worldPos;
 
-    // 3D in camera coordinates
-    const cv::Mat Pc  = mRcw * P + mtcw;
-    const float&  PcX = Pc.at<float>(0);
-    const float&  PcY = Pc.at<float>(1);
-    const float&  PcZ = Pc.at<float>(2);
+    // 3D in camera coordinates (mRcw and mtcw are views into mTcw)
+    const float PcX = mRcw.at<float>(0, 0) * P[0] + mRcw.at<float>(0, 1) * P[1] + mRcw.at<float>(0, 2) * P[2] + mtcw.at<float>(0);
+    const float PcY = mRcw.at<float>(1, 0) * P[0] + mRcw.at<float>(1, 1) * P[1] + mRcw.at<float>(1, 2) * P[2] + mtcw.at<float>(1);
+    const float PcZ = mRcw.at<float>(2, 0) * P[0] + mRcw.at<float>(2, 1) * P[1] + mRcw.at<float>(2, 2) * P[2] + mtcw.at<float>(2);
 
     // Check positive depth
     if (PcZ < 0.0f)
@@ -218,24 +268,28 @@ bool WAIFrame::isInFrustum(WAIMapPoint* pMP, float viewingCosLimit)
         return false;
 
     // Check distance is in the scale invariance region of the WAIMapPoint
-    const float   maxDistance = pMP->GetMaxDistanceInvariance();
-    const float   minDistance = pMP->GetMinDistanceInvariance();
-    const cv::Mat PO          = P - mOw;
-    const float   dist        = (float)cv::norm(PO);
+    const float maxDistance = 1.2f * mp.maxDistance;
+    const float minDistance = 0.8f * mp.minDistance;
+    const float PO[3]       = {P[0] - mOw.at<float>(0), P[1] - mOw.at<float>(1), P[2] - mOw.at<float>(2)};
+    const float dist        = (float)sqrt((double)PO[0] * PO[0] + (double)PO[1] * PO[1] + (double)PO[2] * PO[2]);
 
     if (dist < minDistance || dist > maxDistance)
         return false;
 
     // Check viewing angle
-    cv::Mat Pn = pMP->GetNormal();
+    const float* Pn = mp.normal;
 
-    const float viewCos = (float)(PO.dot(Pn) / dist);
+    const float viewCos = (float)(((double)PO[0] * Pn[0] + (double)PO[1] * Pn[1] + (double)PO[2] * Pn[2]) / dist);
 
     if (viewCos < viewingCosLimit)
         return false;
 
-    // Predict scale in the image
-    const int nPredictedLevel = pMP->PredictScale(dist, this);
+    // Predict scale in the image (as WAIMapPoint::PredictScale)
+    int nPredictedLevel = (int)ceil(log(mp.maxDistance / dist) / mfLogScaleFactor);
+    if (nPredictedLevel < 0)
+        nPredictedLevel = 0;
+    else if (nPredictedLevel >= mnScaleLevels)
+        nPredictedLevel = mnScaleLevels - 1;
 
     // Data used by the tracking
     pMP->mbTrackInView = true;
@@ -271,32 +325,32 @@ vector<size_t> WAIFrame::GetFeaturesInArea(const float& x, const float& y, const
 
     const bool bCheckLevels = (minLevel > 0) || (maxLevel >= 0);
 
+    if (mGridCellStarts.empty())
+        return vIndices;
+
+    // The cells nMinCellY to nMaxCellY of a grid column are one range in mGridIndices
     for (int ix = nMinCellX; ix <= nMaxCellX; ix++)
     {
-        for (int iy = nMinCellY; iy <= nMaxCellY; iy++)
-        {
-            const vector<size_t> vCell = mGrid[ix][iy];
-            if (vCell.empty())
-                continue;
+        const unsigned int jbegin = mGridCellStarts[ix * FRAME_GRID_ROWS + nMinCellY];
+        const unsigned int jend   = mGridCellStarts[ix * FRAME_GRID_ROWS + nMaxCellY + 1];
 
-            for (size_t j = 0, jend = vCell.size(); j < jend; j++)
+        for (unsigned int j = jbegin; j < jend; j++)
+        {
+            const cv::KeyPoint& kpUn = mvKeysUn[mGridIndices[j]];
+            if (bCheckLevels)
             {
-                const cv::KeyPoint& kpUn = mvKeysUn[vCell[j]];
-                if (bCheckLevels)
-                {
-                    if (kpUn.octave < minLevel)
+                if (kpUn.octave < minLevel)
+                    continue;
+                if (maxLevel >= 0)
+                    if (kpUn.octave > maxLevel)
                         continue;
-                    if (maxLevel >= 0)
-                        if (kpUn.octave > maxLevel)
-                            continue;
-                }
+            }
 
-                const float distx = kpUn.pt.x - x;
-                const float disty = kpUn.pt.y - y;
+            const float distx = kpUn.pt.x - x;
+            const float disty = kpUn.pt.y - y;
 
-                if (fabs(distx) < r && fabs(disty) < r)
-                    vIndices.push_back(vCell[j]);
-            }
+            if (fabs(distx) < r && fabs(disty) < r)
+                vIndices.push_back(mGridIndices[j]);
         }
     }
 
@@ -350,14 +404,15 @@ void WAIFrame::UndistortKeyPoints()
     mat = mat.reshape(1);
 
     // Fill undistorted keypoint vector
-    mvKeysUn.resize(N);
+    vector<cv::KeyPoint> keysUn(N);
     for (int i = 0; i < N; i++)
     {
         cv::KeyPoint kp = mvKeys[i];
         kp.pt.x         = mat.at<float>(i, 0);
         kp.pt.y         = mat.at<float>(i, 1);
-        mvKeysUn[i]     = kp;
+        keysUn[i]       = kp;
     }
+    mvKeysUn = std::move(keysUn);
 }
 //-----------------------------------------------------------------------------
 void WAIFrame::ComputeImageBounds(const cv::Mat& imLeft)
@@ -34,6 +34,7 @@
 #include <opencv2/opencv.hpp>
 #include <WAIOrbVocabulary.h>
 #include <orb_slam/ORBextractor.h>
+#include <memory>
 #include <vector>
 
 class WAIMapPoint;
@@ -44,18 +45,59 @@ class WAIKeyFrame;
 
 using namespace ORB_SLAM2;
 
+//-----------------------------------------------------------------------------
+//! Read-only vector that is shared by the copies of a frame
+/*!
+The keypoints and the feature grid of a frame are not changed after they are
+set. The copies of a frame (e.g. the last frame of the tracking and the frames
+in the queue of WAISlam) share them instead of copying them. The element access
+is the one of a const std::vector and it converts to a const std::vector.
+*/
+template<typename T>
+class WAISharedVector
+{
+public:
+    WAISharedVector() {}
+    WAISharedVector(std::vector<T>&& data)
+      : _data(std::make_shared<const std::vector<T>>(std::move(data))) {}
+
+    const T& operator[](size_t i) const { return (*_data)[i]; }
+    size_t   size() const { return _data ? _data->size() : 0; }
+    bool     empty() const { return size() == 0; }
+    void     clear() { _data.reset(); }
+
+    typename std::vector<T>::const_iterator begin() const { return data().begin(); }
+    typename std::vector<T>::const_iterator end() const { return data().end(); }
+
+    operator const std::vector<T>&() const { return data(); }
+
+    const std::vector<T>& data() const
+    {
+        static const std::vector<T> emptyVector;
+        return _data ? *_data : emptyVector;
+    }
+
+private:
+    std::shared_ptr<const std::vector<T>> _data; //!< Shared content (nullptr if empty)
+};
+//-----------------------------------------------------------------------------
 class WAI_API WAIFrame
 {
 public:
     WAIFrame();
-    //!copy constructor
+    //!copy constructor (the keypoints, the grid, the descriptors and the image are shared, they are never changed)
     WAIFrame(const WAIFrame& frame);
-    //!constructor used for detection in tracking
-    WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor* extractor, cv::Mat& K, cv::Mat& distCoef, WAIOrbVocabulary* vocabulary, bool retainImg = false);
+    //!move constructor
+    WAIFrame(WAIFrame&& frame) = default;
+    //!constructor used for detection in tracking (without extractFeatures the keypoints are set by optical flow tracking)
+    WAIFrame(const cv::Mat& imGray, const double& timeStamp, KPextractor* extractor, cv::Mat& K, cv::Mat& distCoef, WAIOrbVocabulary* vocabulary, bool retainImg = false, bool extractFeatures = true);
 
     // Extract feature points on the image
     void ExtractFeaturePoints(const cv::Mat& im);
 
+    // Sets the keypoints and their map points tracked with optical flow (frames without extracted features)
+    void SetOptFlowKeyPoints(const std::vector<cv::KeyPoint>& keyPts, const std::vector<WAIMapPoint*>& mapPts);
+
     // Compute Bag of Words representation.
     void ComputeBoW();
 
@@ -98,6 +140,9 @@ public:
 
     std::vector<size_t> GetFeaturesInArea(const float& x, const float& y, const float& r, const int minLevel = -1, const int maxLevel = -1) const;
 
+    WAIFrame& operator=(const WAIFrame& frame);
+    WAIFrame& operator=(WAIFrame&& frame) = default;
+
 public:
     // Vocabulary used for relocalization.
     WAIOrbVocabulary* mVocabulary = NULL;
@@ -124,8 +169,8 @@ public:
     // Vector of keypoints (original for visualization) and undistorted (actually used by the system).
     // In the stereo case, mvKeysUn is redundant as images must be rectified.
     // In the RGB-D case, RGB images can be distorted.
-    std::vector<cv::KeyPoint> mvKeys;
-    std::vector<cv::KeyPoint> mvKeysUn;
+    WAISharedVector<cv::KeyPoint> mvKeys;
+    WAISharedVector<cv::KeyPoint> mvKeysUn;
 
     // Corresponding stereo coordinate and depth for each keypoint.
     // "Monocular" keypoints have a negative value.
@@ -146,9 +191,13 @@ public:
     std::vector<WAIMapPoint*> mvpMapPoints;
 
     // Keypoints are assigned to cells in a grid to reduce matching complexity when projecting MapPoints.
-    static float             mfGridElementWidthInv;
-    static float             mfGridElementHeightInv;
-    std::vector<std::size_t> mGrid[FRAME_GRID_COLS][FRAME_GRID_ROWS];
+    // The grid is stored in compressed sparse row format: The sorted keypoint indices of the cell
+    // c = ix * FRAME_GRID_ROWS + iy are mGridIndices[mGridCellStarts[c]] to mGridIndices[mGridCellStarts[c + 1] - 1].
+    // The cells of one grid column are consecutive.
+    static float                  mfGridElementWidthInv;
+    static float                  mfGridElementHeightInv;
+    WAISharedVector<unsigned int> mGridCellStarts;
+    WAISharedVector<unsigned int> mGridIndices;
 
     // Camera pose.
     cv::Mat mTcw;
@@ -183,6 +232,12 @@ public:
     //frame image
     cv::Mat imgGray;
 
+    // True if the keypoints are tracked with optical flow instead of extracted (no descriptors)
+    bool mbOptFlow = false;
+
+    // Image pyramid for the Lucas-Kanade optical flow (built once per frame and reused as previous pyramid)
+    std::vector<cv::Mat> mvOptFlowPyramid;
+
 private:
     // Undistort keypoints given OpenCV distortion parameters.
     // Only for the RGB-D case. Stereo must be already rectified!
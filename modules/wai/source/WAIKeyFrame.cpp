@@ -31,13 +31,19 @@
 #include <WAIKeyFrame.h>
 #include <WAIMapPoint.h>
 #include <WAIKeyFrameDB.h>
+#include <WAIWorkerPool.h>
 #include <orb_slam/Converter.h>
 #include <Profiler.h>
 
 long unsigned int WAIKeyFrame::nNextId = 0;
 
 //-----------------------------------------------------------------------------
-//!load an existing keyframe (used during file load)
+/*! load an existing keyframe (used during file load)
+ If bowVec and featVec are passed (e.g. stored in the map file) they are used
+ instead of transforming the descriptors with the vocabulary. With
+ shareDescriptors the descriptors are not cloned, e.g. if they are a view into
+ a contiguous descriptor block of all loaded keyframes.
+*/
 WAIKeyFrame::WAIKeyFrame(const cv::Mat&                   Tcw,
                          unsigned long                    id,
                          bool                             fixKF,
@@ -58,7 +64,10 @@ WAIKeyFrame::WAIKeyFrame(const cv::Mat&                   Tcw,
                          int                              nMinY,
                          int                              nMaxX,
                          int                              nMaxY,
-                         const cv::Mat&                   K)
+                         const cv::Mat&                   K,
+                         const WAIBowVector*              bowVec,
+                         const WAIFeatVector*             featVec,
+                         bool                             shareDescriptors)
   : mnId(id),
     mnFrameId(0),
     mTimeStamp(0),
@@ -79,7 +88,7 @@ WAIKeyFrame::WAIKeyFrame(const cv::Mat&                   Tcw,
     invfy(1 / fy),
     N((int)N),
     mvKeysUn(vKeysUn),
-    mDescriptors(descriptors.clone()),
+    mDescriptors(shareDescriptors ? descriptors : descriptors.clone()),
     mnScaleLevels(nScaleLevels),
     mfScaleFactor(fScaleFactor),
     mfLogScaleFactor(log(fScaleFactor)),
@@ -112,8 +121,15 @@ WAIKeyFrame::WAIKeyFrame(const cv::Mat&                   Tcw,
     //set camera position
     SetPose(Tcw);
 
-    //compute mBowVec and mFeatVec
-    ComputeBoW(vocabulary);
+    //use the stored mBowVec and mFeatVec or compute them
+    //(without vocabulary they are computed later for all keyframes with the static ComputeBoW)
+    if (bowVec && featVec && !bowVec->data.empty() && !featVec->data.empty())
+    {
+        mBowVec  = *bowVec;
+        mFeatVec = *featVec;
+    }
+    else if (vocabulary)
+        ComputeBoW(vocabulary);
 
     //assign features to grid
     AssignFeaturesToGrid();
@@ -154,6 +170,8 @@ WAIKeyFrame::WAIKeyFrame(WAIFrame& F, bool retainImg)
     mnMaxY((int)F.mnMaxY),
     mK(F.mK),
     mvpMapPoints(F.mvpMapPoints),
+    mGridCellStarts(F.mGridCellStarts),
+    mGridIndices(F.mGridIndices),
     /*mpORBvocabulary(F.mpORBvocabulary),*/ mbFirstConnection(true),
     mpParent(NULL),
     mbNotErase(false),
@@ -169,18 +187,6 @@ WAIKeyFrame::WAIKeyFrame(WAIFrame& F, bool retainImg)
     mnMarker[6] = 0;
     mnId        = nNextId++;
 
-    for (int i = 0; i < FRAME_GRID_COLS; i++)
-        for (int j = 0; j < FRAME_GRID_ROWS; j++)
-            mGrid[i][j] = F.mGrid[i][j];
-
-    //mGrid.resize(mnGridCols);
-    //for (int i = 0; i<mnGridCols; i++)
-    //{
-    //    mGrid[i].resize(mnGridRows);
-    //    for (int j = 0; j<mnGridRows; j++)
-    //        mGrid[i][j] = F.mGrid[i][j];
-    //}
-
     SetPose(F.mTcw);
 
     if (retainImg && !F.imgGray.empty())
@@ -214,6 +220,20 @@ void WAIKeyFrame::ComputeBoW(WAIOrbVocabulary* vocabulary)
     }
 }
 //-----------------------------------------------------------------------------
+void WAIKeyFrame::ComputeBoW(const std::vector<WAIKeyFrame*>& keyFrames, WAIOrbVocabulary* vocabulary)
+{
+    PROFILE_SCOPE("WAI::WAIKeyFrame::ComputeBoW(keyFrames)");
+
+    if (!vocabulary)
+        return;
+
+    //the vocabulary transform only reads the tree, so the keyframes can be processed concurrently
+    WAIWorkerPool::shared().parallelFor((int)keyFrames.size(), [&](int i) {
+        if (keyFrames[i])
+            keyFrames[i]->ComputeBoW(vocabulary);
+    });
+}
+//-----------------------------------------------------------------------------
 void WAIKeyFrame::SetPose(const cv::Mat& Tcw)
 {
     PROFILE_SCOPE("WAI::WAIKeyFrame::SetPose");
@@ -265,38 +285,93 @@ cv::Mat WAIKeyFrame::GetTranslation()
 //-----------------------------------------------------------------------------
 void WAIKeyFrame::AddConnection(WAIKeyFrame* pKF, int weight)
 {
+    unique_lock<mutex> lock(mMutexConnections);
+
+    auto it      = mConnectedKeyFrameWeights.find(pKF);
+    bool isNewKF = it == mConnectedKeyFrameWeights.end();
+    if (!isNewKF && it->second == weight)
+        return;
+
+    //the ordered snapshot can only be updated in place if it contains all connections
+    //(UpdateConnections only orders the connections over the threshold)
+    shared_ptr<const WAICovisibility> cov = atomic_load(&mCovisibility);
+    bool isComplete                       = cov->orderedKFs.size() == mConnectedKeyFrameWeights.size();
+
+    if (isNewKF)
+        mConnectedKeyFrameWeights[pKF] = weight;
+    else
+        it->second = weight;
+
+    if (!isComplete)
     {
-        unique_lock<mutex> lock(mMutexConnections);
-        if (!mConnectedKeyFrameWeights.count(pKF))
-            mConnectedKeyFrameWeights[pKF] = weight;
-        else if (mConnectedKeyFrameWeights[pKF] != weight)
-            mConnectedKeyFrameWeights[pKF] = weight;
+        orderCovisibles();
+        return;
+    }
+
+    vector<WAIKeyFrame*> orderedKFs     = cov->orderedKFs;
+    vector<int>          orderedWeights = cov->orderedWeights;
+    if (!isNewKF)
+    {
+        size_t i = find(orderedKFs.begin(), orderedKFs.end(), pKF) - orderedKFs.begin();
+        orderedKFs.erase(orderedKFs.begin() + i);
+        orderedWeights.erase(orderedWeights.begin() + i);
+    }
+
+    //binary search of the insert position in the order of orderCovisibles
+    size_t lo = 0, hi = orderedKFs.size();
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (orderedWeights[mid] > weight || (orderedWeights[mid] == weight && orderedKFs[mid] > pKF))
+            lo = mid + 1;
         else
-            return;
+            hi = mid;
     }
+    orderedKFs.insert(orderedKFs.begin() + lo, pKF);
+    orderedWeights.insert(orderedWeights.begin() + lo, weight);
 
-    UpdateBestCovisibles();
+    publishCovisibility(std::move(orderedKFs), std::move(orderedWeights));
 }
 //-----------------------------------------------------------------------------
 void WAIKeyFrame::UpdateBestCovisibles()
 {
-    unique_lock<mutex>              lock(mMutexConnections);
+    unique_lock<mutex> lock(mMutexConnections);
+    orderCovisibles();
+}
+//-----------------------------------------------------------------------------
+void WAIKeyFrame::orderCovisibles()
+{
     vector<pair<int, WAIKeyFrame*>> vPairs;
     vPairs.reserve(mConnectedKeyFrameWeights.size());
     for (map<WAIKeyFrame*, int>::iterator mit = mConnectedKeyFrameWeights.begin(), mend = mConnectedKeyFrameWeights.end(); mit != mend; mit++)
         vPairs.push_back(make_pair(mit->second, mit->first));
 
-    sort(vPairs.begin(), vPairs.end());
-    list<WAIKeyFrame*> lKFs;
-    list<int>          lWs;
+    //descending order of weight (and of pointer for equal weights)
+    sort(vPairs.rbegin(), vPairs.rend());
+    vector<WAIKeyFrame*> orderedKFs(vPairs.size());
+    vector<int>          orderedWeights(vPairs.size());
     for (size_t i = 0, iend = vPairs.size(); i < iend; i++)
     {
-        lKFs.push_front(vPairs[i].second);
-        lWs.push_front(vPairs[i].first);
+        orderedKFs[i]     = vPairs[i].second;
+        orderedWeights[i] = vPairs[i].first;
     }
 
-    mvpOrderedConnectedKeyFrames = vector<WAIKeyFrame*>(lKFs.begin(), lKFs.end());
-    mvOrderedWeights             = vector<int>(lWs.begin(), lWs.end());
+    publishCovisibility(std::move(orderedKFs), std::move(orderedWeights));
+}
+//-----------------------------------------------------------------------------
+void WAIKeyFrame::publishCovisibility(vector<WAIKeyFrame*>&& orderedKFs, vector<int>&& orderedWeights)
+{
+    shared_ptr<WAICovisibility> cov = make_shared<WAICovisibility>();
+    cov->orderedKFs                 = std::move(orderedKFs);
+    cov->orderedWeights             = std::move(orderedWeights);
+    cov->version                    = atomic_load(&mCovisibility)->version + 1;
+
+    atomic_store(&mCovisibility, shared_ptr<const WAICovisibility>(cov));
+}
+//-----------------------------------------------------------------------------
+shared_ptr<const WAICovisibility> WAIKeyFrame::GetCovisibility()
+{
+    return atomic_load(&mCovisibility);
 }
 //-----------------------------------------------------------------------------
 set<WAIKeyFrame*> WAIKeyFrame::GetConnectedKeyFrames()
@@ -310,33 +385,32 @@ set<WAIKeyFrame*> WAIKeyFrame::GetConnectedKeyFrames()
 //-----------------------------------------------------------------------------
 vector<WAIKeyFrame*> WAIKeyFrame::GetVectorCovisibleKeyFrames()
 {
-    unique_lock<mutex> lock(mMutexConnections);
-    return mvpOrderedConnectedKeyFrames;
+    return GetCovisibility()->orderedKFs;
 }
 //-----------------------------------------------------------------------------
 vector<WAIKeyFrame*> WAIKeyFrame::GetBestCovisibilityKeyFrames(const int& N)
 {
-    unique_lock<mutex> lock(mMutexConnections);
-    if ((int)mvpOrderedConnectedKeyFrames.size() < N)
-        return mvpOrderedConnectedKeyFrames;
+    shared_ptr<const WAICovisibility> cov = GetCovisibility();
+    if ((int)cov->orderedKFs.size() < N)
+        return cov->orderedKFs;
     else
-        return vector<WAIKeyFrame*>(mvpOrderedConnectedKeyFrames.begin(), mvpOrderedConnectedKeyFrames.begin() + N);
+        return vector<WAIKeyFrame*>(cov->orderedKFs.begin(), cov->orderedKFs.begin() + N);
 }
 //-----------------------------------------------------------------------------
 vector<WAIKeyFrame*> WAIKeyFrame::GetCovisiblesByWeight(const int& w)
 {
-    unique_lock<mutex> lock(mMutexConnections);
+    shared_ptr<const WAICovisibility> cov = GetCovisibility();
 
-    if (mvpOrderedConnectedKeyFrames.empty())
+    if (cov->orderedKFs.empty())
         return vector<WAIKeyFrame*>();
 
-    vector<int>::iterator it = upper_bound(mvOrderedWeights.begin(), mvOrderedWeights.end(), w, WAIKeyFrame::weightComp);
-    if (it == mvOrderedWeights.end())
+    vector<int>::const_iterator it = upper_bound(cov->orderedWeights.begin(), cov->orderedWeights.end(), w, WAIKeyFrame::weightComp);
+    if (it == cov->orderedWeights.end())
         return vector<WAIKeyFrame*>();
     else
     {
-        int n = (int)(it - mvOrderedWeights.begin());
-        return vector<WAIKeyFrame*>(mvpOrderedConnectedKeyFrames.begin(), mvpOrderedConnectedKeyFrames.begin() + n);
+        int n = (int)(it - cov->orderedWeights.begin());
+        return vector<WAIKeyFrame*>(cov->orderedKFs.begin(), cov->orderedKFs.begin() + n);
     }
 }
 //-----------------------------------------------------------------------------
@@ -507,28 +581,27 @@ void WAIKeyFrame::UpdateConnections(std::map<WAIKeyFrame*, int> KFcounter, bool
         pKFmax->AddConnection(this, nmax);
     }
 
-    sort(vPairs.begin(), vPairs.end());
-    list<WAIKeyFrame*> lKFs;
-    list<int>          lWs;
+    //descending order of weight (and of pointer for equal weights)
+    sort(vPairs.rbegin(), vPairs.rend());
+    vector<WAIKeyFrame*> orderedKFs(vPairs.size());
+    vector<int>          orderedWeights(vPairs.size());
     for (size_t i = 0; i < vPairs.size(); i++)
     {
-        lKFs.push_front(vPairs[i].second);
-        lWs.push_front(vPairs[i].first);
+        orderedKFs[i]     = vPairs[i].second;
+        orderedWeights[i] = vPairs[i].first;
     }
 
     {
         unique_lock<mutex> lockCon(mMutexConnections);
 
-        // mspConnectedKeyFrames = spConnectedKeyFrames;
-        mConnectedKeyFrameWeights    = KFcounter;
-        mvpOrderedConnectedKeyFrames = vector<WAIKeyFrame*>(lKFs.begin(), lKFs.end());
-        mvOrderedWeights             = vector<int>(lWs.begin(), lWs.end());
+        mConnectedKeyFrameWeights = KFcounter;
+        publishCovisibility(std::move(orderedKFs), std::move(orderedWeights));
 
         if (mbFirstConnection && mnId != 0)
         {
             if (buildSpanningTree)
             {
-                mpParent = mvpOrderedConnectedKeyFrames.front();
+                mpParent = atomic_load(&mCovisibility)->orderedKFs.front();
                 mpParent->AddChild(this);
             }
             mbFirstConnection = false;
@@ -645,7 +718,7 @@ void WAIKeyFrame::SetBadFlag()
         unique_lock<mutex> lock1(mMutexFeatures);
 
         mConnectedKeyFrameWeights.clear();
-        mvpOrderedConnectedKeyFrames.clear();
+        publishCovisibility(vector<WAIKeyFrame*>(), vector<int>());
 
         // ghm1: Update Spanning Tree: As we try to cull a keyframe we have to update the parent keyframe from all his children.
         // A parent keyframe is the one that has the best covisibility with his potential child. So it is not necessaryly the parent of the culled keyframe.
@@ -754,18 +827,29 @@ bool WAIKeyFrame::isBad()
 //-----------------------------------------------------------------------------
 void WAIKeyFrame::EraseConnection(WAIKeyFrame* pKF)
 {
-    bool bUpdate = false;
+    unique_lock<mutex> lock(mMutexConnections);
+
+    auto it = mConnectedKeyFrameWeights.find(pKF);
+    if (it == mConnectedKeyFrameWeights.end())
+        return;
+
+    shared_ptr<const WAICovisibility> cov = atomic_load(&mCovisibility);
+    bool isComplete                       = cov->orderedKFs.size() == mConnectedKeyFrameWeights.size();
+    mConnectedKeyFrameWeights.erase(it);
+
+    if (!isComplete)
     {
-        unique_lock<mutex> lock(mMutexConnections);
-        if (mConnectedKeyFrameWeights.count(pKF))
-        {
-            mConnectedKeyFrameWeights.erase(pKF);
-            bUpdate = true;
-        }
+        orderCovisibles();
+        return;
     }
 
-    if (bUpdate)
-        UpdateBestCovisibles();
+    //removing an element keeps the order of the others
+    vector<WAIKeyFrame*> orderedKFs     = cov->orderedKFs;
+    vector<int>          orderedWeights = cov->orderedWeights;
+    size_t               i              = find(orderedKFs.begin(), orderedKFs.end(), pKF) - orderedKFs.begin();
+    orderedKFs.erase(orderedKFs.begin() + i);
+    orderedWeights.erase(orderedWeights.begin() + i);
+    publishCovisibility(std::move(orderedKFs), std::move(orderedWeights));
 }
 //-----------------------------------------------------------------------------
 vector<size_t> WAIKeyFrame::GetFeaturesInArea(const float& x, const float& y, const float& r) const
@@ -789,20 +873,23 @@ vector<size_t> WAIKeyFrame::GetFeaturesInArea(const float& x, const float& y, co
     if (nMaxCellY < 0)
         return vIndices;
 
+    if (mGridCellStarts.empty())
+        return vIndices;
+
+    // The cells nMinCellY to nMaxCellY of a grid column are one range in mGridIndices
     for (int ix = nMinCellX; ix <= nMaxCellX; ix++)
     {
-        for (int iy = nMinCellY; iy <= nMaxCellY; iy++)
+        const unsigned int jbegin = mGridCellStarts[ix * mnGridRows + nMinCellY];
+        const unsigned int jend   = mGridCellStarts[ix * mnGridRows + nMaxCellY + 1];
+
+        for (unsigned int j = jbegin; j < jend; j++)
         {
-            const vector<size_t> vCell = mGrid[ix][iy];
-            for (size_t j = 0, jend = vCell.size(); j < jend; j++)
-            {
-                const cv::KeyPoint& kpUn  = mvKeysUn[vCell[j]];
-                const float         distx = kpUn.pt.x - x;
-                const float         disty = kpUn.pt.y - y;
+            const cv::KeyPoint& kpUn  = mvKeysUn[mGridIndices[j]];
+            const float         distx = kpUn.pt.x - x;
+            const float         disty = kpUn.pt.y - y;
 
-                if (fabs(distx) < r && fabs(disty) < r)
-                    vIndices.push_back(vCell[j]);
-            }
+            if (fabs(distx) < r && fabs(disty) < r)
+                vIndices.push_back(mGridIndices[j]);
         }
     }
 
@@ -859,19 +946,31 @@ void WAIKeyFrame::AssignFeaturesToGrid()
 {
     PROFILE_SCOPE("WAI::WAIKeyFrame::AssignFeaturesToGrid");
 
-    int nReserve = (int)(0.5f * N / (FRAME_GRID_COLS * FRAME_GRID_ROWS));
-    for (unsigned int i = 0; i < FRAME_GRID_COLS; i++)
-        for (unsigned int j = 0; j < FRAME_GRID_ROWS; j++)
-            mGrid[i][j].reserve(nReserve);
+    // Counting sort into the cells as in WAIFrame::AssignFeaturesToGrid
+    vector<int> keyPointCells(N, -1);
+    mGridCellStarts.assign(FRAME_GRID_COLS * FRAME_GRID_ROWS + 1, 0);
 
     for (int i = 0; i < N; i++)
     {
-        const cv::KeyPoint& kp = mvKeysUn[i];
-
         int nGridPosX, nGridPosY;
-        if (PosInGrid(kp, nGridPosX, nGridPosY))
-            mGrid[nGridPosX][nGridPosY].push_back(i);
+        if (PosInGrid(mvKeysUn[i], nGridPosX, nGridPosY))
+        {
+            keyPointCells[i] = nGridPosX * FRAME_GRID_ROWS + nGridPosY;
+            mGridCellStarts[keyPointCells[i] + 1]++;
+        }
     }
+
+    for (size_t c = 1; c < mGridCellStarts.size(); c++)
+        mGridCellStarts[c] += mGridCellStarts[c - 1];
+
+    mGridIndices.resize(mGridCellStarts.back());
+    for (int i = 0; i < N; i++)
+        if (keyPointCells[i] >= 0)
+            mGridIndices[mGridCellStarts[keyPointCells[i]]++] = (unsigned int)i;
+
+    for (size_t c = mGridCellStarts.size() - 1; c > 0; c--)
+        mGridCellStarts[c] = mGridCellStarts[c - 1];
+    mGridCellStarts[0] = 0;
 }
 //-----------------------------------------------------------------------------
 //! this is a function from Frame, but we need it here for map loading
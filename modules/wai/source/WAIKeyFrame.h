@@ -32,6 +32,7 @@
 #define WAIKEYFRAME_H
 
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -49,7 +50,20 @@ using namespace ORB_SLAM2;
 class WAIMapPoint;
 class WAIKeyFrameDB;
 class WAIMap;
+class WAIKeyFrame;
 
+//-----------------------------------------------------------------------------
+//! Immutable snapshot of the covisibility graph edges of a keyframe
+/*! The keyframe publishes a new snapshot on every change of its connections.
+Readers keep the snapshot alive with its shared pointer and can walk it without
+holding the connections mutex of the keyframe.
+*/
+struct WAICovisibility
+{
+    std::vector<WAIKeyFrame*> orderedKFs;     //!< connected keyframes ordered by descending weight
+    std::vector<int>          orderedWeights; //!< covisibility weights of orderedKFs
+    unsigned long             version = 0;    //!< incremented with every published snapshot
+};
 //-----------------------------------------------------------------------------
 //! AR Keyframe node class
 /*! A Keyframe is a camera with a position and additional information about key-
@@ -81,7 +95,10 @@ public:
                 int                              nMinY,
                 int                              nMaxX,
                 int                              nMaxY,
-                const cv::Mat&                   KB);
+                const cv::Mat&                   KB,
+                const WAIBowVector*              bowVec           = nullptr,
+                const WAIFeatVector*             featVec          = nullptr,
+                bool                             shareDescriptors = false);
 
     //!keyframe generation from frame
     WAIKeyFrame(WAIFrame& F, bool retainImg = true);
@@ -97,6 +114,8 @@ public:
     // Bag of Words Representation
     void ComputeBoW(WAIOrbVocabulary* vocabulary);
     void SetBowVector(WAIBowVector& bow);
+    //! Computes the missing BoW and feature vectors of all keyframes in parallel (e.g. after map loading)
+    static void ComputeBoW(const std::vector<WAIKeyFrame*>& keyFrames, WAIOrbVocabulary* vocabulary);
 
     // Covisibility graph functions
     void                      AddConnection(WAIKeyFrame* pKF, int weight);
@@ -108,6 +127,8 @@ public:
     std::vector<WAIKeyFrame*> GetVectorCovisibleKeyFrames();
     std::vector<WAIKeyFrame*> GetBestCovisibilityKeyFrames(const int& N);
     std::vector<WAIKeyFrame*> GetCovisiblesByWeight(const int& w);
+    //! current snapshot of the ordered covisibles (does not block the mapping threads)
+    std::shared_ptr<const WAICovisibility> GetCovisibility();
     //get weight of covisibility connection to this keyframe
     int                                GetWeight(WAIKeyFrame* pKF);
     const std::map<WAIKeyFrame*, int>& GetConnectedKfWeights();
@@ -263,14 +284,15 @@ protected:
     //unassociated keypoint from original frame)
     std::vector<WAIMapPoint*> mvpMapPoints;
 
-    // Grid over the image to speed up feature matching
-    std::vector<std::size_t> mGrid[FRAME_GRID_COLS][FRAME_GRID_ROWS];
+    // Grid over the image to speed up feature matching (compressed sparse row format as in WAIFrame)
+    std::vector<unsigned int> mGridCellStarts;
+    std::vector<unsigned int> mGridIndices;
 
     //maps covisibility weights to this keyframe by keyframe pointer of the connected one
     std::map<WAIKeyFrame*, int> mConnectedKeyFrameWeights;
     //all covisibility keyframes ordered by weight (over min thres 15) (number of common keypoint observations)
-    std::vector<WAIKeyFrame*> mvpOrderedConnectedKeyFrames;
-    std::vector<int>          mvOrderedWeights;
+    //published as immutable snapshot (written under mMutexConnections, read with GetCovisibility)
+    std::shared_ptr<const WAICovisibility> mCovisibility = std::make_shared<const WAICovisibility>();
 
     // Spanning Tree and Loop Edges
     bool                   mbFirstConnection = true;
@@ -304,6 +326,10 @@ private:
     void AssignFeaturesToGrid();
     //! this is a function from Frame, but we need it here for map loading
     bool PosInGrid(const cv::KeyPoint& kp, int& posX, int& posY);
+    //! orders all connections by weight and publishes them (mMutexConnections has to be locked)
+    void orderCovisibles();
+    //! publishes a new covisibility snapshot (mMutexConnections has to be locked)
+    void publishCovisibility(std::vector<WAIKeyFrame*>&& orderedKFs, std::vector<int>&& orderedWeights);
 
     //path to background texture image
     std::string _pathToTexture;
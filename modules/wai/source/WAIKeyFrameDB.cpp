@@ -29,8 +29,17 @@
 */
 
 #include <WAIKeyFrameDB.h>
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <cmath>
+//-----------------------------------------------------------------------------
+//! Returns the current camera center of the keyframe
+static cv::Point3f cameraCenter(WAIKeyFrame* pKF)
+{
+    cv::Mat Ow = pKF->GetCameraCenter();
+    return cv::Point3f(Ow.at<float>(0), Ow.at<float>(1), Ow.at<float>(2));
+}
 //-----------------------------------------------------------------------------
 WAIKeyFrameDB::WAIKeyFrameDB(WAIOrbVocabulary* voc) : mpVoc(voc)
 {
@@ -46,9 +55,30 @@ void WAIKeyFrameDB::add(WAIKeyFrame* pKF)
         std::cout << "kf data empty" << std::endl;
         return;
     }
+
+    if (_slotOfKeyFrame.count(pKF))
+        return;
+
+    int slot;
+    if (_freeSlots.empty())
+    {
+        slot = (int)_slotKeyFrames.size();
+        _slotKeyFrames.push_back(pKF);
+        _slotResident.push_back(true);
+    }
+    else
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+        _slotKeyFrames[slot] = pKF;
+        _slotResident[slot]  = true;
+    }
+    _slotOfKeyFrame[pKF] = slot;
+    indexSlot(slot, cameraCenter(pKF));
+
     for (auto vit = pKF->mBowVec.getWordScoreMapping().begin(), vend = pKF->mBowVec.getWordScoreMapping().end(); vit != vend; vit++)
     {
-        mvInvertedFile[vit->first].push_back(pKF);
+        mvInvertedFile[vit->first].push_back({slot, (float)vit->second});
     }
 }
 //-----------------------------------------------------------------------------
@@ -56,27 +86,311 @@ void WAIKeyFrameDB::erase(WAIKeyFrame* pKF)
 {
     std::unique_lock<std::mutex> lock(mMutex);
 
+    auto slotIt = _slotOfKeyFrame.find(pKF);
+    if (slotIt == _slotOfKeyFrame.end())
+        return;
+
+    const int slot = slotIt->second;
+
     // Erase elements in the Inverse File for the entry
     for (auto vit = pKF->mBowVec.getWordScoreMapping().begin(), vend = pKF->mBowVec.getWordScoreMapping().end(); vit != vend; vit++)
     {
-        // List of keyframes that share the word
-        std::list<WAIKeyFrame*>& lKFs = mvInvertedFile[vit->first];
+        // Posting list of keyframes that share the word. The remaining postings
+        // are moved together, so the list stays contiguous and in insert order.
+        std::vector<Posting>& postings = mvInvertedFile[vit->first];
 
-        for (std::list<WAIKeyFrame*>::iterator lit = lKFs.begin(), lend = lKFs.end(); lit != lend; lit++)
+        for (auto pit = postings.begin(), pend = postings.end(); pit != pend; pit++)
         {
-            if (pKF == *lit)
+            if (pit->slot == slot)
             {
-                lKFs.erase(lit);
+                postings.erase(pit);
                 break;
             }
         }
     }
+
+    unindexSlot(slot);
+    _slotKeyFrames[slot] = nullptr;
+    _freeSlots.push_back(slot);
+    _slotOfKeyFrame.erase(slotIt);
 }
 //-----------------------------------------------------------------------------
 void WAIKeyFrameDB::clear()
 {
+    std::unique_lock<std::mutex> lock(mMutex);
     mvInvertedFile.clear();
     mvInvertedFile.resize(mpVoc->size());
+    _slotKeyFrames.clear();
+    _freeSlots.clear();
+    _slotOfKeyFrame.clear();
+    _slotResident.clear();
+    _tileSlots.clear();
+    _slotTile.clear();
+    _hasResidentRegion = false;
+}
+//-----------------------------------------------------------------------------
+/*! Restricts the relocalization queries to the keyframes in the tiles of the
+region. The tiles are assigned by the current camera centers of the keyframes,
+so that poses changed by loop closing or bundle adjustment are respected.
+*/
+void WAIKeyFrameDB::setResidentRegion(const WAIMapTiles::Region& region)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    std::vector<cv::Point3f> positions(_slotKeyFrames.size());
+    std::vector<int>         slots;
+    slots.reserve(_slotKeyFrames.size());
+    for (size_t slot = 0; slot < _slotKeyFrames.size(); slot++)
+    {
+        if (!_slotKeyFrames[slot])
+            continue;
+
+        positions[slots.size()] = cameraCenter(_slotKeyFrames[slot]);
+        slots.push_back((int)slot);
+    }
+    positions.resize(slots.size());
+
+    // the camera centers are read anyway, so the spatial index is updated too
+    _tileSlots.clear();
+    for (size_t i = 0; i < slots.size(); i++)
+        indexSlot(slots[i], positions[i]);
+
+    std::vector<bool> selected;
+    _tiles.select(positions, region, selected);
+
+    _slotResident.assign(_slotKeyFrames.size(), false);
+    for (size_t i = 0; i < slots.size(); i++)
+        _slotResident[slots[i]] = selected[i];
+
+    _residentRegion    = region;
+    _hasResidentRegion = true;
+}
+//-----------------------------------------------------------------------------
+/*! Returns the region of the last setResidentRegion (see hasResidentRegion).
+Passed to WAIMapStorage::loadMapBinary it loads the same tiles of a stored map.
+*/
+WAIMapTiles::Region WAIKeyFrameDB::residentRegion()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    return _residentRegion;
+}
+//-----------------------------------------------------------------------------
+//! Sets the edge length of the map tiles and rebuilds the spatial index
+void WAIKeyFrameDB::tileSize(float size)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    _tiles.tileSize(size);
+    rebuildSpatialIndex();
+}
+//-----------------------------------------------------------------------------
+/*! Reassigns all keyframes to the map tiles of their current camera centers.
+Should be called after big map changes (loop closing, global bundle adjustment),
+because the index only tolerates keyframes that moved by less than a tile.
+*/
+void WAIKeyFrameDB::updateSpatialIndex()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    rebuildSpatialIndex();
+}
+//-----------------------------------------------------------------------------
+//! Adds the slot to the tile of the position (mMutex must be locked)
+void WAIKeyFrameDB::indexSlot(int slot, const cv::Point3f& position)
+{
+    if (_slotTile.size() <= (size_t)slot)
+        _slotTile.resize(slot + 1);
+
+    uint64_t key    = _tiles.tileKey(position);
+    _slotTile[slot] = key;
+    _tileSlots[key].push_back(slot);
+}
+//-----------------------------------------------------------------------------
+//! Removes the slot from its tile (mMutex must be locked)
+void WAIKeyFrameDB::unindexSlot(int slot)
+{
+    auto tileIt = _tileSlots.find(_slotTile[slot]);
+    if (tileIt == _tileSlots.end())
+        return;
+
+    std::vector<int>& slots = tileIt->second;
+    auto              it    = std::find(slots.begin(), slots.end(), slot);
+    if (it != slots.end())
+    {
+        *it = slots.back();
+        slots.pop_back();
+    }
+    if (slots.empty())
+        _tileSlots.erase(tileIt);
+}
+//-----------------------------------------------------------------------------
+//! Reassigns all slots to their tiles (mMutex must be locked)
+void WAIKeyFrameDB::rebuildSpatialIndex()
+{
+    _tileSlots.clear();
+    for (size_t slot = 0; slot < _slotKeyFrames.size(); slot++)
+        if (_slotKeyFrames[slot])
+            indexSlot((int)slot, cameraCenter(_slotKeyFrames[slot]));
+}
+//-----------------------------------------------------------------------------
+/*! Flags the slots of the keyframes whose camera center is within the radius
+of the prior and whose viewing direction (camera z-axis) is within the heading
+cone (mMutex must be locked). Only the tiles around the prior are visited. They
+are searched with a margin of one tile for keyframes that were moved by local
+bundle adjustment since they were indexed. If the search box has more tiles
+than the map, all keyframes are tested.
+*/
+void WAIKeyFrameDB::selectPriorSlots(const PosePrior& prior, std::vector<char>& selected)
+{
+    selected.assign(_slotKeyFrames.size(), 0);
+
+    const float        ts      = _tiles.tileSize();
+    const float        reach   = prior.radius + ts;
+    const cv::Point3f& p       = prior.position;
+    const float        dirNorm = (float)cv::norm(prior.viewDir);
+    const float        minCos  = std::cos(prior.maxAngleDEG * (float)CV_PI / 180.0f);
+
+    auto test = [&](int slot)
+    {
+        WAIKeyFrame* pKF = _slotKeyFrames[slot];
+        if (!pKF)
+            return;
+
+        if (cv::norm(cameraCenter(pKF) - p) > prior.radius)
+            return;
+
+        if (dirNorm > 0.0f)
+        {
+            cv::Mat     Rcw = pKF->GetRotation();
+            cv::Point3f kfDir(Rcw.at<float>(2, 0), Rcw.at<float>(2, 1), Rcw.at<float>(2, 2));
+            if (kfDir.dot(prior.viewDir) < minCos * dirNorm)
+                return;
+        }
+
+        selected[slot] = 1;
+    };
+
+    const int ix0 = (int)std::floor((p.x - reach) / ts), ix1 = (int)std::floor((p.x + reach) / ts);
+    const int iy0 = (int)std::floor((p.y - reach) / ts), iy1 = (int)std::floor((p.y + reach) / ts);
+    const int iz0 = (int)std::floor((p.z - reach) / ts), iz1 = (int)std::floor((p.z + reach) / ts);
+
+    const double numTiles = (double)(ix1 - ix0 + 1) * (iy1 - iy0 + 1) * (iz1 - iz0 + 1);
+    if (numTiles > (double)_tileSlots.size())
+    {
+        for (size_t slot = 0; slot < _slotKeyFrames.size(); slot++)
+            test((int)slot);
+        return;
+    }
+
+    for (int ix = ix0; ix <= ix1; ix++)
+        for (int iy = iy0; iy <= iy1; iy++)
+            for (int iz = iz0; iz <= iz1; iz++)
+            {
+                cv::Point3f tileCenter((ix + 0.5f) * ts, (iy + 0.5f) * ts, (iz + 0.5f) * ts);
+                auto        tileIt = _tileSlots.find(_tiles.tileKey(tileCenter));
+                if (tileIt == _tileSlots.end())
+                    continue;
+
+                for (int slot : tileIt->second)
+                    test(slot);
+            }
+}
+//-----------------------------------------------------------------------------
+//! Makes all keyframes resident again
+void WAIKeyFrameDB::clearResidentRegion()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    _slotResident.assign(_slotKeyFrames.size(), true);
+    _hasResidentRegion = false;
+}
+//-----------------------------------------------------------------------------
+int WAIKeyFrameDB::numResidentKeyFrames()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    int n = 0;
+    for (size_t slot = 0; slot < _slotKeyFrames.size(); slot++)
+        if (_slotKeyFrames[slot] && _slotResident[slot])
+            n++;
+    return n;
+}
+//-----------------------------------------------------------------------------
+/*! Returns in vpKFs all keyframes that share at least one word with bow in the
+order of their first common word. vCommonWords gets the NO. of common words and
+vScores the BoW score of every keyframe. The words and scores are accumulated
+in flat arrays indexed by the keyframe slot in one pass over the posting lists.
+With fbow the score is the dot product over the common words, so it is summed
+up in the same pass in the same order as fbow::fBow::score does.
+With residentOnly the keyframes outside of the resident region are skipped.
+With a pose prior only the postings of the keyframes around the prior are
+accumulated (see selectPriorSlots).
+*/
+void WAIKeyFrameDB::accumulateScores(WAIBowVector&              bow,
+                                     std::vector<WAIKeyFrame*>& vpKFs,
+                                     std::vector<int>&          vCommonWords,
+                                     std::vector<float>&        vScores,
+                                     bool                       residentOnly,
+                                     const PosePrior*           prior)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    const size_t        nSlots = _slotKeyFrames.size();
+    std::vector<int>    commonWords(nSlots, 0);
+    std::vector<double> scores(nSlots, 0.0);
+    std::vector<int>    touchedSlots;
+
+    std::vector<char> priorSlots;
+    if (prior)
+        selectPriorSlots(*prior, priorSlots);
+    const char* mask = prior ? priorSlots.data() : nullptr;
+
+    for (auto vit = bow.getWordScoreMapping().begin(), vend = bow.getWordScoreMapping().end(); vit != vend; vit++)
+    {
+        if (vit->first >= mvInvertedFile.size())
+        {
+            std::stringstream ss;
+            ss << "WAIKeyFrameDB::accumulateScores: word index bigger than inverted file. word: " << vit->first << " val: " << vit->second;
+            throw std::runtime_error(ss.str());
+        }
+
+        const std::vector<Posting>& postings = mvInvertedFile[vit->first];
+        const Posting*              pp       = postings.data();
+        const size_t                n        = postings.size();
+        const float                 weight   = vit->second;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const int slot = pp[i].slot;
+            if (mask && !mask[slot])
+                continue;
+            if (commonWords[slot]++ == 0)
+                touchedSlots.push_back(slot);
+            scores[slot] += weight * pp[i].weight;
+        }
+    }
+
+    if (residentOnly && _hasResidentRegion)
+    {
+        touchedSlots.erase(std::remove_if(touchedSlots.begin(),
+                                          touchedSlots.end(),
+                                          [this](int slot)
+                                          { return !_slotResident[slot]; }),
+                           touchedSlots.end());
+    }
+
+    vpKFs.resize(touchedSlots.size());
+    vCommonWords.resize(touchedSlots.size());
+    vScores.resize(touchedSlots.size());
+
+    for (size_t i = 0; i < touchedSlots.size(); i++)
+    {
+        const int slot  = touchedSlots[i];
+        vpKFs[i]        = _slotKeyFrames[slot];
+        vCommonWords[i] = commonWords[slot];
+#if USE_FBOW
+        vScores[i] = (float)scores[slot];
+#else
+        vScores[i] = (float)mpVoc->score(bow, vpKFs[i]->mBowVec);
+#endif
+    }
 }
 //-----------------------------------------------------------------------------
 // NOTE(jan): errorcode is set to:
@@ -91,26 +405,21 @@ std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectLoopCandidates(WAIKeyFrame* pKF,
     // Search all keyframes that share a word with current keyframes
     // Discard keyframes connected to the query keyframe
     {
-        std::unique_lock<std::mutex> lock(mMutex);
+        std::vector<WAIKeyFrame*> vpKFs;
+        std::vector<int>          vCommonWords;
+        std::vector<float>        vScores;
+        accumulateScores(pKF->mBowVec, vpKFs, vCommonWords, vScores);
 
-        for (auto vit = pKF->mBowVec.getWordScoreMapping().begin(), vend = pKF->mBowVec.getWordScoreMapping().end(); vit != vend; vit++)
+        for (size_t i = 0; i < vpKFs.size(); i++)
         {
-            std::list<WAIKeyFrame*>& lKFs = mvInvertedFile[vit->first];
+            WAIKeyFrame* pKFi = vpKFs[i];
+            if (spConnectedKeyFrames.count(pKFi))
+                continue;
 
-            for (std::list<WAIKeyFrame*>::iterator lit = lKFs.begin(), lend = lKFs.end(); lit != lend; lit++)
-            {
-                WAIKeyFrame* pKFi = *lit;
-                if (pKFi->mnLoopQuery != pKF->mnId)
-                {
-                    pKFi->mnLoopWords = 0;
-                    if (!spConnectedKeyFrames.count(pKFi))
-                    {
-                        pKFi->mnLoopQuery = pKF->mnId;
-                        lKFsSharingWords.push_back(pKFi);
-                    }
-                }
-                pKFi->mnLoopWords++;
-            }
+            pKFi->mnLoopQuery = pKF->mnId;
+            pKFi->mnLoopWords = vCommonWords[i];
+            pKFi->mLoopScore  = vScores[i];
+            lKFsSharingWords.push_back(pKFi);
         }
     }
 
@@ -139,9 +448,8 @@ std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectLoopCandidates(WAIKeyFrame* pKF,
 
         if (pKFi->mnLoopWords > minCommonWords)
         {
-            float si = (float)mpVoc->score(pKF->mBowVec, pKFi->mBowVec);
+            float si = pKFi->mLoopScore;
 
-            pKFi->mLoopScore = si;
             if (si >= minScore)
                 lScoreAndMatch.push_back(std::make_pair(si, pKFi));
         }
@@ -216,34 +524,21 @@ std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectRelocalizationCandidates(WAIFrame
 
     // Search all keyframes that share a word with current frame
     {
-        std::unique_lock<std::mutex> lock(mMutex);
+        std::vector<WAIKeyFrame*> vpKFs;
+        std::vector<int>          vCommonWords;
+        std::vector<float>        vAllScores;
+        accumulateScores(F->mBowVec, vpKFs, vCommonWords, vAllScores, true);
 
-        for (auto vit = F->mBowVec.getWordScoreMapping().begin(), vend = F->mBowVec.getWordScoreMapping().end(); vit != vend; vit++)
+        for (size_t i = 0; i < vpKFs.size(); i++)
         {
-            if (vit->first > mvInvertedFile.size())
-            {
-                std::stringstream ss;
-                ss << "WAIKeyFrameDB::DetectRelocalizationCandidates: word index bigger than inverted file. word: " << vit->first << " val: " << vit->second;
-                throw std::runtime_error(ss.str());
-            }
-
-            std::list<WAIKeyFrame*>& lKFs = mvInvertedFile[vit->first];
-
-            for (std::list<WAIKeyFrame*>::iterator lit = lKFs.begin(), lend = lKFs.end(); lit != lend; lit++)
-            {
-                WAIKeyFrame* pKFi = *lit;
-                if (pKFi->isBad())
-                    continue;
+            WAIKeyFrame* pKFi = vpKFs[i];
+            if (pKFi->isBad())
+                continue;
 
-                if (pKFi->mnRelocQuery != F->mnId)
-                {
-                    pKFi->mnRelocWords = 0;
-                    pKFi->mRelocScore  = 0.f;
-                    pKFi->mnRelocQuery = F->mnId;
-                    lKFsSharingWords.push_back(pKFi);
-                }
-                pKFi->mnRelocWords++;
-            }
+            pKFi->mnRelocWords = vCommonWords[i];
+            pKFi->mRelocScore  = 0.f;
+            pKFi->mnRelocQuery = F->mnId;
+            lKFsSharingWords.push_back(pKFi);
         }
     }
     if (lKFsSharingWords.empty())
@@ -259,39 +554,49 @@ std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectRelocalizationCandidates(WAIFrame
 
 
 std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectRelocalizationCandidates(WAIFrame* F, float minCommonWordFactor, bool applyMinAccScoreFilter)
+{
+    return relocalizationCandidates(F, nullptr, minCommonWordFactor, applyMinAccScoreFilter);
+}
+//-----------------------------------------------------------------------------
+/*! Returns the relocalization candidates among the keyframes that are within
+the radius and heading cone of the pose prior. The other keyframes are skipped
+before the BoW scoring, so they are neither scored nor matched in the expensive
+relocalization with PnP RANSAC.
+*/
+std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectRelocalizationCandidates(WAIFrame*        F,
+                                                                        const PosePrior& prior,
+                                                                        float            minCommonWordFactor,
+                                                                        bool             applyMinAccScoreFilter)
+{
+    return relocalizationCandidates(F, &prior, minCommonWordFactor, applyMinAccScoreFilter);
+}
+//-----------------------------------------------------------------------------
+std::vector<WAIKeyFrame*> WAIKeyFrameDB::relocalizationCandidates(WAIFrame*        F,
+                                                                  const PosePrior* prior,
+                                                                  float            minCommonWordFactor,
+                                                                  bool             applyMinAccScoreFilter)
 {
     std::list<WAIKeyFrame*> lKFsSharingWords;
+    std::vector<float>      vScores;
 
     // Search all keyframes that share a word with current frame
     {
-        std::unique_lock<std::mutex> lock(mMutex);
+        std::vector<WAIKeyFrame*> vpKFs;
+        std::vector<int>          vCommonWords;
+        std::vector<float>        vAllScores;
+        accumulateScores(F->mBowVec, vpKFs, vCommonWords, vAllScores, true, prior);
 
-        for (auto vit = F->mBowVec.getWordScoreMapping().begin(), vend = F->mBowVec.getWordScoreMapping().end(); vit != vend; vit++)
+        for (size_t i = 0; i < vpKFs.size(); i++)
         {
-            if (vit->first > mvInvertedFile.size())
-            {
-                std::stringstream ss;
-                ss << "WAIKeyFrameDB::DetectRelocalizationCandidates: word index bigger than inverted file. word: " << vit->first << " val: " << vit->second;
-                throw std::runtime_error(ss.str());
-            }
-
-            std::list<WAIKeyFrame*>& lKFs = mvInvertedFile[vit->first];
-
-            for (std::list<WAIKeyFrame*>::iterator lit = lKFs.begin(), lend = lKFs.end(); lit != lend; lit++)
-            {
-                WAIKeyFrame* pKFi = *lit;
-                if (pKFi->isBad())
-                    continue;
+            WAIKeyFrame* pKFi = vpKFs[i];
+            if (pKFi->isBad())
+                continue;
 
-                if (pKFi->mnRelocQuery != F->mnId)
-                {
-                    pKFi->mnRelocWords = 0;
-                    pKFi->mRelocScore  = 0.f;
-                    pKFi->mnRelocQuery = F->mnId;
-                    lKFsSharingWords.push_back(pKFi);
-                }
-                pKFi->mnRelocWords++;
-            }
+            pKFi->mnRelocWords = vCommonWords[i];
+            pKFi->mRelocScore  = 0.f;
+            pKFi->mnRelocQuery = F->mnId;
+            lKFsSharingWords.push_back(pKFi);
+            vScores.push_back(vAllScores[i]);
         }
     }
     if (lKFsSharingWords.empty())
@@ -331,16 +636,17 @@ std::vector<WAIKeyFrame*> WAIKeyFrameDB::DetectRelocalizationCandidates(WAIFrame
             We return all keyframe matches whose scores are higher than the 75 % of the best score.*/
         std::list<std::pair<float, WAIKeyFrame*>> lScoreAndMatch;
         int                                       nscores = 0;
+        size_t                                    iScore  = 0;
 
-        // Compute similarity score.
-        for (std::list<WAIKeyFrame*>::iterator lit = lKFsSharingWords.begin(), lend = lKFsSharingWords.end(); lit != lend; lit++)
+        // Similarity scores of the keyframes from the inverted file
+        for (std::list<WAIKeyFrame*>::iterator lit = lKFsSharingWords.begin(), lend = lKFsSharingWords.end(); lit != lend; lit++, iScore++)
         {
             WAIKeyFrame* pKFi = *lit;
 
             if (pKFi->mnRelocWords > minCommonWords)
             {
                 nscores++;
-                float si = (float)mpVoc->score(F->mBowVec, pKFi->mBowVec);
+                float si = vScores[iScore];
                 //std::cout << "si: " << si << std::endl;
                 pKFi->mRelocScore = si;
                 lScoreAndMatch.push_back(std::make_pair(si, pKFi));
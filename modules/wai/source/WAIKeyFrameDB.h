@@ -32,9 +32,11 @@
 
 #include <vector>
 #include <list>
+#include <unordered_map>
 #include <WAIHelper.h>
 #include <WAIKeyFrame.h>
 #include <WAIOrbVocabulary.h>
+#include <WAIMapTiles.h>
 #include <opencv2/core.hpp>
 
 #include <mutex>
@@ -42,6 +44,20 @@
 //-----------------------------------------------------------------------------
 //! AR Keyframe database class
 /*!
+The inverted file holds for every word of the vocabulary a posting list with
+the keyframes that contain the word. A posting list is a contiguous array of
+(keyframe slot, word weight) pairs. Every keyframe in the database gets a dense
+slot index, so that a query can count the common words and accumulate the BoW
+score of all keyframes in flat arrays in one pass over the posting lists of its
+words. Erasing a keyframe removes its postings and compacts the arrays.
+With setResidentRegion the relocalization queries are restricted to the
+keyframes in the map tiles around a position (see WAIMapTiles). Keyframes that
+are added later are always resident, because they are created at the pose.
+The slots are also indexed by the map tile of the keyframe camera center. A
+relocalization query with a pose prior (e.g. GPS position and compass heading)
+only scores the keyframes of the tiles around the prior position, whose camera
+center is within the prior radius and whose viewing direction is within the
+heading cone.
 */
 class WAI_API WAIKeyFrameDB
 {
@@ -53,8 +69,37 @@ class WAI_API WAIKeyFrameDB
 
     void clear();
 
+    //! Entry of a posting list
+    struct Posting
+    {
+        int   slot;   //!< Slot of the keyframe (see _slotKeyFrames)
+        float weight; //!< Weight of the word in the BoW vector of the keyframe
+    };
+
+    //! Prior of the camera pose for relocalization in map coordinates
+    struct PosePrior
+    {
+        cv::Point3f position;            //!< Prior camera center (e.g. from GPS)
+        float       radius      = 10.0f; //!< Max. distance of the keyframe camera centers
+        cv::Point3f viewDir;             //!< Prior viewing direction (zero = any direction)
+        float       maxAngleDEG = 60.0f; //!< Half opening angle of the heading cone
+    };
+
+    std::vector<std::vector<Posting>>& getInvertedFile() { return mvInvertedFile; }
+    size_t                             numKeyFrames() const { return _slotOfKeyFrame.size(); }
+
+    // Resident map tiles
+    void                setResidentRegion(const WAIMapTiles::Region& region);
+    void                clearResidentRegion();
+    bool                hasResidentRegion() const { return _hasResidentRegion; }
+    WAIMapTiles::Region residentRegion();
+    int                 numResidentKeyFrames();
+    void                tileSize(float size);
+    float               tileSize() const { return _tiles.tileSize(); }
+    WAIMapTiles&        tiles() { return _tiles; }
 
-    std::vector<std::list<WAIKeyFrame*>>& getInvertedFile() { return mvInvertedFile; }
+    // Spatial index
+    void updateSpatialIndex();
 
     // Loop Detection
     enum LoopDetectionErrorCodes
@@ -68,13 +113,42 @@ class WAI_API WAIKeyFrameDB
     // Relocalization
     std::vector<WAIKeyFrame*> DetectRelocalizationCandidates(WAIFrame* F, float minCommonWordFactor, bool applyMinAccScoreFilter = false);
     std::vector<WAIKeyFrame*> DetectRelocalizationCandidates(WAIFrame* F, cv::Mat extrinsicGuess);
-
+    std::vector<WAIKeyFrame*> DetectRelocalizationCandidates(WAIFrame* F, const PosePrior& prior, float minCommonWordFactor, bool applyMinAccScoreFilter = false);
 
     protected:
+    void accumulateScores(WAIBowVector&              bow,
+                          std::vector<WAIKeyFrame*>& vpKFs,
+                          std::vector<int>&          vCommonWords,
+                          std::vector<float>&        vScores,
+                          bool                       residentOnly = false,
+                          const PosePrior*           prior        = nullptr);
+
+    std::vector<WAIKeyFrame*> relocalizationCandidates(WAIFrame*        F,
+                                                       const PosePrior* prior,
+                                                       float            minCommonWordFactor,
+                                                       bool             applyMinAccScoreFilter);
+
+    void indexSlot(int slot, const cv::Point3f& position);
+    void unindexSlot(int slot);
+    void rebuildSpatialIndex();
+    void selectPriorSlots(const PosePrior& prior, std::vector<char>& selected);
+
     // Associated vocabulary
     WAIOrbVocabulary* mpVoc;
-    // Inverted file
-    std::vector<std::list<WAIKeyFrame*>> mvInvertedFile;
+    // Inverted file with one posting list per word
+    std::vector<std::vector<Posting>> mvInvertedFile;
+
+    std::vector<WAIKeyFrame*>             _slotKeyFrames;  //!< Keyframe per slot (nullptr if free)
+    std::vector<int>                      _freeSlots;      //!< Slots of erased keyframes for reuse
+    std::unordered_map<WAIKeyFrame*, int> _slotOfKeyFrame; //!< Slot per keyframe in the database
+
+    WAIMapTiles         _tiles;                     //!< Tiling for the resident region
+    bool                _hasResidentRegion = false; //!< True if the queries are restricted to a region
+    WAIMapTiles::Region _residentRegion;            //!< Region of the last setResidentRegion
+    std::vector<bool>   _slotResident;              //!< Flag per slot if the keyframe is in the region
+
+    std::unordered_map<uint64_t, std::vector<int>> _tileSlots; //!< Slots per map tile (spatial index)
+    std::vector<uint64_t>                          _slotTile;  //!< Map tile key per slot
 
     // Mutex
     std::mutex mMutex;
@@ -12,6 +12,7 @@
 #include <WAIKeyFrame.h>
 #include <WAIFrame.h>
 #include <orb_slam/ORBmatcher.h>
+#include <cstring>
 #include <mutex>
 
 long unsigned int WAIMapPoint::nNextId = 0;
@@ -95,11 +96,13 @@ WAIMapPoint::WAIMapPoint(const cv::Mat& Pos,
 //-----------------------------------------------------------------------------
 WAI::V3 WAIMapPoint::worldPosVec()
 {
-    unique_lock<mutex> lock(mMutexPos);
-    WAI::V3            vec;
-    vec.x = mWorldPos.at<float>(0, 0);
-    vec.y = mWorldPos.at<float>(1, 0);
-    vec.z = mWorldPos.at<float>(2, 0);
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+
+    WAI::V3 vec;
+    vec.x = snapshot.worldPos[0];
+    vec.y = snapshot.worldPos[1];
+    vec.z = snapshot.worldPos[2];
     return vec;
 }
 //-----------------------------------------------------------------------------
@@ -109,18 +112,18 @@ void WAIMapPoint::worldPosVec(WAI::V3 vec)
     mWorldPos.at<float>(0, 0) = vec.x;
     mWorldPos.at<float>(1, 0) = vec.y;
     mWorldPos.at<float>(2, 0) = vec.z;
+    publishPosition();
 }
 //-----------------------------------------------------------------------------
 WAI::V3 WAIMapPoint::normalVec()
 {
-    WAI::V3 vec = {};
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
 
-    if (!mNormalVector.empty())
-    {
-        vec.x = mNormalVector.at<float>(0, 0);
-        vec.y = mNormalVector.at<float>(1, 0);
-        vec.z = mNormalVector.at<float>(2, 0);
-    }
+    WAI::V3 vec;
+    vec.x = snapshot.normal[0];
+    vec.y = snapshot.normal[1];
+    vec.z = snapshot.normal[2];
     return vec;
 }
 //-----------------------------------------------------------------------------
@@ -129,24 +132,89 @@ void WAIMapPoint::SetWorldPos(const cv::Mat& Pos)
     unique_lock<mutex> lock2(mGlobalMutex);
     unique_lock<mutex> lock(mMutexPos);
     Pos.copyTo(mWorldPos);
+    publishPosition();
 }
 //-----------------------------------------------------------------------------
 cv::Mat WAIMapPoint::GetWorldPos()
 {
-    unique_lock<mutex> lock(mMutexPos);
-    return mWorldPos.clone();
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    return cv::Mat(3, 1, CV_32F, snapshot.worldPos).clone();
 }
 //-----------------------------------------------------------------------------
 cv::Mat WAIMapPoint::GetNormal()
 {
-    unique_lock<mutex> lock(mMutexPos);
-    return mNormalVector.clone();
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    return cv::Mat(3, 1, CV_32F, snapshot.normal).clone();
 }
 //-----------------------------------------------------------------------------
 void WAIMapPoint::SetNormal(const cv::Mat& normal)
 {
     unique_lock<mutex> lock(mMutexPos);
     normal.copyTo(mNormalVector);
+    publishPosition();
+}
+//-----------------------------------------------------------------------------
+void WAIMapPoint::GetSnapshot(WAIMapPointSnapshot& snapshot) const
+{
+    uint32_t     descriptor[8];
+    unsigned int version;
+    do
+    {
+        version = _snapshotVersion.load(memory_order_acquire);
+
+        for (int i = 0; i < 3; i++)
+        {
+            snapshot.worldPos[i] = _snapshotPos[i].load(memory_order_relaxed);
+            snapshot.normal[i]   = _snapshotPos[3 + i].load(memory_order_relaxed);
+        }
+        snapshot.minDistance   = _snapshotPos[6].load(memory_order_relaxed);
+        snapshot.maxDistance   = _snapshotPos[7].load(memory_order_relaxed);
+        snapshot.hasDescriptor = _snapshotHasDescriptor.load(memory_order_relaxed);
+        for (int i = 0; i < 8; i++)
+            descriptor[i] = _snapshotDescriptor[i].load(memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        // retry if a writer was active before or during the reads
+    } while ((version & 1) || version != _snapshotVersion.load(memory_order_relaxed));
+
+    memcpy(snapshot.descriptor, descriptor, sizeof(descriptor));
+}
+//-----------------------------------------------------------------------------
+void WAIMapPoint::publishPosition()
+{
+    unsigned int version = _snapshotVersion.load(memory_order_relaxed);
+    _snapshotVersion.store(version + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (int i = 0; i < 3; i++)
+    {
+        _snapshotPos[i].store(mWorldPos.at<float>(i), memory_order_relaxed);
+        _snapshotPos[3 + i].store(mNormalVector.empty() ? 0.0f : mNormalVector.at<float>(i), memory_order_relaxed);
+    }
+    _snapshotPos[6].store(mfMinDistance, memory_order_relaxed);
+    _snapshotPos[7].store(mfMaxDistance, memory_order_relaxed);
+
+    _snapshotVersion.store(version + 2, memory_order_release);
+}
+//-----------------------------------------------------------------------------
+void WAIMapPoint::publishDescriptor()
+{
+    uint32_t descriptor[8] = {};
+    bool     hasDescriptor = mDescriptor.total() * mDescriptor.elemSize() == sizeof(descriptor);
+    if (hasDescriptor)
+        memcpy(descriptor, mDescriptor.ptr(), sizeof(descriptor));
+
+    unsigned int version = _snapshotVersion.load(memory_order_relaxed);
+    _snapshotVersion.store(version + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (int i = 0; i < 8; i++)
+        _snapshotDescriptor[i].store(descriptor[i], memory_order_relaxed);
+    _snapshotHasDescriptor.store(hasDescriptor, memory_order_relaxed);
+
+    _snapshotVersion.store(version + 2, memory_order_release);
 }
 //-----------------------------------------------------------------------------
 WAIKeyFrame* WAIMapPoint::GetReferenceKeyFrame()
@@ -162,6 +230,7 @@ void WAIMapPoint::AddObservation(WAIKeyFrame* pKF, size_t idx)
         return;
     mObservations[pKF] = idx;
     nObs++;
+    publishObservations();
 }
 //-----------------------------------------------------------------------------
 void WAIMapPoint::EraseObservation(WAIKeyFrame* pKF)
@@ -179,6 +248,7 @@ void WAIMapPoint::EraseObservation(WAIKeyFrame* pKF)
             nObs--;
 
             mObservations.erase(pKF);
+            publishObservations();
 
             if (mpRefKF == pKF)
             {
@@ -218,6 +288,19 @@ std::map<WAIKeyFrame*, size_t> WAIMapPoint::GetObservations()
     return mObservations;
 }
 //-----------------------------------------------------------------------------
+/*! Returns the observations without locking and copying them. The snapshot is
+not changed: Added or erased observations are published as a new snapshot.
+*/
+std::shared_ptr<const std::map<WAIKeyFrame*, size_t>> WAIMapPoint::GetObservationSnapshot() const
+{
+    return atomic_load(&_observationSnapshot);
+}
+//-----------------------------------------------------------------------------
+void WAIMapPoint::publishObservations()
+{
+    atomic_store(&_observationSnapshot, std::make_shared<const std::map<WAIKeyFrame*, size_t>>(mObservations));
+}
+//-----------------------------------------------------------------------------
 int WAIMapPoint::Observations()
 {
     unique_lock<mutex> lock(mMutexFeatures);
@@ -233,6 +316,7 @@ void WAIMapPoint::SetBadFlag()
         mbBad = true;
         obs   = mObservations;
         mObservations.clear();
+        publishObservations();
     }
     for (map<WAIKeyFrame*, size_t>::iterator mit = obs.begin(), mend = obs.end(); mit != mend; mit++)
     {
@@ -260,6 +344,7 @@ void WAIMapPoint::Replace(WAIMapPoint* pMP)
         unique_lock<mutex> lock2(mMutexPos);
         obs = mObservations;
         mObservations.clear();
+        publishObservations();
         mbBad      = true;
         nvisible   = mnVisible;
         nfound     = mnFound;
@@ -313,9 +398,6 @@ float WAIMapPoint::GetFoundRatio()
 //-----------------------------------------------------------------------------
 void WAIMapPoint::ComputeDistinctiveDescriptors()
 {
-    // Retrieve all observed descriptors
-    vector<cv::Mat> vDescriptors;
-
     map<WAIKeyFrame*, size_t> observations;
 
     {
@@ -328,91 +410,70 @@ void WAIMapPoint::ComputeDistinctiveDescriptors()
     if (observations.empty())
         return;
 
-    vDescriptors.reserve(observations.size());
-
+    // Retrieve all observed descriptors into one contiguous block
+    cv::Mat descriptors((int)observations.size(), 32, CV_8U);
+    int     N = 0;
     for (map<WAIKeyFrame*, size_t>::iterator mit = observations.begin(), mend = observations.end(); mit != mend; mit++)
     {
         WAIKeyFrame* pKF = mit->first;
 
         if (pKF && !pKF->isBad())
-            vDescriptors.push_back(pKF->mDescriptors.row((int)mit->second));
+            memcpy(descriptors.ptr<uchar>(N++), pKF->mDescriptors.ptr<uchar>((int)mit->second), 32);
     }
 
-    if (vDescriptors.empty())
+    if (N == 0)
         return;
 
-        // Compute distances between them
-#ifdef _WINDOWS
-    size_t N = vDescriptors.size();
-
-    float** Distances = new float*[N];
-    for (size_t i = 0; i < N; ++i)
-        Distances[i] = new float[N];
-
-    for (size_t i = 0; i < N; i++)
+    // Compute distances between them, each descriptor against the block of the following ones
+    vector<int> Distances((size_t)N * N);
+    for (int i = 0; i < N; i++)
     {
-        Distances[i][i] = 0;
-        for (size_t j = i + 1; j < N; j++)
-        {
-            int distij      = ORBmatcher::DescriptorDistance(vDescriptors[i], vDescriptors[j]);
-            Distances[i][j] = (float)distij;
-            Distances[j][i] = (float)distij;
-        }
+        int* distRow = &Distances[(size_t)i * N];
+        distRow[i]   = 0;
+        ORBmatcher::DescriptorDistances(descriptors.row(i), descriptors, i + 1, N - i - 1, distRow + i + 1);
+        for (int j = i + 1; j < N; j++)
+            Distances[(size_t)j * N + i] = distRow[j];
     }
-#else
-    const size_t N = vDescriptors.size();
 
-    float Distances[N][N];
-    for (size_t i = 0; i < N; i++)
-    {
-        Distances[i][i] = 0;
-        for (size_t j = i + 1; j < N; j++)
-        {
-            int distij      = ORBmatcher::DescriptorDistance(vDescriptors[i], vDescriptors[j]);
-            Distances[i][j] = distij;
-            Distances[j][i] = distij;
-        }
-    }
-#endif
     // Take the descriptor with least median distance to the rest
     int BestMedian = INT_MAX;
     int BestIdx    = 0;
-    for (size_t i = 0; i < N; i++)
+    for (int i = 0; i < N; i++)
     {
-        vector<int> vDists(Distances[i], Distances[i] + N);
+        vector<int> vDists(Distances.begin() + (size_t)i * N, Distances.begin() + (size_t)(i + 1) * N);
         sort(vDists.begin(), vDists.end());
         int median = vDists[(uint64_t)(0.5 * (N - 1))];
 
         if (median < BestMedian)
         {
             BestMedian = median;
-            BestIdx    = (int)i;
+            BestIdx    = i;
         }
     }
 
-    //free Distances
-#ifdef _WINDOWS
-    for (size_t i = 0; i < N; ++i)
-        delete Distances[i];
-    delete Distances;
-#endif
-
     {
         unique_lock<mutex> lock(mMutexFeatures);
-        mDescriptor = vDescriptors[BestIdx].clone();
+        unique_lock<mutex> lock2(mMutexPos);
+        mDescriptor = descriptors.row(BestIdx).clone();
+        publishDescriptor();
     }
 }
 //-----------------------------------------------------------------------------
 cv::Mat WAIMapPoint::GetDescriptor()
 {
-    unique_lock<mutex> lock(mMutexFeatures);
-    return mDescriptor.clone();
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    if (!snapshot.hasDescriptor)
+        return cv::Mat();
+    return cv::Mat(1, 32, CV_8U, snapshot.descriptor).clone();
 }
 //-----------------------------------------------------------------------------
 void WAIMapPoint::SetDescriptor(const cv::Mat& descriptor)
 {
     unique_lock<mutex> lock(mMutexFeatures);
+    unique_lock<mutex> lock2(mMutexPos);
     descriptor.copyTo(mDescriptor);
+    publishDescriptor();
 }
 //-----------------------------------------------------------------------------
 int WAIMapPoint::GetIndexInKeyFrame(WAIKeyFrame* pKF)
@@ -471,19 +532,22 @@ void WAIMapPoint::UpdateNormalAndDepth()
         mfMaxDistance = dist * levelScaleFactor;
         mfMinDistance = mfMaxDistance / pRefKF->mvScaleFactors[nLevels - 1];
         mNormalVector = normal / n;
+        publishPosition();
     }
 }
 //-----------------------------------------------------------------------------
 float WAIMapPoint::GetMinDistanceInvariance()
 {
-    unique_lock<mutex> lock(mMutexPos);
-    return 0.8f * mfMinDistance;
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    return 0.8f * snapshot.minDistance;
 }
 //-----------------------------------------------------------------------------
 float WAIMapPoint::GetMaxDistanceInvariance()
 {
-    unique_lock<mutex> lock(mMutexPos);
-    return 1.2f * mfMaxDistance;
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    return 1.2f * snapshot.maxDistance;
 }
 //-----------------------------------------------------------------------------
 float WAIMapPoint::GetMinDistance()
@@ -498,21 +562,23 @@ float WAIMapPoint::GetMaxDistance()
 //-----------------------------------------------------------------------------
 void WAIMapPoint::SetMaxDistance(float maxDist)
 {
+    unique_lock<mutex> lock(mMutexPos);
     mfMaxDistance = maxDist;
+    publishPosition();
 }
 //-----------------------------------------------------------------------------
 void WAIMapPoint::SetMinDistance(float minDist)
 {
+    unique_lock<mutex> lock(mMutexPos);
     mfMinDistance = minDist;
+    publishPosition();
 }
 //-----------------------------------------------------------------------------
 int WAIMapPoint::PredictScale(const float& currentDist, WAIKeyFrame* pKF)
 {
-    float ratio;
-    {
-        unique_lock<mutex> lock(mMutexPos);
-        ratio = mfMaxDistance / currentDist;
-    }
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    float ratio = snapshot.maxDistance / currentDist;
 
     int nScale = (int)ceil(log(ratio) / pKF->mfLogScaleFactor);
     if (nScale < 0)
@@ -525,11 +591,9 @@ int WAIMapPoint::PredictScale(const float& currentDist, WAIKeyFrame* pKF)
 //-----------------------------------------------------------------------------
 int WAIMapPoint::PredictScale(const float& currentDist, WAIFrame* pF)
 {
-    float ratio;
-    {
-        unique_lock<mutex> lock(mMutexPos);
-        ratio = mfMaxDistance / currentDist;
-    }
+    WAIMapPointSnapshot snapshot;
+    GetSnapshot(snapshot);
+    float ratio = snapshot.maxDistance / currentDist;
 
     int nScale = (int)ceil(log(ratio) / pF->mfLogScaleFactor);
     if (nScale < 0)
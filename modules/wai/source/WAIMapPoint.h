@@ -13,7 +13,10 @@
 
 #include <WAIHelper.h>
 #include <WAIMap.h>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -25,6 +28,17 @@ class WAIKeyFrame;
 class WAIFrame;
 class WAIMap;
 //-----------------------------------------------------------------------------
+//! Copy of the map point values that are read by the tracking for every frame
+struct WAIMapPointSnapshot
+{
+    float   worldPos[3];               //!< world position
+    float   normal[3];                 //!< mean viewing direction
+    float   minDistance;               //!< min. scale invariance distance
+    float   maxDistance;               //!< max. scale invariance distance
+    alignas(8) uint8_t descriptor[32]; //!< ORB descriptor
+    bool    hasDescriptor;             //!< false until a descriptor was computed or set
+};
+//-----------------------------------------------------------------------------
 //!
 /*! 
 */
@@ -57,8 +71,9 @@ public:
     void         SetNormal(const cv::Mat& normal);
     WAIKeyFrame* GetReferenceKeyFrame();
 
-    std::map<WAIKeyFrame*, size_t> GetObservations();
-    int                            Observations();
+    std::map<WAIKeyFrame*, size_t>                        GetObservations();
+    std::shared_ptr<const std::map<WAIKeyFrame*, size_t>> GetObservationSnapshot() const;
+    int                                                   Observations();
 
     void AddObservation(WAIKeyFrame* pKF, size_t idx);
     void EraseObservation(WAIKeyFrame* pKF);
@@ -76,6 +91,9 @@ public:
     void  IncreaseFound(int n = 1);
     float GetFoundRatio();
 
+    //! Reads position, normal, distances and descriptor without a mutex or allocation
+    void GetSnapshot(WAIMapPointSnapshot& snapshot) const;
+
     void    ComputeDistinctiveDescriptors();
     cv::Mat GetDescriptor();
     void    SetDescriptor(const cv::Mat& descriptor);
@@ -180,6 +198,24 @@ protected:
 
     std::mutex mMutexPos;
     std::mutex mMutexFeatures;
+
+private:
+    //! publishes world position, normal and distances to the snapshot (mMutexPos has to be locked)
+    void publishPosition();
+    //! publishes the descriptor to the snapshot (mMutexPos has to be locked)
+    void publishDescriptor();
+    //! publishes a copy of mObservations (mMutexFeatures has to be locked)
+    void publishObservations();
+
+    // Seqlock over the snapshot values: the version is odd while a writer publishes
+    // new values. The writers are serialized by mMutexPos.
+    std::atomic<unsigned int> _snapshotVersion{0};
+    std::atomic<float>        _snapshotPos[8]{};        //!< world position, normal, min. and max. distance
+    std::atomic<uint32_t>     _snapshotDescriptor[8]{}; //!< descriptor as 32 bit words
+    std::atomic<bool>         _snapshotHasDescriptor{false};
+
+    // Immutable copy of mObservations (written under mMutexFeatures, read with GetObservationSnapshot)
+    std::shared_ptr<const std::map<WAIKeyFrame*, size_t>> _observationSnapshot = std::make_shared<const std::map<WAIKeyFrame*, size_t>>();
 };
 
 #endif // !WAIMAPPOINT_H
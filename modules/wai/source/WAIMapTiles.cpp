@@ -0,0 +1,103 @@
+//#############################################################################
+//  File:      WAIMapTiles.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <WAIMapTiles.h>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+//-----------------------------------------------------------------------------
+//! Returns the key of the tile with the position (21 bits per axis)
+uint64_t WAIMapTiles::tileKey(const cv::Point3f& position) const
+{
+    const int64_t offset = 1 << 20;
+    const int64_t mask   = (1 << 21) - 1;
+
+    int64_t ix = (int64_t)std::floor(position.x / _tileSize) + offset;
+    int64_t iy = (int64_t)std::floor(position.y / _tileSize) + offset;
+    int64_t iz = (int64_t)std::floor(position.z / _tileSize) + offset;
+
+    return (uint64_t)(ix & mask) << 42 | (uint64_t)(iy & mask) << 21 | (uint64_t)(iz & mask);
+}
+//-----------------------------------------------------------------------------
+/*! Selects the tiles of the region and returns the NO. of selected positions.
+ A tile belongs to the region if its closest point is within the radius around
+ the center. The tiles are added from the nearest to the farthest as long as
+ the budget of region.maxKeyFrames is not exceeded. The nearest tile is always
+ added, even if it alone exceeds the budget.
+ @param positions Positions (keyframe camera centers) in map coordinates
+ @param region Center, radius and budget of the region
+ @param selected Gets true for every position in a selected tile
+ */
+int WAIMapTiles::select(const std::vector<cv::Point3f>& positions,
+                        const Region&                   region,
+                        std::vector<bool>&              selected) const
+{
+    selected.assign(positions.size(), false);
+
+    // group the positions by tile
+    std::unordered_map<uint64_t, std::vector<int>> tiles;
+    std::unordered_map<uint64_t, float>            tileDist;
+    for (int i = 0; i < (int)positions.size(); i++)
+    {
+        uint64_t key = tileKey(positions[i]);
+        auto     it  = tiles.find(key);
+        if (it == tiles.end())
+        {
+            // distance from the center to the closest point of the tile
+            cv::Point3f tileMin(std::floor(positions[i].x / _tileSize) * _tileSize,
+                                std::floor(positions[i].y / _tileSize) * _tileSize,
+                                std::floor(positions[i].z / _tileSize) * _tileSize);
+            cv::Point3f closest(std::min(std::max(region.center.x, tileMin.x), tileMin.x + _tileSize),
+                                std::min(std::max(region.center.y, tileMin.y), tileMin.y + _tileSize),
+                                std::min(std::max(region.center.z, tileMin.z), tileMin.z + _tileSize));
+            tileDist[key] = (float)cv::norm(closest - region.center);
+
+            it = tiles.emplace(key, std::vector<int>()).first;
+        }
+        it->second.push_back(i);
+    }
+
+    // sort the tiles of the region from the nearest to the farthest
+    std::vector<std::pair<float, uint64_t>> regionTiles;
+    for (auto& tile : tiles)
+    {
+        float dist = tileDist[tile.first];
+        if (dist <= region.radius)
+            regionTiles.push_back(std::make_pair(dist, tile.first));
+    }
+    std::sort(regionTiles.begin(), regionTiles.end());
+
+    int numSelected = 0;
+    for (auto& regionTile : regionTiles)
+    {
+        const std::vector<int>& indices = tiles[regionTile.second];
+
+        if (region.maxKeyFrames > 0 &&
+            numSelected > 0 &&
+            numSelected + (int)indices.size() > region.maxKeyFrames)
+            break;
+
+        for (int i : indices)
+            selected[i] = true;
+        numSelected += (int)indices.size();
+    }
+
+    return numSelected;
+}
+//-----------------------------------------------------------------------------
+//! Returns the camera center -R^T * t of the camera pose Tcw (4x4 CV_32F)
+cv::Point3f WAIMapTiles::cameraCenter(const cv::Mat& Tcw)
+{
+    cv::Mat Rcw = Tcw.rowRange(0, 3).colRange(0, 3);
+    cv::Mat tcw = Tcw.rowRange(0, 3).col(3);
+    cv::Mat Ow  = -Rcw.t() * tcw;
+
+    return cv::Point3f(Ow.at<float>(0), Ow.at<float>(1), Ow.at<float>(2));
+}
+//-----------------------------------------------------------------------------
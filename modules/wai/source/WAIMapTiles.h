@@ -0,0 +1,61 @@
+//#############################################################################
+//  File:      WAIMapTiles.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef WAIMAPTILES_H
+#define WAIMAPTILES_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <WAIHelper.h>
+
+//-----------------------------------------------------------------------------
+//! Spatial tiling of a map into cubic tiles of equal size
+/*!
+Large maps (e.g. a whole campus) are split into cubic tiles by the camera
+centers of their keyframes. Only the tiles of a region around the current pose
+or a GPS prior are resident: WAIMapStorage::loadMapBinary only loads the
+keyframes of the region and WAIKeyFrameDB only returns relocalization
+candidates of the region. The tiles are selected from the nearest to the
+farthest, until the memory budget given as max. NO. of keyframes is reached.
+In onlyTracking mode WAISlam streams the regions along the tracked pose: The next
+region is loaded in the background and the previous one is evicted (see
+WAISlam::setMapRegionLoader).
+The tiles are cubes, so the tiling does not depend on the up axis of the map.
+*/
+class WAI_API WAIMapTiles
+{
+public:
+    //! Region of the map around a position that is resident in memory
+    struct Region
+    {
+        cv::Point3f center;                //!< Center of the region in map coordinates
+        float       radius       = 100.0f; //!< Max. distance of a tile to the center
+        int         maxKeyFrames = 0;      //!< Memory budget in keyframes (0 = unlimited)
+    };
+
+    explicit WAIMapTiles(float tileSize = 50.0f) : _tileSize(tileSize) {}
+
+    uint64_t tileKey(const cv::Point3f& position) const;
+    int      select(const std::vector<cv::Point3f>& positions,
+                    const Region&                   region,
+                    std::vector<bool>&              selected) const;
+
+    static cv::Point3f cameraCenter(const cv::Mat& Tcw);
+
+    // Setters
+    void tileSize(float size) { _tileSize = size; }
+
+    // Getters
+    float tileSize() const { return _tileSize; }
+
+private:
+    float _tileSize; //!< Edge length of the cubic tiles in map units
+};
+//-----------------------------------------------------------------------------
+#endif // WAIMAPTILES_H
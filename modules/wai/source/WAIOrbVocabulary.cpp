@@ -71,18 +71,38 @@ void WAIOrbVocabulary::loadFromFile(std::string strVocFile)
 
 WAIBowVector::WAIBowVector(std::vector<int> wid, std::vector<float> values)
 {
+    // the word ids are stored in ascending order, so every insert is at the end
     for (int i = 0; i < wid.size(); i++)
     {
 #if USE_FBOW
         fbow::_float v;
         v.var = values[i];
-        data.insert(std::pair<uint32_t, fbow::_float>(wid[i], v));
+        data.emplace_hint(data.end(), (uint32_t)wid[i], v);
 #else
-        data.insert(std::pair<DBoW2::WordId, DBoW2::WordValue>(wid[i], values[i]));
+        data.emplace_hint(data.end(), (DBoW2::WordId)wid[i], values[i]);
 #endif
     }
 }
 
+/*! Builds the feature vector from the flattened node ids, the NO. of feature
+ indices per node and the concatenated feature indices of all nodes.
+*/
+WAIFeatVector::WAIFeatVector(const std::vector<int>& nodeIds,
+                             const std::vector<int>& nodeSizes,
+                             const std::vector<int>& indices)
+{
+    size_t first = 0;
+    for (size_t i = 0; i < nodeIds.size(); i++)
+    {
+        size_t last = first + nodeSizes[i];
+        data.emplace_hint(data.end(),
+                          nodeIds[i],
+                          std::vector<unsigned int>(indices.begin() + first, indices.begin() + last));
+        first = last;
+    }
+    isFill = true;
+}
+
 void WAIOrbVocabulary::transform(const cv::Mat& descriptors, WAIBowVector& bow, WAIFeatVector& feat)
 {
     bow.isFill  = true;
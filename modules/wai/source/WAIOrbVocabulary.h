@@ -39,6 +39,7 @@ struct WAIBowVector
 struct WAIFeatVector
 {
     WAIFeatVector(){};
+    WAIFeatVector(const std::vector<int>& nodeIds, const std::vector<int>& nodeSizes, const std::vector<int>& indices);
     bool isFill = false;
 #if USE_FBOW
     fbow::fBow2  data;
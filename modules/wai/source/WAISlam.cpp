@@ -1,6 +1,7 @@
 #include <WAISlam.h>
 #include <AverageTiming.h>
 #include <Utils.h>
+#include <algorithm>
 
 #define MIN_FRAMES 0
 #define MAX_FRAMES 30
@@ -59,6 +60,8 @@ WAISlam::WAISlam(const cv::Mat&          intrinsic,
         _initialized = true;
     }
 
+    _globalMap->GetKeyFrameDB()->tileSize(_params.tileSize);
+
     _localMapping = new ORB_SLAM2::LocalMapping(_globalMap.get(),
                                                 _voc,
                                                 params.cullRedundantPerc);
@@ -114,6 +117,8 @@ WAISlam::~WAISlam()
     _poseUpdateThread = nullptr;
 #endif
 
+    finishRegionLoad();
+
     delete _localMapping;
     delete _loopClosing;
 }
@@ -131,6 +136,11 @@ void WAISlam::reset()
     _poseUpdateThread->join();
 #endif
 
+    // a region that is still loading belongs to the map before the reset
+    finishRegionLoad();
+    _regionLoadedMap.reset();
+    _regionLoadDone = false;
+
     _globalMap->clear();
     _localMap.keyFrames.clear();
     _localMap.mapPoints.clear();
@@ -138,6 +148,7 @@ void WAISlam::reset()
 
     _lastKeyFrameFrameId = 0;
     _lastRelocFrameId    = 0;
+    _optFlowExtractNext  = true;
 
 #if MULTI_THREAD_FRAME_PROCESSING
     _poseUpdateThread = new std::thread(updatePoseThread, this);
@@ -183,14 +194,24 @@ void WAISlam::createFrame(WAIFrame& frame, cv::Mat& imageGray)
                              _params.retainImg);
             break;
         default:
+        {
+            // With optical flow tracking only the frames requested by the pose thread are extracted
+            bool extractFeatures = !_params.trackOptFlow || _params.ensureKFIntegration || _optFlowExtractNext;
+
             frame = WAIFrame(imageGray,
                              0.0,
                              _extractor,
                              _cameraIntrinsic,
                              _distortion,
                              _voc,
-                             _params.retainImg);
+                             _params.retainImg,
+                             extractFeatures);
+        }
     }
+
+    // Every frame gets its pyramid, so it can be the previous frame of the optical flow tracking
+    if (_params.trackOptFlow && !_params.ensureKFIntegration)
+        buildOptFlowPyramid(frame, imageGray);
 }
 //-----------------------------------------------------------------------------
 /* Separate Pose update thread */
@@ -217,15 +238,27 @@ int WAISlam::getNextFrame(WAIFrame& frame)
     if (nbFrameInQueue == 0)
         return 0;
 
-    frame = _framesQueue.front();
+    frame = std::move(_framesQueue.front());
     _framesQueue.pop();
     return nbFrameInQueue;
 }
 //-----------------------------------------------------------------------------
 void WAISlam::requestFinish()
 {
-    std::unique_lock<std::mutex> lock(_stateMutex);
-    _requestFinish = true;
+    {
+        std::unique_lock<std::mutex> lock(_stateMutex);
+        _requestFinish = true;
+    }
+    wakeUpPoseThread();
+}
+//-----------------------------------------------------------------------------
+//! Wakes up the pose update thread after a new frame or a state change
+void WAISlam::wakeUpPoseThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(_frameQueueMutex);
+    }
+    _frameQueueCondVar.notify_all();
 }
 //-----------------------------------------------------------------------------
 bool WAISlam::finishRequested()
@@ -248,10 +281,13 @@ bool WAISlam::isStop()
 //-----------------------------------------------------------------------------
 void WAISlam::resume()
 {
-    std::unique_lock<std::mutex> lock(_stateMutex);
-    _isStop = false;
-    _localMapping->RequestContinue();
-    _state = WAITrackingState::TrackingLost;
+    {
+        std::unique_lock<std::mutex> lock(_stateMutex);
+        _isStop = false;
+        _localMapping->RequestContinue();
+        _state = WAITrackingState::TrackingLost;
+    }
+    wakeUpPoseThread();
 }
 //-----------------------------------------------------------------------------
 void WAISlam::updatePoseThread(WAISlam* ptr)
@@ -277,10 +313,12 @@ void WAISlam::updatePoseThread(WAISlam* ptr)
             break;
         }
 
-        while (ptr->isStop() && !ptr->isFinished() && !ptr->finishRequested())
-        {
-            std::this_thread::sleep_for(25ms);
-        }
+        // Sleep until the next frame is pushed or a finish is requested
+        std::unique_lock<std::mutex> lock(ptr->_frameQueueMutex);
+        ptr->_frameQueueCondVar.wait(lock, [ptr] {
+            return ptr->finishRequested() ||
+                   (!ptr->_framesQueue.empty() && !ptr->isStop());
+        });
     }
 
     std::unique_lock<std::mutex> lock(ptr->_stateMutex);
@@ -292,6 +330,16 @@ void WAISlam::updatePose(WAIFrame& frame)
 {
     std::unique_lock<std::mutex> guard(_mutexStates);
 
+    swapLoadedRegion();
+
+    // Frames without features are only tracked with optical flow while tracking is ok
+    if (frame.mbOptFlow)
+    {
+        if (_state == WAITrackingState::TrackingOK)
+            updatePoseOptFlow(frame);
+        return;
+    }
+
     switch (_state)
     {
         case WAITrackingState::Initializing:
@@ -349,35 +397,42 @@ void WAISlam::updatePose(WAIFrame& frame)
                             _velocity,
                             _cameraExtrinsic);
                 lock.unlock();
-                mapping(_globalMap.get(),
-                        _localMap,
-                        _localMapping,
-                        frame,
-                        inliers,
-                        _lastRelocFrameId,
-                        _lastKeyFrameFrameId);
-                if (_params.serial)
+                updateResidentRegion(frame.GetCameraCenter(), false);
+
+                // Without local mapping new keyframes would never get into the map
+                if (!_params.onlyTracking)
                 {
-                    _localMapping->RunOnce();
-                    _loopClosing->RunOnce();
+                    mapping(_globalMap.get(),
+                            _localMap,
+                            _localMapping,
+                            frame,
+                            inliers,
+                            _lastRelocFrameId,
+                            _lastKeyFrameFrameId);
+                    if (_params.serial)
+                    {
+                        _localMapping->RunOnce();
+                        _loopClosing->RunOnce();
+                    }
                 }
                 _infoMatchedInliners = inliers;
+
+                // the next frames are tracked with optical flow against this frame
+                _optFlowFrameCount  = 0;
+                _optFlowRefInliers  = inliers;
+                _optFlowExtractNext = false;
             }
             else
             {
-                _state = WAITrackingState::TrackingLost;
+                _state              = WAITrackingState::TrackingLost;
+                _optFlowExtractNext = true;
             }
         }
         break;
         case WAITrackingState::TrackingLost:
         {
             int inliers;
-            if (relocalization(frame,
-                               _globalMap.get(),
-                               _localMap,
-                               _params.minCommonWordFactor,
-                               inliers,
-                               _params.minAccScoreFilter))
+            if (relocalize(frame, inliers))
             {
                 _relocFrameCounter = 0;
                 _lastRelocFrameId  = frame.mnId;
@@ -392,8 +447,42 @@ void WAISlam::updatePose(WAIFrame& frame)
     _lastFrame = WAIFrame(frame);
 }
 //-----------------------------------------------------------------------------
+/*! Tracks a frame without features with optical flow against the last frame. The
+ local map and the keyframe decision are only updated on frames with ORB features:
+ They are requested again after optFlowMaxFrames frames, if the inliers drop or if
+ the optical flow tracking fails. A failed frame is dropped.
+ */
+void WAISlam::updatePoseOptFlow(WAIFrame& frame)
+{
+    int inliers;
+    if (!trackWithOptFlow(_velocity, _lastFrame, frame, inliers))
+    {
+        _optFlowExtractNext = true;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_cameraExtrinsicMutex);
+    motionModel(frame,
+                _lastFrame,
+                _velocity,
+                _cameraExtrinsic);
+    lock.unlock();
+    updateResidentRegion(frame.GetCameraCenter(), false);
+    _infoMatchedInliners = inliers;
+
+    _optFlowFrameCount++;
+    if (_optFlowFrameCount >= _params.optFlowMaxFrames ||
+        inliers < _params.optFlowMinInlierRatio * _optFlowRefInliers)
+        _optFlowExtractNext = true;
+
+    std::unique_lock<std::mutex> lock2(_lastFrameMutex);
+    _lastFrame = WAIFrame(frame);
+}
+//-----------------------------------------------------------------------------
 void WAISlam::updatePoseKFIntegration(WAIFrame& frame)
 {
+    swapLoadedRegion();
+
     switch (_state)
     {
         case WAITrackingState::TrackingOK:
@@ -413,17 +502,21 @@ void WAISlam::updatePoseKFIntegration(WAIFrame& frame)
                             _velocity,
                             _cameraExtrinsic);
                 lock.unlock();
-                strictMapping(_globalMap.get(),
-                              _localMap,
-                              _localMapping,
-                              frame,
-                              inliers,
-                              _lastRelocFrameId,
-                              _lastKeyFrameFrameId);
-                if (_params.serial)
+                updateResidentRegion(frame.GetCameraCenter(), false);
+                if (!_params.onlyTracking)
                 {
-                    _localMapping->RunOnce();
-                    _loopClosing->RunOnce();
+                    strictMapping(_globalMap.get(),
+                                  _localMap,
+                                  _localMapping,
+                                  frame,
+                                  inliers,
+                                  _lastRelocFrameId,
+                                  _lastKeyFrameFrameId);
+                    if (_params.serial)
+                    {
+                        _localMapping->RunOnce();
+                        _loopClosing->RunOnce();
+                    }
                 }
                 _infoMatchedInliners = inliers;
             }
@@ -436,12 +529,7 @@ void WAISlam::updatePoseKFIntegration(WAIFrame& frame)
         case WAITrackingState::TrackingLost:
         {
             int inliers;
-            if (relocalization(frame,
-                               _globalMap.get(),
-                               _localMap,
-                               _params.minCommonWordFactor,
-                               inliers,
-                               _params.minAccScoreFilter))
+            if (relocalize(frame, inliers))
             {
                 _lastRelocFrameId    = frame.mnId;
                 _velocity            = cv::Mat();
@@ -474,8 +562,11 @@ bool WAISlam::update(cv::Mat& imageGray)
     createFrame(frame, imageGray);
 
 #if MULTI_THREAD_FRAME_PROCESSING
-    std::unique_lock<std::mutex> lock(_frameQueueMutex);
-    _framesQueue.push(frame);
+    {
+        std::unique_lock<std::mutex> lock(_frameQueueMutex);
+        _framesQueue.push(std::move(frame));
+    }
+    _frameQueueCondVar.notify_one();
 #else
     if (_params.ensureKFIntegration)
         updatePoseKFIntegration(frame);
@@ -566,10 +657,7 @@ void WAISlam::requestStateIdle()
     {
         std::unique_lock<std::mutex> guard(_mutexStates);
         _localMapping->RequestPause();
-        while (!_localMapping->isPaused())
-        {
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-        }
+        _localMapping->WaitUntilPaused();
         std::cout << "localMapping is stopped" << std::endl;
     }
 
@@ -598,10 +686,7 @@ void WAISlam::transformCoords(cv::Mat transform)
     if (_loopClosingThread != nullptr)
     {
         _localMapping->RequestPause();
-        while (!_localMapping->isPaused() && !_localMapping->isFinished())
-        {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
+        _localMapping->WaitUntilPaused();
     }
 
     WAIMap* map = _globalMap.get();
@@ -618,9 +703,232 @@ void WAISlam::setMap(std::unique_ptr<WAIMap> globalMap)
     reset();
     _globalMap   = std::move(globalMap);
     _initialized = true;
+    _globalMap->GetKeyFrameDB()->tileSize(_params.tileSize);
+    _hasResidentTile       = false;
+    _mapRegionLoader       = nullptr;
+    _evictedMap.reset();
+    _spatialIndexChangeIdx = _globalMap->GetLastBigChangeIdx();
     resume();
 }
 //-----------------------------------------------------------------------------
+/*! Restricts the relocalization to the map tiles around the position prior,
+e.g. the GPS location transformed into map coordinates. The region follows the
+tracked pose again as soon as the tracking is found. The next relocalization
+only scores the keyframes within a radius that depends on the GPS accuracy and
+whose viewing direction is within the heading cone around viewDir (optional).
+*/
+void WAISlam::setPositionPrior(const cv::Mat& position, const cv::Mat& viewDir, float accuracyM)
+{
+    std::unique_lock<std::mutex> guard(_mutexStates);
+    updateResidentRegion(position, true);
+    guard.unlock();
+
+    if (position.empty())
+        return;
+
+    // the search radius grows with the reported GPS accuracy
+    float radius = _params.gpsMaxRadius;
+    if (accuracyM > 0.0f)
+        radius = std::min(std::max(_params.gpsAccuracyFactor * accuracyM, _params.gpsMinRadius), _params.gpsMaxRadius);
+
+    std::unique_lock<std::mutex> lock(_posePriorMutex);
+    _posePrior.position    = cv::Point3f(position.at<float>(0), position.at<float>(1), position.at<float>(2));
+    _posePrior.radius      = radius;
+    _posePrior.viewDir     = viewDir.empty() ? cv::Point3f() : cv::Point3f(viewDir.at<float>(0), viewDir.at<float>(1), viewDir.at<float>(2));
+    _posePrior.maxAngleDEG = _params.gpsMaxViewAngle;
+    _hasPosePrior          = true;
+}
+//-----------------------------------------------------------------------------
+/*! Relocalizes the frame. With a pose prior only the keyframes around the prior
+are searched (see WAISlamTools::relocalizationGPS). The prior is used up by a
+successful relocalization, the tracked pose is more accurate afterwards.
+*/
+bool WAISlam::relocalize(WAIFrame& frame, int& inliers)
+{
+    std::unique_lock<std::mutex> lock(_posePriorMutex);
+    bool                         hasPrior = _hasPosePrior;
+    WAIKeyFrameDB::PosePrior     prior    = _posePrior;
+    lock.unlock();
+
+    if (!hasPrior)
+        return relocalization(frame,
+                              _globalMap.get(),
+                              _localMap,
+                              _params.minCommonWordFactor,
+                              inliers,
+                              _params.minAccScoreFilter);
+
+    // loop closing moves the keyframes by more than the spatial index tolerates
+    int changeIdx = _globalMap->GetLastBigChangeIdx();
+    if (changeIdx != _spatialIndexChangeIdx)
+    {
+        _globalMap->GetKeyFrameDB()->updateSpatialIndex();
+        _spatialIndexChangeIdx = changeIdx;
+    }
+
+    if (!relocalizationGPS(frame,
+                           _globalMap.get(),
+                           _localMap,
+                           prior,
+                           _params.minCommonWordFactor,
+                           inliers,
+                           _params.minAccScoreFilter))
+        return false;
+
+    lock.lock();
+    _hasPosePrior = false;
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*! Sets the resident region of the keyframe database around the position if
+the position is in another tile than the center of the current region.
+*/
+void WAISlam::updateResidentRegion(const cv::Mat& position, bool force)
+{
+    if (_params.residentRadius <= 0.0f || position.empty())
+        return;
+
+    WAIKeyFrameDB* kfDB = _globalMap->GetKeyFrameDB();
+
+    WAIMapTiles::Region region;
+    region.center       = cv::Point3f(position.at<float>(0), position.at<float>(1), position.at<float>(2));
+    region.radius       = _params.residentRadius;
+    region.maxKeyFrames = _params.maxResidentKeyFrames;
+
+    uint64_t tileKey = kfDB->tiles().tileKey(region.center);
+    if (!force && _hasResidentTile && tileKey == _residentTileKey)
+        return;
+
+    kfDB->setResidentRegion(region);
+    _residentTileKey = tileKey;
+    _hasResidentTile = true;
+
+    // stream the next region before the pose leaves the loaded one
+    if (_mapRegionLoader &&
+        _regionLoadThread == nullptr &&
+        cv::norm(region.center - _loadedRegion.center) > 0.5f * _params.residentRadius)
+        startRegionLoad(region);
+}
+//-----------------------------------------------------------------------------
+/*! Streams the regions of a large map around the tracked pose. This replaces
+loading the whole map: The map passed to WAISlam or setMap only contains the
+keyframes of loadedRegion (see WAIMapStorage::loadMapBinary). When the tracked
+pose or a position prior moves more than half of residentRadius away from the
+center of the loaded region, the region around it is loaded with the loader on
+a background thread. The pose thread then swaps the maps and evicts the previous
+region. Its radius and keyframe budget are given by residentRadius and
+maxResidentKeyFrames, so at most two regions (current and loading) are in memory.
+The regions are only streamed in onlyTracking mode, because the local mapping
+and the loop closing keep raw pointers into the map. Call this again after setMap.
+*/
+void WAISlam::setMapRegionLoader(MapRegionLoader            loader,
+                                 const WAIMapTiles::Region& loadedRegion)
+{
+    if (!_params.onlyTracking || _params.residentRadius <= 0.0f)
+    {
+        LOG_WAISLAM_WARN("Map regions are only streamed in onlyTracking mode with a residentRadius > 0");
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(_mutexStates);
+    _mapRegionLoader = loader;
+    _loadedRegion    = loadedRegion;
+}
+//-----------------------------------------------------------------------------
+//! Loads the region on a new thread. The result is swapped in by swapLoadedRegion.
+void WAISlam::startRegionLoad(const WAIMapTiles::Region& region)
+{
+    // the region before the current one is not needed anymore
+    _evictedMap.reset();
+
+    _loadingRegion         = region;
+    MapRegionLoader loader = _mapRegionLoader;
+    _regionLoadThread      = new std::thread([this, loader, region]() {
+        std::unique_ptr<WAIMap> map = loader(region);
+
+        std::unique_lock<std::mutex> lock(_regionLoadMutex);
+        _regionLoadedMap = std::move(map);
+        _regionLoadDone  = true;
+    });
+}
+//-----------------------------------------------------------------------------
+//! Waits for a running region load
+void WAISlam::finishRegionLoad()
+{
+    if (_regionLoadThread == nullptr)
+        return;
+
+    _regionLoadThread->join();
+    delete _regionLoadThread;
+    _regionLoadThread = nullptr;
+}
+//-----------------------------------------------------------------------------
+/*! Replaces the map by the region that was loaded in the background. The
+local map and the last frame point into the previous region, so they are
+cleared and the next frame is relocalized around the last tracked position.
+The previous map is kept until the next region load starts, so that the
+pointers returned by getMapPoints and getKeyFrames stay valid until then.
+*/
+void WAISlam::swapLoadedRegion()
+{
+    if (_regionLoadThread == nullptr)
+        return;
+
+    std::unique_lock<std::mutex> lock(_regionLoadMutex);
+    if (!_regionLoadDone)
+        return;
+    std::unique_ptr<WAIMap> map = std::move(_regionLoadedMap);
+    _regionLoadDone             = false;
+    lock.unlock();
+
+    finishRegionLoad();
+
+    if (map == nullptr || map->KeyFramesInMap() == 0)
+    {
+        LOG_WAISLAM_WARN("Map region could not be loaded");
+        return;
+    }
+
+    // relocalize around the last tracked position or the center of the region
+    cv::Mat position;
+    if (_state == WAITrackingState::TrackingOK || _state == WAITrackingState::TrackingStart)
+    {
+        std::unique_lock<std::mutex> lockPose(_cameraExtrinsicMutex);
+        cv::Point3f center = WAIMapTiles::cameraCenter(_cameraExtrinsic);
+        position           = (cv::Mat_<float>(3, 1) << center.x, center.y, center.z);
+    }
+    else
+        position = (cv::Mat_<float>(3, 1) << _loadingRegion.center.x, _loadingRegion.center.y, _loadingRegion.center.z);
+
+    map->GetKeyFrameDB()->tileSize(_params.tileSize);
+    _evictedMap            = std::move(_globalMap);
+    _globalMap             = std::move(map);
+    _loadedRegion          = _loadingRegion;
+    _spatialIndexChangeIdx = _globalMap->GetLastBigChangeIdx();
+
+    _localMap.keyFrames.clear();
+    _localMap.mapPoints.clear();
+    _localMap.refKF = nullptr;
+    {
+        std::unique_lock<std::mutex> lockFrame(_lastFrameMutex);
+        _lastFrame = WAIFrame();
+    }
+    _velocity           = cv::Mat();
+    _state              = WAITrackingState::TrackingLost;
+    _optFlowExtractNext = true;
+    _hasResidentTile    = false;
+    updateResidentRegion(position, true);
+
+    std::unique_lock<std::mutex> lockPrior(_posePriorMutex);
+    _posePrior.position    = cv::Point3f(position.at<float>(0), position.at<float>(1), position.at<float>(2));
+    _posePrior.radius      = _params.gpsMaxRadius;
+    _posePrior.viewDir     = cv::Point3f();
+    _posePrior.maxAngleDEG = _params.gpsMaxViewAngle;
+    _hasPosePrior          = true;
+
+    LOG_WAISLAM_INFO("Swapped in map region with %d keyframes", (int)_globalMap->KeyFramesInMap());
+}
+//-----------------------------------------------------------------------------
 int WAISlam::getMapPointMatchesCount() const
 {
     return _infoMatchedInliners;
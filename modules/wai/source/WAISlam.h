@@ -16,6 +16,8 @@
 #include <WAIMap.h>
 #include <WAIMapPoint.h>
 #include <WAIKeyFrame.h>
+#include <atomic>
+#include <functional>
 #include <memory>
 
 //-----------------------------------------------------------------------------
@@ -39,8 +41,13 @@ public:
         // If true, keyframes loaded from a map will not be culled and the pose will not be changed. Local bundle adjustment is applied only on newly added kfs.
         // Also, the loop closing will be disabled so that there will be no optimization of the essential graph and no global bundle adjustment.
         bool fixOldKfs = false;
-        // use lucas canade optical flow tracking
+        // use lucas canade optical flow tracking: Between the frames with full ORB extraction the
+        // matched keypoints are tracked with optical flow and only the pose is optimized
         bool trackOptFlow = false;
+        // optical flow tracking: extract ORB features at least every optFlowMaxFrames frames
+        int optFlowMaxFrames = 10;
+        // optical flow tracking: extract ORB features if the inliers drop below this ratio of the last extracted frame
+        float optFlowMinInlierRatio = 0.7f;
 
         // keyframe culling strategy params:
         //  A keyframe is considered redundant if _cullRedundantPerc of the MapPoints it sees, are seen
@@ -53,8 +60,26 @@ public:
 
         // Min acceleration score filter in detectRelocalizationCandidates
         bool minAccScoreFilter = false;
+
+        // Spatial map tiles (see WAIMapTiles): If residentRadius > 0 the relocalization only
+        // searches the keyframes in the tiles around the last tracked pose or the position prior.
+        // With setMapRegionLoader the map itself is streamed within this radius and keyframe budget.
+        float tileSize             = 50.0f;
+        float residentRadius       = 0.0f;
+        int   maxResidentKeyFrames = 0;
+
+        // GPS guided relocalization (see setPositionPrior): The keyframes are searched within
+        // gpsAccuracyFactor times the GPS accuracy around the prior, clamped to [gpsMinRadius, gpsMaxRadius],
+        // and within gpsMaxViewAngle (half opening angle in degrees) around the heading
+        float gpsMinRadius      = 5.0f;
+        float gpsMaxRadius      = 50.0f;
+        float gpsAccuracyFactor = 2.0f;
+        float gpsMaxViewAngle   = 60.0f;
     };
 
+    //! Loads the keyframes of a region of a large map into a new map, e.g. with WAIMapStorage::loadMapBinary
+    typedef std::function<std::unique_ptr<WAIMap>(const WAIMapTiles::Region&)> MapRegionLoader;
+
     WAISlam(const cv::Mat&          intrinsic,
             const cv::Mat&          distortion,
             WAIOrbVocabulary*       voc,
@@ -95,6 +120,8 @@ public:
     virtual WAIFrame*                 getLastFramePtr();
     virtual std::vector<WAIMapPoint*> getLocalMapPoints() { return _localMap.mapPoints; }
     virtual int                       getNumKeyFrames() { return (int)_globalMap->KeyFramesInMap(); }
+    virtual float                     getKeyFrameLatencyMS() { return _localMapping->keyFrameLatencyMS(); }
+    virtual float                     getMaxKeyFrameLatencyMS() { return _localMapping->maxKeyFrameLatencyMS(); }
 
     virtual std::vector<WAIMapPoint*> getMapPoints()
     {
@@ -145,6 +172,14 @@ public:
     // set camera extrinsic guess
     virtual void setCamExrinsicGuess(cv::Mat extrinsicGuess);
     virtual void setMap(std::unique_ptr<WAIMap> globalMap);
+    // set position prior (e.g. from GPS) in map coordinates for the resident map tiles and the
+    // next relocalization, optionally with the viewing direction (e.g. from the compass) and the GPS accuracy
+    virtual void setPositionPrior(const cv::Mat& position,
+                                  const cv::Mat& viewDir   = cv::Mat(),
+                                  float          accuracyM = -1.0f);
+    // stream the regions of a large map around the tracked pose in onlyTracking mode (see WAIMapTiles)
+    virtual void setMapRegionLoader(MapRegionLoader            loader,
+                                    const WAIMapTiles::Region& loadedRegion);
 
     virtual WAITrackingState getTrackingState() { return _state; }
 
@@ -169,6 +204,12 @@ public:
 
 protected:
     void updateState(WAITrackingState state);
+    void updateResidentRegion(const cv::Mat& position, bool force);
+    void startRegionLoad(const WAIMapTiles::Region& region);
+    void finishRegionLoad();
+    void swapLoadedRegion();
+    void updatePoseOptFlow(WAIFrame& frame);
+    bool relocalize(WAIFrame& frame, int& inliers);
 
     bool        _requestFinish;
     bool        _isFinish;
@@ -180,6 +221,7 @@ protected:
     bool        isFinished();
     void        flushQueue();
     int         getNextFrame(WAIFrame& frame);
+    void        wakeUpPoseThread();
     static void updatePoseThread(WAISlam* ptr);
 
     WAITrackingState _state = WAITrackingState::Idle;
@@ -190,16 +232,40 @@ protected:
 
     WAISlam::Params _params;
 
-    unsigned int         _relocFrameCounter   = 0;
-    unsigned long        _lastRelocFrameId    = 0;
-    unsigned long        _lastKeyFrameFrameId = 0;
-    KPextractor*         _extractor           = nullptr;
-    KPextractor*         _relocExtractor      = nullptr;
-    KPextractor*         _iniExtractor        = nullptr;
-    int                  _infoMatchedInliners = 0;
-    std::thread*         _poseUpdateThread;
-    std::queue<WAIFrame> _framesQueue;
-    std::mutex           _frameQueueMutex;
+    unsigned int            _relocFrameCounter   = 0;
+    unsigned long           _lastRelocFrameId    = 0;
+    unsigned long           _lastKeyFrameFrameId = 0;
+    KPextractor*            _extractor           = nullptr;
+    KPextractor*            _relocExtractor      = nullptr;
+    KPextractor*            _iniExtractor        = nullptr;
+    int                     _infoMatchedInliners = 0;
+    std::thread*            _poseUpdateThread;
+    std::queue<WAIFrame>    _framesQueue;
+    std::mutex              _frameQueueMutex;
+    std::condition_variable _frameQueueCondVar;
+    uint64_t                _residentTileKey     = 0;
+    bool                    _hasResidentTile     = false;
+
+    // Map region streaming: the next region is loaded on _regionLoadThread and swapped in by the pose thread
+    MapRegionLoader         _mapRegionLoader;
+    WAIMapTiles::Region     _loadedRegion;               //!< region of the current map
+    WAIMapTiles::Region     _loadingRegion;              //!< region that is loaded on _regionLoadThread
+    std::thread*            _regionLoadThread = nullptr; //!< thread of the running region load
+    std::mutex              _regionLoadMutex;
+    std::unique_ptr<WAIMap> _regionLoadedMap;            //!< loaded map that is not swapped in yet
+    bool                    _regionLoadDone = false;     //!< true if _regionLoadThread has finished
+    std::unique_ptr<WAIMap> _evictedMap;                 //!< previous region, deleted when the next load starts
+
+    // GPS guided relocalization: the prior is set by setPositionPrior and cleared on relocalization
+    std::mutex               _posePriorMutex;
+    WAIKeyFrameDB::PosePrior _posePrior;
+    bool                     _hasPosePrior          = false;
+    int                      _spatialIndexChangeIdx = 0; //!< big map change index of the last spatial index update
+
+    // Optical flow tracking: the pose thread requests the ORB extraction of the next frames
+    std::atomic<bool> _optFlowExtractNext{true};
+    int               _optFlowFrameCount = 0; //!< NO. of optical flow frames since the last extracted frame
+    int               _optFlowRefInliers = 0; //!< inliers of the last extracted frame
 };
 //-----------------------------------------------------------------------------
 #endif
@@ -1,9 +1,18 @@
 #include <WAISlamTools.h>
+#include <WAIWorkerPool.h>
 #include <AverageTiming.h>
 #include <Utils.h>
+#include <algorithm>
+#include <memory>
+#include <opencv2/video/tracking.hpp>
 
 #define MIN_FRAMES 0
 #define MAX_FRAMES 30
+
+// Lucas-Kanade optical flow tracking (see trackWithOptFlow)
+#define OPTFLOW_WIN_SIZE 21
+#define OPTFLOW_MAX_LEVEL 3
+#define OPTFLOW_MIN_INLIERS 50
 //#define MULTI_MAPPING_THREADS 1
 //#define MULTI_THREAD_FRAME_PROCESSING 1
 
@@ -493,14 +502,19 @@ bool WAISlamTools::trackLocalMap(LocalMap& localMap,
                                  int       lastRelocFrameId,
                                  int&      inliers)
 {
+    AVERAGE_TIMING_START("trackLocalMap");
     updateLocalMap(frame, localMap);
     if (!localMap.keyFrames.empty())
     {
         frame.mpReferenceKF = localMap.refKF;
         inliers             = trackLocalMapPoints(localMap, lastRelocFrameId, frame);
         if (inliers > 50)
+        {
+            AVERAGE_TIMING_STOP("trackLocalMap");
             return true;
+        }
     }
+    AVERAGE_TIMING_STOP("trackLocalMap");
     return false;
 }
 
@@ -731,192 +745,28 @@ bool WAISlamTools::relocalization(WAIFrame& currentFrame,
         return false;
     }
 
-    //vector<WAIKeyFrame*> vpCandidateKFs = mpKeyFrameDatabase->keyFrames();
-    const int nKFs = (int)vpCandidateKFs.size();
-
-    //DUtils::Random::SeedRandOnce(42);
-    //for(int i= 0; i < 10; ++ i)
-    //    std::cout << "rand: " << DUtils::Random::RandomInt(0, 10) << std::endl;
-    
-    // We perform first an ORB matching with each candidate
-    // If enough matches are found we setup a PnP solver
-    // Best match < 0.75 * second best match (default is 0.6)
-    ORBmatcher matcher(0.75, true);
-
-    vector<PnPsolver*> vpPnPsolvers;
-    vpPnPsolvers.resize(nKFs);
-
-    vector<vector<WAIMapPoint*>> vvpMapPointMatches;
-    vvpMapPointMatches.resize(nKFs);
-
-    std::vector<bool> outliers;
-
-    vector<bool> vbDiscarded;
-    vbDiscarded.resize(nKFs);
-
-    int nCandidates = 0;
-
-    for (int i = 0; i < nKFs; i++)
-    {
-        WAIKeyFrame* pKF = vpCandidateKFs[i];
-        if (pKF->isBad())
-            vbDiscarded[i] = true;
-        else
-        {
-            int nmatches = matcher.SearchByBoW(pKF, currentFrame, vvpMapPointMatches[i]);
-            if (nmatches < 15)
-            {
-                vbDiscarded[i] = true;
-                continue;
-            }
-            else
-            {
-                PnPsolver* pSolver = new PnPsolver(currentFrame, vvpMapPointMatches[i]);
-                pSolver->SetRansacParameters(0.99, 10, 300, 4, 0.5f, 5.991f);
-                vpPnPsolvers[i] = pSolver;
-                nCandidates++;
-            }
-        }
-    }
-
-    // Alternatively perform some iterations of P4P RANSAC
-    // Until we found a camera pose supported by enough inliers
-    bool       bMatch = false;
-    ORBmatcher matcher2(0.9f, true);
-
-    while (nCandidates > 0 && !bMatch)
-    {
-        for (int i = 0; i < nKFs; i++)
-        {
-            if (vbDiscarded[i])
-                continue;
-
-            // Perform 5 Ransac Iterations
-            vector<bool> vbInliers;
-            int          nInliers;
-            bool         bNoMore;
-
-            PnPsolver* pSolver = vpPnPsolvers[i];
-            cv::Mat    Tcw     = pSolver->iterate(5, bNoMore, vbInliers, nInliers);
-
-            // If Ransac reachs max. iterations discard keyframe
-            if (bNoMore)
-            {
-                vbDiscarded[i] = true;
-                nCandidates--;
-            }
-
-            // If a Camera Pose is computed, optimize
-            if (!Tcw.empty())
-            {
-                Tcw.copyTo(currentFrame.mTcw);
-
-                set<WAIMapPoint*> sFound;
-
-                const int np = (int)vbInliers.size();
-
-                for (int j = 0; j < np; j++)
-                {
-                    if (vbInliers[j])
-                    {
-                        currentFrame.mvpMapPoints[j] = vvpMapPointMatches[i][j];
-                        sFound.insert(vvpMapPointMatches[i][j]);
-                    }
-                    else
-                        currentFrame.mvpMapPoints[j] = NULL;
-                }
-
-                int nGood = Optimizer::PoseOptimization(&currentFrame, outliers);
-
-                if (nGood < 10)
-                {
-                    //std::cout << "Number of nGood:" << nGood << std::endl;
-                    continue;
-                }
-
-                // If few inliers, search by projection in a coarse window and optimize again:
-                //ghm1: mappoints seen in the keyframe which was found as candidate via BoW-search are projected into
-                //the current frame using the position that was calculated using the matches from BoW matcher
-                if (nGood < 50)
-                {
-                    int nadditional = matcher2.SearchByProjection(currentFrame, vpCandidateKFs[i], sFound, 10, 100);
-
-                    if (nadditional + nGood >= 50)
-                    {
-                        nGood = Optimizer::PoseOptimization(&currentFrame, outliers);
-
-                        // If many inliers but still not enough, search by projection again in a narrower window
-                        // the camera has been already optimized with many points
-                        if (nGood > 30 && nGood < 50)
-                        {
-                            sFound.clear();
-                            for (int ip = 0; ip < currentFrame.N; ip++)
-                                if (currentFrame.mvpMapPoints[ip] && !outliers[ip])
-                                    sFound.insert(currentFrame.mvpMapPoints[ip]);
-                            nadditional = matcher2.SearchByProjection(currentFrame, vpCandidateKFs[i], sFound, 3, 64);
-
-                            // Final optimization
-                            if (nGood + nadditional >= 50)
-                            {
-                                nGood = Optimizer::PoseOptimization(&currentFrame);
-                            }
-                        }
-                    }
-                }
-
-                // If the pose is supported by enough inliers stop ransacs and continue
-                if (nGood >= 50)
-                {
-                    bMatch = trackLocalMap(localMap, currentFrame, (int)currentFrame.mnId, inliers);
-                    //std::cout << "Number of nGood:" << nGood << std::endl;
-                    break;
-                }
-            }
-        }
-    }
+    bool bMatch = relocalizeFromCandidates(currentFrame, vpCandidateKFs, localMap, inliers);
 
     AVERAGE_TIMING_STOP("relocalization");
     return bMatch;
 }
 
-bool WAISlamTools::relocalizationGPS(WAIFrame& currentFrame,
-                                     WAIMap*   waiMap,
-                                     LocalMap& localMap,
-                                     cv::Mat   locENU,
-                                     cv::Mat   dirENU,
-                                     float     minCommonWordFactor,
-                                     int&      inliers,
-                                     bool      minAccScoreFilter)
+// Relocalization with a pose prior from GPS and compass in map coordinates: Only the
+// keyframes within the radius and heading cone of the prior are scored in the
+// keyframe database. The map must be aligned to ENU, e.g. with transformCoords.
+bool WAISlamTools::relocalizationGPS(WAIFrame&                       currentFrame,
+                                     WAIMap*                         waiMap,
+                                     LocalMap&                       localMap,
+                                     const WAIKeyFrameDB::PosePrior& prior,
+                                     float                           minCommonWordFactor,
+                                     int&                            inliers,
+                                     bool                            minAccScoreFilter)
 {
     AVERAGE_TIMING_START("relocalization");
     currentFrame.ComputeBoW();
     // Relocalization is performed when tracking is lost
     vector<WAIKeyFrame*> vpCandidateKFs;
-    vector<WAIKeyFrame*> allKf = waiMap->GetAllKeyFrames();
-
-    float minDist;
-    for (WAIKeyFrame * kf : allKf)
-    {
-        cv::Mat tcw = kf->GetPose();
-        cv::Mat_<double> front(3, 1);
-
-        front(0, 0) = 0;
-        front(1, 0) = 0;
-        front(2, 0) =-1.0;
-
-        front = tcw * front;
-        if (dirENU.dot(front) < 0)
-            continue;
-
-        cv::Mat pose = tcw.col(3).rowRange(0, 2);
-
-        float dist = (float)cv::norm(locENU, pose);
-        if (dist < minDist)
-            minDist = dist;
-
-        if (dist < 3)
-            vpCandidateKFs.push_back(kf);
-    }
+    vpCandidateKFs = waiMap->GetKeyFrameDB()->DetectRelocalizationCandidates(&currentFrame, prior, minCommonWordFactor, minAccScoreFilter);
 
     if (vpCandidateKFs.empty())
     {
@@ -924,28 +774,36 @@ bool WAISlamTools::relocalizationGPS(WAIFrame& currentFrame,
         return false;
     }
 
-    const int nKFs = (int)vpCandidateKFs.size();
+    bool bMatch = relocalizeFromCandidates(currentFrame, vpCandidateKFs, localMap, inliers);
+
+    AVERAGE_TIMING_STOP("relocalization");
+    return bMatch;
+}
+
+// Finds the pose of the current frame with P4P RANSAC on the matches with the candidate
+// keyframes. The BoW matching and the RANSAC iterations of the candidates run in
+// parallel on the shared worker pool. The found poses are optimized in the order of
+// the candidates on the calling thread because the optimization changes the frame.
+bool WAISlamTools::relocalizeFromCandidates(WAIFrame&                        currentFrame,
+                                            const std::vector<WAIKeyFrame*>& vpCandidateKFs,
+                                            LocalMap&                        localMap,
+                                            int&                             inliers)
+{
+    const int      nKFs = (int)vpCandidateKFs.size();
+    WAIWorkerPool& pool = WAIWorkerPool::shared();
 
     // We perform first an ORB matching with each candidate
     // If enough matches are found we setup a PnP solver
     // Best match < 0.75 * second best match (default is 0.6)
     ORBmatcher matcher(0.75, true);
 
-    vector<PnPsolver*> vpPnPsolvers;
-    vpPnPsolvers.resize(nKFs);
-
-    vector<vector<WAIMapPoint*>> vvpMapPointMatches;
-    vvpMapPointMatches.resize(nKFs);
-
-    std::vector<bool> outliers;
-
-    vector<bool> vbDiscarded;
-    vbDiscarded.resize(nKFs);
+    vector<unique_ptr<PnPsolver>> vpPnPsolvers(nKFs);
+    vector<vector<WAIMapPoint*>>  vvpMapPointMatches(nKFs);
 
-    int nCandidates = 0;
+    // vector<bool> can't be written by several threads
+    vector<char> vbDiscarded(nKFs, false);
 
-    for (int i = 0; i < nKFs; i++)
-    {
+    pool.parallelFor(nKFs, [&](int i) {
         WAIKeyFrame* pKF = vpCandidateKFs[i];
         if (pKF->isBad())
             vbDiscarded[i] = true;
@@ -953,47 +811,57 @@ bool WAISlamTools::relocalizationGPS(WAIFrame& currentFrame,
         {
             int nmatches = matcher.SearchByBoW(pKF, currentFrame, vvpMapPointMatches[i]);
             if (nmatches < 15)
-            {
                 vbDiscarded[i] = true;
-                continue;
-            }
             else
             {
-                PnPsolver* pSolver = new PnPsolver(currentFrame, vvpMapPointMatches[i]);
-                pSolver->SetRansacParameters(0.99, 10, 300, 4, 0.5f, 5.991f);
-                vpPnPsolvers[i] = pSolver;
-                nCandidates++;
+                vpPnPsolvers[i].reset(new PnPsolver(currentFrame, vvpMapPointMatches[i]));
+                vpPnPsolvers[i]->SetRansacParameters(0.99, 10, 300, 4, 0.5f, 5.991f);
             }
         }
-    }
+    });
+
+    int nCandidates = (int)count(vbDiscarded.begin(), vbDiscarded.end(), false);
 
     // Alternatively perform some iterations of P4P RANSAC
     // Until we found a camera pose supported by enough inliers
     bool       bMatch = false;
     ORBmatcher matcher2(0.9f, true);
 
+    std::vector<bool> outliers;
+
+    // Results of the RANSAC iterations of every candidate
+    vector<cv::Mat>      vTcw(nKFs);
+    vector<vector<bool>> vvbInliers(nKFs);
+    vector<char>         vbNoMore(nKFs, false);
+
     while (nCandidates > 0 && !bMatch)
     {
+        // Perform 5 Ransac Iterations on all candidates in parallel
+        pool.parallelFor(nKFs, [&](int i) {
+            if (vbDiscarded[i])
+                return;
+
+            int  nInliers;
+            bool bNoMore;
+            vTcw[i]     = vpPnPsolvers[i]->iterate(5, bNoMore, vvbInliers[i], nInliers);
+            vbNoMore[i] = bNoMore;
+        });
+
         for (int i = 0; i < nKFs; i++)
         {
             if (vbDiscarded[i])
                 continue;
 
-            // Perform 5 Ransac Iterations
-            vector<bool> vbInliers;
-            int          nInliers;
-            bool         bNoMore;
-
-            PnPsolver* pSolver = vpPnPsolvers[i];
-            cv::Mat    Tcw     = pSolver->iterate(5, bNoMore, vbInliers, nInliers);
-
             // If Ransac reachs max. iterations discard keyframe
-            if (bNoMore)
+            if (vbNoMore[i])
             {
                 vbDiscarded[i] = true;
                 nCandidates--;
             }
 
+            const cv::Mat&      Tcw       = vTcw[i];
+            const vector<bool>& vbInliers = vvbInliers[i];
+
             // If a Camera Pose is computed, optimize
             if (!Tcw.empty())
             {
@@ -1063,7 +931,6 @@ bool WAISlamTools::relocalizationGPS(WAIFrame& currentFrame,
         }
     }
 
-    AVERAGE_TIMING_STOP("relocalization");
     return bMatch;
 }
 
@@ -1238,8 +1105,9 @@ void WAISlamTools::updateLocalMap(WAIFrame& frame,
             WAIMapPoint* pMP = frame.mvpMapPoints[i];
             if (!pMP->isBad())
             {
-                const map<WAIKeyFrame*, size_t> observations = pMP->GetObservations();
-                for (map<WAIKeyFrame*, size_t>::const_iterator it = observations.begin(), itend = observations.end(); it != itend; it++)
+                // the snapshot is shared, the observations are neither copied nor locked
+                shared_ptr<const map<WAIKeyFrame*, size_t>> observations = pMP->GetObservationSnapshot();
+                for (map<WAIKeyFrame*, size_t>::const_iterator it = observations->begin(), itend = observations->end(); it != itend; it++)
                     keyframeCounter[it->first]++;
             }
             else
@@ -1286,11 +1154,13 @@ void WAISlamTools::updateLocalMap(WAIFrame& frame,
 
         WAIKeyFrame* pKF = localMap.keyFrames[i];
 
-        const vector<WAIKeyFrame*> vNeighs = pKF->GetBestCovisibilityKeyFrames(10);
+        // walk the 10 best covisibles in the snapshot without copying them
+        shared_ptr<const WAICovisibility> cov     = pKF->GetCovisibility();
+        const size_t                      nNeighs = min(cov->orderedKFs.size(), (size_t)10);
 
-        for (vector<WAIKeyFrame*>::const_iterator itNeighKF = vNeighs.begin(), itEndNeighKF = vNeighs.end(); itNeighKF != itEndNeighKF; itNeighKF++)
+        for (size_t iNeigh = 0; iNeigh < nNeighs; iNeigh++)
         {
-            WAIKeyFrame* pNeighKF = *itNeighKF;
+            WAIKeyFrame* pNeighKF = cov->orderedKFs[iNeigh];
             if (!pNeighKF->isBad())
             {
                 if (pNeighKF->mnMarker[TRACK_REF_FRAME] != frame.mnId) //to ensure not already added at previous step
@@ -1398,6 +1268,105 @@ bool WAISlamTools::trackWithMotionModel(cv::Mat   velocity,
     return nmatches >= 10;
 }
 
+void WAISlamTools::buildOptFlowPyramid(WAIFrame& frame, const cv::Mat& imageGray)
+{
+    AVERAGE_TIMING_START("BuildOptFlowPyramid");
+
+    // The derivatives are stored with the pyramid, so they are not computed again when the frame
+    // is the previous frame of the next optical flow tracking
+    cv::buildOpticalFlowPyramid(imageGray,
+                                frame.mvOptFlowPyramid,
+                                cv::Size(OPTFLOW_WIN_SIZE, OPTFLOW_WIN_SIZE),
+                                OPTFLOW_MAX_LEVEL,
+                                true,
+                                cv::BORDER_REFLECT_101,
+                                cv::BORDER_CONSTANT,
+                                false);
+
+    AVERAGE_TIMING_STOP("BuildOptFlowPyramid");
+}
+
+bool WAISlamTools::trackWithOptFlow(cv::Mat   velocity,
+                                    WAIFrame& previousFrame,
+                                    WAIFrame& frame,
+                                    int&      inliers)
+{
+    inliers = 0;
+
+    // Only consecutive frames with prebuilt pyramids can be tracked
+    if (previousFrame.mvOptFlowPyramid.empty() || frame.mvOptFlowPyramid.empty() || frame.mnId != previousFrame.mnId + 1)
+        return false;
+
+    AVERAGE_TIMING_START("TrackWithOptFlow");
+
+    // Track the keypoints of the previous frame that are associated to a map point
+    vector<cv::Point2f>  prevPts;
+    vector<cv::KeyPoint> keyPts;
+    vector<WAIMapPoint*> mapPts;
+    for (int i = 0; i < previousFrame.N; i++)
+    {
+        WAIMapPoint* pMP = previousFrame.mvpMapPoints[i];
+        if (pMP && !pMP->isBad())
+        {
+            prevPts.push_back(previousFrame.mvKeys[i].pt);
+            keyPts.push_back(previousFrame.mvKeys[i]);
+            mapPts.push_back(pMP);
+        }
+    }
+
+    if (prevPts.size() < OPTFLOW_MIN_INLIERS)
+    {
+        AVERAGE_TIMING_STOP("TrackWithOptFlow");
+        return false;
+    }
+
+    vector<cv::Point2f> nextPts;
+    vector<uchar>       status;
+    vector<float>       err;
+    cv::calcOpticalFlowPyrLK(previousFrame.mvOptFlowPyramid,
+                             frame.mvOptFlowPyramid,
+                             prevPts,
+                             nextPts,
+                             status,
+                             err,
+                             cv::Size(OPTFLOW_WIN_SIZE, OPTFLOW_WIN_SIZE),
+                             OPTFLOW_MAX_LEVEL,
+                             cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01));
+
+    // Keep the successfully tracked points inside the image (the keypoints keep their octave)
+    const float maxX = (float)frame.mvOptFlowPyramid[0].cols;
+    const float maxY = (float)frame.mvOptFlowPyramid[0].rows;
+    size_t      n    = 0;
+    for (size_t i = 0; i < prevPts.size(); i++)
+    {
+        const cv::Point2f& pt = nextPts[i];
+        if (!status[i] || pt.x < 0.0f || pt.y < 0.0f || pt.x >= maxX || pt.y >= maxY)
+            continue;
+
+        keyPts[n]    = keyPts[i];
+        keyPts[n].pt = pt;
+        mapPts[n]    = mapPts[i];
+        n++;
+    }
+    keyPts.resize(n);
+    mapPts.resize(n);
+
+    frame.SetOptFlowKeyPoints(keyPts, mapPts);
+    frame.mpReferenceKF = previousFrame.mpReferenceKF;
+    if (velocity.empty())
+        frame.SetPose(previousFrame.mTcw);
+    else
+        frame.SetPose(velocity * previousFrame.mTcw);
+
+    // Optimize frame pose with the tracked points (outliers are removed from the frame)
+    if ((int)n >= OPTFLOW_MIN_INLIERS)
+        inliers = Optimizer::PoseOptimization(&frame);
+
+    AVERAGE_TIMING_STOP("TrackWithOptFlow");
+
+    return inliers >= OPTFLOW_MIN_INLIERS;
+}
+
 WAIFrame WAISlamTools::createMarkerFrame(std::string       markerFile,
                                          KPextractor*      markerExtractor,
                                          const cv::Mat&    markerCameraIntrinsic,
@@ -83,14 +83,13 @@ public:
                                int&      inliers,
                                bool      minAccScoreFilter = false);
 
-    static bool relocalizationGPS(WAIFrame& currentFrame,
-                                  WAIMap*   waiMap,
-                                  LocalMap& localMap,
-                                  cv::Mat   locENU,
-                                  cv::Mat   dirENU,
-                                  float     minCommonWordFactor,
-                                  int&      inliers,
-                                  bool      minAccScoreFilter);
+    static bool relocalizationGPS(WAIFrame&                       currentFrame,
+                                  WAIMap*                         waiMap,
+                                  LocalMap&                       localMap,
+                                  const WAIKeyFrameDB::PosePrior& prior,
+                                  float                           minCommonWordFactor,
+                                  int&                            inliers,
+                                  bool                            minAccScoreFilter);
 
     static bool tracking(WAIMap*   map,
                          LocalMap& localMap,
@@ -139,6 +138,12 @@ public:
 
     static bool trackWithMotionModel(cv::Mat velocity, WAIFrame& previousFrame, WAIFrame& frame);
 
+    //! Builds the Lucas-Kanade image pyramid of a frame (once per frame, see trackWithOptFlow)
+    static void buildOptFlowPyramid(WAIFrame& frame, const cv::Mat& imageGray);
+
+    //! Tracks the matched keypoints of the previous frame with Lucas-Kanade optical flow and optimizes the pose
+    static bool trackWithOptFlow(cv::Mat velocity, WAIFrame& previousFrame, WAIFrame& frame, int& inliers);
+
     static void updateLocalMap(WAIFrame& frame, LocalMap& localMap);
 
     static int trackLocalMapPoints(LocalMap& localMap, int lastRelocFrameId, WAIFrame& frame);
@@ -197,6 +202,11 @@ protected:
                                           unsigned int& n,
                                           unsigned int& outliers);
 
+    static bool relocalizeFromCandidates(WAIFrame&                        currentFrame,
+                                         const std::vector<WAIKeyFrame*>& vpCandidateKFs,
+                                         LocalMap&                        localMap,
+                                         int&                             inliers);
+
     cv::Mat _distortion;
     cv::Mat _cameraIntrinsic;
     cv::Mat _cameraExtrinsic;
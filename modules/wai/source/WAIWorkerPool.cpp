@@ -0,0 +1,104 @@
+//#############################################################################
+//  File:      WAIWorkerPool.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <WAIWorkerPool.h>
+#include <Utils.h>
+
+//-----------------------------------------------------------------------------
+//! Creates numThreads-1 worker threads because the caller works as well
+WAIWorkerPool::WAIWorkerPool(int numThreads)
+{
+    for (int i = 1; i < numThreads; ++i)
+        _threads.emplace_back(&WAIWorkerPool::run, this);
+}
+//-----------------------------------------------------------------------------
+WAIWorkerPool::~WAIWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wakeUpCondVar.notify_all();
+
+    for (auto& thread : _threads)
+        thread.join();
+}
+//-----------------------------------------------------------------------------
+//! Calls task(i) for i = 0 to numTasks-1 in parallel and waits for the end
+void WAIWorkerPool::parallelFor(int numTasks, const std::function<void(int)>& task)
+{
+    if (numTasks <= 0)
+        return;
+
+    if (_threads.empty() || numTasks == 1)
+    {
+        for (int i = 0; i < numTasks; ++i)
+            task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(_callMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task     = &task;
+        _numTasks = numTasks;
+        _nextTask = 0;
+        _numBusy  = (int)_threads.size();
+        _generation++;
+    }
+    _wakeUpCondVar.notify_all();
+
+    // The calling thread works as well
+    work();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondVar.wait(lock, [this] { return _numBusy == 0; });
+    _task = nullptr;
+}
+//-----------------------------------------------------------------------------
+//! Pool with the max. NO. of threads that is created on the first call
+WAIWorkerPool& WAIWorkerPool::shared()
+{
+    static WAIWorkerPool pool((int)Utils::maxThreads());
+    return pool;
+}
+//-----------------------------------------------------------------------------
+//! Runs the tasks of the current loop until there are no more left
+void WAIWorkerPool::work()
+{
+    int i;
+    while ((i = _nextTask.fetch_add(1)) < _numTasks)
+        (*_task)(i);
+}
+//-----------------------------------------------------------------------------
+//! Worker thread routine that waits for the next loop
+void WAIWorkerPool::run()
+{
+    unsigned long generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeUpCondVar.wait(lock, [&] { return _stop || _generation != generation; });
+            if (_stop)
+                return;
+            generation = _generation;
+        }
+
+        work();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_numBusy == 0)
+                _doneCondVar.notify_one();
+        }
+    }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,64 @@
+//#############################################################################
+//  File:      WAIWorkerPool.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef WAIWORKERPOOL_H
+#define WAIWORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <WAIHelper.h>
+
+//-----------------------------------------------------------------------------
+//! Pool of persistent worker threads for data parallel loops
+/*!
+WAIWorkerPool::parallelFor calls a task for the indices 0 to numTasks-1 on the
+worker threads and on the calling thread. The indices are fetched from an
+atomic counter, so tasks of different sizes are balanced automatically. The
+call returns when all tasks are finished. The threads are created once and
+wait on a condition variable between the calls, so there is no thread creation
+per frame. A pool with one thread runs all tasks on the calling thread.
+Calls from different threads are serialized, so a task must never call
+parallelFor of the same pool. WAIWorkerPool::shared is the pool of the
+tracking algorithms (e.g. the ORB extraction and the RANSAC loops), so that
+they do not create their own sets of threads.
+*/
+class WAI_API WAIWorkerPool
+{
+public:
+    explicit WAIWorkerPool(int numThreads);
+    ~WAIWorkerPool();
+
+    void parallelFor(int numTasks, const std::function<void(int)>& task);
+
+    static WAIWorkerPool& shared();
+
+    //! NO. of threads including the calling thread
+    int numThreads() const { return (int)_threads.size() + 1; }
+
+private:
+    void run();
+    void work();
+
+    std::vector<std::thread>        _threads;             //!< Worker threads
+    std::mutex                      _callMutex;           //!< Serializes calls of parallelFor
+    std::mutex                      _mutex;               //!< Mutex for the members below
+    std::condition_variable         _wakeUpCondVar;       //!< Wakes up the workers for a new loop
+    std::condition_variable         _doneCondVar;         //!< Signals the end of a loop to the caller
+    const std::function<void(int)>* _task       = nullptr; //!< Task of the current loop
+    int                             _numTasks   = 0;       //!< NO. of tasks of the current loop
+    std::atomic<int>                _nextTask{0};          //!< Index of the next task to run
+    int                             _numBusy    = 0;       //!< NO. of workers in the current loop
+    unsigned long                   _generation = 0;       //!< Counter of the loops
+    bool                            _stop       = false;   //!< Flag to end the worker threads
+};
+//-----------------------------------------------------------------------------
+#endif // WAIWORKERPOOL_H
@@ -25,7 +25,10 @@
 #include <orb_slam/Optimizer.h>
 #include <orb_slam/ORBmatcher.h>
 
-#include <thread>
+#include <WAIWorkerPool.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace ORB_SLAM2
 {
@@ -55,19 +58,7 @@ bool Initializer::Initialize(const WAIFrame&           CurrentFrame,
     // Reference Frame: 1, Current Frame: 2
     mvKeys2 = CurrentFrame.mvKeysUn;
 
-    mvMatches12.clear();
-    mvMatches12.reserve(mvKeys2.size());
-    mvbMatched1.resize(mvKeys1.size());
-    for (size_t i = 0, iend = vMatches12.size(); i < iend; i++)
-    {
-        if (vMatches12[i] >= 0)
-        {
-            mvMatches12.push_back(make_pair(i, vMatches12[i]));
-            mvbMatched1[i] = true;
-        }
-        else
-            mvbMatched1[i] = false;
-    }
+    SetMatches(vMatches12);
 
     const int N = (int)mvMatches12.size();
 
@@ -101,17 +92,12 @@ bool Initializer::Initialize(const WAIFrame&           CurrentFrame,
         }
     }
 
-    // Launch threads to compute in parallel a fundamental matrix and a homography
+    // Compute in parallel a fundamental matrix and a homography
     std::vector<bool> vbMatchesInliersH, vbMatchesInliersF;
     float             SH, SF;
     cv::Mat           H, F;
 
-    thread threadH(&Initializer::FindHomography, this, ref(vbMatchesInliersH), ref(SH), ref(H));
-    thread threadF(&Initializer::FindFundamental, this, ref(vbMatchesInliersF), ref(SF), ref(F));
-
-    // Wait until both threads have finished
-    threadH.join();
-    threadF.join();
+    FindHomographyAndFundamental(vbMatchesInliersH, SH, H, vbMatchesInliersF, SF, F);
 
     // Compute ratio of scores
     float RH = SH / (SH + SF);
@@ -147,21 +133,7 @@ bool Initializer::InitializeWithKnownPose(const std::vector<cv::KeyPoint>& mvKey
     mvKeys1 = mvKeysUnInitialFrame;
     mvKeys2 = mvKeysUnCurrentFrame;
 
-    mvMatches12.clear();
-    mvMatches12.reserve(mvKeys2.size());
-    mvbMatched1.resize(mvKeys1.size());
-    for (size_t i = 0, iend = vMatches12.size(); i < iend; i++)
-    {
-        if (vMatches12[i] >= 0)
-        {
-            mvMatches12.push_back(make_pair(i, vMatches12[i]));
-            mvbMatched1[i] = true;
-        }
-        else
-        {
-            mvbMatched1[i] = false;
-        }
-    }
+    SetMatches(vMatches12);
 
     cv::Mat Tcw1 = mTcwInitialFrame.clone();
     cv::Mat Rcw1 = mTcwInitialFrame.rowRange(0, 3).colRange(0, 3).clone();
@@ -204,7 +176,8 @@ bool Initializer::InitializeWithKnownPose(const std::vector<cv::KeyPoint>& mvKey
     //cv::Mat F21i = T2t * F21 * T1;
     cv::Mat F21i = F21;
 
-    float score = CheckFundamental(F21i, vMatchesInliers, mSigma);
+    int   nInliers;
+    float score = CheckFundamental(F21i, &vMatchesInliers, nInliers, mSigma);
     // TODO(dgj1): this makes no sense
     if (score < 0.6f)
     {
@@ -279,109 +252,171 @@ bool Initializer::InitializeWithKnownPose(const WAIFrame&           InitialFrame
     return result;
 }
 
-void Initializer::FindHomography(std::vector<bool>& vbMatchesInliers, float& score, cv::Mat& H21)
+void Initializer::SetMatches(const std::vector<int>& vMatches12)
 {
-    // Number of putative matches
-    const int N = (int)mvMatches12.size();
-
-    // Normalize coordinates
-    std::vector<cv::Point2f> vPn1, vPn2;
-    cv::Mat                  T1, T2;
-    Normalize(mvKeys1, vPn1, T1);
-    Normalize(mvKeys2, vPn2, T2);
-    cv::Mat T2inv = T2.inv();
-
-    // Best Results variables
-    score            = 0.0;
-    vbMatchesInliers = std::vector<bool>(N, false);
-
-    // Iteration variables
-    std::vector<cv::Point2f> vPn1i(8);
-    std::vector<cv::Point2f> vPn2i(8);
-    cv::Mat                  H21i, H12i;
-    std::vector<bool>        vbCurrentInliers(N, false);
-    float                    currentScore;
-
-    // Perform all RANSAC iterations and save the solution with highest score
-    for (int it = 0; it < mMaxIterations; it++)
+    mvMatches12.clear();
+    mvMatches12.reserve(mvKeys2.size());
+    mvbMatched1.resize(mvKeys1.size());
+    for (size_t i = 0, iend = vMatches12.size(); i < iend; i++)
     {
-        // Select a minimum set
-        for (size_t j = 0; j < 8; j++)
+        if (vMatches12[i] >= 0)
         {
-            int idx = (int)mvSets[it][j];
-
-            vPn1i[j] = vPn1[mvMatches12[idx].first];
-            vPn2i[j] = vPn2[mvMatches12[idx].second];
+            mvMatches12.push_back(make_pair(i, vMatches12[i]));
+            mvbMatched1[i] = true;
         }
+        else
+            mvbMatched1[i] = false;
+    }
 
-        cv::Mat Hn = ComputeH21(vPn1i, vPn2i);
-        H21i       = T2inv * Hn * T1;
-        H12i       = H21i.inv();
-
-        currentScore = CheckHomography(H21i, H12i, vbCurrentInliers, mSigma);
+    const size_t N = mvMatches12.size();
+    mvU1.resize(N);
+    mvV1.resize(N);
+    mvU2.resize(N);
+    mvV2.resize(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        const cv::Point2f& pt1 = mvKeys1[mvMatches12[i].first].pt;
+        const cv::Point2f& pt2 = mvKeys2[mvMatches12[i].second].pt;
 
-        if (currentScore > score)
-        {
-            H21              = H21i.clone();
-            vbMatchesInliers = vbCurrentInliers;
-            score            = currentScore;
-        }
+        mvU1[i] = pt1.x;
+        mvV1[i] = pt1.y;
+        mvU2[i] = pt2.x;
+        mvV2[i] = pt2.y;
     }
 }
 
-void Initializer::FindFundamental(std::vector<bool>& vbMatchesInliers,
-                                  float&             score,
-                                  cv::Mat&           F21)
+// NO. of RANSAC iterations needed to draw at least one minimal set of 8 inliers with the probability p
+static int RansacIterations(int nInliers, int N, double p, int maxIterations)
+{
+    if (nInliers <= 0 || N <= 0)
+        return maxIterations;
+
+    const double w8 = pow((double)nInliers / N, 8);
+    if (w8 >= 1.0)
+        return 1;
+    if (w8 <= 0.0)
+        return maxIterations;
+
+    const double nIterations = ceil(log(1.0 - p) / log(1.0 - w8));
+    return (int)std::min(nIterations, (double)maxIterations);
+}
+
+void Initializer::FindHomographyAndFundamental(std::vector<bool>& vbMatchesInliersH,
+                                               float&             SH,
+                                               cv::Mat&           H21,
+                                               std::vector<bool>& vbMatchesInliersF,
+                                               float&             SF,
+                                               cv::Mat&           F21)
 {
     // Number of putative matches
-    const int N = (int)vbMatchesInliers.size();
+    const int N = (int)mvMatches12.size();
 
     // Normalize coordinates
     std::vector<cv::Point2f> vPn1, vPn2;
     cv::Mat                  T1, T2;
     Normalize(mvKeys1, vPn1, T1);
     Normalize(mvKeys2, vPn2, T2);
-    cv::Mat T2t = T2.t();
+    const cv::Mat T2inv = T2.inv();
+    const cv::Mat T2t   = T2.t();
 
-    // Best Results variables
-    score            = 0.0;
-    vbMatchesInliers = std::vector<bool>(N, false);
+    // Hypotheses, scores and NO. of inliers of every iteration
+    std::vector<cv::Mat> vH21(mMaxIterations), vF21(mMaxIterations);
+    std::vector<float>   vScoreH(mMaxIterations, 0.0f), vScoreF(mMaxIterations, 0.0f);
+    std::vector<int>     vInliersH(mMaxIterations, 0), vInliersF(mMaxIterations, 0);
 
-    // Iteration variables
-    std::vector<cv::Point2f> vPn1i(8);
-    std::vector<cv::Point2f> vPn2i(8);
-    cv::Mat                  F21i;
-    std::vector<bool>        vbCurrentInliers(N, false);
-    float                    currentScore;
+    WAIWorkerPool& pool      = WAIWorkerPool::shared();
+    const int      batchSize = std::max(16, 2 * pool.numThreads());
 
-    // Perform all RANSAC iterations and save the solution with highest score
-    for (int it = 0; it < mMaxIterations; it++)
+    // Best Results variables
+    SH        = 0.0;
+    SF        = 0.0;
+    int bestH = -1;
+    int bestF = -1;
+
+    // The iterations are evaluated in batches. After every batch the needed NO. of
+    // iterations is reduced according to the inlier ratio of the best hypotheses.
+    // Both models get the same NO. of iterations, so their scores stay comparable.
+    int nIterations = mMaxIterations;
+    int itBatch     = 0;
+    while (itBatch < nIterations)
     {
-        // Select a minimum set
-        for (int j = 0; j < 8; j++)
-        {
-            int idx = (int)mvSets[it][j];
+        const int nBatch = std::min(batchSize, nIterations - itBatch);
 
-            vPn1i[j] = vPn1[mvMatches12[idx].first];
-            vPn2i[j] = vPn2[mvMatches12[idx].second];
-        }
+        // Task 2*i evaluates the homography, task 2*i+1 the fundamental matrix of iteration itBatch+i
+        pool.parallelFor(2 * nBatch, [&](int task) {
+            const int it = itBatch + task / 2;
 
-        cv::Mat Fn = ComputeF21(vPn1i, vPn2i);
+            // Select a minimum set
+            std::vector<cv::Point2f> vPn1i(8);
+            std::vector<cv::Point2f> vPn2i(8);
+            for (size_t j = 0; j < 8; j++)
+            {
+                int idx = (int)mvSets[it][j];
 
-        F21i = T2t * Fn * T1;
+                vPn1i[j] = vPn1[mvMatches12[idx].first];
+                vPn2i[j] = vPn2[mvMatches12[idx].second];
+            }
 
-        currentScore = CheckFundamental(F21i, vbCurrentInliers, mSigma);
+            if (task % 2 == 0)
+            {
+                cv::Mat Hn   = ComputeH21(vPn1i, vPn2i);
+                cv::Mat H21i = T2inv * Hn * T1;
+                cv::Mat H12i = H21i.inv();
 
-        if (currentScore > score)
+                vScoreH[it] = CheckHomography(H21i, H12i, nullptr, vInliersH[it], mSigma);
+                vH21[it]    = H21i;
+            }
+            else
+            {
+                cv::Mat Fn   = ComputeF21(vPn1i, vPn2i);
+                cv::Mat F21i = T2t * Fn * T1;
+
+                vScoreF[it] = CheckFundamental(F21i, nullptr, vInliersF[it], mSigma);
+                vF21[it]    = F21i;
+            }
+        });
+
+        // Keep the solution with highest score. The first best iteration wins
+        // like in a sequential loop, so the result doesn't depend on the threads.
+        for (int it = itBatch; it < itBatch + nBatch; it++)
         {
-            F21              = F21i.clone();
-            vbMatchesInliers = vbCurrentInliers;
-            score            = currentScore;
+            if (vScoreH[it] > SH)
+            {
+                SH    = vScoreH[it];
+                bestH = it;
+            }
+            if (vScoreF[it] > SF)
+            {
+                SF    = vScoreF[it];
+                bestF = it;
+            }
         }
+
+        itBatch += nBatch;
+
+        if (bestH >= 0 && bestF >= 0)
+            nIterations = std::max(RansacIterations(vInliersH[bestH], N, 0.99, mMaxIterations),
+                                   RansacIterations(vInliersF[bestF], N, 0.99, mMaxIterations));
+    }
+
+    // Only the inliers of the best hypotheses are needed
+    int nInliers;
+    vbMatchesInliersH = std::vector<bool>(N, false);
+    if (bestH >= 0)
+    {
+        H21 = vH21[bestH];
+        CheckHomography(H21, H21.inv(), &vbMatchesInliersH, nInliers, mSigma);
+    }
+
+    vbMatchesInliersF = std::vector<bool>(N, false);
+    if (bestF >= 0)
+    {
+        F21 = vF21[bestF];
+        CheckFundamental(F21, &vbMatchesInliersF, nInliers, mSigma);
     }
 }
 
-cv::Mat Initializer::ComputeH21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2)
+cv::Mat Initializer::ComputeH21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2) const
 {
     const int N = (int)vP1.size();
 
@@ -422,7 +457,7 @@ cv::Mat Initializer::ComputeH21(const std::vector<cv::Point2f>& vP1, const std::
     return vt.row(8).reshape(0, 3);
 }
 
-cv::Mat Initializer::ComputeF21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2)
+cv::Mat Initializer::ComputeF21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2) const
 {
     const int N = (int)vP1.size();
 
@@ -459,7 +494,11 @@ cv::Mat Initializer::ComputeF21(const std::vector<cv::Point2f>& vP1, const std::
     return u * cv::Mat::diag(w) * vt;
 }
 
-float Initializer::CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::vector<bool>& vbMatchesInliers, float sigma)
+float Initializer::CheckHomography(const cv::Mat&     H21,
+                                   const cv::Mat&     H12,
+                                   std::vector<bool>* pvbMatchesInliers,
+                                   int&               nInliers,
+                                   float              sigma) const
 {
     const int N = (int)mvMatches12.size();
 
@@ -483,25 +522,28 @@ float Initializer::CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::
     const float h32inv = H12.at<float>(2, 1);
     const float h33inv = H12.at<float>(2, 2);
 
-    vbMatchesInliers.resize(N);
+    if (pvbMatchesInliers)
+        pvbMatchesInliers->resize(N);
 
     float score = 0;
+    nInliers    = 0;
 
     const float th = 5.991f;
 
     const float invSigmaSquare = 1.0f / (sigma * sigma);
 
+    const float* vU1 = mvU1.data();
+    const float* vV1 = mvV1.data();
+    const float* vU2 = mvU2.data();
+    const float* vV2 = mvV2.data();
+
+    // The scoring has no branches, so the loop can be vectorized while pvbMatchesInliers is null
     for (int i = 0; i < N; i++)
     {
-        bool bIn = true;
-
-        const cv::KeyPoint& kp1 = mvKeys1[mvMatches12[i].first];
-        const cv::KeyPoint& kp2 = mvKeys2[mvMatches12[i].second];
-
-        const float u1 = kp1.pt.x;
-        const float v1 = kp1.pt.y;
-        const float u2 = kp2.pt.x;
-        const float v2 = kp2.pt.y;
+        const float u1 = vU1[i];
+        const float v1 = vV1[i];
+        const float u2 = vU2[i];
+        const float v2 = vV2[i];
 
         // Reprojection error in first image
         // x2in1 = H12*x2
@@ -514,11 +556,6 @@ float Initializer::CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::
 
         const float chiSquare1 = squareDist1 * invSigmaSquare;
 
-        if (chiSquare1 > th)
-            bIn = false;
-        else
-            score += th - chiSquare1;
-
         // Reprojection error in second image
         // x1in2 = H21*x1
 
@@ -530,21 +567,24 @@ float Initializer::CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::
 
         const float chiSquare2 = squareDist2 * invSigmaSquare;
 
-        if (chiSquare2 > th)
-            bIn = false;
-        else
-            score += th - chiSquare2;
+        const bool bIn1 = chiSquare1 <= th;
+        const bool bIn2 = chiSquare2 <= th;
 
-        if (bIn)
-            vbMatchesInliers[i] = true;
-        else
-            vbMatchesInliers[i] = false;
+        score += bIn1 ? th - chiSquare1 : 0.0f;
+        score += bIn2 ? th - chiSquare2 : 0.0f;
+        nInliers += (int)(bIn1 && bIn2);
+
+        if (pvbMatchesInliers)
+            (*pvbMatchesInliers)[i] = bIn1 && bIn2;
     }
 
     return score;
 }
 
-float Initializer::CheckFundamental(const cv::Mat& F21, std::vector<bool>& vbMatchesInliers, float sigma)
+float Initializer::CheckFundamental(const cv::Mat&     F21,
+                                    std::vector<bool>* pvbMatchesInliers,
+                                    int&               nInliers,
+                                    float              sigma) const
 {
     const int N = (int)mvMatches12.size();
 
@@ -558,26 +598,29 @@ float Initializer::CheckFundamental(const cv::Mat& F21, std::vector<bool>& vbMat
     const float f32 = F21.at<float>(2, 1);
     const float f33 = F21.at<float>(2, 2);
 
-    vbMatchesInliers.resize(N);
+    if (pvbMatchesInliers)
+        pvbMatchesInliers->resize(N);
 
     float score = 0;
+    nInliers    = 0;
 
     const float th      = 3.841f;
     const float thScore = 5.991f;
 
     const float invSigmaSquare = 1.0f / (sigma * sigma);
 
+    const float* vU1 = mvU1.data();
+    const float* vV1 = mvV1.data();
+    const float* vU2 = mvU2.data();
+    const float* vV2 = mvV2.data();
+
+    // The scoring has no branches, so the loop can be vectorized while pvbMatchesInliers is null
     for (int i = 0; i < N; i++)
     {
-        bool bIn = true;
-
-        const cv::KeyPoint& kp1 = mvKeys1[mvMatches12[i].first];
-        const cv::KeyPoint& kp2 = mvKeys2[mvMatches12[i].second];
-
-        const float u1 = kp1.pt.x;
-        const float v1 = kp1.pt.y;
-        const float u2 = kp2.pt.x;
-        const float v2 = kp2.pt.y;
+        const float u1 = vU1[i];
+        const float v1 = vV1[i];
+        const float u2 = vU2[i];
+        const float v2 = vV2[i];
 
         // Reprojection error in second image
         // l2=F21x1=(a2,b2,c2)
@@ -592,11 +635,6 @@ float Initializer::CheckFundamental(const cv::Mat& F21, std::vector<bool>& vbMat
 
         const float chiSquare1 = squareDist1 * invSigmaSquare;
 
-        if (chiSquare1 > th)
-            bIn = false;
-        else
-            score += thScore - chiSquare1;
-
         // Reprojection error in second image
         // l1 =x2tF21=(a1,b1,c1)
 
@@ -610,15 +648,15 @@ float Initializer::CheckFundamental(const cv::Mat& F21, std::vector<bool>& vbMat
 
         const float chiSquare2 = squareDist2 * invSigmaSquare;
 
-        if (chiSquare2 > th)
-            bIn = false;
-        else
-            score += thScore - chiSquare2;
+        const bool bIn1 = chiSquare1 <= th;
+        const bool bIn2 = chiSquare2 <= th;
 
-        if (bIn)
-            vbMatchesInliers[i] = true;
-        else
-            vbMatchesInliers[i] = false;
+        score += bIn1 ? thScore - chiSquare1 : 0.0f;
+        score += bIn2 ? thScore - chiSquare2 : 0.0f;
+        nInliers += (int)(bIn1 && bIn2);
+
+        if (pvbMatchesInliers)
+            (*pvbMatchesInliers)[i] = bIn1 && bIn2;
     }
 
     return score;
@@ -46,15 +46,18 @@ class WAI_API Initializer
     static void Triangulate(const cv::Point& p1, const cv::Point& p2, const cv::Mat& P1, const cv::Mat& P2, cv::Mat& x3D);
 
     private:
-    void FindHomography(std::vector<bool>& vbMatchesInliers, float& score, cv::Mat& H21);
-    void FindFundamental(std::vector<bool>& vbInliers, float& score, cv::Mat& F21);
+    void SetMatches(const std::vector<int>& vMatches12);
 
-    cv::Mat ComputeH21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2);
-    cv::Mat ComputeF21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2);
+    // Evaluates the homography and the fundamental matrix hypotheses on the shared worker pool
+    void FindHomographyAndFundamental(std::vector<bool>& vbMatchesInliersH, float& SH, cv::Mat& H21, std::vector<bool>& vbMatchesInliersF, float& SF, cv::Mat& F21);
 
-    float CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::vector<bool>& vbMatchesInliers, float sigma);
+    cv::Mat ComputeH21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2) const;
+    cv::Mat ComputeF21(const std::vector<cv::Point2f>& vP1, const std::vector<cv::Point2f>& vP2) const;
 
-    float CheckFundamental(const cv::Mat& F21, std::vector<bool>& vbMatchesInliers, float sigma);
+    // The inliers are only written if pvbMatchesInliers is not null
+    float CheckHomography(const cv::Mat& H21, const cv::Mat& H12, std::vector<bool>* pvbMatchesInliers, int& nInliers, float sigma) const;
+
+    float CheckFundamental(const cv::Mat& F21, std::vector<bool>* pvbMatchesInliers, int& nInliers, float sigma) const;
 
     bool ReconstructF(std::vector<bool>& vbMatchesInliers, cv::Mat& F21, cv::Mat& K, cv::Mat& R21, cv::Mat& t21, std::vector<cv::Point3f>& vP3D, std::vector<bool>& vbTriangulated, float minParallax, int minTriangulated);
 
@@ -76,6 +79,9 @@ class WAI_API Initializer
     std::vector<Match> mvMatches12;
     std::vector<bool>  mvbMatched1;
 
+    // Keypoint coordinates of the matches in contiguous arrays for the scoring loops
+    std::vector<float> mvU1, mvV1, mvU2, mvV2;
+
     // Calibration
     cv::Mat mK;
 
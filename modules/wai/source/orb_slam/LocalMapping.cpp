@@ -51,6 +51,17 @@ LocalMapping::LocalMapping(WAIMap*           pMap,
     mbPaused(false),
     _cullRedundantPerc(cullRedundantPerc)
 {
+    // Leave half of the cores to the tracking that runs at the same time
+    numThreads(std::max((int)Utils::maxThreads() / 2, 1));
+
+    _keyFrameLatencyMS.init(60, 0.0f);
+}
+
+// Recreates the worker pool with the passed NO. of threads. With one thread
+// all jobs run on the mapping thread.
+void LocalMapping::numThreads(int numThreads)
+{
+    _workerPool = std::make_unique<WAIWorkerPool>(std::max(numThreads, 1));
 }
 
 void LocalMapping::SetLoopCloser(LoopClosing* pLoopCloser)
@@ -95,14 +106,14 @@ void LocalMapping::Run()
                 KeyFrameCulling(frame);
             }
 
+            KeyFrameProcessed(frame);
             mpLoopCloser->InsertKeyFrame(frame);
         }
 
         if (CheckPause())
         {
             Pause();
-            while (isPaused() && !CheckFinish())
-                std::this_thread::sleep_for(3ms);
+            WaitWhilePaused();
         }
 
         if (CheckReset())
@@ -113,7 +124,8 @@ void LocalMapping::Run()
         if (CheckFinish())
             break;
 
-        std::this_thread::sleep_for(10ms);
+        // Sleep until a new keyframe or a request arrives
+        WaitForWork();
     }
     Finish();
 }
@@ -172,21 +184,20 @@ void LocalMapping::Run2()
                 }
             }
 
+            KeyFrameProcessed(frame);
             mpLoopCloser->InsertKeyFrame(frame);
 
             if (CheckPause())
             {
                 Pause();
-                while (isPaused() && !CheckFinish())
-                    std::this_thread::sleep_for(3ms);
+                WaitWhilePaused();
             }
         }
 
         if (CheckPause())
         {
             Pause();
-            while (isPaused() && !CheckFinish())
-                std::this_thread::sleep_for(3ms);
+            WaitWhilePaused();
         }
 
         if (CheckReset())
@@ -195,17 +206,19 @@ void LocalMapping::Run2()
         if (CheckFinish())
             break;
 
-        //SetAcceptKeyFrames(true);
-        //std::this_thread::sleep_for(1ms);
+        WaitForWork();
     }
     Finish();
 }
 
+// Processes one keyframe on the calling thread. Used in the serial mode, so
+// the timing blocks are only measured here and not in the mapping thread.
 void LocalMapping::RunOnce()
 {
     // Check if there are keyframes in the queue
     if (CheckNewKeyFrames())
     {
+        AVERAGE_TIMING_START("LocalMapping");
         WAIKeyFrame* frame = GetNewKeyFrame();
 
         // BoW conversion and insertion in Map
@@ -221,20 +234,28 @@ void LocalMapping::RunOnce()
         // Local BA
         if (mpMap->KeyFramesInMap() > 2)
         {
+            AVERAGE_TIMING_START("LocalBA");
             Optimizer::LocalBundleAdjustment(frame, &mbAbortBA, mpMap);
+            AVERAGE_TIMING_STOP("LocalBA");
         }
 
         // Check redundant local Keyframes
         KeyFrameCulling(frame);
 
+        KeyFrameProcessed(frame);
         mpLoopCloser->InsertKeyFrame(frame);
+        AVERAGE_TIMING_STOP("LocalMapping");
     }
 }
 
 void LocalMapping::InsertKeyFrame(WAIKeyFrame* pKF)
 {
-    unique_lock<mutex> lock(mMutexNewKFs);
-    mlNewKeyFrames.push_back(pKF);
+    {
+        unique_lock<mutex> lock(mMutexNewKFs);
+        mlNewKeyFrames.push_back(pKF);
+        _keyFrameInsertTimes[pKF] = std::chrono::steady_clock::now();
+    }
+    WakeUp();
 }
 
 bool LocalMapping::CheckNewKeyFrames()
@@ -257,6 +278,68 @@ WAIKeyFrame* LocalMapping::GetNewKeyFrame()
     return kf;
 }
 
+// Measures the time from the insertion of the keyframe until the end of its
+// local BA, i.e. until it is handed over to the loop closing.
+void LocalMapping::KeyFrameProcessed(WAIKeyFrame* kf)
+{
+    std::chrono::steady_clock::time_point insertTime;
+    {
+        unique_lock<mutex> lock(mMutexNewKFs);
+        auto               it = _keyFrameInsertTimes.find(kf);
+        if (it == _keyFrameInsertTimes.end())
+            return;
+        insertTime = it->second;
+        _keyFrameInsertTimes.erase(it);
+    }
+
+    float latencyMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - insertTime).count();
+
+    unique_lock<mutex> lock(_latencyMutex);
+    _keyFrameLatencyMS.set(latencyMS);
+    _maxKeyFrameLatencyMS = std::max(_maxKeyFrameLatencyMS, latencyMS);
+}
+
+float LocalMapping::keyFrameLatencyMS()
+{
+    unique_lock<mutex> lock(_latencyMutex);
+    return _keyFrameLatencyMS.average();
+}
+
+float LocalMapping::maxKeyFrameLatencyMS()
+{
+    unique_lock<mutex> lock(_latencyMutex);
+    return _maxKeyFrameLatencyMS;
+}
+
+// The state is changed under its own mutex before WakeUp is called. Locking
+// mMutexWakeUp here guarantees that a waiting thread either has not yet
+// checked its predicate or is already waiting, so no notification is lost.
+void LocalMapping::WakeUp()
+{
+    {
+        unique_lock<mutex> lock(mMutexWakeUp);
+    }
+    mCondWakeUp.notify_all();
+}
+
+void LocalMapping::WaitForWork()
+{
+    unique_lock<mutex> lock(mMutexWakeUp);
+    mCondWakeUp.wait(lock, [this] { return CheckNewKeyFrames() || CheckPause() || CheckReset() || CheckFinish(); });
+}
+
+void LocalMapping::WaitWhilePaused()
+{
+    unique_lock<mutex> lock(mMutexWakeUp);
+    mCondWakeUp.wait(lock, [this] { return !isPaused() || CheckFinish(); });
+}
+
+void LocalMapping::WaitUntilPaused()
+{
+    unique_lock<mutex> lock(mMutexWakeUp);
+    mCondWakeUp.wait(lock, [this] { return isPaused() || isFinished(); });
+}
+
 void LocalMapping::ProcessNewKeyFrame(WAIKeyFrame* kf)
 {
     // Compute Bags of Words structures
@@ -336,6 +419,15 @@ void LocalMapping::MapPointCulling(WAIKeyFrame* kf)
     }
 }
 
+// New MapPoint triangulated from the keypoints idx1 and idx2 of two keyframes
+struct TriangulatedPoint
+{
+    cv::Mat      x3D;
+    int          idx1;
+    int          idx2;
+    WAIMapPoint* pMP = nullptr;
+};
+
 void LocalMapping::CreateNewMapPoints(WAIKeyFrame* kf)
 {
     // Retrieve neighbor keyframes in covisibility graph
@@ -364,15 +456,23 @@ void LocalMapping::CreateNewMapPoints(WAIKeyFrame* kf)
 
     const float ratioFactor = 1.5f * kf->mfScaleFactor;
 
-    int nnew = 0;
+    // The neighbor keyframes are matched and triangulated in parallel. The new
+    // MapPoints are only collected per neighbor and added to the map afterwards
+    // in the order of the neighbors.
+    const int                         nNeighKFs = (int)vpNeighKFs.size();
+    vector<vector<TriangulatedPoint>> vvNewPoints(nNeighKFs);
+    vector<char>                      vbAborted(nNeighKFs, false);
 
     // Search matches with epipolar restriction and triangulate
-    for (size_t i = 0; i < vpNeighKFs.size(); i++)
-    {
+    _workerPool->parallelFor(nNeighKFs, [&](int i) {
         if (i > 0 && CheckNewKeyFrames())
+        {
+            vbAborted[i] = true;
             return;
+        }
 
-        WAIKeyFrame* pKF2 = vpNeighKFs[i];
+        WAIKeyFrame*               pKF2       = vpNeighKFs[i];
+        vector<TriangulatedPoint>& vNewPoints = vvNewPoints[i];
 
         // Check first that baseline is not too short
         cv::Mat Ow2       = pKF2->GetCameraCenter();
@@ -391,7 +491,7 @@ void LocalMapping::CreateNewMapPoints(WAIKeyFrame* kf)
         const float ratioBaselineDepth = baseline / medianDepthKF2;
 
         if (ratioBaselineDepth < 0.01)
-            continue;
+            return;
         //}
 
         // Compute Fundamental Matrix
@@ -566,22 +666,49 @@ void LocalMapping::CreateNewMapPoints(WAIKeyFrame* kf)
                 continue;
 
             // Triangulation is succesfull
-            WAIMapPoint* pMP = new WAIMapPoint(x3D, kf);
+            vNewPoints.push_back({x3D, idx1, idx2});
+        }
+    });
 
-            kf->AddMapPoint(pMP, idx1);
-            pKF2->AddMapPoint(pMP, idx2);
+    // Create the MapPoints of the neighbors up to the first aborted one. A keypoint
+    // of kf that was triangulated with an earlier neighbor is not used again.
+    int                  nNeighKFsDone = 0;
+    vector<WAIMapPoint*> vpNewMPs;
+    vector<bool>         vbUsed1(kf->N, false);
 
-            pMP->AddObservation(kf, idx1);
-            pMP->AddObservation(pKF2, idx2);
+    for (; nNeighKFsDone < nNeighKFs && !vbAborted[nNeighKFsDone]; nNeighKFsDone++)
+    {
+        WAIKeyFrame* pKF2 = vpNeighKFs[nNeighKFsDone];
 
-            pMP->ComputeDistinctiveDescriptors();
+        for (TriangulatedPoint& tp : vvNewPoints[nNeighKFsDone])
+        {
+            if (vbUsed1[tp.idx1] || kf->GetMapPoint(tp.idx1) || pKF2->GetMapPoint(tp.idx2))
+                continue;
+            vbUsed1[tp.idx1] = true;
 
-            pMP->UpdateNormalAndDepth();
+            tp.pMP = new WAIMapPoint(tp.x3D, kf);
+            tp.pMP->AddObservation(kf, tp.idx1);
+            tp.pMP->AddObservation(pKF2, tp.idx2);
+            vpNewMPs.push_back(tp.pMP);
+        }
+    }
 
-            mpMap->AddMapPoint(pMP);
-            mlpRecentAddedMapPoints.push_back(pMP);
+    // The new MapPoints are not yet visible to other threads
+    UpdateMapPoints(vpNewMPs);
+
+    unique_lock<mutex> lock(mpMap->mMutexMapUpdate);
+    for (int i = 0; i < nNeighKFsDone; i++)
+    {
+        for (const TriangulatedPoint& tp : vvNewPoints[i])
+        {
+            if (!tp.pMP)
+                continue;
 
-            nnew++;
+            kf->AddMapPoint(tp.pMP, tp.idx1);
+            vpNeighKFs[i]->AddMapPoint(tp.pMP, tp.idx2);
+
+            mpMap->AddMapPoint(tp.pMP);
+            mlpRecentAddedMapPoints.push_back(tp.pMP);
         }
     }
 }
@@ -600,10 +727,11 @@ void LocalMapping::searchNeihborsLocalMap(LocalMap& lmap, WorkingSet& ws, WAIKey
         pKFi->mnMarker[FUSE_TARGET_KF] = frame->mnId;
 
         // Extend to some second neighbors
-        const vector<WAIKeyFrame*> vpSecondNeighKFs = pKFi->GetBestCovisibilityKeyFrames(5);
-        for (vector<WAIKeyFrame*>::const_iterator vit2 = vpSecondNeighKFs.begin(), vend2 = vpSecondNeighKFs.end(); vit2 != vend2; vit2++)
+        shared_ptr<const WAICovisibility> cov       = pKFi->GetCovisibility();
+        const size_t                      nSecNeigh = min(cov->orderedKFs.size(), (size_t)5);
+        for (size_t i2 = 0; i2 < nSecNeigh; i2++)
         {
-            WAIKeyFrame* pKFi2 = *vit2;
+            WAIKeyFrame* pKFi2 = cov->orderedKFs[i2];
             if (ws.isInUseSet(pKFi2) || pKFi2->isBad() || pKFi2->mnMarker[FUSE_TARGET_KF] == frame->mnId || pKFi2->mnId == frame->mnId)
                 continue;
             lmap.keyFrames.push_back(pKFi2);
@@ -614,55 +742,7 @@ void LocalMapping::searchNeihborsLocalMap(LocalMap& lmap, WorkingSet& ws, WAIKey
 
 void LocalMapping::SearchInNeighbors(LocalMap& lmap)
 {
-    // Search matches by projection from current KF in target KFs
-    ORBmatcher           matcher;
-    vector<WAIMapPoint*> vpMapPointMatches = lmap.refKF->GetMapPointMatches();
-    for (vector<WAIKeyFrame*>::iterator vit = lmap.keyFrames.begin(), vend = lmap.keyFrames.end(); vit != vend; vit++)
-    {
-        WAIKeyFrame* pKFi = *vit;
-        matcher.Fuse(mpMap, pKFi, vpMapPointMatches);
-    }
-
-    // Search matches by projection from target KFs in current KF
-    vector<WAIMapPoint*> vpFuseCandidates;
-    vpFuseCandidates.reserve(lmap.keyFrames.size() * vpMapPointMatches.size());
-
-    for (vector<WAIKeyFrame*>::iterator vitKF = lmap.keyFrames.begin(), vendKF = lmap.keyFrames.end(); vitKF != vendKF; vitKF++)
-    {
-        WAIKeyFrame*         pKFi           = *vitKF;
-        vector<WAIMapPoint*> vpMapPointsKFi = pKFi->GetMapPointMatches();
-
-        for (vector<WAIMapPoint*>::iterator vitMP = vpMapPointsKFi.begin(), vendMP = vpMapPointsKFi.end(); vitMP != vendMP; vitMP++)
-        {
-            WAIMapPoint* pMP = *vitMP;
-            if (!pMP)
-                continue;
-            if (pMP->isBad() || pMP->mnMarker[FUSE_CANDIDATE_KF] == lmap.refKF->mnId)
-                continue;
-            pMP->mnMarker[FUSE_CANDIDATE_KF] = (int)lmap.refKF->mnId;
-            vpFuseCandidates.push_back(pMP);
-        }
-    }
-
-    matcher.Fuse(mpMap, lmap.refKF, vpFuseCandidates);
-
-    // Update points
-    vpMapPointMatches = lmap.refKF->GetMapPointMatches();
-    for (size_t i = 0, iend = vpMapPointMatches.size(); i < iend; i++)
-    {
-        WAIMapPoint* pMP = vpMapPointMatches[i];
-        if (pMP)
-        {
-            if (!pMP->isBad())
-            {
-                pMP->ComputeDistinctiveDescriptors();
-                pMP->UpdateNormalAndDepth();
-            }
-        }
-    }
-
-    // Update connections in covisibility graph
-    lmap.refKF->FindAndUpdateConnections();
+    FuseWithNeighbors(lmap.refKF, lmap.keyFrames);
 }
 
 void LocalMapping::SearchInNeighbors(WAIKeyFrame* frame)
@@ -684,31 +764,47 @@ void LocalMapping::SearchInNeighbors(WAIKeyFrame* frame)
         pKFi->mnMarker[FUSE_TARGET_KF] = frame->mnId;
 
         // Extend to some second neighbors
-        const vector<WAIKeyFrame*> vpSecondNeighKFs = pKFi->GetBestCovisibilityKeyFrames(5);
-        for (vector<WAIKeyFrame*>::const_iterator vit2 = vpSecondNeighKFs.begin(), vend2 = vpSecondNeighKFs.end(); vit2 != vend2; vit2++)
+        shared_ptr<const WAICovisibility> cov       = pKFi->GetCovisibility();
+        const size_t                      nSecNeigh = min(cov->orderedKFs.size(), (size_t)5);
+        for (size_t i2 = 0; i2 < nSecNeigh; i2++)
         {
-            WAIKeyFrame* pKFi2 = *vit2;
+            WAIKeyFrame* pKFi2 = cov->orderedKFs[i2];
             if (pKFi2->isBad() || pKFi2->mnMarker[FUSE_TARGET_KF] == frame->mnId || pKFi2->mnId == frame->mnId)
                 continue;
             vpTargetKFs.push_back(pKFi2);
         }
     }
 
+    FuseWithNeighbors(frame, vpTargetKFs);
+}
+
+// Fuses the MapPoints of frame with the target keyframes and the other way round.
+// The projection and descriptor matching run in parallel per target keyframe or per
+// chunk of candidates. The MapPoints are then fused in the same order as before.
+void LocalMapping::FuseWithNeighbors(WAIKeyFrame* frame, const vector<WAIKeyFrame*>& vpTargetKFs)
+{
     // Search matches by projection from current KF in target KFs
     ORBmatcher           matcher;
     vector<WAIMapPoint*> vpMapPointMatches = frame->GetMapPointMatches();
-    for (vector<WAIKeyFrame*>::iterator vit = vpTargetKFs.begin(), vend = vpTargetKFs.end(); vit != vend; vit++)
-    {
-        WAIKeyFrame* pKFi = *vit;
+    const int            nTargetKFs        = (int)vpTargetKFs.size();
+    const int            nMPs              = (int)vpMapPointMatches.size();
+    vector<vector<int>>  vvMatchedIdx(nTargetKFs, vector<int>(nMPs, -1));
+
+    _workerPool->parallelFor(nTargetKFs, [&](int i) {
+        matcher.FuseSearch(vpTargetKFs[i], vpMapPointMatches, 0, nMPs, vvMatchedIdx[i]);
+    });
 
-        matcher.Fuse(mpMap, pKFi, vpMapPointMatches);
+    {
+        unique_lock<mutex> lock(mpMap->mMutexMapUpdate);
+        for (int i = 0; i < nTargetKFs; i++)
+            matcher.FuseApply(mpMap, vpTargetKFs[i], vpMapPointMatches, vvMatchedIdx[i]);
     }
 
     // Search matches by projection from target KFs in current KF
     vector<WAIMapPoint*> vpFuseCandidates;
     vpFuseCandidates.reserve(vpTargetKFs.size() * vpMapPointMatches.size());
 
-    for (vector<WAIKeyFrame*>::iterator vitKF = vpTargetKFs.begin(), vendKF = vpTargetKFs.end(); vitKF != vendKF; vitKF++)
+    for (vector<WAIKeyFrame*>::const_iterator vitKF = vpTargetKFs.begin(), vendKF = vpTargetKFs.end(); vitKF != vendKF; vitKF++)
     {
         WAIKeyFrame* pKFi = *vitKF;
 
@@ -726,27 +822,40 @@ void LocalMapping::SearchInNeighbors(WAIKeyFrame* frame)
         }
     }
 
-    matcher.Fuse(mpMap, frame, vpFuseCandidates);
+    const int   chunkSize   = 128;
+    const int   nCandidates = (int)vpFuseCandidates.size();
+    const int   nChunks     = (nCandidates + chunkSize - 1) / chunkSize;
+    vector<int> vMatchedIdx(nCandidates, -1);
+
+    _workerPool->parallelFor(nChunks, [&](int c) {
+        matcher.FuseSearch(frame, vpFuseCandidates, c * chunkSize, std::min((c + 1) * chunkSize, nCandidates), vMatchedIdx);
+    });
 
-    // Update points
-    vpMapPointMatches = frame->GetMapPointMatches();
-    for (size_t i = 0, iend = vpMapPointMatches.size(); i < iend; i++)
     {
-        WAIMapPoint* pMP = vpMapPointMatches[i];
-        if (pMP)
-        {
-            if (!pMP->isBad())
-            {
-                pMP->ComputeDistinctiveDescriptors();
-                pMP->UpdateNormalAndDepth();
-            }
-        }
+        unique_lock<mutex> lock(mpMap->mMutexMapUpdate);
+        matcher.FuseApply(mpMap, frame, vpFuseCandidates, vMatchedIdx);
     }
 
+    // Update points
+    UpdateMapPoints(frame->GetMapPointMatches());
+
     // Update connections in covisibility graph
     frame->FindAndUpdateConnections();
 }
 
+// Recomputes the descriptor, normal and depth of the MapPoints in parallel
+void LocalMapping::UpdateMapPoints(const vector<WAIMapPoint*>& vpMapPoints)
+{
+    _workerPool->parallelFor((int)vpMapPoints.size(), [&](int i) {
+        WAIMapPoint* pMP = vpMapPoints[i];
+        if (pMP && !pMP->isBad())
+        {
+            pMP->ComputeDistinctiveDescriptors();
+            pMP->UpdateNormalAndDepth();
+        }
+    });
+}
+
 cv::Mat LocalMapping::ComputeF12(WAIKeyFrame*& pKF1, WAIKeyFrame*& pKF2)
 {
     cv::Mat R1w = pKF1->GetRotation();
@@ -774,6 +883,7 @@ void LocalMapping::Release()
     for (list<WAIKeyFrame*>::iterator lit = mlNewKeyFrames.begin(), lend = mlNewKeyFrames.end(); lit != lend; lit++)
         delete *lit;
     mlNewKeyFrames.clear();
+    _keyFrameInsertTimes.clear();
 }
 
 bool LocalMapping::AcceptKeyFrames()
@@ -953,9 +1063,12 @@ cv::Mat LocalMapping::SkewSymmetricMatrix(const cv::Mat& v)
 //Reset
 void LocalMapping::RequestReset()
 {
-    unique_lock<mutex> lock(mMutexReset);
-    mbResetRequested = true;
-    mbAbortBA        = true;
+    {
+        unique_lock<mutex> lock(mMutexReset);
+        mbResetRequested = true;
+        mbAbortBA        = true;
+    }
+    WakeUp();
 }
 
 bool LocalMapping::CheckReset()
@@ -966,22 +1079,29 @@ bool LocalMapping::CheckReset()
 
 void LocalMapping::Reset()
 {
-    unique_lock<mutex> lock(mMutexReset);
-    unique_lock<mutex> lock2(mMutexNewKFs);
-    mlNewKeyFrames.clear();
-    mlpRecentAddedMapPoints.clear();
-    mbResetRequested  = false;
-    mbFinishRequested = false;
-    mbPauseRequested  = false;
-    mbPaused          = false;
+    {
+        unique_lock<mutex> lock(mMutexReset);
+        unique_lock<mutex> lock2(mMutexNewKFs);
+        mlNewKeyFrames.clear();
+        _keyFrameInsertTimes.clear();
+        mlpRecentAddedMapPoints.clear();
+        mbResetRequested  = false;
+        mbFinishRequested = false;
+        mbPauseRequested  = false;
+        mbPaused          = false;
+    }
+    WakeUp();
 }
 
 //Finish
 void LocalMapping::RequestFinish()
 {
-    unique_lock<mutex> lock(mMutexFinish);
-    mbFinishRequested = true;
-    mbAbortBA         = true;
+    {
+        unique_lock<mutex> lock(mMutexFinish);
+        mbFinishRequested = true;
+        mbAbortBA         = true;
+    }
+    WakeUp();
 }
 
 bool LocalMapping::isFinished()
@@ -998,21 +1118,27 @@ bool LocalMapping::CheckFinish()
 
 void LocalMapping::Finish()
 {
-    unique_lock<mutex> lock(mMutexFinish);
-    SetAcceptKeyFrames(false);
-    mlNewKeyFrames.clear();
-    mlpRecentAddedMapPoints.clear();
-    mbFinishRequested = false;
-    mbFinished        = true;
+    {
+        unique_lock<mutex> lock(mMutexFinish);
+        SetAcceptKeyFrames(false);
+        mlNewKeyFrames.clear();
+        mlpRecentAddedMapPoints.clear();
+        mbFinishRequested = false;
+        mbFinished        = true;
+    }
+    WakeUp();
 }
 
 //Pause
 void LocalMapping::RequestPause()
 {
-    unique_lock<mutex> lock(mMutexPause);
-    mbPauseRequested = true;
-    unique_lock<mutex> lock2(mMutexNewKFs);
-    mbAbortBA = true;
+    {
+        unique_lock<mutex> lock(mMutexPause);
+        mbPauseRequested = true;
+        unique_lock<mutex> lock2(mMutexNewKFs);
+        mbAbortBA = true;
+    }
+    WakeUp();
 }
 
 bool LocalMapping::isPaused()
@@ -1029,16 +1155,22 @@ bool LocalMapping::CheckPause()
 
 void LocalMapping::Pause()
 {
-    unique_lock<mutex> lock(mMutexPause);
-    mbPauseRequested = false;
-    mbPaused         = true;
+    {
+        unique_lock<mutex> lock(mMutexPause);
+        mbPauseRequested = false;
+        mbPaused         = true;
+    }
+    WakeUp();
 }
 
 void LocalMapping::RequestContinue()
 {
-    unique_lock<mutex> lock(mMutexPause);
-    mbPaused         = false;
-    mbPauseRequested = false;
+    {
+        unique_lock<mutex> lock(mMutexPause);
+        mbPaused         = false;
+        mbPauseRequested = false;
+    }
+    WakeUp();
 }
 
 } //namespace ORB_SLAM
@@ -22,13 +22,18 @@
 #define LOCALMAPPING_H
 
 #include <list>
+#include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 #include <opencv2/core.hpp>
+#include <Averaged.h>
 #include <WorkingSet.h>
 #include <LocalMap.h>
+#include <WAIWorkerPool.h>
 
 class WAIKeyFrame;
 class WAIMap;
@@ -74,6 +79,8 @@ public:
     void Pause();
     void RequestContinue();
 
+    // Blocks until the mapping thread is paused or finished
+    void WaitUntilPaused();
 
     int KeyframesInQueue()
     {
@@ -83,6 +90,14 @@ public:
 
     std::thread* AddLocalBAThread();
 
+    // NO. of threads for the triangulation and fusion with the neighbor keyframes
+    void numThreads(int numThreads);
+    int  numThreads() const { return _workerPool->numThreads(); }
+
+    // Latency from the insertion of a keyframe to the end of its local BA
+    float keyFrameLatencyMS();
+    float maxKeyFrameLatencyMS();
+
 protected:
 
     WAIKeyFrame* GetNewKeyFrame();
@@ -97,6 +112,8 @@ protected:
     void searchNeihborsLocalMap(LocalMap &lmap, WorkingSet &ws, WAIKeyFrame* frame);
     void SearchInNeighbors(LocalMap &lmap);
     void SearchInNeighbors(WAIKeyFrame * kf);
+    void FuseWithNeighbors(WAIKeyFrame* frame, const std::vector<WAIKeyFrame*>& vpTargetKFs);
+    void UpdateMapPoints(const std::vector<WAIMapPoint*>& vpMapPoints);
 
     void KeyFrameCulling(WAIKeyFrame* frame, WorkingSet &ws);
     void KeyFrameCulling(WAIKeyFrame* frame);
@@ -125,6 +142,14 @@ protected:
     bool       CheckFinish();
     bool       CheckPause();
 
+    // Wakes up the mapping thread and the threads waiting in WaitUntilPaused.
+    // Must be called without holding any of the other mutexes.
+    void       WakeUp();
+    void       WaitForWork();
+    void       WaitWhilePaused();
+
+    std::mutex              mMutexWakeUp;
+    std::condition_variable mCondWakeUp;
 
     LoopClosing* mpLoopCloser;
 
@@ -133,6 +158,15 @@ protected:
     std::list<WAIKeyFrame*> mlNewKeyFrames;
     std::list<WAIMapPoint*> mlpRecentAddedMapPoints;
 
+    void KeyFrameProcessed(WAIKeyFrame* kf);
+
+    // Insertion time of the queued keyframes (protected by mMutexNewKFs)
+    std::unordered_map<WAIKeyFrame*, std::chrono::steady_clock::time_point> _keyFrameInsertTimes;
+
+    std::mutex      _latencyMutex;
+    Utils::AvgFloat _keyFrameLatencyMS;
+    float           _maxKeyFrameLatencyMS = 0.0f;
+
 
     bool       mbAbortBA;
     std::mutex mMutexAccept;
@@ -142,6 +176,9 @@ protected:
     // A keyframe is considered redundant if the _cullRedundantPerc of the MapPoints it sees, are seen
     // in at least other 3 keyframes (in the same or finer scale)
     const float _cullRedundantPerc;
+
+    // Worker threads for the independent jobs per neighbor keyframe
+    std::unique_ptr<WAIWorkerPool> _workerPool;
 };
 
 } //namespace ORB_SLAM
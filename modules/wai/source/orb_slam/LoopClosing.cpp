@@ -26,6 +26,7 @@
 
 #include <WAIKeyFrameDB.h>
 #include <mutex>
+#include <AverageTiming.h>
 #include <thread>
 
 namespace ORB_SLAM2
@@ -123,6 +124,7 @@ bool LoopClosing::RunOnce()
     // Check if there are keyframes in the queue
     if (CheckNewKeyFrames())
     {
+        AVERAGE_TIMING_START("LoopClosing");
         // Detect loop candidates and check covisibility consistency
         if (DetectLoop())
         {
@@ -136,9 +138,11 @@ bool LoopClosing::RunOnce()
 
                 mpMap->incNumLoopClosings();
 
+                AVERAGE_TIMING_STOP("LoopClosing");
                 return true;
             }
         }
+        AVERAGE_TIMING_STOP("LoopClosing");
     }
     else
     {
@@ -647,11 +651,11 @@ void LoopClosing::doCorrectLoop()
     mpMatchedKF->AddLoopEdge(mpCurrentKF);
     mpCurrentKF->AddLoopEdge(mpMatchedKF);
 
-    // Launch a new thread to perform Global Bundle Adjustment
+    // Launch a new thread to perform the Bundle Adjustment of the loop region
     mbRunningGBA  = true;
     mbFinishedGBA = false;
     mbStopGBA     = false;
-    mpThreadGBA   = new thread(&LoopClosing::RunGlobalBundleAdjustment, this, mpCurrentKF->mnId);
+    mpThreadGBA   = new thread(&LoopClosing::RunGlobalBundleAdjustment, this, mpMatchedKF, mpCurrentKF);
 
     // Loop closed. Release Local Mapping.
     mpLocalMapper->Release();
@@ -681,10 +685,7 @@ void LoopClosing::CorrectLoop()
     }
 
     // Wait until Local Mapping has effectively stopped
-    while (!mpLocalMapper->isPaused() && !mpLocalMapper->isFinished())
-    {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
+    mpLocalMapper->WaitUntilPaused();
 
     doCorrectLoop();
 
@@ -735,31 +736,32 @@ void LoopClosing::RequestReset()
     }
     loopContinue();
 
-    while (1)
-    {
-        {
-            unique_lock<mutex> lock2(mMutexReset);
-            if (!mbResetRequested)
-                break;
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
+    // Wait until the loop closing thread has done the reset
+    unique_lock<mutex> lock(mMutexReset);
+    _condVarReset.wait(lock, [&] { return !mbResetRequested; });
 }
 
 void LoopClosing::ResetIfRequested()
 {
-    unique_lock<mutex> lock(mMutexReset);
-    if (mbResetRequested)
     {
+        unique_lock<mutex> lock(mMutexReset);
+        if (!mbResetRequested)
+            return;
         reset();
     }
+    _condVarReset.notify_all();
 }
 
-void LoopClosing::RunGlobalBundleAdjustment(unsigned long nLoopKF)
+void LoopClosing::RunGlobalBundleAdjustment(WAIKeyFrame* pLoopKF, WAIKeyFrame* pCurKF)
 {
     cout << "Starting Global Bundle Adjustment" << endl;
-    int idx = mnFullBAIdx;
-    Optimizer::GlobalBundleAdjustemnt(mpMap, 10, &mbStopGBA, nLoopKF, false);
+    const unsigned long nLoopKF = pCurKF->mnId;
+    int                 idx     = mnFullBAIdx;
+
+    // Only the region of the loop is optimized. The keyframes around it are fixed and the
+    // rest of the map is corrected through the spanning tree below. The essential graph
+    // optimization has already distributed the loop error over the whole map.
+    Optimizer::LoopBundleAdjustment(mpMap, pLoopKF, pCurKF, 10, &mbStopGBA, nLoopKF, false);
 
     // Update all MapPoints and KeyFrames
     // Local Mapping was active during BA, that means that there might be new keyframes
@@ -774,18 +776,28 @@ void LoopClosing::RunGlobalBundleAdjustment(unsigned long nLoopKF)
         {
             mpLocalMapper->RequestPause();
             // Wait until Local Mapping has effectively stopped
+            mpLocalMapper->WaitUntilPaused();
 
-            while (!mpLocalMapper->isPaused() && !mpLocalMapper->isFinished())
-            {
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-            }
-
-            // Get Map Mutex
-            unique_lock<mutex> lock(mpMap->mMutexMapUpdate);
+            // The corrections are computed without the map mutex. While Local Mapping is
+            // paused and mMutexGBA is locked no other thread changes the poses. The map
+            // mutex is only locked to set the results, so tracking is blocked only shortly.
+            vector<WAIKeyFrame*> vpKFs;
+            vector<cv::Mat>      vTcwOld;
 
             // Correct keyframes starting at map first keyframe
             list<WAIKeyFrame*> lpKFtoCheck(mpMap->mvpKeyFrameOrigins.begin(), mpMap->mvpKeyFrameOrigins.end());
 
+            // Origins that are neither in the loop region nor fixed have no mTcwGBA of this BA.
+            // They keep their pose, so their children are not moved by a stale mTcwGBA.
+            for (WAIKeyFrame* pKF : lpKFtoCheck)
+            {
+                if (pKF->mnMarker[BA_GLOBAL_KF] != nLoopKF)
+                {
+                    pKF->mTcwGBA                = pKF->GetPose();
+                    pKF->mnMarker[BA_GLOBAL_KF] = nLoopKF;
+                }
+            }
+
             while (!lpKFtoCheck.empty())
             {
                 WAIKeyFrame*            pKF     = lpKFtoCheck.front();
@@ -804,13 +816,19 @@ void LoopClosing::RunGlobalBundleAdjustment(unsigned long nLoopKF)
                     lpKFtoCheck.push_back(pChild);
                 }
 
-                pKF->mTcwRefGBA = pKF->GetPose();
-                pKF->SetPose(pKF->mTcwGBA);
+                vpKFs.push_back(pKF);
+                vTcwOld.push_back(pKF->GetPose());
                 lpKFtoCheck.pop_front();
             }
 
+            const set<WAIKeyFrame*> sCorrectedKFs(vpKFs.begin(), vpKFs.end());
+
             // Correct MapPoints
             const vector<WAIMapPoint*> vpMPs = mpMap->GetAllMapPoints();
+            vector<WAIMapPoint*>       vpMPsToCorrect;
+            vector<cv::Mat>            vPosCorrected;
+            vpMPsToCorrect.reserve(vpMPs.size());
+            vPosCorrected.reserve(vpMPs.size());
 
             for (size_t i = 0; i < vpMPs.size(); i++)
             {
@@ -822,7 +840,8 @@ void LoopClosing::RunGlobalBundleAdjustment(unsigned long nLoopKF)
                 if (pMP->mnMarker[BA_GLOBAL_KF] == nLoopKF)
                 {
                     // If optimized by Global BA, just update
-                    pMP->SetWorldPos(pMP->mPosGBA);
+                    vpMPsToCorrect.push_back(pMP);
+                    vPosCorrected.push_back(pMP->mPosGBA);
                 }
                 else
                 {
@@ -832,29 +851,44 @@ void LoopClosing::RunGlobalBundleAdjustment(unsigned long nLoopKF)
                     if (pRefKF->mnMarker[BA_GLOBAL_KF] != nLoopKF)
                         continue;
 
-                    if (pRefKF->mTcwRefGBA.empty())
+                    if (!sCorrectedKFs.count(pRefKF))
                     {
-                        cout << "mTcwRefGBA is empty!!!\n It should not be the case" << endl;
+                        cout << "refKF is not corrected!!!\n It should not be the case" << endl;
                         cout << "this happend when refKF is no more in the map" << endl;
                         continue;
                     }
 
                     // Map to non-corrected camera
-                    std::flush(std::cout);
-                    cv::Mat Rcw = pRefKF->mTcwRefGBA.rowRange(0, 3).colRange(0, 3);
-                    cv::Mat tcw = pRefKF->mTcwRefGBA.rowRange(0, 3).col(3);
+                    cv::Mat Tcw = pRefKF->GetPose();
+                    cv::Mat Rcw = Tcw.rowRange(0, 3).colRange(0, 3);
+                    cv::Mat tcw = Tcw.rowRange(0, 3).col(3);
                     cv::Mat Xc  = Rcw * pMP->GetWorldPos() + tcw;
 
                     // Backproject using corrected camera
-                    cv::Mat Twc = pRefKF->GetPoseInverse();
-                    cv::Mat Rwc = Twc.rowRange(0, 3).colRange(0, 3);
-                    cv::Mat twc = Twc.rowRange(0, 3).col(3);
+                    cv::Mat Rcw2 = pRefKF->mTcwGBA.rowRange(0, 3).colRange(0, 3);
+                    cv::Mat tcw2 = pRefKF->mTcwGBA.rowRange(0, 3).col(3);
+                    cv::Mat Rwc2 = Rcw2.t();
 
-                    pMP->SetWorldPos(Rwc * Xc + twc);
+                    vpMPsToCorrect.push_back(pMP);
+                    vPosCorrected.push_back(Rwc2 * (Xc - tcw2));
                 }
             }
 
-            mpMap->InformNewBigChange();
+            {
+                // Get Map Mutex
+                unique_lock<mutex> lock(mpMap->mMutexMapUpdate);
+
+                for (size_t i = 0; i < vpKFs.size(); i++)
+                {
+                    vpKFs[i]->mTcwRefGBA = vTcwOld[i];
+                    vpKFs[i]->SetPose(vpKFs[i]->mTcwGBA);
+                }
+
+                for (size_t i = 0; i < vpMPsToCorrect.size(); i++)
+                    vpMPsToCorrect[i]->SetWorldPos(vPosCorrected[i]);
+
+                mpMap->InformNewBigChange();
+            }
 
             mpLocalMapper->Release();
         }
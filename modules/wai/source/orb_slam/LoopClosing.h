@@ -62,7 +62,8 @@ class LoopClosing
     void reset();
 
     // This function will run in a separate thread
-    void RunGlobalBundleAdjustment(unsigned long nLoopKF);
+    // It adjusts the region of the loop between pLoopKF and pCurKF, the rest of the map follows
+    void RunGlobalBundleAdjustment(WAIKeyFrame* pLoopKF, WAIKeyFrame* pCurKF);
 
     bool isRunningGBA()
     {
@@ -116,8 +117,9 @@ class LoopClosing
     void doCorrectLoop();
 
     void       ResetIfRequested();
-    bool       mbResetRequested;
-    std::mutex mMutexReset;
+    bool                    mbResetRequested;
+    std::mutex              mMutexReset;
+    std::condition_variable _condVarReset;
 
     bool       CheckFinish();
     void       SetFinish();
@@ -57,8 +57,10 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/features2d/features2d.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <cassert>
 #include <vector>
 #include <AverageTiming.h>
+#include <Utils.h>
 #include <ORBextractor.h>
 #include <BRIEFPattern.h>
 #include <ExtractorNode.h>
@@ -228,6 +230,43 @@ ORBextractor::ORBextractor(int   _nfeatures,
         umax[v] = v0;
         ++v0;
     }
+
+    _pyramidBuffers.resize(nlevels);
+    _blurBuffers.resize(nlevels);
+    _workerPool = &WAIWorkerPool::shared();
+}
+
+/**
+     * Sets the NO. of threads. All extractors share the threads of
+     * WAIWorkerPool::shared. Only a different NO. of threads (e.g. one thread
+     * in a benchmark) creates an own pool. With one thread all tasks run on
+     * the calling thread. The keypoints and descriptors are the same for
+     * every NO. of threads.
+     */
+void ORBextractor::numThreads(int numThreads)
+{
+    numThreads = std::max(numThreads, 1);
+    if (numThreads == WAIWorkerPool::shared().numThreads())
+    {
+        _ownWorkerPool.reset();
+        _workerPool = &WAIWorkerPool::shared();
+        return;
+    }
+
+    _ownWorkerPool = std::make_unique<WAIWorkerPool>(numThreads);
+    _workerPool    = _ownWorkerPool.get();
+}
+
+/**
+     * Sets the worker pool for the level and cell tasks, e.g. a pool that is
+     * shared by all extractors of a SLAM instance. The pool must outlive the
+     * extractor and must not be used by a task that calls the extractor.
+     */
+void ORBextractor::workerPool(WAIWorkerPool* pool)
+{
+    assert(pool);
+    _ownWorkerPool.reset();
+    _workerPool = pool;
 }
 
 static void computeOrientation(const Mat& image, vector<KeyPoint>& keypoints, const vector<int>& umax)
@@ -470,6 +509,10 @@ vector<cv::KeyPoint> ORBextractor::DistributeOctTree(const vector<cv::KeyPoint>&
      * 2. Detects corners in a 7x7 cell area
      * 3. Make sure key points are well distributed
      * 4. Compute orientation of keypoints
+     * The FAST detection runs in parallel over the cell rows of all levels.
+     * The distribution and orientation run in parallel over the levels.
+     * The keypoints of a level are merged in the order of the cells, so the
+     * result does not depend on the NO. of threads.
      * @param allKeypoints
      */
 void ORBextractor::ComputeKeyPointsOctTree(vector<vector<KeyPoint>>& allKeypoints)
@@ -478,77 +521,109 @@ void ORBextractor::ComputeKeyPointsOctTree(vector<vector<KeyPoint>>& allKeypoint
 
     const float W = 30;
 
+    // Cell grid of a pyramid level
+    struct LevelGrid
+    {
+        int minBorderX, minBorderY;
+        int maxBorderX, maxBorderY;
+        int nCols, nRows;
+        int wCell, hCell;
+        int firstRowTask;
+    };
+
+    vector<LevelGrid> grids(nlevels);
+    vector<int>       rowTaskLevel;
+
     for (int level = 0; level < nlevels; ++level)
     {
-        const int minBorderX = EDGE_THRESHOLD - 3;
-        const int minBorderY = minBorderX;
-        const int maxBorderX = mvImagePyramid[level].cols - EDGE_THRESHOLD + 3;
-        const int maxBorderY = mvImagePyramid[level].rows - EDGE_THRESHOLD + 3;
+        LevelGrid& g = grids[level];
+        g.minBorderX = EDGE_THRESHOLD - 3;
+        g.minBorderY = g.minBorderX;
+        g.maxBorderX = mvImagePyramid[level].cols - EDGE_THRESHOLD + 3;
+        g.maxBorderY = mvImagePyramid[level].rows - EDGE_THRESHOLD + 3;
+
+        const float width  = (float)(g.maxBorderX - g.minBorderX);
+        const float height = (float)(g.maxBorderY - g.minBorderY);
+
+        g.nCols        = (int)(width / W);
+        g.nRows        = (int)(height / W);
+        g.wCell        = (int)ceil(width / g.nCols);
+        g.hCell        = (int)ceil(height / g.nRows);
+        g.firstRowTask = (int)rowTaskLevel.size();
+
+        for (int i = 0; i < g.nRows; i++)
+            rowTaskLevel.push_back(level);
+    }
 
-        vector<cv::KeyPoint> vToDistributeKeys;
-        vToDistributeKeys.reserve(nfeatures * 10);
+    // FAST corners of every cell row of every level
+    vector<vector<cv::KeyPoint>> rowKeys(rowTaskLevel.size());
 
-        const float width  = (float)(maxBorderX - minBorderX);
-        const float height = (float)(maxBorderY - minBorderY);
+    _workerPool->parallelFor((int)rowTaskLevel.size(), [&](int task) {
+        const int        level = rowTaskLevel[task];
+        const LevelGrid& g     = grids[level];
+        const int        i     = task - g.firstRowTask;
 
-        const int nCols = (int)(width / W);
-        const int nRows = (int)(height / W);
-        const int wCell = (int)ceil(width / nCols);
-        const int hCell = (int)ceil(height / nRows);
+        const float iniY = (float)(g.minBorderY + i * g.hCell);
+        float       maxY = iniY + g.hCell + 6;
 
-        for (int i = 0; i < nRows; i++)
-        {
-            const float iniY = (float)(minBorderY + i * hCell);
-            float       maxY = iniY + hCell + 6;
+        if (iniY >= g.maxBorderY - 3)
+            return;
+        if (maxY > g.maxBorderY)
+            maxY = (float)g.maxBorderY;
+
+        vector<cv::KeyPoint>& vRowKeys = rowKeys[task];
+        vector<cv::KeyPoint>  vKeysCell;
 
-            if (iniY >= maxBorderY - 3)
+        for (int j = 0; j < g.nCols; j++)
+        {
+            const float iniX = (float)(g.minBorderX + j * g.wCell);
+            float       maxX = iniX + g.wCell + 6;
+            if (iniX >= g.maxBorderX - 6)
                 continue;
-            if (maxY > maxBorderY)
-                maxY = (float)maxBorderY;
+            if (maxX > g.maxBorderX)
+                maxX = (float)g.maxBorderX;
 
-            for (int j = 0; j < nCols; j++)
-            {
-                const float iniX = (float)(minBorderX + j * wCell);
-                float       maxX = iniX + wCell + 6;
-                if (iniX >= maxBorderX - 6)
-                    continue;
-                if (maxX > maxBorderX)
-                    maxX = (float)maxBorderX;
+            vKeysCell.clear();
+            FAST(mvImagePyramid[level].rowRange((int)iniY, (int)maxY).colRange((int)iniX, (int)maxX),
+                 vKeysCell,
+                 iniThFAST,
+                 true);
 
-                vector<cv::KeyPoint> vKeysCell;
+            if (vKeysCell.empty())
+            {
                 FAST(mvImagePyramid[level].rowRange((int)iniY, (int)maxY).colRange((int)iniX, (int)maxX),
                      vKeysCell,
-                     iniThFAST,
+                     minThFAST,
                      true);
+            }
 
-                if (vKeysCell.empty())
-                {
-                    FAST(mvImagePyramid[level].rowRange((int)iniY, (int)maxY).colRange((int)iniX, (int)maxX),
-                         vKeysCell,
-                         minThFAST,
-                         true);
-                }
-
-                if (!vKeysCell.empty())
-                {
-                    for (vector<cv::KeyPoint>::iterator vit = vKeysCell.begin(); vit != vKeysCell.end(); vit++)
-                    {
-                        (*vit).pt.x += j * wCell;
-                        (*vit).pt.y += i * hCell;
-                        vToDistributeKeys.push_back(*vit);
-                    }
-                }
+            for (vector<cv::KeyPoint>::iterator vit = vKeysCell.begin(); vit != vKeysCell.end(); vit++)
+            {
+                (*vit).pt.x += j * g.wCell;
+                (*vit).pt.y += i * g.hCell;
+                vRowKeys.push_back(*vit);
             }
         }
+    });
+
+    // Distribution, scale information and orientation of every level
+    _workerPool->parallelFor(nlevels, [&](int level) {
+        const LevelGrid& g = grids[level];
+
+        vector<cv::KeyPoint> vToDistributeKeys;
+        vToDistributeKeys.reserve(nfeatures * 10);
+
+        for (int task = g.firstRowTask; task < g.firstRowTask + g.nRows; task++)
+            vToDistributeKeys.insert(vToDistributeKeys.end(), rowKeys[task].begin(), rowKeys[task].end());
 
         vector<KeyPoint>& keypoints = allKeypoints[level];
         keypoints.reserve(nfeatures);
 
         keypoints = DistributeOctTree(vToDistributeKeys,
-                                      minBorderX,
-                                      maxBorderX,
-                                      minBorderY,
-                                      maxBorderY,
+                                      g.minBorderX,
+                                      g.maxBorderX,
+                                      g.minBorderY,
+                                      g.maxBorderY,
                                       mnFeaturesPerLevel[level],
                                       level);
 
@@ -558,16 +633,15 @@ void ORBextractor::ComputeKeyPointsOctTree(vector<vector<KeyPoint>>& allKeypoint
         const int nkps = (int)keypoints.size();
         for (int i = 0; i < nkps; i++)
         {
-            keypoints[i].pt.x += minBorderX;
-            keypoints[i].pt.y += minBorderY;
+            keypoints[i].pt.x += g.minBorderX;
+            keypoints[i].pt.y += g.minBorderY;
             keypoints[i].octave = level;
             keypoints[i].size   = (float)scaledPatchSize;
         }
-    }
 
-    // compute orientations
-    for (int level = 0; level < nlevels; ++level)
-        computeOrientation(mvImagePyramid[level], allKeypoints[level], umax);
+        // compute orientations
+        computeOrientation(mvImagePyramid[level], keypoints, umax);
+    });
 }
 
 void ORBextractor::ComputeKeyPointsOld(std::vector<std::vector<KeyPoint>>& allKeypoints)
@@ -788,28 +862,29 @@ void ORBextractor::operator()(InputArray _image, vector<KeyPoint>& _keypoints, O
         descriptors = _descriptors.getMat();
     }
 
-    _keypoints.clear();
-    _keypoints.reserve(nkeypoints);
+    // First descriptor row of every level
+    vector<int> levelOffsets(nlevels, 0);
+    for (int level = 1; level < nlevels; ++level)
+        levelOffsets[level] = levelOffsets[level - 1] + (int)allKeypoints[level - 1].size();
 
-    int offset = 0;
-    for (int level = 0; level < nlevels; ++level)
-    {
-        int               tOffset         = level * 3;
+    // The levels write into disjoint descriptor rows, so they run in parallel
+    _workerPool->parallelFor(nlevels, [&](int level) {
         vector<KeyPoint>& keypoints       = allKeypoints[level];
         int               nkeypointsLevel = (int)keypoints.size();
+        int               offset          = levelOffsets[level];
 
         if (nkeypointsLevel == 0)
-            continue;
+            return;
 
-        // preprocess the resized image
-        Mat workingMat = mvImagePyramid[level].clone();
-        GaussianBlur(workingMat, workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101);
+        // preprocess the resized image into the reused buffer (the isolated
+        // border gives the same result as blurring a clone of the level)
+        Mat& workingMat = _blurBuffers[level];
+        GaussianBlur(mvImagePyramid[level], workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101 | BORDER_ISOLATED);
 
         // Compute the descriptors
         Mat desc = descriptors.rowRange(offset, offset + nkeypointsLevel);
 
         computeDescriptors(workingMat, keypoints, desc, pattern);
-        offset += nkeypointsLevel;
 
         // Scale keypoint coordinates
         if (level != 0)
@@ -821,14 +896,23 @@ void ORBextractor::operator()(InputArray _image, vector<KeyPoint>& _keypoints, O
                  ++keypoint)
                 keypoint->pt *= scale;
         }
+    });
 
-        // And add the keypoints to the output
-        _keypoints.insert(_keypoints.end(), keypoints.begin(), keypoints.end());
-    }
+    // And add the keypoints to the output
+    _keypoints.clear();
+    _keypoints.reserve(nkeypoints);
+    for (int level = 0; level < nlevels; ++level)
+        _keypoints.insert(_keypoints.end(), allKeypoints[level].begin(), allKeypoints[level].end());
 
     AVERAGE_TIMING_STOP("BlurAndComputeDescr");
 }
 
+/**
+     * Builds the image pyramid into buffers that are reused from frame to
+     * frame. Every level is resized from the previous one, so the resizing
+     * is a serial chain. The border of a level is only needed by the level
+     * itself, so the borders of the scaled levels get filled in parallel.
+     */
 void ORBextractor::ComputePyramid(cv::Mat image)
 {
     for (int level = 0; level < nlevels; ++level)
@@ -836,22 +920,24 @@ void ORBextractor::ComputePyramid(cv::Mat image)
         float scale = mvInvScaleFactor[level];
         Size  sz(cvRound((float)image.cols * scale), cvRound((float)image.rows * scale));
         Size  wholeSize(sz.width + EDGE_THRESHOLD * 2, sz.height + EDGE_THRESHOLD * 2);
-        Mat   temp(wholeSize, image.type()), masktemp;
+
+        // Allocates only if the image size changed since the last frame
+        Mat& temp = _pyramidBuffers[level];
+        temp.create(wholeSize, image.type());
         mvImagePyramid[level] = temp(Rect(EDGE_THRESHOLD, EDGE_THRESHOLD, sz.width, sz.height));
 
         // Compute the resized image
         if (level != 0)
-        {
             resize(mvImagePyramid[level - 1], mvImagePyramid[level], sz, 0, 0, INTER_LINEAR);
-
-            copyMakeBorder(mvImagePyramid[level], temp, EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, BORDER_REFLECT_101 + BORDER_ISOLATED);
-        }
         else
-        {
             copyMakeBorder(image, temp, EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, BORDER_REFLECT_101);
-        }
     }
 
+    _workerPool->parallelFor(nlevels - 1, [&](int task) {
+        int level = task + 1;
+        copyMakeBorder(mvImagePyramid[level], _pyramidBuffers[level], EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, EDGE_THRESHOLD, BORDER_REFLECT_101 + BORDER_ISOLATED);
+    });
+
     ////save image pyramid
     //for (int level = 0; level < nlevels; ++level) {
     //    string filename = "D:/Development/ORB_SLAM2/debug_ouput/imagePyriamid" + std::to_string(level) + ".jpg";
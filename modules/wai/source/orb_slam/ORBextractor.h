@@ -23,8 +23,10 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <WAIHelper.h>
+#include <WAIWorkerPool.h>
 #include <orb_slam/KPextractor.h>
 #include <orb_slam/ExtractorNode.h>
 
@@ -54,6 +56,12 @@ class WAI_API ORBextractor : public KPextractor
                     cv::OutputArray            descriptors);
     void computeKeyPointDescriptors(const cv::Mat& image, std::vector<cv::KeyPoint>& keypoints, cv::Mat& descriptors);
 
+    // Sets the NO. of threads for the pyramid, FAST and descriptor computation
+    void numThreads(int numThreads);
+    int  numThreads() const { return _workerPool->numThreads(); }
+    // Sets the worker pool for the level and cell tasks (default: WAIWorkerPool::shared)
+    void workerPool(WAIWorkerPool* pool);
+
     std::vector<cv::Mat> mvImagePyramid;
 
     protected:
@@ -66,6 +74,11 @@ class WAI_API ORBextractor : public KPextractor
 
     int iniThFAST;
     int minThFAST;
+
+    std::vector<cv::Mat>           _pyramidBuffers; // Pyramid images with border, reused between frames
+    std::vector<cv::Mat>           _blurBuffers;    // Blurred pyramid images, reused between frames
+    WAIWorkerPool*                 _workerPool;     // Worker threads for the level and cell tasks
+    std::unique_ptr<WAIWorkerPool> _ownWorkerPool;  // Pool with a custom NO. of threads (see numThreads)
 };
 
 } //namespace ORB_SLAM
@@ -28,6 +28,25 @@
 #include <DBoW2/FeatureVector.h>
 
 #include <stdint.h>
+#include <string.h>
+
+// On x86-64 the AVX2 and POPCNT kernels are compiled with a function target attribute
+// and selected at runtime, so no -mavx2 or -mpopcnt is needed for the whole target
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#        define ORB_TARGET_AVX2
+#        define ORB_TARGET_POPCNT
+#    else
+#        include <immintrin.h>
+#        define ORB_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#        define ORB_TARGET_POPCNT __attribute__((target("popcnt")))
+#    endif
+#    define ORB_HAMMING_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define ORB_HAMMING_NEON
+#endif
 
 using namespace std;
 
@@ -49,6 +68,8 @@ int ORBmatcher::SearchByProjection(WAIFrame& F, const vector<WAIMapPoint*>& vpMa
 
     const bool bFactor = th != 1.0;
 
+    vector<int> vDist;
+
     for (size_t iMP = 0; iMP < vpMapPoints.size(); iMP++)
     {
         WAIMapPoint* pMP = vpMapPoints[iMP];
@@ -72,7 +93,15 @@ int ORBmatcher::SearchByProjection(WAIFrame& F, const vector<WAIMapPoint*>& vpMa
         if (vIndices.empty())
             continue;
 
-        const cv::Mat MPdescriptor = pMP->GetDescriptor();
+        // The descriptor is read without locking or copying the map point descriptor
+        WAIMapPointSnapshot mpSnapshot;
+        pMP->GetSnapshot(mpSnapshot);
+        if (!mpSnapshot.hasDescriptor)
+            continue;
+        const cv::Mat MPdescriptor(1, 32, CV_8U, mpSnapshot.descriptor);
+
+        // Compare the descriptor to all near keypoints at once
+        DescriptorDistances(MPdescriptor, F.mDescriptors, vIndices, vDist);
 
         int bestDist   = 256;
         int bestLevel  = -1;
@@ -81,9 +110,9 @@ int ORBmatcher::SearchByProjection(WAIFrame& F, const vector<WAIMapPoint*>& vpMa
         int bestIdx    = -1;
 
         // Get best and second matches with near keypoints
-        for (vector<size_t>::const_iterator vit = vIndices.begin(), vend = vIndices.end(); vit != vend; vit++)
+        for (size_t iC = 0; iC < vIndices.size(); iC++)
         {
-            const size_t idx = *vit;
+            const size_t idx = vIndices[iC];
 
             if (F.mvpMapPoints[idx])
                 if (F.mvpMapPoints[idx]->Observations() > 0)
@@ -96,9 +125,7 @@ int ORBmatcher::SearchByProjection(WAIFrame& F, const vector<WAIMapPoint*>& vpMa
             //        continue;
             //}
 
-            const cv::Mat& d = F.mDescriptors.row((int)idx);
-
-            const int dist = DescriptorDistance(MPdescriptor, d);
+            const int dist = vDist[iC];
 
             if (dist < bestDist)
             {
@@ -175,6 +202,8 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF, WAIFrame& F, vector<WAIMapPoint*>&
     }
     const float factor = 1.0f / HISTO_LENGTH;
 
+    vector<int> vDist;
+
     // We perform the matching over ORB that belong to the same vocabulary node (at a certain level)
     auto KFit  = vFeatVecKF.getFeatMapping().begin();
     auto Fit   = F.mFeatVec.getFeatMapping().begin();
@@ -185,8 +214,8 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF, WAIFrame& F, vector<WAIMapPoint*>&
     {
         if (KFit->first == Fit->first)
         {
-            const vector<unsigned int> vIndicesKF = KFit->second;
-            const vector<unsigned int> vIndicesF  = Fit->second;
+            const vector<unsigned int>& vIndicesKF = KFit->second;
+            const vector<unsigned int>& vIndicesF  = Fit->second;
 
             for (size_t iKF = 0; iKF < vIndicesKF.size(); iKF++)
             {
@@ -202,6 +231,8 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF, WAIFrame& F, vector<WAIMapPoint*>&
 
                 const cv::Mat& dKF = pKF->mDescriptors.row(realIdxKF);
 
+                DescriptorDistances(dKF, F.mDescriptors, vIndicesF, vDist);
+
                 int bestDist1 = 256;
                 int bestIdxF  = -1;
                 int bestDist2 = 256;
@@ -213,9 +244,7 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF, WAIFrame& F, vector<WAIMapPoint*>&
                     if (vpMapPointMatches[realIdxF])
                         continue;
 
-                    const cv::Mat& dF = F.mDescriptors.row(realIdxF);
-
-                    const int dist = DescriptorDistance(dKF, dF);
+                    const int dist = vDist[iF];
 
                     if (dist < bestDist1)
                     {
@@ -664,7 +693,8 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, vector<WAIMapP
 
     const float factor = 1.0f / HISTO_LENGTH;
 
-    int nmatches = 0;
+    int         nmatches = 0;
+    vector<int> vDist;
 
     auto f1it  = vFeatVec1.getFeatMapping().begin();
     auto f2it  = vFeatVec2.getFeatMapping().begin();
@@ -687,6 +717,8 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, vector<WAIMapP
 
                 const cv::Mat& d1 = Descriptors1.row((int)idx1);
 
+                DescriptorDistances(d1, Descriptors2, f2it->second, vDist);
+
                 int bestDist1 = 256;
                 int bestIdx2  = -1;
                 int bestDist2 = 256;
@@ -703,9 +735,7 @@ int ORBmatcher::SearchByBoW(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, vector<WAIMapP
                     if (pMP2->isBad())
                         continue;
 
-                    const cv::Mat& d2 = Descriptors2.row((int)idx2);
-
-                    int dist = DescriptorDistance(d1, d2);
+                    int dist = vDist[i2];
 
                     if (dist < bestDist1)
                     {
@@ -800,6 +830,7 @@ int ORBmatcher::SearchForTriangulation(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, cv:
     int          nmatches = 0;
     vector<bool> vbMatched2(pKF2->N, false);
     vector<int>  vMatches12(pKF1->N, -1);
+    vector<int>  vDist;
 
     vector<int> rotHist[HISTO_LENGTH];
     for (int i = 0; i < HISTO_LENGTH; i++)
@@ -837,6 +868,8 @@ int ORBmatcher::SearchForTriangulation(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, cv:
 
                 const cv::Mat& d1 = pKF1->mDescriptors.row((int)idx1);
 
+                DescriptorDistances(d1, pKF2->mDescriptors, f2it->second, vDist);
+
                 int bestDist = TH_LOW;
                 int bestIdx2 = -1;
 
@@ -857,9 +890,7 @@ int ORBmatcher::SearchForTriangulation(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, cv:
                         if (!bStereo2)
                             continue;
 
-                    const cv::Mat& d2 = pKF2->mDescriptors.row((int)idx2);
-
-                    const int dist = DescriptorDistance(d1, d2);
+                    const int dist = vDist[i2];
 
                     if (dist > TH_LOW || dist > bestDist)
                         continue;
@@ -947,8 +978,17 @@ int ORBmatcher::SearchForTriangulation(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, cv:
     return nmatches;
 }
 
-int ORBmatcher::Fuse(WAIMap * map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const float th)
+int ORBmatcher::Fuse(WAIMap* map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const float th)
+{
+    vector<int> vMatchedIdx(vpMapPoints.size(), -1);
+    FuseSearch(pKF, vpMapPoints, 0, (int)vpMapPoints.size(), vMatchedIdx, th);
+    return FuseApply(map, pKF, vpMapPoints, vMatchedIdx);
+}
+
+void ORBmatcher::FuseSearch(WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, int first, int last, vector<int>& vMatchedIdx, const float th)
 {
+    assert(vMatchedIdx.size() == vpMapPoints.size() && first >= 0 && last <= (int)vpMapPoints.size());
+
     cv::Mat Rcw = pKF->GetRotation();
     cv::Mat tcw = pKF->GetTranslation();
 
@@ -960,12 +1000,10 @@ int ORBmatcher::Fuse(WAIMap * map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>&
 
     cv::Mat Ow = pKF->GetCameraCenter();
 
-    int nFused = 0;
-
-    const int nMPs = (int)vpMapPoints.size();
-
-    for (int i = 0; i < nMPs; i++)
+    for (int i = first; i < last; i++)
     {
+        vMatchedIdx[i] = -1;
+
         WAIMapPoint* pMP = vpMapPoints[i];
 
         if (!pMP)
@@ -1073,33 +1111,52 @@ int ORBmatcher::Fuse(WAIMap * map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>&
             }
         }
 
-        // If there is already a WAIMapPoint replace otherwise add new measurement
         if (bestDist <= TH_LOW)
+            vMatchedIdx[i] = bestIdx;
+    }
+}
+
+int ORBmatcher::FuseApply(WAIMap* map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const vector<int>& vMatchedIdx)
+{
+    int nFused = 0;
+
+    const int nMPs = (int)vpMapPoints.size();
+
+    for (int i = 0; i < nMPs; i++)
+    {
+        const int bestIdx = vMatchedIdx[i];
+        if (bestIdx < 0)
+            continue;
+
+        // The MapPoint may have been replaced or added to the keyframe since the search
+        WAIMapPoint* pMP = vpMapPoints[i];
+        if (pMP->isBad() || pMP->IsInKeyFrame(pKF))
+            continue;
+
+        // If there is already a WAIMapPoint replace otherwise add new measurement
+        WAIMapPoint* pMPinKF = pKF->GetMapPoint(bestIdx);
+        if (pMPinKF)
         {
-            WAIMapPoint* pMPinKF = pKF->GetMapPoint(bestIdx);
-            if (pMPinKF)
+            if (!pMPinKF->isBad())
             {
-                if (!pMPinKF->isBad())
+                if (pMPinKF->Observations() > pMP->Observations())
                 {
-                    if (pMPinKF->Observations() > pMP->Observations())
-                    {
-                        pMP->Replace(pMPinKF);
-                        map->EraseMapPoint(pMP);
-                    }
-                    else
-                    {
-                        pMPinKF->Replace(pMP);
-                        map->EraseMapPoint(pMPinKF);
-                    }
+                    pMP->Replace(pMPinKF);
+                    map->EraseMapPoint(pMP);
+                }
+                else
+                {
+                    pMPinKF->Replace(pMP);
+                    map->EraseMapPoint(pMPinKF);
                 }
             }
-            else
-            {
-                pKF->AddMapPoint(pMP, bestIdx);
-                pMP->AddObservation(pKF, bestIdx);
-            }
-            nFused++;
         }
+        else
+        {
+            pKF->AddMapPoint(pMP, bestIdx);
+            pMP->AddObservation(pKF, bestIdx);
+        }
+        nFused++;
     }
 
     return nFused;
@@ -1465,6 +1522,8 @@ int ORBmatcher::SearchByProjection(WAIFrame& CurrentFrame, const WAIFrame& LastF
         rotHist[i].reserve(500);
     const float factor = 1.0f / HISTO_LENGTH;
 
+    vector<int> vDist;
+
     const cv::Mat Rcw = CurrentFrame.mTcw.rowRange(0, 3).colRange(0, 3);
     const cv::Mat tcw = CurrentFrame.mTcw.rowRange(0, 3).col(3);
 
@@ -1516,12 +1575,14 @@ int ORBmatcher::SearchByProjection(WAIFrame& CurrentFrame, const WAIFrame& LastF
 
                 const cv::Mat dMP = pMP->GetDescriptor();
 
+                DescriptorDistances(dMP, CurrentFrame.mDescriptors, vIndices2, vDist);
+
                 int bestDist = 256;
                 int bestIdx2 = -1;
 
-                for (vector<size_t>::const_iterator vit = vIndices2.begin(), vend = vIndices2.end(); vit != vend; vit++)
+                for (size_t iC = 0; iC < vIndices2.size(); iC++)
                 {
-                    const size_t i2 = *vit;
+                    const size_t i2 = vIndices2[iC];
                     if (CurrentFrame.mvpMapPoints[i2])
                         if (CurrentFrame.mvpMapPoints[i2]->Observations() > 0)
                             continue;
@@ -1534,9 +1595,7 @@ int ORBmatcher::SearchByProjection(WAIFrame& CurrentFrame, const WAIFrame& LastF
                     //        continue;
                     //}
 
-                    const cv::Mat& d = CurrentFrame.mDescriptors.row((int)i2);
-
-                    const int dist = DescriptorDistance(dMP, d);
+                    const int dist = vDist[iC];
 
                     if (dist < bestDist)
                     {
@@ -1605,6 +1664,8 @@ int ORBmatcher::SearchByProjection(WAIFrame& CurrentFrame, WAIKeyFrame* pKF, con
         rotHist[i].reserve(500);
     const float factor = 1.0f / HISTO_LENGTH;
 
+    vector<int> vDist;
+
     const vector<WAIMapPoint*> vpMPs = pKF->GetMapPointMatches();
 
     for (size_t i = 0, iend = vpMPs.size(); i < iend; i++)
@@ -1654,18 +1715,18 @@ int ORBmatcher::SearchByProjection(WAIFrame& CurrentFrame, WAIKeyFrame* pKF, con
 
                 const cv::Mat dMP = pMP->GetDescriptor();
 
+                DescriptorDistances(dMP, CurrentFrame.mDescriptors, vIndices2, vDist);
+
                 int bestDist = 256;
                 int bestIdx2 = -1;
 
-                for (vector<size_t>::const_iterator vit = vIndices2.begin(); vit != vIndices2.end(); vit++)
+                for (size_t iC = 0; iC < vIndices2.size(); iC++)
                 {
-                    const size_t i2 = *vit;
+                    const size_t i2 = vIndices2[iC];
                     if (CurrentFrame.mvpMapPoints[i2])
                         continue;
 
-                    const cv::Mat& d = CurrentFrame.mDescriptors.row((int)i2);
-
-                    const int dist = DescriptorDistance(dMP, d);
+                    const int dist = vDist[iC];
 
                     if (dist < bestDist)
                     {
@@ -1762,24 +1823,203 @@ void ORBmatcher::ComputeThreeMaxima(vector<int>* histo, const int L, int& ind1,
     }
 }
 
+// Hamming distance kernels for 256 bit ORB descriptors. Each kernel compares the query descriptor a
+// to n candidates: The candidate i is the row indices[i] of data or the row i if indices is null.
+// AVX2 compares a whole descriptor per instruction and counts the bits with a nibble lookup table,
+// POPCNT counts four 64 bit words and NEON counts bytes with vcnt. Without any of them the bits of
+// four 64 bit words are counted with the parallel bit count.
+template<typename IndexT>
+static inline const uchar* CandidateRow(const uchar* data, size_t step, const IndexT* indices, int i)
+{
+    return data + (indices ? (size_t)indices[i] : (size_t)i) * step;
+}
+
 // Bit set count operation from
 // http://graphics.stanford.edu/~seander/bithacks.html#CountBitsSetParallel
-int ORBmatcher::DescriptorDistance(const cv::Mat& a, const cv::Mat& b)
+static inline int PopCount64(uint64_t v)
+{
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    return (int)((((v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL) * 0x0101010101010101ULL) >> 56);
+}
+
+template<typename IndexT>
+static void HammingDistancesGeneric(const uchar* a, const uchar* data, size_t step, const IndexT* indices, int n, int* dist)
+{
+    uint64_t qa[4], qb[4];
+    memcpy(qa, a, 32);
+
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(qb, CandidateRow(data, step, indices, i), 32);
+        dist[i] = PopCount64(qa[0] ^ qb[0]) + PopCount64(qa[1] ^ qb[1]) +
+                  PopCount64(qa[2] ^ qb[2]) + PopCount64(qa[3] ^ qb[3]);
+    }
+}
+
+#if defined(ORB_HAMMING_X86)
+template<typename IndexT>
+ORB_TARGET_POPCNT static void HammingDistancesPOPCNT(const uchar* a, const uchar* data, size_t step, const IndexT* indices, int n, int* dist)
+{
+    uint64_t qa[4], qb[4];
+    memcpy(qa, a, 32);
+
+    for (int i = 0; i < n; i++)
+    {
+        memcpy(qb, CandidateRow(data, step, indices, i), 32);
+        dist[i] = (int)(_mm_popcnt_u64(qa[0] ^ qb[0]) + _mm_popcnt_u64(qa[1] ^ qb[1]) +
+                        _mm_popcnt_u64(qa[2] ^ qb[2]) + _mm_popcnt_u64(qa[3] ^ qb[3]));
+    }
+}
+
+template<typename IndexT>
+ORB_TARGET_AVX2 static void HammingDistancesAVX2(const uchar* a, const uchar* data, size_t step, const IndexT* indices, int n, int* dist)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low4   = _mm256_set1_epi8(0x0f);
+    const __m256i qa     = _mm256_loadu_si256((const __m256i*)a);
+
+    for (int i = 0; i < n; i++)
+    {
+        __m256i v   = _mm256_xor_si256(qa, _mm256_loadu_si256((const __m256i*)CandidateRow(data, step, indices, i)));
+        __m256i lo  = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low4));
+        __m256i hi  = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+        __m256i sum = _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+
+        dist[i] = _mm256_extract_epi32(sum, 0) + _mm256_extract_epi32(sum, 2) +
+                  _mm256_extract_epi32(sum, 4) + _mm256_extract_epi32(sum, 6);
+    }
+}
+
+enum HammingKernel
+{
+    HAMMING_GENERIC,
+    HAMMING_POPCNT,
+    HAMMING_AVX2
+};
+
+// Returns the fastest kernel that the CPU supports
+static HammingKernel SelectHammingKernel()
+{
+#    if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool popcnt  = (info[2] & (1 << 23)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+
+    // AVX2 also needs the OS to save the YMM registers
+    bool avx2 = false;
+    if (maxLeaf >= 7 && avx && osxsave && (_xgetbv(0) & 6) == 6)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#    else
+    __builtin_cpu_init();
+    bool popcnt = __builtin_cpu_supports("popcnt");
+    bool avx2   = __builtin_cpu_supports("avx2");
+#    endif
+
+    if (avx2 && popcnt)
+        return HAMMING_AVX2;
+    if (popcnt)
+        return HAMMING_POPCNT;
+    return HAMMING_GENERIC;
+}
+
+static HammingKernel GetHammingKernel()
 {
-    const int* pa = a.ptr<int32_t>();
-    const int* pb = b.ptr<int32_t>();
+    static const HammingKernel kernel = SelectHammingKernel();
+    return kernel;
+}
+#elif defined(ORB_HAMMING_NEON)
+template<typename IndexT>
+static void HammingDistancesNEON(const uchar* a, const uchar* data, size_t step, const IndexT* indices, int n, int* dist)
+{
+    const uint8x16_t qa0 = vld1q_u8(a);
+    const uint8x16_t qa1 = vld1q_u8(a + 16);
 
-    int dist = 0;
+    for (int i = 0; i < n; i++)
+    {
+        const uchar* b = CandidateRow(data, step, indices, i);
+        uint8x16_t   c = vaddq_u8(vcntq_u8(veorq_u8(qa0, vld1q_u8(b))),
+                                vcntq_u8(veorq_u8(qa1, vld1q_u8(b + 16))));
+#    if defined(__aarch64__)
+        dist[i] = vaddlvq_u8(c);
+#    else
+        uint64x2_t s = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(c)));
+        dist[i]      = (int)(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+#    endif
+    }
+}
+#endif
 
-    for (int i = 0; i < 8; i++, pa++, pb++)
+template<typename IndexT>
+static void HammingDistances(const uchar* a, const uchar* data, size_t step, const IndexT* indices, int n, int* dist)
+{
+#if defined(ORB_HAMMING_X86)
+    switch (GetHammingKernel())
     {
-        unsigned int v = *pa ^ *pb;
-        v              = v - ((v >> 1) & 0x55555555);
-        v              = (v & 0x33333333) + ((v >> 2) & 0x33333333);
-        dist += (((v + (v >> 4)) & 0xF0F0F0F) * 0x1010101) >> 24;
+        case HAMMING_AVX2: HammingDistancesAVX2(a, data, step, indices, n, dist); break;
+        case HAMMING_POPCNT: HammingDistancesPOPCNT(a, data, step, indices, n, dist); break;
+        default: HammingDistancesGeneric(a, data, step, indices, n, dist);
     }
+#elif defined(ORB_HAMMING_NEON)
+    HammingDistancesNEON(a, data, step, indices, n, dist);
+#else
+    HammingDistancesGeneric(a, data, step, indices, n, dist);
+#endif
+}
+
+int ORBmatcher::DescriptorDistance(const cv::Mat& a, const cv::Mat& b)
+{
+    return DescriptorDistance(a.ptr<uchar>(), b.ptr<uchar>());
+}
 
+int ORBmatcher::DescriptorDistance(const uchar* a, const uchar* b)
+{
+    int dist;
+#if defined(ORB_HAMMING_X86)
+    // a single pair does not pay off the AVX2 setup
+    if (GetHammingKernel() != HAMMING_GENERIC)
+        HammingDistancesPOPCNT<int>(a, b, 0, nullptr, 1, &dist);
+    else
+        HammingDistancesGeneric<int>(a, b, 0, nullptr, 1, &dist);
+#else
+    HammingDistances<int>(a, b, 0, nullptr, 1, &dist);
+#endif
     return dist;
 }
 
+void ORBmatcher::DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, const vector<size_t>& vIndices, vector<int>& vDist)
+{
+    assert(a.cols == 32 && descriptors.cols == 32 && a.type() == CV_8U && descriptors.type() == CV_8U);
+
+    vDist.resize(vIndices.size());
+    HammingDistances(a.ptr<uchar>(), descriptors.data, descriptors.step[0], vIndices.data(), (int)vIndices.size(), vDist.data());
+}
+
+void ORBmatcher::DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, const vector<unsigned int>& vIndices, vector<int>& vDist)
+{
+    assert(a.cols == 32 && descriptors.cols == 32 && a.type() == CV_8U && descriptors.type() == CV_8U);
+
+    vDist.resize(vIndices.size());
+    HammingDistances(a.ptr<uchar>(), descriptors.data, descriptors.step[0], vIndices.data(), (int)vIndices.size(), vDist.data());
+}
+
+void ORBmatcher::DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, int first, int n, int* dist)
+{
+    assert(a.cols == 32 && descriptors.cols == 32 && a.type() == CV_8U && descriptors.type() == CV_8U);
+    assert(first >= 0 && first + n <= descriptors.rows);
+    if (n <= 0)
+        return;
+
+    HammingDistances<int>(a.ptr<uchar>(), descriptors.ptr<uchar>(first), descriptors.step[0], nullptr, n, dist);
+}
+
 } //namespace ORB_SLAM
@@ -39,6 +39,16 @@ class ORBmatcher
 
     // Computes the Hamming distance between two ORB descriptors
     static int DescriptorDistance(const cv::Mat& a, const cv::Mat& b);
+    static int DescriptorDistance(const uchar* a, const uchar* b);
+
+    // Computes the Hamming distances between descriptor a and the rows vIndices of the
+    // descriptors of a frame or keyframe (one-to-many). vDist gets resized to vIndices.size().
+    static void DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, const std::vector<size_t>& vIndices, std::vector<int>& vDist);
+    static void DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, const std::vector<unsigned int>& vIndices, std::vector<int>& vDist);
+
+    // Computes the Hamming distances between descriptor a and the n contiguous rows of descriptors
+    // starting at row first (one-to-many)
+    static void DescriptorDistances(const cv::Mat& a, const cv::Mat& descriptors, int first, int n, int* dist);
 
     // Search matches between Frame keypoints and projected MapPoints. Returns number of matches
     // Used to track the local map (Tracking)
@@ -75,7 +85,15 @@ class ORBmatcher
     int SearchBySim3(WAIKeyFrame* pKF1, WAIKeyFrame* pKF2, std::vector<WAIMapPoint*>& vpMatches12, const float& s12, const cv::Mat& R12, const cv::Mat& t12, const float th);
 
     // Project MapPoints into KeyFrame and search for duplicated MapPoints.
-    int Fuse(WAIMap * map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const float th = 3.0);
+    int Fuse(WAIMap* map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const float th = 3.0);
+
+    // Search part of Fuse: Projects the MapPoints [first, last) into KeyFrame and stores in vMatchedIdx
+    // the index of the matched keypoint or -1. vMatchedIdx must have the size of vpMapPoints.
+    // Nothing is modified, so different ranges or keyframes can be searched in parallel.
+    void FuseSearch(WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, int first, int last, vector<int>& vMatchedIdx, const float th = 3.0);
+
+    // Apply part of Fuse: Adds or replaces the MapPoints matched by FuseSearch in KeyFrame.
+    int FuseApply(WAIMap* map, WAIKeyFrame* pKF, const vector<WAIMapPoint*>& vpMapPoints, const vector<int>& vMatchedIdx);
 
     // Project MapPoints into KeyFrame using a given Sim3 and search for duplicated MapPoints.
     int Fuse(WAIKeyFrame* pKF, cv::Mat Scw, const std::vector<WAIMapPoint*>& vpPoints, float th, vector<WAIMapPoint*>& vpReplacePoint);
@@ -44,12 +44,87 @@ void Optimizer::GlobalBundleAdjustemnt(WAIMap*             pMap,
     BundleAdjustment(vpKFs, vpMP, nIterations, pbStopFlag, nLoopKF, bRobust);
 }
 
+void Optimizer::LoopBundleAdjustment(WAIMap*             pMap,
+                                     WAIKeyFrame*        pLoopKF,
+                                     WAIKeyFrame*        pCurKF,
+                                     int                 nIterations,
+                                     bool*               pbStopFlag,
+                                     const unsigned long nLoopKF,
+                                     const bool          bRobust)
+{
+    // The region of the loop are the keyframes created since the loop keyframe and the
+    // neighbors of the loop keyframe. The loop keyframe was fixed in the essential graph
+    // optimization and stays fixed.
+    vector<WAIKeyFrame*> vpKFs;
+    set<WAIKeyFrame*>    sRegionKFs;
+
+    const vector<WAIKeyFrame*> vpAllKFs = pMap->GetAllKeyFrames();
+    for (WAIKeyFrame* pKF : vpAllKFs)
+    {
+        if (!pKF->isBad() && pKF != pLoopKF && pKF->mnId >= pLoopKF->mnId)
+            sRegionKFs.insert(pKF);
+    }
+
+    const vector<WAIKeyFrame*> vpLoopNeighKFs = pLoopKF->GetVectorCovisibleKeyFrames();
+    for (WAIKeyFrame* pKF : vpLoopNeighKFs)
+    {
+        if (!pKF->isBad())
+            sRegionKFs.insert(pKF);
+    }
+    sRegionKFs.insert(pCurKF);
+    sRegionKFs.erase(pLoopKF);
+
+    vpKFs.assign(sRegionKFs.begin(), sRegionKFs.end());
+
+    // All map points seen in the region
+    vector<WAIMapPoint*> vpMP;
+    set<WAIMapPoint*>    sMPs;
+    for (WAIKeyFrame* pKF : vpKFs)
+    {
+        const vector<WAIMapPoint*> vpMPsKF = pKF->GetMapPointMatches();
+        for (WAIMapPoint* pMP : vpMPsKF)
+        {
+            if (pMP && !pMP->isBad() && sMPs.insert(pMP).second)
+                vpMP.push_back(pMP);
+        }
+    }
+
+    // Keyframes outside of the region that see these map points are fixed
+    vector<WAIKeyFrame*> vpFixedKFs;
+    set<WAIKeyFrame*>    sFixedKFs;
+    sFixedKFs.insert(pLoopKF);
+    vpFixedKFs.push_back(pLoopKF);
+    for (WAIMapPoint* pMP : vpMP)
+    {
+        const map<WAIKeyFrame*, size_t> observations = pMP->GetObservations();
+        for (auto& obs : observations)
+        {
+            WAIKeyFrame* pKF = obs.first;
+            if (!pKF->isBad() && !sRegionKFs.count(pKF) && sFixedKFs.insert(pKF).second)
+                vpFixedKFs.push_back(pKF);
+        }
+    }
+
+    BundleAdjustment(vpKFs, vpFixedKFs, vpMP, nIterations, pbStopFlag, nLoopKF, bRobust);
+}
+
 void Optimizer::BundleAdjustment(const vector<WAIKeyFrame*>& vpKFs,
                                  const vector<WAIMapPoint*>& vpMP,
                                  int                         nIterations,
                                  bool*                       pbStopFlag,
                                  const unsigned long         nLoopKF,
                                  const bool                  bRobust)
+{
+    BundleAdjustment(vpKFs, vector<WAIKeyFrame*>(), vpMP, nIterations, pbStopFlag, nLoopKF, bRobust);
+}
+
+void Optimizer::BundleAdjustment(const vector<WAIKeyFrame*>& vpKFs,
+                                 const vector<WAIKeyFrame*>& vpFixedKFs,
+                                 const vector<WAIMapPoint*>& vpMP,
+                                 int                         nIterations,
+                                 bool*                       pbStopFlag,
+                                 const unsigned long         nLoopKF,
+                                 const bool                  bRobust)
 {
     vector<bool> vbNotIncludedMP;
     vbNotIncludedMP.resize(vpMP.size());
@@ -84,6 +159,21 @@ void Optimizer::BundleAdjustment(const vector<WAIKeyFrame*>& vpKFs,
             maxKFid = pKF->mnId;
     }
 
+    // Set fixed WAIKeyFrame vertices
+    for (size_t i = 0; i < vpFixedKFs.size(); i++)
+    {
+        WAIKeyFrame* pKF = vpFixedKFs[i];
+        if (pKF->isBad())
+            continue;
+        g2o::VertexSE3Expmap* vSE3 = new g2o::VertexSE3Expmap();
+        vSE3->setEstimate(Converter::toSE3Quat(pKF->GetPose()));
+        vSE3->setId((int)pKF->mnId);
+        vSE3->setFixed(true);
+        optimizer.addVertex(vSE3);
+        if (pKF->mnId > maxKFid)
+            maxKFid = pKF->mnId;
+    }
+
     const float thHuber2D = sqrt(CHI2_1);
 
     // Set WAIMapPoint vertices
@@ -106,7 +196,7 @@ void Optimizer::BundleAdjustment(const vector<WAIKeyFrame*>& vpKFs,
         for (map<WAIKeyFrame*, size_t>::const_iterator mit = observations.begin(); mit != observations.end(); mit++)
         {
             WAIKeyFrame* pKF = mit->first;
-            if (pKF->isBad() || pKF->mnId > maxKFid)
+            if (pKF->isBad() || pKF->mnId > maxKFid || !optimizer.vertex((int)pKF->mnId))
                 continue;
 
             nEdges++;
@@ -177,6 +267,19 @@ void Optimizer::BundleAdjustment(const vector<WAIKeyFrame*>& vpKFs,
         }
     }
 
+    // The fixed keyframes keep their pose
+    if (nLoopKF != 0)
+    {
+        for (size_t i = 0; i < vpFixedKFs.size(); i++)
+        {
+            WAIKeyFrame* pKF = vpFixedKFs[i];
+            if (pKF->isBad())
+                continue;
+            pKF->mTcwGBA                = pKF->GetPose();
+            pKF->mnMarker[BA_GLOBAL_KF] = nLoopKF;
+        }
+    }
+
     //Points
     for (size_t i = 0; i < vpMP.size(); i++)
     {
@@ -59,8 +59,12 @@ class WAI_API Optimizer
 {
 public:
     void static BundleAdjustment(const std::vector<WAIKeyFrame*>& vpKF, const std::vector<WAIMapPoint*>& vpMP, int nIterations = 5, bool* pbStopFlag = NULL, const unsigned long nLoopKF = 0, const bool bRobust = true);
+    void static BundleAdjustment(const std::vector<WAIKeyFrame*>& vpKF, const std::vector<WAIKeyFrame*>& vpFixedKF, const std::vector<WAIMapPoint*>& vpMP, int nIterations = 5, bool* pbStopFlag = NULL, const unsigned long nLoopKF = 0, const bool bRobust = true);
     void static GlobalBundleAdjustemnt(WAIMap* pMap, int nIterations = 5, bool* pbStopFlag = NULL, const unsigned long nLoopKF = 0, const bool bRobust = true);
 
+    // Bundle adjustment over the region of a closed loop. Keyframes outside of the region that see its map points are fixed
+    void static LoopBundleAdjustment(WAIMap* pMap, WAIKeyFrame* pLoopKF, WAIKeyFrame* pCurKF, int nIterations = 10, bool* pbStopFlag = NULL, const unsigned long nLoopKF = 0, const bool bRobust = false);
+
     void static initOptimizerStruct(OptimizerStruct* os, WAIKeyFrame* pKF, WorkingSet &wc);
     void static LocalBundleAdjustment(OptimizerStruct* os, bool* pbStopFlag);
     void static applyBundleAdjustment(OptimizerStruct* os, WAIMap* pMap);
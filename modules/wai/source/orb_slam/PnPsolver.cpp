@@ -55,7 +55,6 @@
 #include <vector>
 #include <cmath>
 #include <opencv2/core/core.hpp>
-#include <DUtils/Random.h>
 #include <algorithm>
 
 using namespace std;
@@ -63,7 +62,7 @@ using namespace std;
 namespace ORB_SLAM2
 {
 
-PnPsolver::PnPsolver(const WAIFrame& F, const vector<WAIMapPoint*>& vpMapPointMatches) : pws(0), us(0), alphas(0), pcs(0), maximum_number_of_correspondences(0), number_of_correspondences(0), mnInliersi(0), mnIterations(0), mnBestInliers(0), N(0)
+PnPsolver::PnPsolver(const WAIFrame& F, const vector<WAIMapPoint*>& vpMapPointMatches) : pws(0), us(0), alphas(0), pcs(0), maximum_number_of_correspondences(0), number_of_correspondences(0), mnInliersi(0), mnIterations(0), mnBestInliers(0), N(0), mRandom(1337)
 {
     mvpMapPointMatches = vpMapPointMatches;
     mvP2D.reserve(F.mvpMapPoints.size());
@@ -188,7 +187,8 @@ cv::Mat PnPsolver::iterate(int nIterations, bool& bNoMore, vector<bool>& vbInlie
         // Get min set of points
         for (short i = 0; i < mRansacMinSet; ++i)
         {
-            int randi = DUtils::Random::RandomInt(0, (int)vAvailableIndices.size() - 1);
+            std::uniform_int_distribution<int> distribution(0, (int)vAvailableIndices.size() - 1);
+            int                                randi = distribution(mRandom);
 
             int idx = (int)vAvailableIndices[randi];
 
@@ -219,6 +219,17 @@ cv::Mat PnPsolver::iterate(int nIterations, bool& bNoMore, vector<bool>& vbInlie
                 mBestTcw = cv::Mat::eye(4, 4, CV_32F);
                 Rcw.copyTo(mBestTcw.rowRange(0, 3).colRange(0, 3));
                 tcw.copyTo(mBestTcw.rowRange(0, 3).col(3));
+
+                // Adaptive termination: Reduce the max. NO. of iterations to the NO. that
+                // draws at least one set without outliers with the RANSAC probability
+                double wSet = pow((double)mnBestInliers / N, mRansacMinSet);
+                if (wSet >= 1.0)
+                    mRansacMaxIts = min(mRansacMaxIts, mnIterations);
+                else if (wSet > 0.0)
+                {
+                    int nIterations = (int)ceil(log(1 - mRansacProb) / log(1 - wSet));
+                    mRansacMaxIts   = max(1, min(nIterations, mRansacMaxIts));
+                }
             }
 
             if (Refine())
@@ -303,35 +314,38 @@ bool PnPsolver::Refine()
 
 void PnPsolver::CheckInliers()
 {
-    mnInliersi = 0;
-
+    const float r00 = (float)mRi[0][0], r01 = (float)mRi[0][1], r02 = (float)mRi[0][2];
+    const float r10 = (float)mRi[1][0], r11 = (float)mRi[1][1], r12 = (float)mRi[1][2];
+    const float r20 = (float)mRi[2][0], r21 = (float)mRi[2][1], r22 = (float)mRi[2][2];
+    const float t0 = (float)mti[0], t1 = (float)mti[1], t2 = (float)mti[2];
+    const float fuf = (float)fu, fvf = (float)fv, ucf = (float)uc, vcf = (float)vc;
+
+    const cv::Point3f* vP3Dw     = mvP3Dw.data();
+    const cv::Point2f* vP2D      = mvP2D.data();
+    const float*       vMaxError = mvMaxError.data();
+    uchar*             vbInliers = mvbInliersi.data();
+
+    // The loop has no branches, so the compiler can vectorize it
+    int nInliers = 0;
     for (int i = 0; i < N; i++)
     {
-        cv::Point3f P3Dw = mvP3Dw[i];
-        cv::Point2f P2D  = mvP2D[i];
+        const cv::Point3f& P3Dw = vP3Dw[i];
 
-        float Xc    = (float)(mRi[0][0] * P3Dw.x + mRi[0][1] * P3Dw.y + mRi[0][2] * P3Dw.z + mti[0]);
-        float Yc    = (float)(mRi[1][0] * P3Dw.x + mRi[1][1] * P3Dw.y + mRi[1][2] * P3Dw.z + mti[1]);
-        float invZc = (float)(1 / (mRi[2][0] * P3Dw.x + mRi[2][1] * P3Dw.y + mRi[2][2] * P3Dw.z + mti[2]));
+        float Xc    = r00 * P3Dw.x + r01 * P3Dw.y + r02 * P3Dw.z + t0;
+        float Yc    = r10 * P3Dw.x + r11 * P3Dw.y + r12 * P3Dw.z + t1;
+        float invZc = 1.0f / (r20 * P3Dw.x + r21 * P3Dw.y + r22 * P3Dw.z + t2);
 
-        double ue = uc + fu * Xc * invZc;
-        double ve = vc + fv * Yc * invZc;
-
-        float distX = (float)(P2D.x - ue);
-        float distY = (float)(P2D.y - ve);
+        float distX = vP2D[i].x - (ucf + fuf * Xc * invZc);
+        float distY = vP2D[i].y - (vcf + fvf * Yc * invZc);
 
         float error2 = distX * distX + distY * distY;
 
-        if (error2 < mvMaxError[i])
-        {
-            mvbInliersi[i] = true;
-            mnInliersi++;
-        }
-        else
-        {
-            mvbInliersi[i] = false;
-        }
+        uchar bIn    = (uchar)(error2 < vMaxError[i]);
+        vbInliers[i] = bIn;
+        nInliers += bIn;
     }
+
+    mnInliersi = nInliers;
 }
 
 void PnPsolver::set_maximum_number_of_correspondences(int n)
@@ -887,23 +901,16 @@ void PnPsolver::gauss_newton(const cv::Mat* L_6x10, const cv::Mat* Rho, double b
 
 void PnPsolver::qr_solve(cv::Mat* A, cv::Mat* b, cv::Mat* X)
 {
-    static int     max_nr = 0;
-    static double *A1, *A2;
-
     const int nr = A->rows;
     const int nc = A->cols;
 
-    if (max_nr != 0 && max_nr < nr)
-    {
-        delete[] A1;
-        delete[] A2;
-    }
-    if (max_nr < nr)
+    if ((int)mvQrA1.size() < nr)
     {
-        max_nr = nr;
-        A1     = new double[nr];
-        A2     = new double[nr];
+        mvQrA1.resize(nr);
+        mvQrA2.resize(nr);
     }
+    double* A1 = mvQrA1.data();
+    double* A2 = mvQrA2.data();
 
     double* pA = A->ptr<double>(0);
 
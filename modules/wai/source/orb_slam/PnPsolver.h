@@ -51,6 +51,7 @@
 #ifndef PNPSOLVER_H
 #define PNPSOLVER_H
 
+#include <random>
 #include <opencv2/core/core.hpp>
 #include <WAIFrame.h>
 #include <WAIMapPoint.h>
@@ -128,6 +129,9 @@ class PnPsolver
     double cws[4][3], ccs[4][3];
     double cws_determinant;
 
+    // Householder buffers of qr_solve, per solver so that several solvers can iterate in parallel
+    vector<double> mvQrA1, mvQrA2;
+
     vector<WAIMapPoint*> mvpMapPointMatches;
 
     // 2D Points
@@ -144,19 +148,19 @@ class PnPsolver
     double       mRi[3][3];
     double       mti[3];
     cv::Mat      mTcwi;
-    vector<bool> mvbInliersi;
-    int          mnInliersi;
+    vector<uchar> mvbInliersi;
+    int           mnInliersi;
 
     // Current Ransac State
-    int          mnIterations;
-    vector<bool> mvbBestInliers;
-    int          mnBestInliers;
-    cv::Mat      mBestTcw;
+    int           mnIterations;
+    vector<uchar> mvbBestInliers;
+    int           mnBestInliers;
+    cv::Mat       mBestTcw;
 
     // Refined
-    cv::Mat      mRefinedTcw;
-    vector<bool> mvbRefinedInliers;
-    int          mnRefinedInliers;
+    cv::Mat       mRefinedTcw;
+    vector<uchar> mvbRefinedInliers;
+    int           mnRefinedInliers;
 
     // Number of Correspondences
     int N;
@@ -164,6 +168,9 @@ class PnPsolver
     // Indices for random selection [0 .. N-1]
     vector<size_t> mvAllIndices;
 
+    // Own random generator, so that several solvers can iterate in parallel
+    std::mt19937 mRandom;
+
     // RANSAC probability
     double mRansacProb;
 